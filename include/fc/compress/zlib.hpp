@@ -1,10 +1,38 @@
 #pragma once
 
 #include <fc/string.hpp>
+#include <memory>
+#include <string_view>
 
 namespace fc 
 {
 
   string zlib_compress(const string& in);
 
+  /**
+   *  Incremental decoder of a deflate stream, fed with the compressed data as it arrives.
+   */
+  class zlib_inflater
+  {
+    public:
+      enum class format
+      {
+        zlib,   ///< zlib wrapped, or raw deflate when the data does not start with a zlib header
+        gzip
+      };
+
+      explicit zlib_inflater( format f );
+      ~zlib_inflater();
+
+      /// decodes in and appends the output to out, throws if the data is corrupt
+      void write( std::string_view in, std::string& out );
+
+      /// the end of the compressed stream was reached and its checksum matched
+      bool done()const;
+
+    private:
+      struct impl;
+      std::unique_ptr<impl> my;
+  };
+
 } // namespace fc
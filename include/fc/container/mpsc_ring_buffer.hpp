@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+namespace fc {
+
+/**
+ *  Bounded lock-free queue for many producers and a single consumer.
+ *
+ *  Each slot carries a sequence number that tells producers and the consumer whose turn it is, so a
+ *  push is one CAS on the write position plus a release store, and a pop never blocks producers.
+ *  Capacity is rounded up to a power of two. try_push fails instead of blocking when the queue is
+ *  full, leaving the caller to decide whether to count or drop the element.
+ *
+ *  T only needs to be move constructible. try_pop must only be called from one thread at a time.
+ */
+template<typename T>
+class mpsc_ring_buffer {
+public:
+   explicit mpsc_ring_buffer( size_t capacity )
+   : _mask( round_up_pow2( capacity ) - 1 ), _slots( new slot[_mask + 1] ) {
+      for( size_t i = 0; i <= _mask; ++i )
+         _slots[i].seq.store( i, std::memory_order_relaxed );
+   }
+
+   mpsc_ring_buffer( const mpsc_ring_buffer& ) = delete;
+   mpsc_ring_buffer& operator=( const mpsc_ring_buffer& ) = delete;
+
+   ~mpsc_ring_buffer() {
+      while( try_pop() ) {}
+   }
+
+   /// @return false, leaving v untouched, when the queue is full
+   bool try_push( T&& v ) {
+      size_t pos = _head.load( std::memory_order_relaxed );
+      slot* s;
+      while( true ) {
+         s = &_slots[pos & _mask];
+         const size_t seq = s->seq.load( std::memory_order_acquire );
+         const auto diff = static_cast<std::ptrdiff_t>( seq - pos );
+         if( diff == 0 ) {
+            if( _head.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+               break;
+         } else if( diff < 0 ) {
+            return false;
+         } else {
+            pos = _head.load( std::memory_order_relaxed );
+         }
+      }
+      new( &s->storage ) T( std::move( v ) );
+      s->seq.store( pos + 1, std::memory_order_release );
+      return true;
+   }
+
+   /// @return the oldest element, or nothing when the queue is empty or the oldest push is still in progress
+   std::optional<T> try_pop() {
+      const size_t pos = _tail.load( std::memory_order_relaxed );
+      slot& s = _slots[pos & _mask];
+      if( s.seq.load( std::memory_order_acquire ) != pos + 1 )
+         return {};
+      T* p = std::launder( reinterpret_cast<T*>( &s.storage ) );
+      std::optional<T> result( std::move( *p ) );
+      p->~T();
+      s.seq.store( pos + _mask + 1, std::memory_order_release );
+      _tail.store( pos + 1, std::memory_order_relaxed );
+      return result;
+   }
+
+   size_t capacity()const { return _mask + 1; }
+
+   /// number of elements pushed and not yet popped, may be stale by the time it is used
+   size_t size_approx()const {
+      const size_t tail = _tail.load( std::memory_order_relaxed );
+      const size_t head = _head.load( std::memory_order_relaxed );
+      return head > tail ? head - tail : 0;
+   }
+
+private:
+   static size_t round_up_pow2( size_t n ) {
+      size_t r = 2;
+      while( r < n )
+         r <<= 1;
+      return r;
+   }
+
+   struct slot {
+      std::atomic<size_t>                                        seq;
+      typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+   };
+
+   const size_t                    _mask;
+   std::unique_ptr<slot[]>         _slots;
+   alignas(64) std::atomic<size_t> _head{0};
+   alignas(64) std::atomic<size_t> _tail{0};
+};
+
+} // namespace fc
@@ -25,6 +25,17 @@ namespace fc {
 
     int ECDSA_SIG_recover_key_GFp(EC_KEY *eckey, ECDSA_SIG *ecsig, const unsigned char *msg, int msglen, int recid, int check);
 
+    /**
+     *  Recovers the compressed key of the signature r, s in c of digest, see SEC1 4.1.6, without the
+     *  checks of public_key( c, digest ). Runs on a P-256 group shared between calls and BN_CTX of the
+     *  calling thread. recid % 2 is the parity of y of the signing point, recid / 2 whether its x was
+     *  reduced by the order.
+     *  @return false if there is no such key
+     */
+    bool recover_public_key_data( const compact_signature& c, int recid, const fc::sha256& digest, public_key_data& out );
+    /// public_key( c, digest ).serialize() without building the EC_KEY
+    public_key_data recover_public_key_data( const compact_signature& c, const fc::sha256& digest );
+
     /**
      *  @class public_key
      *  @brief contains only the public point of an elliptic curve key.
@@ -146,7 +157,7 @@ namespace fc {
         using crypto::shim<compact_signature>::shim;
 
         public_key_type recover(const sha256& digest, bool check_canonical) const {
-           return public_key_type(public_key(_data, digest, check_canonical).serialize());
+           return public_key_type(recover_public_key_data(_data, digest));
         }
      };
 
@@ -176,7 +187,7 @@ namespace fc {
         }
      };
 
-     //key here is just an optimization for getting the curve's parameters from an already constructed curve
+     //key is not read, the curve's parameters are shared; the recovery id is computed from pub
      compact_signature signature_from_ecdsa(const EC_KEY* key, const public_key_data& pub, fc::ecdsa_sig& sig, const fc::sha256& d);
 
   } // namespace r1
@@ -0,0 +1,53 @@
+#pragma once
+#include <fc/crypto/sha256.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace fc {
+
+   /// runs a task on some thread, e.g. [&pool]( auto t ) { boost::asio::post( pool, std::move(t) ); }
+   using merkle_executor = std::function<void( std::function<void()> )>;
+
+   /**
+    *  Root of the Merkle tree over leaves. The parent of two nodes is the sha256 of their 64 byte
+    *  concatenation, sha256::hash( std::make_pair( left, right ) ); the last node of a level with an odd
+    *  number of nodes is paired with itself. The root of a single leaf is that leaf, of no leaves sha256().
+    *
+    *  Each level is hashed by sha256::hash_pairs, wide levels in chunks shared between the calling thread
+    *  and the threads of a pool owned by fc.
+    */
+   sha256 merkle_root( std::vector<sha256> leaves );
+   /// as above with up to helpers tasks run by executor, 0 hashes on the calling thread only
+   sha256 merkle_root( std::vector<sha256> leaves, const merkle_executor& executor, size_t helpers );
+
+   /**
+    *  A Merkle tree, as merkle_root, that can grow. It keeps every level, so append hashes only the new
+    *  nodes and the ones above them rather than the whole tree: a single leaf costs one hash per level.
+    */
+   class merkle_tree {
+      public:
+         merkle_tree() = default;
+         explicit merkle_tree( std::vector<sha256> leaves );
+
+         void append( const sha256& leaf ) { append( &leaf, 1 ); }
+         void append( const sha256* leaves, size_t count );
+         /// as above with up to helpers tasks run by executor for the wide levels
+         void append( const sha256* leaves, size_t count, const merkle_executor& executor, size_t helpers );
+         void append( const std::vector<sha256>& leaves ) { append( leaves.data(), leaves.size() ); }
+
+         /// merkle_root of the leaves appended so far
+         sha256 root()const { return _levels.empty() ? sha256() : _levels.back().front(); }
+
+         size_t                     size()const   { return _levels.empty() ? 0 : _levels.front().size(); }
+         const std::vector<sha256>& leaves()const;
+
+      private:
+         /// hashes the parents of the nodes of every level from index first of the leaves on
+         void update( size_t first, const merkle_executor& executor, size_t helpers );
+
+         /// leaves first, the root last
+         std::vector<std::vector<sha256>> _levels;
+   };
+
+} // fc
@@ -6,6 +6,10 @@
 #include <fc/reflect/reflect.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/static_variant.hpp>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
 
 namespace fc { namespace crypto {
    namespace config {
@@ -18,18 +22,41 @@ namespace fc { namespace crypto {
       };
    };
 
+   struct recovered_key;
+
    class public_key
    {
       public:
          using storage_type = std::variant<ecc::public_key_shim, r1::public_key_shim, webauthn::public_key>;
+         using recovery_item = std::pair<signature, sha256>;
+         /// runs a task on some thread, e.g. [&pool]( auto t ) { boost::asio::post( pool, std::move(t) ); }
+         using executor_type = std::function<void( std::function<void()> )>;
 
          public_key() = default;
          public_key( public_key&& ) = default;
          public_key( const public_key& ) = default;
          public_key& operator= (const public_key& ) = default;
 
+         /// recovers the key that signed digest, through recovery_cache when it is enabled
          public_key( const signature& c, const sha256& digest, bool check_canonical = true );
 
+         /**
+          *  Recovers the keys of count signatures, result i being the one of items[i]. The items are
+          *  shared out in small chunks between the calling thread and the threads of a pool owned by fc,
+          *  one per core, so a batch on a busy pool still completes on the calling thread.
+          *  An item that cannot be recovered gets its error in its result, the others are unaffected.
+          */
+         static std::vector<recovered_key> recover_batch( const recovery_item* items, size_t count,
+                                                          bool check_canonical = true );
+         /// as above with up to helpers tasks run by executor, 0 recovers on the calling thread only
+         static std::vector<recovered_key> recover_batch( const recovery_item* items, size_t count,
+                                                          const executor_type& executor, size_t helpers,
+                                                          bool check_canonical = true );
+         static std::vector<recovered_key> recover_batch( const std::vector<recovery_item>& items,
+                                                          bool check_canonical = true ) {
+            return recover_batch( items.data(), items.size(), check_canonical );
+         }
+
          public_key( storage_type&& other_storage )
          :_storage(std::forward<storage_type>(other_storage))
          {}
@@ -53,6 +80,14 @@ namespace fc { namespace crypto {
          friend class private_key;
    }; // public_key
 
+   /// result of public_key::recover_batch for one item
+   struct recovered_key {
+      public_key          key;     ///< default constructed if error is set
+      std::exception_ptr  error;
+
+      bool ok()const { return !error; }
+   };
+
 } }  // fc::crypto
 
 namespace fc {
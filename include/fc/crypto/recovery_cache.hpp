@@ -0,0 +1,51 @@
+#pragma once
+#include <fc/crypto/public_key.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/crypto/signature.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <atomic>
+#include <optional>
+
+namespace fc { namespace crypto {
+
+   /**
+    *  Opt-in cache of the keys recovered by public_key( const signature&, const sha256&, bool ), off
+    *  until set_capacity() is called with a non zero capacity.
+    *
+    *  Entries are keyed by the sha256 of the packed signature, the digest and the check_canonical
+    *  flag, so a hit is the key the same recovery would return. The cache is split in shards, each
+    *  with its own lock and least recently used order, picked by the first bytes of the entry id.
+    *  Failed recoveries are not cached.
+    */
+   class recovery_cache {
+      public:
+         struct stats {
+            uint64_t  hits = 0;
+            uint64_t  misses = 0;
+            uint64_t  evictions = 0;   ///< least recently used entries dropped to make room
+            size_t    size = 0;
+            size_t    capacity = 0;
+         };
+
+         /// caps the number of cached keys, evicting the least recently used ones, 0 disables the cache
+         static void   set_capacity( size_t capacity );
+         static size_t capacity();
+         static bool   enabled() { return _enabled.load( std::memory_order_relaxed ); }
+         /// drops all entries, the counters are kept
+         static void   clear();
+         static stats  get_stats();
+
+      private:
+         static sha256                    id( const signature& sig, const sha256& digest, bool check_canonical );
+         static std::optional<public_key> find( const sha256& id );
+         static void                      insert( const sha256& id, const public_key& key );
+
+         static std::atomic<bool> _enabled;
+
+         friend class public_key;
+   };
+
+} }  // fc::crypto
+
+FC_REFLECT( fc::crypto::recovery_cache::stats, (hits)(misses)(evictions)(size)(capacity) )
@@ -80,6 +80,10 @@ class ripemd160
 
   template<> struct get_typename<uint160_t>    { static const char* name()  { return "uint160_t";  } };
 
+  namespace raw {
+    template<> struct is_trivially_packable<ripemd160> : std::true_type {};
+  }
+
 } // namespace fc
 
 namespace std
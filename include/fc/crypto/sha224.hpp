@@ -75,6 +75,10 @@ class sha224
   void to_variant( const sha224& bi, variant& v );
   void from_variant( const variant& v, sha224& bi );
 
+  namespace raw {
+    template<> struct is_trivially_packable<sha224> : std::true_type {};
+  }
+
 } // fc
 namespace std
 {
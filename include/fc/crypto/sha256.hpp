@@ -7,6 +7,7 @@
 #include <boost/container_hash/hash.hpp>
 
 #include <fstream>
+#include <vector>
 
 namespace fc
 {
@@ -32,6 +33,35 @@ class sha256
     // that the file has been read properly and completely
     static sha256 hash( std::ifstream& ifs );
 
+    /// one message of hash_many
+    struct const_buffer {
+       const char* data = nullptr;
+       size_t      size = 0;
+    };
+
+    /**
+     *  out[i] = hash( in[i].data, in[i].size ) for i < count. Many messages are hashed side by side in the
+     *  lanes of a SIMD kernel (AVX-512, SHA extensions or AVX2), picked at run time from what the CPU
+     *  supports, or one at a time by OpenSSL where none of them is available.
+     */
+    static void hash_many( const const_buffer* in, size_t count, sha256* out );
+    static void hash_many( const std::vector<const_buffer>& in, std::vector<sha256>& out );
+
+    /**
+     *  out[i] = hash of the 64 bytes nodes[2i] || nodes[2i+1] for i < pairs, the same as
+     *  hash( std::make_pair( nodes[2i], nodes[2i+1] ) ). This is the step of a Merkle tree from one level
+     *  to the next, and skips the message schedule of the padding block all these messages share.
+     *  out may be nodes, the parents of a level can overwrite its first half.
+     */
+    static void hash_pairs( const sha256* nodes, size_t pairs, sha256* out );
+
+    /// kernels of hash_many and hash_pairs this CPU can run, the one used by default first
+    static std::vector<std::string> hash_many_kernels();
+    /// name of the kernel hash_many and hash_pairs use
+    static const char* hash_many_kernel();
+    /// makes hash_many and hash_pairs use the named kernel; false, and no change, if the CPU cannot run it
+    static bool use_hash_many_kernel( const std::string& name );
+
     template<typename T>
     static sha256 hash( const T& t ) 
     { 
@@ -114,6 +144,10 @@ class sha256
 
   uint64_t hash64(const char* buf, size_t len);    
 
+  namespace raw {
+    template<> struct is_trivially_packable<sha256> : std::true_type {};
+  }
+
 } // fc
 
 #include <spdlog/fmt/fmt.h>
@@ -4,6 +4,9 @@
 #include <string.h>
 #include <stdint.h>
 #include <type_traits>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 #include <boost/multiprecision/cpp_int.hpp>
 
@@ -96,6 +99,70 @@ class datastream<size_t, void> {
      size_t _size;
 };
 
+/**
+ *  A growable output buffer that fc::raw::pack can write to directly, packing in a single pass
+ *  without knowing the final size up front. Capacity grows geometrically and is kept by clear(),
+ *  so a buffer reused for many fc::raw::pack_to calls stops allocating once it is large enough.
+ *  Unlike std::vector<char>, newly reserved bytes are not zero filled.
+ */
+class pack_buffer {
+   public:
+      pack_buffer() = default;
+      explicit pack_buffer( size_t capacity ) { reserve( capacity ); }
+
+      pack_buffer( pack_buffer&& ) = default;
+      pack_buffer& operator=( pack_buffer&& ) = default;
+
+      inline bool write( const char* d, size_t s ) {
+        if( _capacity - _size < s )
+          grow( s );
+        memcpy( _data.get() + _size, d, s );
+        _size += s;
+        return true;
+      }
+
+      inline bool put( char c ) {
+        if( _capacity == _size )
+          grow( 1 );
+        _data[_size++] = c;
+        return true;
+      }
+
+      inline void reserve( size_t s ) {
+        if( s > _capacity )
+          reallocate( s );
+      }
+
+      inline void   clear()                  { _size = 0;                     }
+      inline void   resize( size_t s )       { reserve( s ); _size = s;       }
+      inline bool   valid()const             { return true;                   }
+      inline size_t tellp()const             { return _size;                  }
+      inline size_t size()const              { return _size;                  }
+      inline size_t capacity()const          { return _capacity;              }
+      inline bool   empty()const             { return _size == 0;             }
+      inline char*       data()              { return _data.get();            }
+      inline const char* data()const         { return _data.get();            }
+
+      std::vector<char> to_vector()const     { return std::vector<char>( data(), data() + _size ); }
+
+   private:
+      void grow( size_t s ) {
+        reallocate( std::max( _size + s, _capacity + _capacity / 2 + 64 ) );
+      }
+
+      void reallocate( size_t capacity ) {
+        std::unique_ptr<char[]> data( new char[capacity] );
+        if( _size )
+          memcpy( data.get(), _data.get(), _size );
+        _data     = std::move( data );
+        _capacity = capacity;
+      }
+
+      std::unique_ptr<char[]> _data;
+      size_t                  _size     = 0;
+      size_t                  _capacity = 0;
+};
+
 template <typename Streambuf>
 class datastream<Streambuf, typename std::enable_if_t<std::is_base_of_v<std::streambuf, Streambuf>>> {
  private:
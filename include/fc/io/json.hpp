@@ -4,6 +4,7 @@
 #include <fc/time.hpp>
 #include <fc/utility.hpp>
 #include <fc/exception/exception.hpp>
+#include <functional>
 
 #define DEFAULT_MAX_RECURSION_DEPTH 200
 
@@ -32,10 +33,57 @@ namespace fc
             legacy_generator = 1
          };
          using yield_function_t = fc::optional_delegate<void(size_t)>;
+         /**
+          *  Supplies the next part of a document parsed by from_chunks(), an empty chunk ends the document.
+          *  A chunk must stay valid until the next call.
+          */
+         using chunk_source = std::function<std::string_view()>;
+
+         /**
+          *  Receives the events of a document parsed by parse_events() in document order,
+          *  allowing a caller to consume JSON without building a variant tree.
+          *
+          *  string_view arguments are only valid for the duration of the call.
+          */
+         class sax_handler
+         {
+            public:
+               virtual ~sax_handler(){}
+
+               virtual void on_null() = 0;
+               virtual void on_bool( bool b ) = 0;
+               virtual void on_int64( int64_t i ) = 0;
+               virtual void on_uint64( uint64_t u ) = 0;
+               virtual void on_double( double d ) = 0;
+               /// also receives doubles when parsing with legacy_parser_with_string_doubles
+               virtual void on_string( std::string_view s ) = 0;
+               virtual void on_start_object() = 0;
+               virtual void on_key( std::string_view key ) = 0;
+               virtual void on_end_object() = 0;
+               virtual void on_start_array() = 0;
+               virtual void on_end_array() = 0;
+         };
+
          static constexpr uint64_t max_length_limit = std::numeric_limits<uint64_t>::max();
          static constexpr size_t escape_string_yield_check_count = 128;
-         static variant  from_string( const string& utf8_str, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
-         static variants variants_from_string( const string& utf8_str, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+         static variant  from_string( std::string_view utf8_str, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+         /**
+          *  Same as from_string() but the strings, arrays and objects of the result are stored in arena,
+          *  so a document that is parsed and discarded is released with the arena in one shot.
+          *  The result must be destroyed before arena, @see variant_arena
+          */
+         static variant  from_string( std::string_view utf8_str, variant_arena& arena, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+         /**
+          *  Same as from_string() but the document is pulled from next as the parser needs it, so it can
+          *  be parsed while it arrives without being held in one piece.
+          */
+         static variant  from_chunks( const chunk_source& next, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+         static variants variants_from_string( std::string_view utf8_str, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+         /**
+          *  Parses utf8_str with the same grammar as from_string() but reports each value to handler
+          *  instead of building a variant.  Only the legacy parser types are supported.
+          */
+         static void     parse_events( std::string_view utf8_str, sax_handler& handler, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
          static string   to_string( const variant& v, const yield_function_t& yield, const output_formatting format = output_formatting::stringify_large_ints_and_doubles);
          static string   to_pretty_string( const variant& v, const yield_function_t& yield, const output_formatting format = output_formatting::stringify_large_ints_and_doubles );
 
@@ -86,6 +134,8 @@ namespace fc
    };
 
    std::string escape_string( const std::string_view& str, const json::yield_function_t& yield, bool escape_control_chars = true );
+   /// same as escape_string() but appends the result to out
+   void append_escaped_string( std::string& out, const std::string_view& str, const json::yield_function_t& yield, bool escape_control_chars = true );
 
 } // fc
 
@@ -0,0 +1,451 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/static_variant.hpp>
+#include <array>
+#include <deque>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace fc
+{
+   /**
+    *  Enables json_codec to encode and decode the reflected type T directly from its members.
+    *
+    *  This is opt in because many reflected types, e.g. fc::blob or fc::crypto::public_key, have
+    *  hand written to_variant()/from_variant() that json_codec would otherwise bypass.  Only enable
+    *  it for types whose variant form is the one produced by FC_REFLECT / FC_REFLECT_ENUM.
+    */
+   template<typename T>
+   struct json_codec_enabled : std::false_type {};
+
+   /**
+    *  Encodes and decodes C++ values as JSON without building an intermediate fc::variant tree.
+    *
+    *  The output of to_string( v, format ) is identical to json::to_string( variant(v), yield, format )
+    *  and from_string( s, v ) produces the same value as json::from_string( s ).as( v ) with the legacy
+    *  parser.  Reflected types enabled with FC_JSON_CODEC, std containers, optional, pair and std::variant
+    *  are handled directly, everything else goes through its to_variant()/from_variant().
+    */
+   namespace json_codec
+   {
+      constexpr uint32_t default_max_depth = 200;
+
+      /// @{ append the JSON encoding of a scalar as json::to_string() encodes the same variant
+      void append_int64( std::string& out, int64_t i, json::output_formatting format );
+      void append_uint64( std::string& out, uint64_t u, json::output_formatting format );
+      void append_double( std::string& out, double d, json::output_formatting format );
+      void append_bool( std::string& out, bool b );
+      void append_string( std::string& out, std::string_view s );
+      void append_variant( std::string& out, const variant& v, json::output_formatting format );
+      /// @}
+
+      /**
+       *  Pull parser over a JSON document following the grammar of json::parse_type::legacy_parser
+       */
+      class reader
+      {
+         public:
+            reader( std::string_view s, uint32_t max_depth );
+
+            /// @return the next character after white space without consuming it, EOF at the end of input
+            int      peek();
+
+            /// consumes '{'
+            void     begin_object();
+            /// reads the next key of the current object and its ':', returns false and consumes '}' at the end
+            bool     next_key( std::string& key );
+
+            /// consumes '['
+            void     begin_array();
+            /// returns true if the current array has another element, false and consumes ']' at the end
+            bool     next_element();
+
+            std::string read_string();
+            /// reads the next complete value with the legacy parser
+            variant     read_value();
+
+         private:
+            uint32_t remaining_depth()const;
+            void     enter( char open );
+
+            const char* _pos;
+            const char* _end;
+            uint32_t    _max_depth;
+            uint32_t    _level = 0;
+      };
+
+      template<typename T> void encode( std::string& out, const T& v, json::output_formatting format );
+      template<typename T> void decode( reader& in, T& v );
+
+      namespace detail
+      {
+         template<typename T>
+         constexpr bool is_reflected_struct()
+         {
+            if constexpr( json_codec_enabled<T>::value )
+               return !fc::reflector<T>::is_enum::value;
+            else
+               return false;
+         }
+
+         template<typename T>
+         constexpr bool is_reflected_enum()
+         {
+            if constexpr( json_codec_enabled<T>::value )
+               return fc::reflector<T>::is_enum::value;
+            else
+               return false;
+         }
+
+         template<typename T>
+         constexpr bool is_signed_int()
+         {
+            return std::is_same_v<T, int8_t> || std::is_same_v<T, int16_t> || std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>;
+         }
+
+         template<typename T>
+         constexpr bool is_unsigned_int()
+         {
+            return std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> || std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t>;
+         }
+
+         template<typename T> struct is_optional : std::false_type {};
+         template<typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+         template<typename T> struct is_std_variant : std::false_type {};
+         template<typename... T> struct is_std_variant<std::variant<T...>> : std::true_type {};
+
+         template<typename T> struct is_pair : std::false_type {};
+         template<typename A, typename B> struct is_pair<std::pair<A,B>> : std::true_type {};
+
+         /// containers that to_variant() turns into an array of their elements
+         template<typename T> struct is_sequence : std::false_type {};
+         template<typename T> struct is_sequence<std::vector<T>> : std::true_type {};
+         template<> struct is_sequence<std::vector<char>> : std::false_type {}; // hex string
+         template<typename T> struct is_sequence<std::deque<T>> : std::true_type {};
+         template<typename T> struct is_sequence<std::set<T>> : std::true_type {};
+         template<typename K, typename V> struct is_sequence<std::map<K,V>> : std::true_type {};
+         template<typename T, size_t N> struct is_sequence<std::array<T,N>> : std::true_type {};
+
+         template<typename T>
+         class encode_visitor
+         {
+            public:
+               encode_visitor( std::string& out, const T& v, json::output_formatting format, bool& first )
+               :_out(out),_val(v),_format(format),_first(first){}
+
+               template<typename Member, class Class, Member (Class::*member)>
+               void operator()( const char* name )const
+               {
+                  const Member& m = _val.*member;
+                  if constexpr( is_optional<Member>::value )
+                  {
+                     if( !m ) return;
+                  }
+                  if( !_first ) _out += ',';
+                  _first = false;
+                  append_string( _out, name );
+                  _out += ':';
+                  if constexpr( is_optional<Member>::value )
+                     json_codec::encode( _out, *m, _format );
+                  else
+                     json_codec::encode( _out, m, _format );
+               }
+
+            private:
+               std::string&            _out;
+               const T&                _val;
+               json::output_formatting _format;
+               bool&                   _first;
+         };
+
+         /// decoders of the members of T in visit() order
+         template<typename T>
+         class member_decoders
+         {
+            public:
+               typedef void (*decode_function)( reader&, T& );
+
+               static const std::vector<decode_function>& get()
+               {
+                  static const std::vector<decode_function> decoders = []() {
+                     std::vector<decode_function> d;
+                     d.reserve( fc::reflector<T>::total_member_count );
+                     fc::reflector<T>::visit_base( collector{ d } );
+                     return d;
+                  }();
+                  return decoders;
+               }
+
+            private:
+               template<typename Member, class Class, Member (Class::*member)>
+               static void decode_member( reader& in, T& v )
+               {
+                  json_codec::decode( in, v.*member );
+               }
+
+               struct collector
+               {
+                  std::vector<decode_function>& decoders;
+
+                  template<typename Member, class Class, Member (Class::*member)>
+                  void operator()( const char* )const
+                  {
+                     decoders.push_back( &decode_member<Member, Class, member> );
+                  }
+               };
+         };
+
+         template<typename T>
+         void encode_elements( std::string& out, const T& c, json::output_formatting format )
+         {
+            out += '[';
+            bool first = true;
+            for( const auto& e : c )
+            {
+               if( !first ) out += ',';
+               first = false;
+               json_codec::encode( out, e, format );
+            }
+            out += ']';
+         }
+
+         template<typename T, typename Insert>
+         void decode_elements( reader& in, Insert&& insert )
+         {
+            in.begin_array();
+            size_t count = 0;
+            while( in.next_element() )
+            {
+               if( ++count > MAX_NUM_ARRAY_ELEMENTS ) throw std::range_error( "too large" );
+               T e{};
+               json_codec::decode( in, e );
+               insert( std::move(e) );
+            }
+         }
+
+         template<typename Variant, size_t I = 0>
+         void encode_alternative( std::string& out, const Variant& v, json::output_formatting format )
+         {
+            if constexpr( I < std::variant_size_v<Variant> )
+            {
+               if( v.index() == I )
+                  json_codec::encode( out, std::get<I>( v ), format );
+               else
+                  encode_alternative<Variant, I + 1>( out, v, format );
+            }
+         }
+      }
+
+      template<typename T>
+      void encode( std::string& out, const T& v, json::output_formatting format )
+      {
+         if constexpr( std::is_same_v<T, bool> )
+            append_bool( out, v );
+         else if constexpr( detail::is_signed_int<T>() )
+            append_int64( out, v, format );
+         else if constexpr( detail::is_unsigned_int<T>() )
+            append_uint64( out, v, format );
+         else if constexpr( std::is_same_v<T, double> || std::is_same_v<T, float> )
+            append_double( out, v, format );
+         else if constexpr( std::is_same_v<T, std::string> )
+            append_string( out, v );
+         else if constexpr( std::is_same_v<T, variant> )
+            append_variant( out, v, format );
+         else if constexpr( detail::is_optional<T>::value )
+         {
+            if( v ) json_codec::encode( out, *v, format );
+            else    out += "null";
+         }
+         else if constexpr( detail::is_pair<T>::value )
+         {
+            out += '[';
+            json_codec::encode( out, v.first, format );
+            out += ',';
+            json_codec::encode( out, v.second, format );
+            out += ']';
+         }
+         else if constexpr( detail::is_std_variant<T>::value )
+         {
+            out += '[';
+            append_uint64( out, v.index(), format );
+            out += ',';
+            detail::encode_alternative( out, v, format );
+            out += ']';
+         }
+         else if constexpr( detail::is_sequence<T>::value )
+         {
+            if( v.size() > MAX_NUM_ARRAY_ELEMENTS ) throw std::range_error( "too large" );
+            detail::encode_elements( out, v, format );
+         }
+         else if constexpr( detail::is_reflected_enum<T>() )
+            append_string( out, fc::reflector<T>::to_fc_string( v ) );
+         else if constexpr( detail::is_reflected_struct<T>() )
+         {
+            out += '{';
+            bool first = true;
+            fc::reflector<T>::visit( detail::encode_visitor<T>( out, v, format, first ) );
+            out += '}';
+         }
+         else
+            append_variant( out, variant( v ), format );
+      }
+
+      template<typename T>
+      void decode( reader& in, T& v )
+      {
+         const int c = in.peek();
+         if constexpr( std::is_same_v<T, std::string> )
+         {
+            if( c == '"' )
+            {
+               v = in.read_string();
+               return;
+            }
+         }
+         else if constexpr( detail::is_optional<T>::value )
+         {
+            if( c != 'n' )
+            {
+               v.emplace();
+               json_codec::decode( in, *v );
+               return;
+            }
+         }
+         else if constexpr( detail::is_sequence<T>::value )
+         {
+            if( c == '[' )
+            {
+               typedef typename T::value_type value_type;
+               if constexpr( std::is_same_v<T, std::vector<value_type>> || std::is_same_v<T, std::deque<value_type>> )
+               {
+                  v.clear();
+                  detail::decode_elements<value_type>( in, [&]( value_type&& e ) { v.push_back( std::move(e) ); } );
+               }
+               else if constexpr( detail::is_pair<value_type>::value ) // std::map
+               {
+                  typedef std::pair<typename T::key_type, typename T::mapped_type> pair_type;
+                  v.clear();
+                  detail::decode_elements<pair_type>( in, [&]( pair_type&& e ) { v.insert( std::move(e) ); } );
+               }
+               else if constexpr( std::is_same_v<T, std::set<value_type>> )
+               {
+                  v.clear();
+                  detail::decode_elements<value_type>( in, [&]( value_type&& e ) { v.insert( std::move(e) ); } );
+               }
+               else // std::array
+               {
+                  size_t i = 0;
+                  detail::decode_elements<value_type>( in, [&]( value_type&& e ) {
+                     if( i < v.size() ) v[i] = std::move(e);
+                     ++i;
+                  } );
+                  FC_ASSERT( i >= v.size(), "Expected {n} elements, got {i}", ("n", v.size())("i", i) );
+               }
+               return;
+            }
+         }
+         else if constexpr( detail::is_pair<T>::value )
+         {
+            if( c == '[' )
+            {
+               in.begin_array();
+               if( in.next_element() ) json_codec::decode( in, v.first );
+               else return;
+               if( in.next_element() ) json_codec::decode( in, v.second );
+               else return;
+               while( in.next_element() ) in.read_value();
+               return;
+            }
+         }
+         else if constexpr( detail::is_std_variant<T>::value )
+         {
+            if( c == '[' )
+            {
+               in.begin_array();
+               if( !in.next_element() )
+               {
+                  v = T();
+                  return;
+               }
+               const uint64_t index = in.read_value().as_uint64();
+               if( !in.next_element() )
+               {
+                  v = T();
+                  return;
+               }
+               fc::from_index( v, index );
+               std::visit( [&]( auto& alternative ) { json_codec::decode( in, alternative ); }, v );
+               while( in.next_element() ) in.read_value();
+               return;
+            }
+         }
+         else if constexpr( detail::is_reflected_struct<T>() )
+         {
+            // a value can be decoded into only one member, a name reflected twice goes through from_variant()
+            if( c == '{' && !fc::reflector_member_index<T>::has_duplicate_names() )
+            {
+               // members already decoded are skipped like from_variant() skips duplicate keys
+               bool seen[fc::reflector<T>::total_member_count + 1] = {};
+               const auto& decoders = detail::member_decoders<T>::get();
+               std::string key;
+               in.begin_object();
+               while( in.next_key( key ) )
+               {
+                  const size_t pos = fc::reflector_member_index<T>::find( key );
+                  if( pos == fc::reflector_member_index<T>::npos || seen[pos] )
+                  {
+                     in.read_value();
+                     continue;
+                  }
+                  seen[pos] = true;
+                  decoders[pos]( in, v );
+               }
+               fc::reflector_init_visitor<T>( v ).reflector_init();
+               return;
+            }
+         }
+         // scalars and anything that does not have the expected shape
+         from_variant( in.read_value(), v );
+      }
+
+      template<typename T>
+      void to_buffer( std::string& out, const T& v, json::output_formatting format = json::output_formatting::stringify_large_ints_and_doubles )
+      {
+         json_codec::encode( out, v, format );
+      }
+
+      template<typename T>
+      std::string to_string( const T& v, json::output_formatting format = json::output_formatting::stringify_large_ints_and_doubles )
+      {
+         std::string out;
+         json_codec::encode( out, v, format );
+         return out;
+      }
+
+      template<typename T>
+      void from_string( std::string_view s, T& v, uint32_t max_depth = default_max_depth )
+      { try {
+         reader in( s, max_depth );
+         json_codec::decode( in, v );
+      } FC_RETHROW_EXCEPTIONS( warn, "", ("str", std::string(s)) ) }
+
+      template<typename T>
+      T from_string( std::string_view s, uint32_t max_depth = default_max_depth )
+      {
+         T v{};
+         from_string( s, v, max_depth );
+         return v;
+      }
+   }
+}
+
+/**
+ *  @def FC_JSON_CODEC(TYPE)
+ *  @brief Enables json_codec to encode and decode the reflected TYPE from its members, @see fc::json_codec_enabled
+ */
+#define FC_JSON_CODEC( TYPE ) \
+namespace fc { template<> struct json_codec_enabled<TYPE> : std::true_type {}; }
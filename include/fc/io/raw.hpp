@@ -15,6 +15,7 @@
 #include <map>
 #include <deque>
 #include <list>
+#include <limits>
 
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/interprocess/containers/string.hpp>
@@ -281,6 +282,22 @@ namespace fc {
       if( b ) { v = T(); fc::raw::unpack( s, *v ); }
     } FC_RETHROW_EXCEPTIONS( warn, "optional<{type}>", ("type",fc::get_typename<T>::name() ) ) }
 
+    namespace detail {
+       /// streams over a contiguous buffer, which can hand out a pointer to the next bytes
+       template<typename Stream>
+       constexpr bool is_buffer_stream() {
+          return std::is_same_v<Stream, datastream<const char*>> || std::is_same_v<Stream, datastream<char*>>;
+       }
+
+       /// reads the size prefix of a byte array, string or string_view
+       template<typename Stream>
+       uint32_t unpack_byte_array_size( Stream& s ) {
+          unsigned_int size; fc::raw::unpack( s, size );
+          FC_ASSERT( size.value <= MAX_SIZE_OF_BYTE_ARRAYS );
+          return size.value;
+       }
+    }
+
     // std::vector<char>
     template<typename Stream> inline void pack( Stream& s, const std::vector<char>& value ) {
       FC_ASSERT( value.size() <= MAX_SIZE_OF_BYTE_ARRAYS );
@@ -289,9 +306,15 @@ namespace fc {
         s.write( &value.front(), (uint32_t)value.size() );
     }
     template<typename Stream> inline void unpack( Stream& s, std::vector<char>& value ) {
-      unsigned_int size; fc::raw::unpack( s, size );
-      FC_ASSERT( size.value <= MAX_SIZE_OF_BYTE_ARRAYS );
-      value.resize(size.value);
+      const uint32_t size = detail::unpack_byte_array_size( s );
+      if constexpr( detail::is_buffer_stream<Stream>() ) {
+        if( s.remaining() >= size ) {
+          value.assign( s.pos(), s.pos() + size );
+          s.skip( size );
+          return;
+        }
+      }
+      value.resize(size);
       if( value.size() )
         s.read( value.data(), value.size() );
     }
@@ -304,10 +327,36 @@ namespace fc {
     }
 
     template<typename Stream> inline void unpack( Stream& s, fc::string& v )  {
-      std::vector<char> tmp; fc::raw::unpack(s,tmp);
-      if( tmp.size() )
-         v = fc::string(tmp.data(),tmp.data()+tmp.size());
-      else v = fc::string();
+      const uint32_t size = detail::unpack_byte_array_size( s );
+      if constexpr( detail::is_buffer_stream<Stream>() ) {
+        if( s.remaining() >= size ) {
+          v.assign( s.pos(), size );
+          s.skip( size );
+          return;
+        }
+      }
+      v.resize( size );
+      if( size ) s.read( v.data(), size );
+    }
+
+    // std::string_view, same encoding as fc::string
+    template<typename Stream> inline void pack( Stream& s, const std::string_view& v )  {
+      FC_ASSERT( v.size() <= MAX_SIZE_OF_BYTE_ARRAYS );
+      fc::raw::pack( s, unsigned_int((uint32_t)v.size()));
+      if( v.size() ) s.write( v.data(), v.size() );
+    }
+
+    /**
+     *  Borrowed unpack: v points into the buffer of s instead of owning a copy, so it is only valid
+     *  as long as that buffer.  Only available for datastream<const char*> and datastream<char*>.
+     */
+    template<typename Stream> inline void unpack( Stream& s, std::string_view& v )  {
+      static_assert( detail::is_buffer_stream<Stream>(), "std::string_view can only be unpacked from a datastream over a buffer" );
+      const uint32_t size = detail::unpack_byte_array_size( s );
+      if( s.remaining() < size )
+        fc::detail::throw_datastream_range_error( "read", s.tellp() + s.remaining(), int64_t(size - s.remaining()) );
+      v = std::string_view( s.pos(), size );
+      s.skip( size );
     }
 
     // bip::basic_string
@@ -318,10 +367,18 @@ namespace fc {
     }
 
     template<typename Stream> inline void unpack( Stream& s, shared_string& v )  {
-      std::vector<char> tmp; fc::raw::unpack(s,tmp);
+      const uint32_t size = detail::unpack_byte_array_size( s );
       FC_ASSERT(v.size() == 0);
-      if( tmp.size() ) {
-         v.append(tmp.begin(), tmp.end());
+      if constexpr( detail::is_buffer_stream<Stream>() ) {
+        if( s.remaining() >= size ) {
+          v.append( s.pos(), size );
+          s.skip( size );
+          return;
+        }
+      }
+      if( size ) {
+         v.resize( size );
+         s.read( &v[0], size );
       }
     }
 
@@ -527,10 +584,109 @@ namespace fc {
       }
     }
 
+    namespace detail {
+
+      template<typename T>
+      constexpr bool is_packed_reflected_candidate() {
+        if constexpr( std::is_class<T>::value && std::is_trivially_copyable<T>::value &&
+                      !std::is_base_of<fc::reflect_init, T>::value ) {
+          return fc::reflector<T>::is_defined::value && !fc::reflector<T>::is_enum::value;
+        } else {
+          return false;
+        }
+      }
+
+      /// true when T is declared to pack as exactly its in-memory bytes, has_packed_layout<T>() gives the final answer
+      template<typename T>
+      constexpr bool may_have_packed_layout = is_trivially_packable<T>::value;
+
+      template<typename T>
+      bool has_packed_layout();
+
+      template<typename Class>
+      struct packed_layout_visitor {
+        packed_layout_visitor( const Class* _obj, size_t& _offset, bool& _packed )
+        :obj(_obj),offset(_offset),packed(_packed){}
+
+        template<typename T, typename C, T(C::*p)>
+        void operator()( const char* )const {
+          const size_t member_offset = reinterpret_cast<const char*>( &(obj->*p) ) - reinterpret_cast<const char*>( obj );
+          packed = packed && member_offset == offset && has_packed_layout<T>();
+          offset += sizeof(T);
+        }
+
+        private:
+          const Class* obj;
+          size_t&      offset;
+          bool&        packed;
+      };
+
+      /**
+       *  Returns true when raw::pack writes a T as exactly its sizeof(T) bytes in memory order. Only types
+       *  that specialize is_trivially_packable qualify. For a reflected struct that does, its reflected
+       *  members, in visit order, must also cover the object with no padding and each have a packed layout
+       *  themselves. Member offsets are not constant expressions, so that check runs once per type and is cached.
+       */
+      template<typename T>
+      bool has_packed_layout() {
+        if constexpr( !is_trivially_packable<T>::value ) {
+          return false;
+        } else if constexpr( is_packed_reflected_candidate<T>() ) {
+          static const bool packed = []() {
+            alignas(T) static char storage[sizeof(T)];
+            size_t offset = 0;
+            bool   tiled  = true;
+            fc::reflector<T>::visit( packed_layout_visitor<T>( reinterpret_cast<const T*>( storage ), offset, tiled ) );
+            return tiled && offset == sizeof(T);
+          }();
+          return packed;
+        } else {
+          return true;
+        }
+      }
+
+      /// writes the elements of a container of packed layout types, one write per contiguous run
+      template<typename Stream, typename Container>
+      void pack_packed_runs( Stream& s, const Container& value ) {
+        using T = typename Container::value_type;
+        auto itr = value.begin();
+        const auto end = value.end();
+        while( itr != end ) {
+          const T* run = &*itr;
+          size_t n = 1;
+          for( ++itr; itr != end && &*itr == run + n; ++itr )
+            ++n;
+          s.write( reinterpret_cast<const char*>( run ), n * sizeof(T) );
+        }
+      }
+
+      /// reads into the elements of an already sized container of packed layout types, one read per contiguous run
+      template<typename Stream, typename Container>
+      void unpack_packed_runs( Stream& s, Container& value ) {
+        using T = typename Container::value_type;
+        auto itr = value.begin();
+        const auto end = value.end();
+        while( itr != end ) {
+          T* run = &*itr;
+          size_t n = 1;
+          for( ++itr; itr != end && &*itr == run + n; ++itr )
+            ++n;
+          s.read( reinterpret_cast<char*>( run ), n * sizeof(T) );
+        }
+      }
+
+    } // namespace detail
+
     template<typename Stream, typename T>
     inline void pack( Stream& s, const std::deque<T>& value ) {
       FC_ASSERT( value.size() <= MAX_NUM_ARRAY_ELEMENTS );
       fc::raw::pack( s, unsigned_int((uint32_t)value.size()) );
+      if constexpr( detail::may_have_packed_layout<T> ) {
+         if( detail::has_packed_layout<T>() ) {
+            detail::pack_packed_runs( s, value );
+            return;
+         }
+      }
       for( const auto& i : value ) {
          fc::raw::pack( s, i );
       }
@@ -541,6 +697,12 @@ namespace fc {
       unsigned_int size; fc::raw::unpack( s, size );
       FC_ASSERT( size.value <= MAX_NUM_ARRAY_ELEMENTS );
       value.resize(size.value);
+      if constexpr( detail::may_have_packed_layout<T> ) {
+         if( detail::has_packed_layout<T>() ) {
+            detail::unpack_packed_runs( s, value );
+            return;
+         }
+      }
       for( auto& i : value ) {
          fc::raw::unpack( s, i );
       }
@@ -550,6 +712,12 @@ namespace fc {
     inline void pack( Stream& s, const boost::container::deque<T, U...>& value ) {
        FC_ASSERT( value.size() <= MAX_NUM_ARRAY_ELEMENTS );
        fc::raw::pack( s, unsigned_int( (uint32_t) value.size() ) );
+       if constexpr( detail::may_have_packed_layout<T> ) {
+          if( detail::has_packed_layout<T>() ) {
+             detail::pack_packed_runs( s, value );
+             return;
+          }
+       }
        for( const auto& i : value ) {
           fc::raw::pack( s, i );
        }
@@ -561,6 +729,12 @@ namespace fc {
        fc::raw::unpack( s, size );
        FC_ASSERT( size.value <= MAX_NUM_ARRAY_ELEMENTS );
        value.resize( size.value );
+       if constexpr( detail::may_have_packed_layout<T> ) {
+          if( detail::has_packed_layout<T>() ) {
+             detail::unpack_packed_runs( s, value );
+             return;
+          }
+       }
        for( auto& i : value ) {
           fc::raw::unpack( s, i );
        }
@@ -570,6 +744,13 @@ namespace fc {
     inline void pack( Stream& s, const std::vector<T>& value ) {
       FC_ASSERT( value.size() <= MAX_NUM_ARRAY_ELEMENTS );
       fc::raw::pack( s, unsigned_int((uint32_t)value.size()) );
+      if constexpr( detail::may_have_packed_layout<T> ) {
+         if( detail::has_packed_layout<T>() ) {
+            if( !value.empty() )
+               s.write( reinterpret_cast<const char*>( value.data() ), value.size() * sizeof(T) );
+            return;
+         }
+      }
       for( const auto& i : value ) {
          fc::raw::pack( s, i );
       }
@@ -580,6 +761,13 @@ namespace fc {
       unsigned_int size; fc::raw::unpack( s, size );
       FC_ASSERT( size.value <= MAX_NUM_ARRAY_ELEMENTS );
       value.resize(size.value);
+      if constexpr( detail::may_have_packed_layout<T> ) {
+         if( detail::has_packed_layout<T>() ) {
+            if( !value.empty() )
+               s.read( reinterpret_cast<char*>( value.data() ), value.size() * sizeof(T) );
+            return;
+         }
+      }
       for( auto& i : value ) {
          fc::raw::unpack( s, i );
       }
@@ -667,6 +855,52 @@ namespace fc {
       fc::raw::detail::if_reflected< typename fc::reflector<T>::is_defined >::unpack(s,v);
     } FC_RETHROW_EXCEPTIONS( warn, "error unpacking {type}", ("type",fc::get_typename<T>::name() ) ) }
 
+    /// value of max_pack_size<T> for types whose packed size has no compile time bound
+    constexpr size_t unbounded_pack_size = std::numeric_limits<size_t>::max();
+
+    /**
+     *  Upper bound of the number of bytes fc::raw::pack writes for a T, or unbounded_pack_size when
+     *  that is not known at compile time. Specialize for fixed size types not covered here.
+     */
+    template<typename T>
+    struct max_pack_size_of;
+
+    template<typename T>
+    constexpr size_t max_pack_size = max_pack_size_of<T>::value;
+
+    namespace detail {
+      template<typename T>
+      constexpr size_t default_max_pack_size() {
+        if constexpr( is_trivially_packable<T>::value ) {
+          return sizeof(T);
+        } else if constexpr( std::is_same<T,bool>::value ) {
+          return 1;
+        } else if constexpr( std::is_enum<T>::value ) {
+          return fc::reflector<T>::is_enum::value ? sizeof(int64_t) : sizeof(T);
+        } else {
+          return unbounded_pack_size;
+        }
+      }
+
+      constexpr size_t max_pack_size_product( size_t n, size_t element ) {
+        return element == unbounded_pack_size || ( n && element > unbounded_pack_size / n ) ? unbounded_pack_size : n * element;
+      }
+    }
+
+    template<typename T>
+    struct max_pack_size_of : std::integral_constant<size_t, detail::default_max_pack_size<T>()> {};
+    template<typename T, size_t N>
+    struct max_pack_size_of<fc::array<T,N>> : std::integral_constant<size_t, detail::max_pack_size_product( N, max_pack_size<T> )> {};
+    template<typename T, size_t N>
+    struct max_pack_size_of<std::array<T,N>> : std::integral_constant<size_t, detail::max_pack_size_product( N, max_pack_size<T> )> {};
+    template<typename T>
+    struct max_pack_size_of<std::optional<T>> : std::integral_constant<size_t, max_pack_size<T> == unbounded_pack_size ? unbounded_pack_size : max_pack_size<T> + 1> {};
+    template<> struct max_pack_size_of<unsigned_int>   : std::integral_constant<size_t, 5> {};
+    template<> struct max_pack_size_of<signed_int>     : std::integral_constant<size_t, 5> {};
+    template<> struct max_pack_size_of<time_point>     : std::integral_constant<size_t, sizeof(uint64_t)> {};
+    template<> struct max_pack_size_of<time_point_sec> : std::integral_constant<size_t, sizeof(uint32_t)> {};
+    template<> struct max_pack_size_of<microseconds>   : std::integral_constant<size_t, sizeof(uint64_t)> {};
+
     template<typename T>
     inline size_t pack_size(  const T& v )
     {
@@ -675,17 +909,36 @@ namespace fc {
       return ps.tellp();
     }
 
+    /**
+     *  Appends the packed form of v to b in a single pass. Reusing one buffer for many calls, clearing
+     *  it in between, avoids the sizing pass and the per call allocation of pack(v).
+     */
     template<typename T>
-    inline std::vector<char> pack(  const T& v ) {
-      datastream<size_t> ps;
-      fc::raw::pack(ps,v );
-      std::vector<char> vec(ps.tellp());
+    inline void pack_to( pack_buffer& b, const T& v ) {
+      if constexpr( max_pack_size<T> != unbounded_pack_size ) {
+        b.reserve( b.size() + max_pack_size<T> );
+      }
+      fc::raw::pack( b, v );
+    }
 
-      if( vec.size() ) {
-        datastream<char*>  ds( vec.data(), size_t(vec.size()) );
-        fc::raw::pack(ds,v);
+    template<typename T>
+    inline std::vector<char> pack(  const T& v ) {
+      if constexpr( max_pack_size<T> != unbounded_pack_size ) {
+        // sized by the bound without the zero fill a vector of that size would do
+        pack_buffer b;
+        pack_to( b, v );
+        return b.to_vector();
+      } else {
+        datastream<size_t> ps;
+        fc::raw::pack(ps,v );
+        std::vector<char> vec(ps.tellp());
+
+        if( vec.size() ) {
+          datastream<char*>  ds( vec.data(), size_t(vec.size()) );
+          fc::raw::pack(ds,v);
+        }
+        return vec;
       }
-      return vec;
     }
 
     template<typename T, typename... Next>
@@ -4,9 +4,11 @@
 #include <fc/io/varint.hpp>
 #include <fc/array.hpp>
 #include <fc/safe.hpp>
+#include <array>
 #include <deque>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <unordered_map>
 #include <set>
@@ -24,11 +26,27 @@ namespace fc {
 
    namespace ecc { class public_key; class private_key; }
    template<typename Storage> class fixed_string;
+   class pack_buffer;
 
    namespace raw {
     template<typename T>
     constexpr bool is_trivial_array = std::is_scalar<T>::value == true && std::is_pointer<T>::value == false;
 
+    /**
+     *  True for types whose raw encoding is exactly their object representation, which lets contiguous
+     *  runs of them in vectors and deques be packed and unpacked with a single write/read. Specialize
+     *  to std::true_type for fixed size types that pack as their raw bytes (see fc::sha256). A reflected
+     *  struct opts in the same way, its layout is then checked by fc::raw::detail::has_packed_layout and
+     *  it is packed member by member if its reflected members do not cover it exactly. A type with its own
+     *  raw::pack and raw::unpack must not specialize it, containers of it would bypass them.
+     */
+    template<typename T>
+    struct is_trivially_packable : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T,bool>::value> {};
+    template<typename T, size_t N>
+    struct is_trivially_packable<fc::array<T,N>> : is_trivially_packable<T> {};
+    template<typename T, size_t N>
+    struct is_trivially_packable<std::array<T,N>> : is_trivially_packable<T> {};
+
     template<typename T>
     inline size_t pack_size(  const T& v );
 
@@ -95,6 +113,8 @@ namespace fc {
     template<typename Stream> void pack( Stream& s, const time_point_sec& );
     template<typename Stream> void unpack( Stream& s, std::string& );
     template<typename Stream> void pack( Stream& s, const std::string& );
+    template<typename Stream> void unpack( Stream& s, std::string_view& );
+    template<typename Stream> void pack( Stream& s, const std::string_view& );
     template<typename Stream> void unpack( Stream& s, fc::ecc::public_key& );
     template<typename Stream> void pack( Stream& s, const fc::ecc::public_key& );
     template<typename Stream> void unpack( Stream& s, fc::ecc::private_key& );
@@ -125,6 +145,7 @@ namespace fc {
     template<typename Stream> inline void unpack( Stream& s, bool& v );
 
     template<typename T> inline std::vector<char> pack( const T& v );
+    template<typename T> inline void pack_to( pack_buffer& b, const T& v );
     template<typename T> inline T unpack( const std::vector<char>& s );
     template<typename T> inline T unpack( const char* d, uint32_t s );
     template<typename T> inline void unpack( const char* d, uint32_t s, T& v );
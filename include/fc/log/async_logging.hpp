@@ -0,0 +1,149 @@
+#pragma once
+#include <fc/log/logger.hpp>
+#include <fc/log/packed_values.hpp>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace fc {
+
+/**
+ *  Asynchronous front end of the fc log macros, turned on with logging_config::async.
+ *
+ *  While active, a log macro that passes its level checks does not format its message. It copies
+ *  the level, a pointer to the static source location of the call site, a pointer to the formatter
+ *  compiled for its format string, and its values into a queue owned by the calling thread, and a
+ *  background thread formats the message and writes it to the sinks with the original timestamp
+ *  and thread name.
+ *
+ *  Each thread has its own single producer, single consumer ring of bytes, so logging takes no
+ *  lock and, once the ring of a thread exists, allocates nothing. Arithmetic and string values
+ *  are copied as they are. Any other value is formatted with "{}" on the calling thread, into a
+ *  stack buffer or, when it is long, a second time straight into the ring, so the background
+ *  thread never touches caller owned objects.
+ *  A message that does not fit in the ring of its thread is dropped and counted.
+ *
+ *  Messages are in order per thread. Messages of different threads are not sorted by timestamp.
+ */
+namespace async_logging {
+
+   /// starts the background thread, the size of each per thread ring is queue_size bytes
+   void start( uint32_t queue_size );
+   /// writes out all queued messages and stops the background thread
+   void stop();
+   /// writes out all messages queued before the call
+   void flush();
+   /// number of messages dropped because the ring of their thread was full
+   uint64_t dropped_messages();
+
+   namespace detail {
+      extern std::atomic<bool> active;
+
+      /// formats the values that follow the record header and thread name into out
+      using fc::detail::format_fn;
+
+      struct record_header {
+         uint32_t                        size;   ///< of the whole record, a multiple of 8
+         spdlog::level::level_enum       level;
+         bool                            forced; ///< written below the level of logger, see log_site::set_mode
+         spdlog::logger*                 logger;
+         const spdlog::source_loc*       loc;
+         spdlog::log_clock::time_point   time;
+         format_fn                       format;
+      };
+
+      class thread_ring;
+
+      /// ring of the calling thread, created on first use; nullptr once the thread is exiting
+      thread_ring* this_thread_ring();
+      /// reserves size bytes in ring, nullptr (and the message of logger counted as dropped) if they do not fit
+      char* reserve( thread_ring& ring, size_t size, spdlog::logger& logger );
+      /// publishes the record written to the last reserve() of ring
+      void  commit( thread_ring& ring );
+      /// name of the calling thread as it is written with each record
+      std::string_view thread_name();
+      /// while the background thread writes a record, the name of the thread that logged it
+      std::string_view record_thread_name();
+
+      inline void format_text( const char* payload, fmt::memory_buffer& out ) {
+         fc::detail::reader r{ payload };
+         const std::string_view format = r.read_string();
+         fmt::format_to( std::back_inserter( out ), fmt::runtime( fmt::string_view( format.data(), format.size() ) ) );
+      }
+
+      inline char* write_header( thread_ring& ring, size_t& size, spdlog::logger& logger, spdlog::level::level_enum level,
+                                 const spdlog::source_loc& loc, bool forced, format_fn format, std::string_view tname ) {
+         size = ( size + 7 ) & ~size_t( 7 );
+         char* out = reserve( ring, size, logger );
+         if( !out )
+            return nullptr;
+         const record_header h{ uint32_t(size), level, forced, &logger, &loc, spdlog::log_clock::now(), format };
+         out = fc::detail::write_bytes( out, &h, sizeof(h) );
+         return fc::detail::write_string( out, tname );
+      }
+
+      template<typename Source, size_t... I, typename... T>
+      bool push( spdlog::logger& logger, spdlog::level::level_enum level, const spdlog::source_loc& loc, bool forced,
+                 std::index_sequence<I...>, const T&... values ) {
+         thread_ring* ring = this_thread_ring();
+         if( !ring )
+            return false;
+         const std::tuple<fc::detail::capture<T>...> captures( values... );
+         const std::string_view tname = thread_name();
+         size_t size = sizeof(record_header) + sizeof(uint32_t) + tname.size();
+         ( (size += fc::detail::encoded_size<T>( std::get<I>( captures ) )), ... );
+         char* out = write_header( *ring, size, logger, level, loc, forced,
+                                   &fc::detail::format_record<Source, fc::detail::decoded_t<T>...>, tname );
+         if( out ) {
+            ( (out = fc::detail::encode<T>( out, std::get<I>( captures ) )), ... );
+            commit( *ring );
+         }
+         return true;
+      }
+   } // namespace detail
+
+   inline bool is_active() { return detail::active.load( std::memory_order_relaxed ); }
+
+   /**
+    *  Queues a message for logger, built by the log macros
+    *  @param loc must have static storage duration
+    *  @param forced write the message even below the level of logger
+    *  @return false if the calling thread can no longer queue messages (it is exiting), the caller
+    *          should then log synchronously
+    */
+   template<typename Source, typename... T>
+   bool push( spdlog::logger& logger, spdlog::level::level_enum level, const spdlog::source_loc& loc, bool forced,
+              const log_format<Source>&, const T&... values ) {
+      if( !forced && !logger.should_log( level ) )
+         return true;
+      return detail::push<Source>( logger, level, loc, forced, std::index_sequence_for<T...>(), values... );
+   }
+
+   /// queues a message without arguments, format is formatted on the background thread
+   template<typename Format>
+   bool push( spdlog::logger& logger, spdlog::level::level_enum level, const spdlog::source_loc& loc, bool forced,
+              const Format& format ) {
+      if( !forced && !logger.should_log( level ) )
+         return true;
+      detail::thread_ring* ring = detail::this_thread_ring();
+      if( !ring )
+         return false;
+      // the text may be a buffer of the caller, such as a local char array, so it is copied, an array up to its terminator
+      const std::string_view format_view( format );
+
+      const std::string_view tname = detail::thread_name();
+      size_t size = sizeof(detail::record_header) + sizeof(uint32_t) + tname.size() + sizeof(uint32_t) + format_view.size();
+      char* out = detail::write_header( *ring, size, logger, level, loc, forced, &detail::format_text, tname );
+      if( out ) {
+         fc::detail::write_string( out, format_view );
+         detail::commit( *ring );
+      }
+      return true;
+   }
+
+} // namespace async_logging
+} // namespace fc
@@ -0,0 +1,218 @@
+#pragma once
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/fmt/compile.h>
+#include <boost/preprocessor/control/iif.hpp>
+#include <boost/preprocessor/facilities/is_empty.hpp>
+#include <boost/preprocessor/punctuation/comma_if.hpp>
+#include <boost/preprocessor/seq/for_each_i.hpp>
+#include <boost/preprocessor/seq/size.hpp>
+#include <boost/preprocessor/seq/variadic_seq_to_seq.hpp>
+#include <boost/preprocessor/tuple/elem.hpp>
+#include <boost/preprocessor/tuple/enum.hpp>
+#include <boost/preprocessor/tuple/pop_front.hpp>
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace fc {
+
+namespace detail {
+   enum class format_error {
+      none,
+      unmatched_open_brace,
+      unmatched_close_brace,
+      unknown_key,
+      index_out_of_range
+   };
+
+   struct format_scan {
+      size_t       size  = 0;   ///< length of the positional format
+      format_error error = format_error::none;
+   };
+
+   constexpr size_t append_index( char* out, size_t pos, size_t index ) {
+      char digits[20] = {};
+      size_t n = 0;
+      do {
+         digits[n++] = char( '0' + index % 10 );
+         index /= 10;
+      } while( index );
+      for( size_t i = 0; i < n; ++i ) {
+         if( out )
+            out[pos] = digits[n - 1 - i];
+         ++pos;
+      }
+      return pos;
+   }
+
+   /**
+    *  Rewrites the argument ids of a fmt format string as argument indexes: "{key}" becomes the index
+    *  of key in keys and "{}" the next automatic index, while numeric ids, format specs and escaped
+    *  braces are kept. Writes to out unless it is null, so it is called once for the size and once
+    *  for the result.
+    */
+   template<size_t N>
+   constexpr format_scan to_positional( std::string_view in, const std::array<std::string_view, N>& keys, char* out ) {
+      format_scan r;
+      size_t auto_index = 0;
+      int    depth = 0;   // 1 inside a replacement field, 2 inside a nested one in its format spec
+      for( size_t i = 0; i < in.size(); ) {
+         const char c = in[i];
+         if( c == '{' ) {
+            if( depth == 0 && i + 1 < in.size() && in[i + 1] == '{' ) {
+               if( out ) { out[r.size] = '{'; out[r.size + 1] = '{'; }
+               r.size += 2;
+               i += 2;
+               continue;
+            }
+            if( depth == 2 )
+               return { r.size, format_error::unmatched_open_brace };
+            ++depth;
+            if( out ) out[r.size] = '{';
+            ++r.size;
+            ++i;
+            size_t end = i;
+            while( end < in.size() && in[end] != '}' && in[end] != ':' && in[end] != '{' )
+               ++end;
+            if( end == in.size() || in[end] == '{' )
+               return { r.size, format_error::unmatched_open_brace };
+            const std::string_view id = in.substr( i, end - i );
+            size_t index = 0;
+            if( id.empty() ) {
+               index = auto_index++;
+            } else if( id[0] >= '0' && id[0] <= '9' ) {
+               for( char d : id ) {
+                  if( d < '0' || d > '9' )
+                     return { r.size, format_error::unknown_key };
+                  index = index * 10 + size_t( d - '0' );
+               }
+            } else {
+               index = N;
+               for( size_t k = 0; k < N; ++k ) {
+                  if( keys[k] == id ) {
+                     index = k;
+                     break;
+                  }
+               }
+               if( index == N )
+                  return { r.size, format_error::unknown_key };
+            }
+            if( index >= N )
+               return { r.size, format_error::index_out_of_range };
+            r.size = append_index( out, r.size, index );
+            i = end;
+            if( in[i] == ':' ) {
+               if( out ) out[r.size] = ':';
+               ++r.size;
+               ++i;
+            }
+            continue;
+         }
+         if( c == '}' ) {
+            if( depth == 0 ) {
+               if( i + 1 < in.size() && in[i + 1] == '}' ) {
+                  if( out ) { out[r.size] = '}'; out[r.size + 1] = '}'; }
+                  r.size += 2;
+                  i += 2;
+                  continue;
+               }
+               return { r.size, format_error::unmatched_close_brace };
+            }
+            --depth;
+         }
+         if( out ) out[r.size] = c;
+         ++r.size;
+         ++i;
+      }
+      if( depth != 0 )
+         return { r.size, format_error::unmatched_open_brace };
+      return r;
+   }
+
+   template<size_t Size, size_t N>
+   constexpr std::array<char, Size + 1> make_positional( std::string_view in, const std::array<std::string_view, N>& keys ) {
+      std::array<char, Size + 1> result{};
+      to_positional( in, keys, result.data() );
+      return result;
+   }
+} // namespace detail
+
+/**
+ *  A log format string checked and rewritten at compile time, built by FC_LOG_FORMAT.
+ *
+ *  Source provides the format literal and the keys of the ("key", value) pairs passed with it. Named
+ *  fields are turned into positional ones, so the values are passed to fmt without names and fmt
+ *  compiles the format (FMT_COMPILE) into direct writes of the values. A field naming a key that is
+ *  not passed, or a brace that is not matched, fails the build.
+ */
+template<typename Source>
+struct log_format : fmt::detail::compiled_string {
+   using char_type = char;
+
+   static constexpr auto                keys = Source::keys();
+   static constexpr detail::format_scan scan = detail::to_positional( Source::format(), keys, nullptr );
+   static_assert( scan.error != detail::format_error::unmatched_open_brace,  "log format string has a '{' without a matching '}'" );
+   static_assert( scan.error != detail::format_error::unmatched_close_brace, "log format string has a '}' without a matching '{', use '}}' for a literal '}'" );
+   static_assert( scan.error != detail::format_error::unknown_key,           "log format string names a key that is not among its (\"key\", value) arguments" );
+   static_assert( scan.error != detail::format_error::index_out_of_range,    "log format string refers to more arguments than it is given" );
+   static constexpr auto                positional = detail::make_positional<scan.size>( Source::format(), keys );
+
+   /// the format as written, with named fields
+   static constexpr std::string_view source() { return Source::format(); }
+
+   explicit constexpr operator fmt::string_view()const { return fmt::string_view( positional.data(), scan.size ); }
+};
+
+template<typename T>
+struct is_log_format : std::false_type {};
+
+template<typename Source>
+struct is_log_format<log_format<Source>> : std::true_type {};
+
+/// formats a message of the log macros, a format without arguments is formatted at run time
+template<typename Source, typename... T>
+std::string format_message( const log_format<Source>& f, const T&... args ) {
+   return fmt::format( f, args... );
+}
+
+template<typename Format>
+std::string format_message( const Format& f ) {
+   return fmt::format( fmt::runtime( f ) );
+}
+
+} // namespace fc
+
+/**
+ *  @def FC_LOG_FORMAT(FORMAT, SEQ)
+ *  @brief Makes an fc::log_format from a string literal and a sequence of ("key", value) pairs,
+ *  only the keys are used.
+ */
+#define FC_LOG_FORMAT( FORMAT, ... ) \
+   [] { \
+      struct fc_format_source { \
+         static constexpr std::string_view format() { return FORMAT; } \
+         static constexpr auto keys() { \
+            return std::array<std::string_view, BOOST_PP_SEQ_SIZE( BOOST_PP_VARIADIC_SEQ_TO_SEQ( __VA_ARGS__ ) )>{ \
+               BOOST_PP_SEQ_FOR_EACH_I( FC_FORMAT_KEY, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ( __VA_ARGS__ ) ) }; \
+         } \
+      }; \
+      return fc::log_format<fc_format_source>(); \
+   }()
+
+#define FC_FORMAT_KEY( r, data, index, elem ) \
+   BOOST_PP_COMMA_IF( index ) BOOST_PP_TUPLE_ELEM( 0, elem )
+
+/// the values of a sequence of ("key", value) pairs, each preceded by a comma
+#define FC_ADD_FMT_VALUES( SEQ ) \
+   BOOST_PP_SEQ_FOR_EACH_I( FC_ADD_FMT_VALUE, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ( SEQ ) )
+
+#define FC_ADD_FMT_VALUE( r, data, index, elem ) \
+   , BOOST_PP_TUPLE_ENUM( BOOST_PP_TUPLE_POP_FRONT( elem ) )
+
+/// an fc::log_format when there are ("key", value) pairs, otherwise FORMAT itself
+#define FC_FORMAT_OR_TEXT( FORMAT, ... ) \
+   BOOST_PP_IIF( BOOST_PP_IS_EMPTY( __VA_ARGS__ ), FC_FORMAT_TEXT, FC_LOG_FORMAT )( FORMAT, __VA_ARGS__ )
+
+#define FC_FORMAT_TEXT( FORMAT, ... ) FORMAT
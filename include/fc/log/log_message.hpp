@@ -8,6 +8,7 @@
 #include <memory>
 #include <boost/preprocessor.hpp>
 #include <spdlog/fmt/fmt.h>
+#include <fc/log/packed_values.hpp>
 
 // get number of arguments with __NARG__
 // It will not be able to detect an empty argument list. This is due to a fundamental difference between C and its preprocessor.
@@ -122,6 +123,10 @@ namespace fc
     *  @note log_message has reference semantics, all copies refer to the same log message
     *  and the message is read-only after construction.
     *
+    *  A message made from an fc::log_format and its values keeps the values packed and is only
+    *  formatted the first time it is read, so an exception that is caught and dropped never
+    *  formats its messages.
+    *
     *  When converted to JSON, log_message has the following form:
     *  @code
     *  {
@@ -140,6 +145,10 @@ namespace fc
        *  @param ctx - generally provided using the FC_LOG_CONTEXT(LEVEL) macro
        */
       log_message( log_context ctx, std::string msg);
+      /**
+       *  @param values - formatted by get_message() and the other accessors on first use
+       */
+      log_message( log_context ctx, detail::packed_values values );
       ~log_message();
 
       log_message( const variant& v );
@@ -177,6 +186,18 @@ namespace fc
       return fc::log_message{};
    }
 
+   template<typename Source, typename... T>
+   inline fc::log_message get_log_message(const fc::log_context& ctx, const fc::log_format<Source>&, const T&... args ) {
+      try {
+         return fc::log_message( ctx, detail::pack_values<Source>( std::index_sequence_for<T...>(), args... ) );
+      } catch( const std::exception & ex ) {
+         std::cerr<< "<" + ctx.get_file() + ":" + std::to_string(ctx.get_line_number()) + "  " + ex.what() + ">" <<std::endl;
+      } catch( ... ) {
+         std::cerr<< "<" + ctx.get_file() + ":" + std::to_string(ctx.get_line_number()) + "  " + "Failed to log this message" + ">" <<std::endl;
+      }
+      return fc::log_message{};
+   }
+
 } // namespace fc
 
 FC_REFLECT_TYPENAME( fc::log_message )
@@ -195,8 +216,13 @@ FC_REFLECT_TYPENAME( fc::log_message )
    fc::log_context( fc::log_level::LOG_LEVEL, __FILE__, __LINE__, __func__ )
 
 
+/**
+ * @def FC_FMT(FORMAT,...)
+ * @brief Formats FORMAT with ("key", value) pairs. With pairs, FORMAT must be a string literal, it is
+ * checked against the keys and compiled at build time, see fc::log_format.
+ */
 #define FC_FMT(FORMAT, ...) \
-      fmt::format( FORMAT FC_ADD_FMT_ARGS( __VA_ARGS__ ) )
+      fc::format_message( FC_FORMAT_OR_TEXT( FORMAT, __VA_ARGS__ ) FC_ADD_FMT_VALUES( __VA_ARGS__ ) )
 
 #define FC_ADD_FMT_ARGS(SEQ)           \
    BOOST_PP_SEQ_FOR_EACH_I(            \
@@ -213,11 +239,12 @@ FC_REFLECT_TYPENAME( fc::log_message )
  * @brief A helper method for generating log messages.
  *
  * @param LOG_LEVEL a valid log_level::Enum name to be passed to the log_context
- * @param FORMAT A const char* string containing zero or more references to keys as "{key}"
+ * @param FORMAT A string literal containing zero or more references to keys as "{key}", checked at
+ *        compile time. Without key/value pairs it may be any string and is used as is.
  * @param ...  A set of key/value pairs denoted as ("key",val)("key2",val2)...
  */
 #define FC_LOG_MESSAGE_1( LOG_LEVEL, FORMAT, ... ) \
-   get_log_message( FC_LOG_CONTEXT(LOG_LEVEL), FORMAT FC_ADD_FMT_ARGS(__VA_ARGS__) )
+   get_log_message( FC_LOG_CONTEXT(LOG_LEVEL), FC_FORMAT_OR_TEXT( FORMAT, __VA_ARGS__ ) FC_ADD_FMT_VALUES(__VA_ARGS__) )
 
 #define FC_LOG_MESSAGE_0(LOG_LEVEL, FORMAT) FC_LOG_MESSAGE_1(LOG_LEVEL, FORMAT,)
 #define FC_LOG_MESSAGE(...) SWITCH_MACRO(FC_LOG_MESSAGE_0, FC_LOG_MESSAGE_1, 2, __VA_ARGS__)
@@ -0,0 +1,110 @@
+#pragma once
+#include <fc/log/logger.hpp>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fc {
+
+   /// messages of one logger since logging was configured
+   struct logger_metrics {
+      std::string  name;
+      uint64_t     messages = 0;   ///< handed to the sinks of the logger
+      uint64_t     dropped = 0;    ///< lost because the async log queue of the logging thread was full
+   };
+
+   /**
+    *  Writes of one sink since logging was configured. write_latency is a histogram of the time a write
+    *  took, formatting included: write_latency[0] counts the writes under 256ns, write_latency[i] the
+    *  ones from 2^(i+7) up to 2^(i+8) ns, and the last entry all the longer ones.
+    */
+   struct sink_metrics {
+      static constexpr size_t latency_buckets = 24;
+
+      std::string            name;
+      std::string            type;
+      uint64_t               messages = 0;
+      uint64_t               bytes = 0;      ///< formatted, as written
+      uint64_t               errors = 0;     ///< writes that threw
+      uint64_t               write_ns = 0;   ///< total time spent writing
+      std::vector<uint64_t>  write_latency;
+   };
+
+   struct logging_metrics {
+      std::vector<logger_metrics>  loggers;
+      std::vector<sink_metrics>    sinks;
+      /// messages dropped by async logging, of all loggers including the ones configured before
+      uint64_t                     async_dropped = 0;
+   };
+
+   namespace detail {
+
+      /// agent logger of an fc::logger, counts the messages it writes
+      class metered_logger : public spdlog::logger {
+      public:
+         template<typename It>
+         metered_logger( std::string name, It begin, It end )
+         :spdlog::logger( std::move( name ), begin, end ) {}
+
+         metered_logger( std::string name, spdlog::sink_ptr sink )
+         :spdlog::logger( std::move( name ), std::move( sink ) ) {}
+
+         /// counts a message written to the sinks of l past l itself, as forced messages are
+         static void count_message( spdlog::logger& l );
+         static void count_dropped( spdlog::logger& l );
+
+         uint64_t messages()const { return _messages.load( std::memory_order_relaxed ); }
+         uint64_t dropped()const  { return _dropped.load( std::memory_order_relaxed ); }
+
+      protected:
+         void sink_it_( const spdlog::details::log_msg& msg ) override;
+
+      private:
+         std::atomic<uint64_t> _messages{0};
+         std::atomic<uint64_t> _dropped{0};
+      };
+
+      /**
+       *  Sink configured by log_config, which formats the messages of the sink it wraps to count the bytes
+       *  and time of each write. The wrapped sink gets the formatted line and must not lock, writes to it
+       *  are serialized here. Colors of a color sink span the whole line.
+       */
+      class metered_sink : public spdlog::sinks::sink {
+      public:
+         metered_sink( std::shared_ptr<spdlog::sinks::sink> inner, std::string type );
+
+         void log( const spdlog::details::log_msg& msg ) override;
+         void flush() override;
+         void set_pattern( const std::string& pattern ) override;
+         void set_formatter( std::unique_ptr<spdlog::formatter> formatter ) override;
+
+         /// all but the name
+         sink_metrics metrics()const;
+
+      private:
+         void record( uint64_t ns, size_t bytes );
+
+         std::mutex                                                     _mutex;
+         std::unique_ptr<spdlog::formatter>                             _formatter;
+         spdlog::memory_buf_t                                           _buf;
+         const std::shared_ptr<spdlog::sinks::sink>                     _inner;
+         const std::string                                              _type;
+         // written under _mutex, read by metrics() without it
+         std::atomic<uint64_t>                                          _messages{0};
+         std::atomic<uint64_t>                                          _bytes{0};
+         std::atomic<uint64_t>                                          _errors{0};
+         std::atomic<uint64_t>                                          _write_ns{0};
+         std::array<std::atomic<uint64_t>, sink_metrics::latency_buckets> _latency{};
+      };
+
+   } // namespace detail
+
+} // namespace fc
+
+#include <fc/reflect/reflect.hpp>
+FC_REFLECT( fc::logger_metrics, (name)(messages)(dropped) )
+FC_REFLECT( fc::sink_metrics, (name)(type)(messages)(bytes)(errors)(write_ns)(write_latency) )
+FC_REFLECT( fc::logging_metrics, (loggers)(sinks)(async_dropped) )
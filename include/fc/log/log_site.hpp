@@ -0,0 +1,126 @@
+#pragma once
+#include <fc/log/logger.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fc {
+
+   class logger;
+
+   namespace detail {
+      /// identifies the logger::impl lgr refers to, defined after logger
+      inline uintptr_t logger_key( const logger& lgr );
+   }
+
+   /**
+    *  Static record of one log statement, defined by the log macros at their call site.
+    *
+    *  Whether the statement logs is cached in a word of the record together with the logger it was
+    *  asked of, so a statement that is disabled costs one relaxed load. The cache of every call site is
+    *  dropped when a logger changes level, is destroyed or a logger variable is assigned, and the next
+    *  time a statement runs it asks its logger again. A statement that runs with another logger than the
+    *  one it cached the answer for asks that logger and keeps its answer instead.
+    *
+    *  A call site registers itself the first time it runs. set_mode() turns call sites on or off
+    *  regardless of the level of their logger.
+    */
+   class log_site {
+   public:
+      enum class mode : uint8_t {
+         follow_logger,   ///< logs when the level of the logger allows it
+         enabled,         ///< always logs, even below the level of the logger
+         disabled         ///< never logs
+      };
+
+      struct info {
+         std::string         file;
+         uint32_t            line = 0;
+         std::string         function;
+         log_level           level;
+         std::string         logger;    ///< name of the logger the statement ran with last
+         mode                site_mode = mode::follow_logger;
+      };
+
+      constexpr log_site( const spdlog::source_loc& loc, log_level::values level )
+      :loc( loc ), level( level ) {}
+
+      log_site( const log_site& ) = delete;
+      log_site& operator=( const log_site& ) = delete;
+
+      /// whether the statement logs through lgr
+      bool is_enabled( const logger& lgr ) {
+         const uintptr_t c = _state.load( std::memory_order_relaxed );
+         if( ( c & ~state_mask ) == detail::logger_key( lgr ) ) {
+            const uintptr_t s = c & state_mask;
+            if( s >= state_enabled )
+               return true;
+            if( s == state_disabled )
+               return false;
+         }
+         return resolve( &lgr );
+      }
+
+      /// whether the statement logs through the default logger, which is only looked up when the cache is empty
+      bool is_enabled() {
+         const uintptr_t s = _state.load( std::memory_order_relaxed ) & state_mask;
+         if( s >= state_enabled )
+            return true;
+         if( s == state_disabled )
+            return false;
+         return resolve( nullptr );
+      }
+
+      /// the statement was enabled by set_mode() below the level of its logger
+      bool is_forced()const { return ( _state.load( std::memory_order_relaxed ) & state_mask ) == state_forced; }
+
+      const spdlog::source_loc loc;
+      const log_level::values  level;
+
+      /// call sites that ran at least once
+      static std::vector<info> registered();
+
+      /**
+       *  Sets the mode of the call sites in files whose path ends with file and, unless line is 0, that are
+       *  on line. Call sites that have not run yet get the mode when they do.
+       *  @return the number of registered call sites that matched
+       */
+      static size_t set_mode( std::string_view file, uint32_t line, mode m );
+
+      /// drops the cached answer of all call sites, called when the level of a logger may have changed
+      static void invalidate_all();
+
+   private:
+      friend struct log_site_registry;
+
+      enum : uintptr_t {
+         state_unregistered,
+         state_unresolved,
+         state_disabled,
+         state_enabled,
+         state_forced,
+         state_mask = 7   ///< the state in the low bits, the logger::impl it was resolved with in the others
+      };
+
+      bool resolve( const logger* lgr );
+
+      std::atomic<uintptr_t> _state{ state_unregistered };
+      std::atomic<uint8_t> _mode{ uint8_t( mode::follow_logger ) };
+   };
+
+   namespace detail {
+      /// writes a message of a statement forced on by log_site::set_mode() to the sinks of l, bypassing the level of l
+      void log_forced( spdlog::logger& l, spdlog::log_clock::time_point time, const spdlog::source_loc& loc,
+                       spdlog::level::level_enum level, spdlog::string_view_t msg );
+
+      inline void log( spdlog::logger& l, const log_site& site, spdlog::level::level_enum level, spdlog::string_view_t msg ) {
+         if( site.is_forced() )
+            log_forced( l, spdlog::log_clock::now(), site.loc, level, msg );
+         else
+            l.log( site.loc, level, msg );
+      }
+   } // namespace detail
+
+} // namespace fc
@@ -13,6 +13,8 @@
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/fmt/fmt.h>
+#include <fc/log/async_logging.hpp>
+#include <fc/log/log_site.hpp>
 
 #ifndef DEFAULT_LOGGER
 #define DEFAULT_LOGGER "default"
@@ -34,10 +36,19 @@ namespace fc
       }
     @endcode
     */
+   class logger;
+
+   namespace detail {
+      /// identifies the logger::impl lgr refers to, the key of the answers cached by log_site
+      inline uintptr_t logger_key( const logger& lgr );
+   }
+
    class logger 
    {
       public:
          static logger get( const fc::string& name = DEFAULT_LOGGER );
+         /// same logger as get( DEFAULT_LOGGER ), cached per thread so the log macros do not lock
+         static const logger& default_logger();
          static void update( const fc::string& name, logger& log );
 
          logger();
@@ -64,6 +75,7 @@ namespace fc
 
       private:
          friend struct log_config;
+         friend uintptr_t detail::logger_key( const logger& lgr );
          void add_sink(const std::shared_ptr<spdlog::sinks::sink>& s);
          std::vector<std::shared_ptr<spdlog::sinks::sink>>& get_sinks() const;
 
@@ -72,6 +84,8 @@ namespace fc
          std::shared_ptr<impl> my;
    };
 
+   inline uintptr_t detail::logger_key( const logger& lgr ) { return reinterpret_cast<uintptr_t>( lgr.my.get() ); }
+
 } // namespace fc
 
 // suppress warning "conditional expression is constant" in the while(0) for visual c++
@@ -94,11 +108,25 @@ namespace fc
       std::cerr<< "<" + std::string(__FILE__) + ":" + std::to_string(__LINE__) + "  " + "Failed to log this message" + ">" <<std::endl; \
    }
 
+/// queues the message when async logging is active, otherwise formats and writes it right away
+#define FC_LOG_DISPATCH( SITE, AGENT_LOGGER, LEVEL, FORMAT, ... ) \
+   { \
+      const auto& fc_log_fmt_ = FC_FORMAT_OR_TEXT( FORMAT, __VA_ARGS__ ); \
+      if( !fc::async_logging::is_active() || \
+          !fc::async_logging::push( *(AGENT_LOGGER), LEVEL, (SITE).loc, (SITE).is_forced(), fc_log_fmt_ FC_ADD_FMT_VALUES( __VA_ARGS__ ) ) ) \
+         fc::detail::log( *(AGENT_LOGGER), SITE, LEVEL, fc::format_message( fc_log_fmt_ FC_ADD_FMT_VALUES( __VA_ARGS__ ) ) ); \
+   }
+
+/// the log_site of the enclosing log statement, constant initialized so it costs no guard
+#define FC_LOG_SITE( LEVEL ) \
+   static fc::log_site fc_log_site_{ spdlog::source_loc{ __FILE__, __LINE__, SPDLOG_FUNCTION }, fc::log_level::LEVEL }
+
 #define fc_dlog_1( LOGGER, FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (LOGGER).is_enabled( fc::log_level::debug ) ) \
+   FC_LOG_SITE( debug ); \
+   if( fc_log_site_.is_enabled( LOGGER ) ) \
       try{ \
-         SPDLOG_LOGGER_DEBUG((LOGGER).get_agent_logger(), FC_FMT( FORMAT, __VA_ARGS__ )); \
+         FC_LOG_DISPATCH(fc_log_site_, (LOGGER).get_agent_logger(), spdlog::level::debug, FORMAT, __VA_ARGS__); \
       } FC_LOG_CATCH \
   FC_MULTILINE_MACRO_END
 
@@ -107,9 +135,10 @@ namespace fc
 
 #define fc_ilog_1( LOGGER, FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (LOGGER).is_enabled( fc::log_level::info ) ) \
+   FC_LOG_SITE( info ); \
+   if( fc_log_site_.is_enabled( LOGGER ) ) \
       try{ \
-         SPDLOG_LOGGER_INFO((LOGGER).get_agent_logger(), FC_FMT( FORMAT, __VA_ARGS__ )); \
+         FC_LOG_DISPATCH(fc_log_site_, (LOGGER).get_agent_logger(), spdlog::level::info, FORMAT, __VA_ARGS__); \
       } FC_LOG_CATCH \
   FC_MULTILINE_MACRO_END
 
@@ -119,9 +148,10 @@ namespace fc
 
 #define fc_wlog_1( LOGGER, FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (LOGGER).is_enabled( fc::log_level::warn ) ) \
+   FC_LOG_SITE( warn ); \
+   if( fc_log_site_.is_enabled( LOGGER ) ) \
       try{ \
-         SPDLOG_LOGGER_WARN((LOGGER).get_agent_logger(), FC_FMT( FORMAT, __VA_ARGS__ )); \
+         FC_LOG_DISPATCH(fc_log_site_, (LOGGER).get_agent_logger(), spdlog::level::warn, FORMAT, __VA_ARGS__); \
       } FC_LOG_CATCH \
   FC_MULTILINE_MACRO_END
 
@@ -130,9 +160,10 @@ namespace fc
 
 #define fc_elog_1( LOGGER, FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (LOGGER).is_enabled( fc::log_level::error ) ) \
+   FC_LOG_SITE( error ); \
+   if( fc_log_site_.is_enabled( LOGGER ) ) \
       try{ \
-         SPDLOG_LOGGER_ERROR((LOGGER).get_agent_logger(), FC_FMT( FORMAT, __VA_ARGS__ )); \
+         FC_LOG_DISPATCH(fc_log_site_, (LOGGER).get_agent_logger(), spdlog::level::err, FORMAT, __VA_ARGS__); \
       } FC_LOG_CATCH \
   FC_MULTILINE_MACRO_END
 
@@ -141,9 +172,10 @@ namespace fc
 
 #define dlog_1( FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get(DEFAULT_LOGGER)).is_enabled( fc::log_level::debug ) ) \
+   FC_LOG_SITE( debug ); \
+   if( fc_log_site_.is_enabled() ) \
       try{ \
-         SPDLOG_LOGGER_DEBUG((fc::logger::get(DEFAULT_LOGGER)).get_agent_logger(), FC_FMT( FORMAT, __VA_ARGS__ )); \
+         FC_LOG_DISPATCH(fc_log_site_, fc::logger::default_logger().get_agent_logger(), spdlog::level::debug, FORMAT, __VA_ARGS__); \
       } FC_LOG_CATCH \
   FC_MULTILINE_MACRO_END
 
@@ -152,9 +184,10 @@ namespace fc
 
 #define ilog_1( FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get(DEFAULT_LOGGER)).is_enabled( fc::log_level::info ) ) \
+   FC_LOG_SITE( info ); \
+   if( fc_log_site_.is_enabled() ) \
       try{ \
-         SPDLOG_LOGGER_INFO((fc::logger::get(DEFAULT_LOGGER)).get_agent_logger(), FC_FMT( FORMAT, __VA_ARGS__ )); \
+         FC_LOG_DISPATCH(fc_log_site_, fc::logger::default_logger().get_agent_logger(), spdlog::level::info, FORMAT, __VA_ARGS__); \
       } FC_LOG_CATCH \
   FC_MULTILINE_MACRO_END
 
@@ -163,9 +196,10 @@ namespace fc
 
 #define wlog_1( FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get(DEFAULT_LOGGER)).is_enabled( fc::log_level::warn ) ) \
+   FC_LOG_SITE( warn ); \
+   if( fc_log_site_.is_enabled() ) \
       try{ \
-         SPDLOG_LOGGER_WARN((fc::logger::get(DEFAULT_LOGGER)).get_agent_logger(), FC_FMT( FORMAT, __VA_ARGS__ )); \
+         FC_LOG_DISPATCH(fc_log_site_, fc::logger::default_logger().get_agent_logger(), spdlog::level::warn, FORMAT, __VA_ARGS__); \
       } FC_LOG_CATCH \
   FC_MULTILINE_MACRO_END
 
@@ -174,9 +208,10 @@ namespace fc
 
 #define elog_1( FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-   if( (fc::logger::get(DEFAULT_LOGGER)).is_enabled( fc::log_level::error ) ) \
+   FC_LOG_SITE( error ); \
+   if( fc_log_site_.is_enabled() ) \
       try{ \
-         SPDLOG_LOGGER_ERROR((fc::logger::get(DEFAULT_LOGGER)).get_agent_logger(), FC_FMT( FORMAT, __VA_ARGS__ )); \
+         FC_LOG_DISPATCH(fc_log_site_, fc::logger::default_logger().get_agent_logger(), spdlog::level::err, FORMAT, __VA_ARGS__); \
       } FC_LOG_CATCH \
   FC_MULTILINE_MACRO_END
 
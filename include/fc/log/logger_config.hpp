@@ -1,6 +1,8 @@
 #pragma once
 #include <fc/log/logger.hpp>
+#include <fc/log/log_metrics.hpp>
 #include <spdlog/spdlog.h>
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -59,14 +61,22 @@ namespace fc {
       std::vector<string>          includes;
       std::vector<sink_config>     sinks;
       std::vector<logger_config>   loggers;
+      /// format and write messages on a background thread, see fc::async_logging
+      bool                         async = false;
+      /// bytes of the per thread queue of async logging, rounded up to a power of two
+      uint32_t                     async_queue_size = 256*1024;
    };
 
    struct log_config {
       static logger get_logger( const fc::string& name );
+      static const logger& get_default_logger();
       static void update_logger( const fc::string& name, logger& log );
 
       static bool configure_logging( const logging_config& l );
 
+      /// counters of the loggers and sinks of the current configuration, and of async logging
+      static logging_metrics get_metrics();
+
    private:
       static log_config& get();
 
@@ -75,6 +85,10 @@ namespace fc {
       std::mutex                                                             log_mutex;
       std::unordered_map<std::string, std::shared_ptr<spdlog::sinks::sink>>  sink_map;
       std::unordered_map<std::string, logger>                                logger_map;
+      /// loggers of the previous configuration, async records queued for them may still be in flight
+      std::unordered_map<std::string, logger>                                retired_logger_map;
+      /// bumped by configure_logging, invalidates the per thread default logger of get_default_logger
+      std::atomic<uint32_t>                                                  generation{1};
    };
 
    void configure_logging( const fc::path& log_config );
@@ -92,4 +106,4 @@ FC_REFLECT( fc::sink::stderr_color_sink_st_config, (level_colors) )
 FC_REFLECT( fc::sink::daily_file_sink_mt_config, (base_filename)(rotation_hour)(rotation_minute)(truncate)(max_files) )
 FC_REFLECT( fc::sink::rotating_file_sink_mt_config, (base_filename)(max_size)(max_files) )
 FC_REFLECT( fc::logger_config, (name)(level)(enabled)(sinks) )
-FC_REFLECT( fc::logging_config, (includes)(sinks)(loggers) )
+FC_REFLECT( fc::logging_config, (includes)(sinks)(loggers)(async)(async_queue_size) )
@@ -0,0 +1,174 @@
+#pragma once
+#include <fc/log/log_format.hpp>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace fc { namespace detail {
+
+   /**
+    *  The values of a log message copied into a flat buffer, so the message can be formatted later and
+    *  on another thread. Arithmetic and string values are copied as they are. Any other value is
+    *  formatted with "{}" when it is packed, so the buffer never refers to caller owned objects.
+    *
+    *  A buffer is read back by the format_fn instantiated for the log_format and value types that
+    *  wrote it.
+    */
+
+   /// formats the packed values that start at payload into out
+   using format_fn = void (*)( const char* payload, fmt::memory_buffer& out );
+
+   template<typename T>
+   constexpr bool is_string_like = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+                                   std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+                                   ( std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char> );
+
+   /**
+    *  What is packed for a value of type T. A value formatted into more than the stack buffer is formatted
+    *  again when it is encoded, straight into the destination, rather than into memory of its own.
+    */
+   template<typename T, typename Enable = void>
+   struct capture {
+      static constexpr size_t buffer_size = 256;
+
+      explicit capture( const T& v ) : value( v ) {
+         size = fmt::format_to_n( buf, buffer_size, "{}", v ).size;
+      }
+      size_t encoded_size()const { return size; }
+      char* encode( char* out )const {
+         if( size <= buffer_size ) {
+            memcpy( out, buf, size );
+         } else {
+            // a value that formats shorter the second time is padded to the size already accounted for
+            const size_t n = fmt::format_to_n( out, size, "{}", value ).size;
+            if( n < size )
+               memset( out + n, ' ', size - n );
+         }
+         return out + size;
+      }
+
+      const T& value;
+      size_t   size;
+      char     buf[buffer_size];
+   };
+
+   template<typename T>
+   struct capture<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+      explicit capture( const T& v ) : value( v ) {}
+      T value;
+   };
+
+   template<typename T>
+   struct capture<T, std::enable_if_t<is_string_like<T>>> {
+      explicit capture( const T& v ) {
+         if constexpr( std::is_pointer_v<T> ) {
+            if( v )
+               value = v;
+         } else {
+            value = std::string_view( v );
+         }
+      }
+      size_t encoded_size()const { return value.size(); }
+      char* encode( char* out )const {
+         memcpy( out, value.data(), value.size() );
+         return out + value.size();
+      }
+      std::string_view value;
+   };
+
+   /// what is formatted in place of a value of type T
+   template<typename T>
+   using decoded_t = std::conditional_t<std::is_arithmetic_v<T>, T, std::string_view>;
+
+   template<typename T>
+   constexpr size_t encoded_size( const capture<T>& c ) {
+      if constexpr( std::is_arithmetic_v<T> )
+         return sizeof(T);
+      else
+         return sizeof(uint32_t) + c.encoded_size();
+   }
+
+   inline char* write_bytes( char* out, const void* p, size_t n ) {
+      memcpy( out, p, n );
+      return out + n;
+   }
+
+   inline char* write_string( char* out, std::string_view s ) {
+      const uint32_t n = s.size();
+      out = write_bytes( out, &n, sizeof(n) );
+      return write_bytes( out, s.data(), n );
+   }
+
+   template<typename T>
+   char* encode( char* out, const capture<T>& c ) {
+      if constexpr( std::is_arithmetic_v<T> ) {
+         return write_bytes( out, &c.value, sizeof(T) );
+      } else {
+         const uint32_t n = c.encoded_size();
+         return c.encode( write_bytes( out, &n, sizeof(n) ) );
+      }
+   }
+
+   struct reader {
+      const char* pos;
+
+      template<typename T>
+      T read() {
+         T v;
+         memcpy( &v, pos, sizeof(T) );
+         pos += sizeof(T);
+         return v;
+      }
+
+      std::string_view read_string() {
+         const auto n = read<uint32_t>();
+         std::string_view s( pos, n );
+         pos += n;
+         return s;
+      }
+   };
+
+   template<typename D>
+   D read_value( reader& r ) {
+      if constexpr( std::is_same_v<D, std::string_view> )
+         return r.read_string();
+      else
+         return r.template read<D>();
+   }
+
+   template<typename Source, typename... D, size_t... I>
+   void format_values( const char* payload, fmt::memory_buffer& out, std::index_sequence<I...> ) {
+      reader r{ payload };
+      std::tuple<D...> values;
+      // braced init list is evaluated left to right, in the order the values were encoded
+      [[maybe_unused]] int unused[] = { 0, ( std::get<I>( values ) = read_value<D>( r ), 0 )... };
+      fmt::format_to( std::back_inserter( out ), log_format<Source>(), std::get<I>( values )... );
+   }
+
+   template<typename Source, typename... D>
+   void format_record( const char* payload, fmt::memory_buffer& out ) {
+      format_values<Source, D...>( payload, out, std::index_sequence_for<D...>() );
+   }
+
+   /// values packed into a buffer of their own, with the function that formats them
+   struct packed_values {
+      format_fn               format = nullptr;
+      std::unique_ptr<char[]> data;
+   };
+
+   template<typename Source, size_t... I, typename... T>
+   packed_values pack_values( std::index_sequence<I...>, const T&... values ) {
+      const std::tuple<capture<T>...> captures( values... );
+      size_t size = 0;
+      ( (size += encoded_size<T>( std::get<I>( captures ) )), ... );
+      packed_values r{ &format_record<Source, decoded_t<T>...>, std::unique_ptr<char[]>( new char[size] ) };
+      [[maybe_unused]] char* out = r.data.get();
+      ( (out = encode<T>( out, std::get<I>( captures ) )), ... );
+      return r;
+   }
+
+} } // namespace fc::detail
@@ -2,6 +2,8 @@
 
 #include <fc/log/logger.hpp>
 #include <string>
+#include <utility>
+#include <vector>
 #include <type_traits>
 
 namespace fc {
@@ -23,6 +25,18 @@ class zipkin;
 
 class sha256;
 
+/// Bounds the span export queue and sets when queued spans are posted as a batch
+struct zipkin_export_config {
+   /// spans waiting for export, spans ended while the queue is full are dropped and counted
+   uint32_t queue_capacity    = 64 * 1024;
+   /// a batch is posted as soon as this many spans are queued
+   uint32_t max_batch_spans   = 500;
+   /// a batch is also cut once its JSON reaches this many bytes
+   uint32_t max_batch_bytes   = 1024 * 1024;
+   /// spans queued for less than max_batch_spans are posted at this interval
+   uint32_t flush_interval_us = 500 * 1000;
+};
+
 class zipkin_config {
 public:
    /// Thread safe only if init() called from main thread before spawning of any threads
@@ -32,10 +46,12 @@ public:
    /// @param url the url endpoint of zipkin server. e.g. http://127.0.0.1:9411/api/v2/spans
    /// @param service_name the service name to include in each zipkin span
    /// @param timeout_us the timeout in microseconds for each http call
-   ///        (9 consecutive failures and zipkin is disabled, SIGHUP will reset the failure counter and re-enable zipkin)
+   ///        (a batch that fails to post is kept and retried, SIGHUP retries it immediately)
    /// @param retry_interval_us the interval in microseconds for connecting to zipkin
    /// @param wait_time_seconds the initial wait time in seconds for connecting to zipkin, an exception is thrown when the connection is not established within the wait time. 
-   static void init( const std::string& url, const std::string& service_name, uint32_t timeout_us, uint32_t retry_interval_us, uint32_t wait_time_seconds = 0 );
+   /// @param export_config queue bound and flush policy of span export
+   static void init( const std::string& url, const std::string& service_name, uint32_t timeout_us, uint32_t retry_interval_us, uint32_t wait_time_seconds = 0,
+                     const zipkin_export_config& export_config = zipkin_export_config() );
 
    /// Thread safe only if init() called from main thread before spawning of any threads
    /// @throw assert_exception if called before init()
@@ -86,29 +102,29 @@ struct zipkin_span {
 
    void add_tag( const std::string& key, const std::string& var ) {
       // zipkin tags are required to be strings
-      data.tags( key, var );
+      data.set_tag( key, var );
    }
 
    void add_tag( const std::string& key, const char* var ) {
       // zipkin tags are required to be strings
-      data.tags( key, var );
+      data.set_tag( key, var );
    }
 
    void add_tag( const std::string& key, bool v ) {
       // zipkin tags are required to be strings
-      data.tags( key, v ? "true" : "false" );
+      data.set_tag( key, v ? "true" : "false" );
    }
 
    template<typename T>
    std::enable_if_t<std::is_arithmetic_v<std::remove_reference_t<T>>, void>
    add_tag( const std::string& key, T&& var ) {
-      data.tags( key, std::to_string( std::forward<T>( var ) ) );
+      data.set_tag( key, std::to_string( std::forward<T>( var ) ) );
    }
 
    template<typename T>
    std::enable_if_t<!std::is_arithmetic_v<std::remove_reference_t<T>>, void>
    add_tag( const std::string& key, T&& var ) {
-      data.tags( key, (std::string) var );
+      data.set_tag( key, (std::string) var );
    }
 
    struct token {
@@ -144,13 +160,25 @@ struct zipkin_span {
       span_data& operator=( span_data&& ) = delete;
       span_data( span_data&& rhs ) = default;
 
+      /// a key already present keeps its place and takes the new value
+      void set_tag( const std::string& key, std::string value ) {
+         for( auto& tag : tags ) {
+            if( tag.first == key ) {
+               tag.second = std::move( value );
+               return;
+            }
+         }
+         tags.emplace_back( key, std::move( value ) );
+      }
+
       uint64_t id;
       const uint64_t             trace_id;
       const uint64_t             parent_id;
       const fc::time_point       start;
       fc::time_point stop;
       std::string name;
-      fc::mutable_variant_object tags;
+      /// in the order they were first added, spans carry only a handful of tags
+      std::vector<std::pair<std::string, std::string>> tags;
    };
 
    [[nodiscard]] std::optional<zipkin_span> create_span( std::string name ) const {
@@ -167,9 +195,23 @@ struct zipkin_span {
    span_data data;
 };
 
+/// Encodes spans as zipkin v2 JSON, writing straight into a caller owned buffer
+class zipkin_span_encoder {
+public:
+   /// @param local_address ip address of this host for localEndpoint, or empty
+   zipkin_span_encoder( const std::string& service_name, const std::string& local_address, bool is_v4 );
+
+   /// appends span as a JSON object
+   void append( std::string& out, const zipkin_span::span_data& span ) const;
+
+private:
+   std::string local_endpoint; // preencoded "localEndpoint" member, constant for all spans
+};
+
 class zipkin {
 public:
-   zipkin( const std::string& url, const std::string& service_name, uint32_t timeout_us, uint32_t retry_interval_us , uint32_t wait_time_seconds );
+   zipkin( const std::string& url, const std::string& service_name, uint32_t timeout_us, uint32_t retry_interval_us , uint32_t wait_time_seconds,
+           const zipkin_export_config& export_config = zipkin_export_config() );
 
    /// finishes logging all queued up spans
    ~zipkin() = default;
@@ -180,12 +222,16 @@ public:
    // finish logging all queued up spans, not restartable
    void shutdown();
 
-   // Logs zipkin json via http on separate thread
+   // Queues span for export, batches of queued spans are posted as zipkin json via http on separate thread.
+   // Thread safe and lock-free, drops the span when the queue is full.
    void log( zipkin_span::span_data&& span );
 
-   // Post http request to the boost asio queue
+   // Queues span and posts the queued batch without waiting for the flush interval
    void post_request(zipkin_span::span_data&& span);
 
+   /// Number of spans dropped because the export queue was full
+   uint64_t dropped_spans() const;
+
 private:
    class impl;
    std::unique_ptr<impl> my;
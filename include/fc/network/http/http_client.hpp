@@ -10,12 +10,72 @@
 #include <fc/exception/exception.hpp>
 #include <fc/network/url.hpp>
 #include <fc/io/json.hpp>
+#include <exception>
+#include <functional>
+#include <future>
 
 namespace fc {
 
+/**
+ *  HTTP client for JSON posts.
+ *
+ *  The post_sync functions block the calling thread and keep at most one connection per host open.
+ *
+ *  The post_async functions return right away. They are served by a thread of the client from a pool
+ *  of keep-alive connections per host, see pool_config. They may be called from any thread, and their
+ *  callbacks run on the thread of the client, so a callback must not block. A request fails with a
+ *  timeout once its deadline passes, whether it is still queued or already sent.
+ *
+ *  A new TLS connection resumes the last session of its host when the server allows it, so reconnects
+ *  skip the full handshake. The sessions are shared by post_sync and post_async.
+ *
+ *  add_cert, set_verify_peers and set_response_config must be called before the first post.
+ */
 class http_client {
    public:
+      struct pool_config {
+         /// keep-alive connections opened to one host by post_async
+         uint32_t max_connections_per_host = 4;
+         /// requests written to a connection ahead of their responses, 1 disables HTTP/1.1 pipelining
+         uint32_t pipeline_depth = 1;
+         /// requests accepted by post_async and not completed yet, beyond it post_async fails right away
+         uint32_t max_in_flight = 1024;
+         /**
+          *  a request written to a keep-alive connection that the server closes before answering is
+          *  sent once more on another connection, the server may have processed it already so this is
+          *  only for endpoints where doing a request twice is harmless
+          */
+         bool     retry_stale_requests = false;
+      };
+
+      struct response_config {
+         /// largest response body accepted, compressed bodies are limited before and after decoding
+         uint64_t max_body_size = 8 * 1024 * 1024;
+         /**
+          *  post_sync parses the body while it arrives instead of after the last byte, so the body is
+          *  never held in memory next to its variant. Responses that fail with an error status are
+          *  still read whole.
+          */
+         bool     streaming = false;
+         /// asks for gzip or deflate encoded responses with Accept-Encoding and decodes them
+         bool     accept_compressed = false;
+      };
+
+      /// TLS handshakes of the connections opened so far
+      struct tls_metrics {
+         uint64_t      full_handshakes = 0;
+         uint64_t      resumed_handshakes = 0;   ///< that reused a cached session
+         uint64_t      failed_handshakes = 0;
+         microseconds  full_handshake_time;      ///< total, from the first handshake message to the last
+         microseconds  resumed_handshake_time;   ///< total
+         microseconds  max_handshake_time;
+      };
+
+      /// receives the response of post_async, or the exception the request failed with
+      using post_callback = std::function<void( std::exception_ptr, variant )>;
+
       http_client();
+      explicit http_client( const pool_config& config );
       ~http_client();
 
       variant
@@ -35,8 +95,59 @@ class http_client {
         return post_sync(dest, payload_v, deadline, formatting);
       }
 
+      /// Posts a payload that is already encoded as JSON, skipping the conversion from variant
+      variant
+      post_sync_json(const url &dest, std::string json_body,
+                     const time_point &deadline = time_point::maximum());
+
+      /**
+       *  Queues a post of a payload that is already encoded as JSON. The body is moved into the request
+       *  as it is.
+       */
+      void
+      post_async_json(const url &dest, std::string json_body,
+                      const time_point &deadline, post_callback cb);
+
+      std::future<variant>
+      post_async_json(const url &dest, std::string json_body,
+                      const time_point &deadline = time_point::maximum());
+
+      /// queues a post of payload, which is encoded on the calling thread
+      void
+      post_async(const url &dest, const variant &payload,
+                 const time_point &deadline, post_callback cb,
+                 json::output_formatting formatting =
+                     json::output_formatting::stringify_large_ints_and_doubles);
+
+      std::future<variant>
+      post_async(const url &dest, const variant &payload,
+                 const time_point &deadline = time_point::maximum(),
+                 json::output_formatting formatting =
+                     json::output_formatting::stringify_large_ints_and_doubles);
+
+      /**
+       *  Opens the connection post_sync uses for the host of dest, including its TLS handshake, unless it
+       *  is open already. Throws when the connection fails.
+       */
+      void
+      warm_up(const url &dest, const time_point &deadline = time_point::maximum());
+
+      /**
+       *  Opens keep-alive connections of post_async to the host of dest until it has the given number,
+       *  at most pool_config::max_connections_per_host. cb runs on the thread of the client once they are
+       *  open, with the exception of the first one that failed.
+       */
+      void
+      warm_up_async(const url &dest, uint32_t connections, std::function<void( std::exception_ptr )> cb);
+
+      std::future<void>
+      warm_up_async(const url &dest, uint32_t connections = 1);
+
+      tls_metrics get_tls_metrics() const;
+
       void add_cert(const std::string& cert_pem_string);
       void set_verify_peers(bool enabled);
+      void set_response_config(const response_config& config);
 
 private:
    std::unique_ptr<class http_client_impl> _my;
@@ -15,6 +15,9 @@
 #include <boost/preprocessor/stringize.hpp>
 #include <stdint.h>
 #include <string.h>
+#include <algorithm>
+#include <string_view>
+#include <vector>
 
 #include <fc/reflect/typename.hpp>
 
@@ -134,6 +137,71 @@ struct reflector_init_visitor {
    Class& obj;
 };
 
+/**
+ *  Maps the names of the reflected members of T, including those of its bases, to their position in
+ *  visit() order.  The table is sorted by name and built once per type, so a lookup is a binary search
+ *  instead of a visit of every member.  A derived class may reflect a name its base reflects too, so
+ *  a name can map to several members.
+ */
+template<typename T>
+class reflector_member_index {
+public:
+   static constexpr size_t npos = static_cast<size_t>(-1);
+
+   /// name and position in visit() order
+   typedef std::pair<std::string_view, size_t> entry;
+   typedef typename std::vector<entry>::const_iterator iterator;
+
+   /// @return the position of the first member named name in visit() order, or npos
+   static size_t find( std::string_view name ) {
+      const auto range = equal_range( name );
+      return range.first == range.second ? npos : range.first->second;
+   }
+
+   /// @return the entries of all members named name, in visit() order
+   static std::pair<iterator, iterator> equal_range( std::string_view name ) {
+      const auto& names = sorted_names();
+      auto first = std::lower_bound( names.begin(), names.end(), name,
+                                     []( const entry& e, std::string_view n ) { return e.first < n; } );
+      auto last = first;
+      while( last != names.end() && last->first == name ) ++last;
+      return { first, last };
+   }
+
+   /// @return true when some name is reflected by more than one member
+   static bool has_duplicate_names() {
+      static const bool duplicates = []() {
+         const auto& names = sorted_names();
+         return std::adjacent_find( names.begin(), names.end(),
+                                    []( const entry& a, const entry& b ) { return a.first == b.first; } ) != names.end();
+      }();
+      return duplicates;
+   }
+
+private:
+
+   struct collector {
+      std::vector<entry>& names;
+
+      template<typename Member, class Class, Member (Class::*member)>
+      void operator()( const char* name )const {
+         names.emplace_back( name, names.size() );
+      }
+   };
+
+   static const std::vector<entry>& sorted_names() {
+      static const std::vector<entry> names = []() {
+         std::vector<entry> n;
+         n.reserve( reflector<T>::total_member_count );
+         reflector<T>::visit_base( collector{ n } );
+         // stable so that the first of duplicate names is found
+         std::stable_sort( n.begin(), n.end(), []( const entry& a, const entry& b ) { return a.first < b.first; } );
+         return n;
+      }();
+      return names;
+   }
+};
+
 } // namespace fc
 
 
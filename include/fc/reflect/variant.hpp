@@ -57,6 +57,63 @@ namespace fc
          const variant_object& vo;
    };
 
+   /**
+    *  Assigns the members of T from the entries of a variant_object in one pass over the entries,
+    *  dispatching each key through reflector_member_index<T>.  Like from_variant_visitor, members
+    *  without an entry are left untouched, unknown keys are ignored, the first of duplicate keys wins
+    *  and every member reflected under a name, in a base and in a derived class, is assigned its entry.
+    */
+   template<typename T>
+   class from_variant_members
+   {
+      public:
+         static void assign( const variant_object& vo, T& o )
+         {
+            const auto& assigners = member_assigners();
+            bool seen[fc::reflector<T>::total_member_count + 1] = {};
+            for( const auto& e : vo )
+            {
+               const auto range = reflector_member_index<T>::equal_range( e.key() );
+               if( range.first == range.second || seen[range.first->second] ) continue;
+               seen[range.first->second] = true;
+               for( auto itr = range.first; itr != range.second; ++itr )
+                  assigners[itr->second]( e.value(), o );
+            }
+         }
+
+      private:
+         typedef void (*assign_function)( const variant&, T& );
+
+         template<typename Member, class Class, Member (Class::*member)>
+         static void assign_member( const variant& v, T& o )
+         {
+            from_variant( v, o.*member );
+         }
+
+         struct collector
+         {
+            std::vector<assign_function>& assigners;
+
+            template<typename Member, class Class, Member (Class::*member)>
+            void operator()( const char* )const
+            {
+               assigners.push_back( &assign_member<Member, Class, member> );
+            }
+         };
+
+         /// in visit() order
+         static const std::vector<assign_function>& member_assigners()
+         {
+            static const std::vector<assign_function> assigners = []() {
+               std::vector<assign_function> a;
+               a.reserve( fc::reflector<T>::total_member_count );
+               fc::reflector<T>::visit_base( collector{ a } );
+               return a;
+            }();
+            return assigners;
+         }
+   };
+
    template<typename IsReflected=fc::false_type>
    struct if_enum 
    {
@@ -71,7 +128,8 @@ namespace fc
      static inline void from_variant( const fc::variant& v, T& o ) 
      { 
          const variant_object& vo = v.get_object();
-         fc::reflector<T>::visit( from_variant_visitor<T>( vo, o ) );
+         from_variant_members<T>::assign( vo, o );
+         reflector_init_visitor<T>( o ).reflector_init();
      }
    };
 
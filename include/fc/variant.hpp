@@ -3,6 +3,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -178,6 +179,29 @@ namespace fc
    void from_variant( const fc::variant& v, std::pair<A,B>& p );
 
 
+   /**
+    *  Backing memory for the string, array, object and blob storage of variants constructed
+    *  with it, released in one shot when the arena is destroyed.
+    *
+    *  Variants constructed with an arena, and any variant moved from them, must be destroyed
+    *  before the arena.  Copying such a variant, or an object or array it holds, allocates from the
+    *  heap down to its nested values, so copies may outlive it.
+    *  An arena is not thread safe.
+    */
+   class variant_arena
+   {
+      public:
+         explicit variant_arena( size_t initial_size = 4096 );
+         ~variant_arena();
+
+         variant_arena( const variant_arena& ) = delete;
+         variant_arena& operator=( const variant_arena& ) = delete;
+
+         void* allocate( size_t size, size_t alignment );
+
+      private:
+         std::pmr::monotonic_buffer_resource _resource;
+   };
 
    /**
     * @brief stores null, int64, uint64, double, bool, string, std::vector<variant>,
@@ -230,8 +254,12 @@ namespace fc
         variant( variant_object );
         variant( mutable_variant_object );
         variant( variants );
+        /// stores the value in arena instead of on the heap, @see variant_arena
+        variant( fc::string val, variant_arena& arena );
+        variant( variant_object obj, variant_arena& arena );
+        variant( variants arr, variant_arena& arena );
         variant( const variant& );
-        variant( variant&& );
+        variant( variant&& ) noexcept;
        ~variant();
 
         /**
@@ -337,7 +365,7 @@ namespace fc
            from_variant( *this, v );
         }
 
-        variant& operator=( variant&& v );
+        variant& operator=( variant&& v ) noexcept;
         variant& operator=( const variant& v );
 
         template<typename T>
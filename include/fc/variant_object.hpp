@@ -6,6 +6,11 @@ namespace fc
 {
    class mutable_variant_object;
 
+   namespace detail
+   {
+      class variant_object_index;
+   }
+
    /**
     *  @ingroup Serializable
     *
@@ -14,8 +19,9 @@ namespace fc
     *  Keys are kept in the order they are inserted.
     *  This dictionary implements copy-on-write
     *
-    *  @note This class is not optimized for random-access on large
-    *        sets of key-value pairs.
+    *  Small objects are searched linearly, objects with at least
+    *  detail::variant_object_index::min_size keys lazily build a hash
+    *  index on first lookup.
     */
    class variant_object
    {
@@ -26,7 +32,7 @@ namespace fc
       public:
          entry();
          entry( string k, variant v );
-         entry( entry&& e );
+         entry( entry&& e ) noexcept;
          entry( const entry& e);
          entry& operator=(const entry&);
          entry& operator=(entry&&);
@@ -92,8 +98,15 @@ namespace fc
       variant_object& operator=( const mutable_variant_object& );
 
    private:
+      iterator find_key( std::string_view key )const;
+
       std::shared_ptr< std::vector< entry > > _key_value;
+      /// built on demand, shared by copies since _key_value is never modified in place
+      mutable std::shared_ptr< detail::variant_object_index > _index;
+      /// held by a variant constructed with a variant_arena, copies take their own entries rather than share these
+      bool _in_arena = false;
       friend class mutable_variant_object;
+      friend class variant;
    };
    /** @ingroup Serializable */
    void to_variant( const variant_object& var,  variant& vo );
@@ -109,8 +122,9 @@ namespace fc
    *  Keys are kept in the order they are inserted.
    *  This dictionary implements copy-on-write
    *
-   *  @note This class is not optimized for random-access on large
-   *        sets of key-value pairs.
+   *  Once the object holds detail::variant_object_index::min_size keys a
+   *  hash index is maintained so find() and set() do not scan all entries.
+   *  Keys must not be modified through the mutable iterators.
    */
    class mutable_variant_object
    {
@@ -232,7 +246,12 @@ namespace fc
       mutable_variant_object& operator=( const mutable_variant_object& );
       mutable_variant_object& operator=( const variant_object& );
    private:
+      iterator find_key( std::string_view key )const;
+      void     push_back( entry e );
+
       std::unique_ptr< std::vector< entry > > _key_value;
+      /// kept in sync with _key_value once built, reset whenever entries are removed or replaced; const lookups build it atomically
+      mutable std::shared_ptr< detail::variant_object_index > _index;
       friend class variant_object;
    };
    /** @ingroup Serializable */
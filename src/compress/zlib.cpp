@@ -1,4 +1,5 @@
 #include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
 
 #include "miniz.c"
 
@@ -12,4 +13,153 @@ namespace fc
     free(compressed_message);
     return result;
   }
+
+  struct zlib_inflater::impl
+  {
+    enum stage_type { header, body, trailer, finished };
+
+    explicit impl( format f ) : fmt(f) {}
+    ~impl() { if( stage != header ) mz_inflateEnd( &zs ); }
+
+    /// length of the gzip header at the start of p, npos while it is incomplete
+    static size_t gzip_header_size( std::string_view p )
+    {
+      if( p.size() < 10 )
+        return std::string_view::npos;
+      FC_ASSERT( uint8_t(p[0]) == 0x1f && uint8_t(p[1]) == 0x8b && p[2] == 8, "Not a gzip stream" );
+      const uint8_t flags = p[3];
+      size_t pos = 10;
+      if( flags & 0x04 ) // FEXTRA
+      {
+        if( p.size() < pos + 2 )
+          return std::string_view::npos;
+        pos += 2 + ( uint8_t(p[pos]) | uint8_t(p[pos + 1]) << 8 );
+      }
+      for( uint8_t field : { 0x08, 0x10 } ) // FNAME, FCOMMENT
+      {
+        if( flags & field )
+        {
+          const size_t end = pos < p.size() ? p.find( '\0', pos ) : std::string_view::npos;
+          if( end == std::string_view::npos )
+            return std::string_view::npos;
+          pos = end + 1;
+        }
+      }
+      if( flags & 0x02 ) // FHCRC
+        pos += 2;
+      return pos <= p.size() ? pos : std::string_view::npos;
+    }
+
+    /// starts the decoder once p holds the whole header, header_size is set to the bytes it takes
+    bool start( std::string_view p, size_t& header_size )
+    {
+      int window_bits = -MZ_DEFAULT_WINDOW_BITS;
+      if( fmt == format::gzip )
+      {
+        header_size = gzip_header_size( p );
+        if( header_size == std::string_view::npos )
+          return false;
+      }
+      else
+      {
+        if( p.size() < 2 )
+          return false;
+        const uint8_t cmf = p[0], flg = p[1];
+        if( ( cmf & 0x0f ) == 8 && ( cmf << 8 | flg ) % 31 == 0 )
+          window_bits = MZ_DEFAULT_WINDOW_BITS;
+        header_size = 0;
+      }
+      memset( &zs, 0, sizeof(zs) );
+      FC_ASSERT( mz_inflateInit2( &zs, window_bits ) == MZ_OK );
+      stage = body;
+      return true;
+    }
+
+    /// returns the input that follows the end of the deflate stream
+    std::string_view decode( std::string_view in, std::string& out )
+    {
+      const size_t chunk = 16 * 1024;
+      zs.next_in  = reinterpret_cast<const unsigned char*>( in.data() );
+      zs.avail_in = in.size();
+      while( true )
+      {
+        const size_t old = out.size();
+        out.resize( old + chunk );
+        zs.next_out  = reinterpret_cast<unsigned char*>( &out[old] );
+        zs.avail_out = chunk;
+        const int r = mz_inflate( &zs, MZ_SYNC_FLUSH );
+        const size_t produced = chunk - zs.avail_out;
+        out.resize( old + produced );
+        crc  = mz_crc32( crc, reinterpret_cast<const unsigned char*>( out.data() + old ), produced );
+        size += produced;
+        if( r == MZ_STREAM_END )
+        {
+          if( fmt == format::gzip )
+          {
+            // tinfl reads ahead, the whole bytes left in its bit buffer are the start of the trailer
+            const tinfl_decompressor& d = reinterpret_cast<const inflate_state*>( zs.state )->m_decomp;
+            tinfl_bit_buf_t bits = d.m_bit_buf >> ( d.m_num_bits & 7 );
+            for( mz_uint32 n = d.m_num_bits / 8; n > 0; --n, bits >>= 8 )
+              pending.push_back( char( bits & 0xff ) );
+            stage = trailer;
+          }
+          else
+            stage = finished;
+          break;
+        }
+        FC_ASSERT( r == MZ_OK || r == MZ_BUF_ERROR, "Corrupt deflate stream: {err}", ("err", mz_error(r)) );
+        // a call that flushes the window returns early, input may be left with room in the output
+        if( zs.avail_in == 0 && zs.avail_out != 0 )
+          break;
+      }
+      return std::string_view( reinterpret_cast<const char*>( zs.next_in ), zs.avail_in );
+    }
+
+    format      fmt;
+    stage_type  stage = header;
+    std::string pending;   ///< header or trailer gathered across writes
+    mz_stream   zs;
+    mz_ulong    crc  = MZ_CRC32_INIT;
+    uint32_t    size = 0;   ///< of the output modulo 2^32, as the gzip trailer stores it
+  };
+
+  zlib_inflater::zlib_inflater( format f )
+  :my( new impl( f ) ) {}
+
+  zlib_inflater::~zlib_inflater() {}
+
+  void zlib_inflater::write( std::string_view in, std::string& out )
+  {
+    std::string header;
+    if( my->stage == impl::header )
+    {
+      my->pending.append( in );
+      size_t header_size;
+      if( !my->start( my->pending, header_size ) )
+        return;
+      header.swap( my->pending );
+      in = std::string_view( header ).substr( header_size );
+    }
+    if( my->stage == impl::body )
+      in = my->decode( in, out );
+    if( my->stage == impl::trailer )
+    {
+      my->pending.append( in.substr( 0, 8 - my->pending.size() ) );
+      if( my->pending.size() == 8 )
+      {
+        const auto le32 = [&]( size_t i ) {
+          const auto* b = reinterpret_cast<const uint8_t*>( my->pending.data() + i );
+          return uint32_t( b[0] ) | uint32_t( b[1] ) << 8 | uint32_t( b[2] ) << 16 | uint32_t( b[3] ) << 24;
+        };
+        const uint32_t crc = le32( 0 ), size = le32( 4 );
+        FC_ASSERT( crc == uint32_t( my->crc ) && size == my->size, "Corrupt gzip stream, checksum mismatch" );
+        my->stage = impl::finished;
+      }
+    }
+  }
+
+  bool zlib_inflater::done()const
+  {
+    return my->stage == impl::finished;
+  }
 }
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <boost/asio/thread_pool.hpp>
+
+#include <algorithm>
+#include <thread>
+
+/* Threads fc owns for batches of crypto work, recover_batch and merkle_root. One per core beside the
+ * calling thread, which always takes part in its own batch.
+ */
+namespace fc { namespace detail {
+    inline size_t worker_threads() {
+       return std::max( std::thread::hardware_concurrency(), 2u ) - 1;
+    }
+
+    inline boost::asio::thread_pool& worker_pool() {
+       static boost::asio::thread_pool pool( worker_threads() );
+       return pool;
+    }
+}}
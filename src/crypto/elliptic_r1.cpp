@@ -8,6 +8,8 @@
 #include <fc/exception/exception.hpp>
 #include <fc/log/logger.hpp>
 
+#include <algorithm>
+
 namespace fc { namespace crypto { namespace r1 {
     namespace detail
     {
@@ -54,6 +56,55 @@ namespace fc { namespace crypto { namespace r1 {
           }
           EC_KEY* _key;
       };
+
+      /// the P-256 group and its constants, built once and only read afterwards, so threads share them
+      struct curve
+      {
+        curve()
+        :group(EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1))
+        {
+          FC_ASSERT( group, "unable to create the secp256r1 group" );
+          EC_GROUP_get_order(group, order, nullptr);
+          BN_rshift1(half_order, order);
+          EC_GROUP_get_curve_GFp(group, field, nullptr, nullptr, nullptr);
+        }
+        ec_group   group;
+        ssl_bignum order;
+        ssl_bignum half_order;
+        ssl_bignum field;
+      };
+
+      static const curve& get_curve()
+      {
+        static const curve c;
+        return c;
+      }
+
+      /// scratch numbers of the calling thread, use within a bn_frame
+      static BN_CTX* thread_bn_ctx()
+      {
+        static thread_local bn_ctx ctx(BN_CTX_new());
+        return ctx;
+      }
+
+      struct bn_frame
+      {
+        explicit bn_frame( BN_CTX* ctx ) : ctx(ctx) { BN_CTX_start(ctx); }
+        ~bn_frame() { BN_CTX_end(ctx); }
+        BN_CTX* ctx;
+      };
+
+      /// an empty key on a copy of the shared group, much cheaper than EC_KEY_new_by_curve_name
+      static EC_KEY* new_key()
+      {
+        EC_KEY* key = EC_KEY_new();
+        if( key && !EC_KEY_set_group(key, get_curve().group) )
+        {
+          EC_KEY_free(key);
+          key = nullptr;
+        }
+        return key;
+      }
     }
     static void * ecies_key_derivation(const void *input, size_t ilen, void *output, size_t *olen)
     {
@@ -141,6 +192,71 @@ namespace fc { namespace crypto { namespace r1 {
         return ret;
     }
 
+    // ECDSA_SIG_recover_key_GFp on the shared P-256 group, which leaves the key out: q = r^-1 (s R - e G)
+    // where R is the point of x coordinate r + (recid / 2) * order and y parity recid % 2
+    static bool recover_point( const unsigned char* rs, int recid, const fc::sha256& digest, EC_POINT* q, BN_CTX* ctx )
+    {
+        const detail::curve& c = detail::get_curve();
+        detail::bn_frame frame(ctx);
+        BIGNUM* r = BN_CTX_get(ctx);
+        BIGNUM* s = BN_CTX_get(ctx);
+        BIGNUM* x = BN_CTX_get(ctx);
+        BIGNUM* e = BN_CTX_get(ctx);
+        BIGNUM* rr = BN_CTX_get(ctx);
+        if (!rr) return false;
+        ec_point R(EC_POINT_new(c.group));
+        if (!R) return false;
+
+        BN_bin2bn(rs, 32, r);
+        BN_bin2bn(rs + 32, 32, s);
+        if (!BN_copy(x, r)) return false;
+        if ((recid & 2) && !BN_add(x, x, c.order)) return false;
+        if (BN_cmp(x, c.field) >= 0) return false;
+        if (!EC_POINT_set_compressed_coordinates_GFp(c.group, R, x, recid & 1, ctx)) return false;
+
+        BN_bin2bn((const unsigned char*)digest.data(), digest.data_size(), e);
+        BN_zero(x);
+        if (!BN_mod_sub(e, x, e, c.order, ctx)) return false;
+        if (!BN_mod_inverse(rr, r, c.order, ctx)) return false;
+        if (!BN_mod_mul(s, s, rr, c.order, ctx)) return false;
+        if (!BN_mod_mul(e, e, rr, c.order, ctx)) return false;
+        return EC_POINT_mul(c.group, q, e, R, s, ctx) && !EC_POINT_is_at_infinity(c.group, q);
+    }
+
+    bool recover_public_key_data( const compact_signature& c, int recid, const fc::sha256& digest, public_key_data& out )
+    {
+        const detail::curve& cv = detail::get_curve();
+        BN_CTX* ctx = detail::thread_bn_ctx();
+        ec_point q(EC_POINT_new(cv.group));
+        return q && recover_point(&c.data[1], recid, digest, q, ctx) &&
+               EC_POINT_point2oct(cv.group, q, POINT_CONVERSION_COMPRESSED, (unsigned char*)out.data, out.size(), ctx) == out.size();
+    }
+
+    // recovery id of c after the checks of public_key( c, digest )
+    static int checked_recovery_id( const compact_signature& c )
+    {
+        int nV = c.data[0];
+        if (nV<27 || nV>=35)
+            FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+
+        BN_CTX* ctx = detail::thread_bn_ctx();
+        detail::bn_frame frame(ctx);
+        BIGNUM* s = BN_CTX_get(ctx);
+        FC_ASSERT( s && BN_bin2bn(&c.data[33],32,s) );
+        if(BN_cmp(s, detail::get_curve().half_order) > 0)
+           FC_THROW_EXCEPTION( exception, "invalid high s-value encountered in r1 signature" );
+
+        return (nV >= 31 ? nV - 4 : nV) - 27;
+    }
+
+    public_key_data recover_public_key_data( const compact_signature& c, const fc::sha256& digest )
+    {
+        public_key_data dat;
+        if (!recover_public_key_data(c, checked_recovery_id(c), digest, dat))
+            FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+        return dat;
+    }
+
     compact_signature signature_from_ecdsa(const EC_KEY* key, const public_key_data& pub_data, fc::ecdsa_sig& sig, const fc::sha256& d) {
         //We can't use ssl_bignum here; _get0() does not transfer ownership to us; _set0() does transfer ownership to fc::ecdsa_sig
         const BIGNUM *sig_r, *sig_s;
@@ -150,12 +266,9 @@ namespace fc { namespace crypto { namespace r1 {
         BN_copy(s, sig_s);
 
         //want to always use the low S value
-        const EC_GROUP* group = EC_KEY_get0_group(key);
-        ssl_bignum order, halforder;
-        EC_GROUP_get_order(group, order, nullptr);
-        BN_rshift1(halforder, order);
-        if(BN_cmp(s, halforder) > 0)
-           BN_sub(s, order, s);
+        const detail::curve& cv = detail::get_curve();
+        if(BN_cmp(s, cv.half_order) > 0)
+           BN_sub(s, cv.order, s);
 
         compact_signature csig;
 
@@ -166,19 +279,35 @@ namespace fc { namespace crypto { namespace r1 {
 
         ECDSA_SIG_set0(sig, r, s);
 
+        // rather than trying each recovery id, compute the signing point R = s^-1 (e G + r Q) as a verification
+        // would: the parity of its y and whether its x exceeds the order are the recovery id
+        BN_CTX* ctx = detail::thread_bn_ctx();
+        detail::bn_frame frame(ctx);
+        BIGNUM* si = BN_CTX_get(ctx);
+        BIGNUM* u1 = BN_CTX_get(ctx);
+        BIGNUM* u2 = BN_CTX_get(ctx);
+        BIGNUM* x = BN_CTX_get(ctx);
+        BIGNUM* y = BN_CTX_get(ctx);
+        ec_point Q(EC_POINT_new(cv.group));
+        ec_point R(EC_POINT_new(cv.group));
         int nRecId = -1;
-        for (int i=0; i<4; i++)
+        if (y && Q && R &&
+            EC_POINT_oct2point(cv.group, Q, (const unsigned char*)pub_data.data, pub_data.size(), ctx) &&
+            BN_mod_inverse(si, s, cv.order, ctx) &&
+            BN_bin2bn((const unsigned char*)d.data(), d.data_size(), u1) &&
+            BN_mod_mul(u1, u1, si, cv.order, ctx) &&
+            BN_mod_mul(u2, r, si, cv.order, ctx) &&
+            EC_POINT_mul(cv.group, R, u1, Q, u2, ctx) &&
+            EC_POINT_get_affine_coordinates_GFp(cv.group, R, x, y, ctx))
         {
-          public_key keyRec;
-          keyRec.my->_key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
-          if (ECDSA_SIG_recover_key_GFp(keyRec.my->_key, sig, (unsigned char*)&d, sizeof(d), i, 1) == 1)
+          nRecId = BN_is_odd(y) ? 1 : 0;
+          if (BN_cmp(x, cv.order) >= 0)
           {
-            if (keyRec.serialize() == pub_data )
-            {
-              nRecId = i;
-              break;
-            }
+            nRecId |= 2;
+            BN_sub(x, x, cv.order);
           }
+          if (BN_cmp(x, r) != 0)
+            nRecId = -1;
         }
         if (nRecId == -1)
           FC_THROW_EXCEPTION( exception, "unable to construct recoverable key");
@@ -244,7 +373,7 @@ namespace fc { namespace crypto { namespace r1 {
     {
         // get point from this public key
         const EC_POINT* master_pub   = EC_KEY_get0_public_key( my->_key );
-        ec_group group(EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1));
+        const EC_GROUP* group = detail::get_curve().group;
 
         ssl_bignum z;
         BN_bin2bn((unsigned char*)&digest, sizeof(digest), z);
@@ -258,7 +387,7 @@ namespace fc { namespace crypto { namespace r1 {
         EC_POINT_mul(group, result, z, master_pub, one, ctx);
 
         public_key rtn;
-        rtn.my->_key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+        rtn.my->_key = detail::new_key();
         EC_KEY_set_public_key(rtn.my->_key,result);
 
         return rtn;
@@ -270,7 +399,7 @@ namespace fc { namespace crypto { namespace r1 {
     public_key public_key::add( const fc::sha256& digest )const
     {
       try {
-        ec_group group(EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1));
+        const EC_GROUP* group = detail::get_curve().group;
         bn_ctx ctx(BN_CTX_new());
 
         fc::bigint digest_bi( (char*)&digest, sizeof(digest) );
@@ -306,7 +435,7 @@ namespace fc { namespace crypto { namespace r1 {
 
 
         public_key rtn;
-        rtn.my->_key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+        rtn.my->_key = detail::new_key();
         EC_KEY_set_public_key(rtn.my->_key,result);
         return rtn;
       } FC_RETHROW_EXCEPTIONS( debug, "digest: {digest}", ("digest",digest) );
@@ -344,7 +473,7 @@ namespace fc { namespace crypto { namespace r1 {
         ssl_bignum z;
         BN_bin2bn((unsigned char*)&offset, sizeof(offset), z);
 
-        ec_group group(EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1));
+        const EC_GROUP* group = detail::get_curve().group;
         bn_ctx ctx(BN_CTX_new());
         ssl_bignum order;
         EC_GROUP_get_order(group, order, ctx);
@@ -365,7 +494,7 @@ namespace fc { namespace crypto { namespace r1 {
     private_key private_key::regenerate( const fc::sha256& secret )
     {
        private_key self;
-       self.my->_key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+       self.my->_key = detail::new_key();
        if( !self.my->_key ) FC_THROW_EXCEPTION( exception, "Unable to generate EC key" );
 
        ssl_bignum bn;
@@ -399,7 +528,7 @@ namespace fc { namespace crypto { namespace r1 {
     private_key private_key::generate()
     {
        private_key self;
-       EC_KEY* k = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+       EC_KEY* k = detail::new_key();
        if( !k ) FC_THROW_EXCEPTION( exception, "Unable to generate EC key" );
        self.my->_key = k;
        if( !EC_KEY_generate_key( self.my->_key ) )
@@ -438,9 +567,15 @@ namespace fc { namespace crypto { namespace r1 {
 
         return sig;
     }
+    // a DER signature is often shorter than the array holding it, and OpenSSL rejects trailing bytes
+    static int der_size( const fc::crypto::r1::signature& sig )
+    {
+      return std::min<int>( 2 + (unsigned char)sig.data[1], sizeof(sig) );
+    }
+
     bool       public_key::verify( const fc::sha256& digest, const fc::crypto::r1::signature& sig )
     {
-      return 1 == ECDSA_verify( 0, (unsigned char*)&digest, sizeof(digest), (unsigned char*)&sig, sizeof(sig), my->_key );
+      return 1 == ECDSA_verify( 0, (unsigned char*)&digest, sizeof(digest), (unsigned char*)&sig, der_size(sig), my->_key );
     }
 
     public_key_data public_key::serialize()const
@@ -485,7 +620,7 @@ namespace fc { namespace crypto { namespace r1 {
       if( *front == 0 ){}
       else
       {
-         my->_key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+         my->_key = detail::new_key();
          my->_key = o2i_ECPublicKey( &my->_key, (const unsigned char**)&front, sizeof(public_key_data) );
          if( !my->_key )
          {
@@ -496,13 +631,13 @@ namespace fc { namespace crypto { namespace r1 {
 
     bool       private_key::verify( const fc::sha256& digest, const fc::crypto::r1::signature& sig )
     {
-      return 1 == ECDSA_verify( 0, (unsigned char*)&digest, sizeof(digest), (unsigned char*)&sig, sizeof(sig), my->_key );
+      return 1 == ECDSA_verify( 0, (unsigned char*)&digest, sizeof(digest), (unsigned char*)&sig, der_size(sig), my->_key );
     }
 
     public_key private_key::get_public_key()const
     {
        public_key pub;
-       pub.my->_key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+       pub.my->_key = detail::new_key();
        EC_KEY_set_public_key( pub.my->_key, EC_KEY_get0_public_key( my->_key ) );
        return pub;
     }
@@ -523,35 +658,17 @@ namespace fc { namespace crypto { namespace r1 {
 
     public_key::public_key( const compact_signature& c, const fc::sha256& digest, bool check_canonical )
     {
-        int nV = c.data[0];
-        if (nV<27 || nV>=35)
+        const int recid = checked_recovery_id(c);
+        const detail::curve& cv = detail::get_curve();
+        ec_point q(EC_POINT_new(cv.group));
+        if (!q || !recover_point(&c.data[1], recid, digest, q, detail::thread_bn_ctx()))
             FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
 
-        ecdsa_sig sig = ECDSA_SIG_new();
-        BIGNUM *r = BN_new(), *s = BN_new();
-        BN_bin2bn(&c.data[1],32,r);
-        BN_bin2bn(&c.data[33],32,s);
-        ECDSA_SIG_set0(sig, r, s);
-
-        my->_key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
-
-        const EC_GROUP* group = EC_KEY_get0_group(my->_key);
-        ssl_bignum order, halforder;
-        EC_GROUP_get_order(group, order, nullptr);
-        BN_rshift1(halforder, order);
-        if(BN_cmp(s, halforder) > 0)
-           FC_THROW_EXCEPTION( exception, "invalid high s-value encountered in r1 signature" );
-
-        if (nV >= 31)
-        {
+        my->_key = detail::new_key();
+        if (!my->_key || !EC_KEY_set_public_key(my->_key, q))
+            FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+        if (c.data[0] >= 31)
             EC_KEY_set_conv_form( my->_key, POINT_CONVERSION_COMPRESSED );
-            nV -= 4;
-//            fprintf( stderr, "compressed\n" );
-        }
-
-        if (ECDSA_SIG_recover_key_GFp(my->_key, sig, (unsigned char*)&digest, sizeof(digest), nV - 27, 0) == 1)
-            return;
-        FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
     }
 
     compact_signature private_key::sign_compact( const fc::sha256& digest )const
@@ -0,0 +1,143 @@
+#include <fc/crypto/merkle.hpp>
+
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "_worker_pool.hpp"
+
+namespace fc {
+
+   namespace {
+      /// pairs per chunk of a level, some hundreds of microseconds of hashing; narrower levels are not split
+      constexpr size_t chunk_pairs = 8192;
+
+      /// one level being hashed, shared with its helper tasks which may start after it is done
+      struct level_job {
+         level_job( const sha256* nodes, size_t pairs, sha256* parents )
+         :nodes(nodes), pairs(pairs), parents(parents) {}
+
+         /// hashes chunks of the level until none is left
+         void run() {
+            size_t hashed = 0;
+            for( size_t begin = next.fetch_add( chunk_pairs, std::memory_order_relaxed ); begin < pairs;
+                 begin = next.fetch_add( chunk_pairs, std::memory_order_relaxed ) ) {
+               const size_t n = std::min( chunk_pairs, pairs - begin );
+               sha256::hash_pairs( nodes + 2 * begin, n, parents + begin );
+               hashed += n;
+            }
+            if( hashed && done.fetch_add( hashed, std::memory_order_acq_rel ) + hashed == pairs ) {
+               std::lock_guard g( mtx );
+               cv.notify_all();
+            }
+         }
+
+         void wait() {
+            std::unique_lock g( mtx );
+            cv.wait( g, [this]() { return done.load( std::memory_order_acquire ) == pairs; } );
+         }
+
+         const sha256* const      nodes;
+         const size_t             pairs;
+         sha256* const            parents;
+         std::atomic<size_t>      next{0};
+         std::atomic<size_t>      done{0};
+         std::mutex               mtx;
+         std::condition_variable  cv;
+      };
+
+      /// the (count + 1) / 2 parents of count nodes
+      void hash_level( const sha256* nodes, size_t count, sha256* parents, const merkle_executor& executor, size_t helpers ) {
+         const size_t pairs = count / 2;
+         helpers = std::min( helpers, ( pairs + chunk_pairs - 1 ) / chunk_pairs - ( pairs ? 1 : 0 ) );
+         if( helpers ) {
+            auto job = std::make_shared<level_job>( nodes, pairs, parents );
+            for( size_t i = 0; i < helpers; ++i ) {
+               try {
+                  executor( [job]() { job->run(); } );
+               } catch( ... ) {
+                  break; // what is left is hashed here
+               }
+            }
+            job->run();
+            job->wait();
+         } else {
+            sha256::hash_pairs( nodes, pairs, parents );
+         }
+         if( count % 2 ) {
+            const sha256 last[2] = { nodes[count - 1], nodes[count - 1] };
+            sha256::hash_pairs( last, 1, parents + pairs );
+         }
+      }
+
+      const merkle_executor& pool_executor() {
+         static const merkle_executor executor = []( std::function<void()> task ) {
+            boost::asio::post( detail::worker_pool(), std::move( task ) );
+         };
+         return executor;
+      }
+   }
+
+   sha256 merkle_root( std::vector<sha256> leaves ) {
+      return merkle_root( std::move( leaves ), pool_executor(), detail::worker_threads() );
+   }
+
+   sha256 merkle_root( std::vector<sha256> leaves, const merkle_executor& executor, size_t helpers ) {
+      if( leaves.empty() )
+         return sha256();
+      // the levels go back and forth between the leaves and a buffer for the first level of parents
+      std::vector<sha256> parents( ( leaves.size() + 1 ) / 2 );
+      sha256* from = leaves.data();
+      sha256* to = parents.data();
+      for( size_t count = leaves.size(); count > 1; count = ( count + 1 ) / 2 ) {
+         hash_level( from, count, to, executor, helpers );
+         std::swap( from, to );
+      }
+      return *from;
+   }
+
+   merkle_tree::merkle_tree( std::vector<sha256> leaves ) {
+      if( leaves.empty() )
+         return;
+      _levels.push_back( std::move( leaves ) );
+      update( 0, pool_executor(), detail::worker_threads() );
+   }
+
+   void merkle_tree::append( const sha256* leaves, size_t count ) {
+      append( leaves, count, pool_executor(), detail::worker_threads() );
+   }
+
+   void merkle_tree::append( const sha256* leaves, size_t count, const merkle_executor& executor, size_t helpers ) {
+      if( !count )
+         return;
+      if( _levels.empty() )
+         _levels.emplace_back();
+      const size_t first = _levels.front().size();
+      _levels.front().insert( _levels.front().end(), leaves, leaves + count );
+      update( first, executor, helpers );
+   }
+
+   const std::vector<sha256>& merkle_tree::leaves()const {
+      static const std::vector<sha256> none;
+      return _levels.empty() ? none : _levels.front();
+   }
+
+   void merkle_tree::update( size_t first, const merkle_executor& executor, size_t helpers ) {
+      for( size_t k = 0; _levels[k].size() > 1; ++k ) {
+         if( k + 1 == _levels.size() )
+            _levels.emplace_back();
+         const auto& nodes = _levels[k];
+         auto& parents = _levels[k + 1];
+         // from the parent of the first new node on, which takes in a last node that was paired with itself
+         const size_t from = first / 2;
+         parents.resize( ( nodes.size() + 1 ) / 2 );
+         hash_level( nodes.data() + 2 * from, nodes.size() - 2 * from, parents.data() + from, executor, helpers );
+         first = from;
+      }
+   }
+
+} // fc
@@ -1,7 +1,17 @@
 #include <fc/crypto/public_key.hpp>
 #include <fc/crypto/common.hpp>
+#include <fc/crypto/recovery_cache.hpp>
 #include <fc/exception/exception.hpp>
 
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "_worker_pool.hpp"
+
 namespace fc { namespace crypto {
 
    struct recovery_visitor : fc::visitor<public_key::storage_type> {
@@ -20,8 +30,89 @@ namespace fc { namespace crypto {
    };
 
    public_key::public_key( const signature& c, const sha256& digest, bool check_canonical )
-   :_storage(std::visit(recovery_visitor(digest, check_canonical), c._storage))
    {
+      if( !recovery_cache::enabled() ) {
+         _storage = std::visit(recovery_visitor(digest, check_canonical), c._storage);
+         return;
+      }
+
+      const sha256 id = recovery_cache::id(c, digest, check_canonical);
+      if( auto cached = recovery_cache::find(id) ) {
+         _storage = std::move(cached->_storage);
+         return;
+      }
+      _storage = std::visit(recovery_visitor(digest, check_canonical), c._storage);
+      recovery_cache::insert(id, *this);
+   }
+
+   namespace {
+      /// state of one recover_batch call, shared with its helper tasks which may start after it returned
+      struct recovery_batch {
+         recovery_batch( const public_key::recovery_item* items, size_t count, size_t chunk, bool check_canonical )
+         :items(items), count(count), chunk(chunk), check_canonical(check_canonical), results(count) {}
+
+         /// recovers chunks of items until none is left
+         void run() {
+            size_t recovered = 0;
+            for( size_t begin = next.fetch_add( chunk, std::memory_order_relaxed ); begin < count;
+                 begin = next.fetch_add( chunk, std::memory_order_relaxed ) ) {
+               const size_t end = std::min( begin + chunk, count );
+               for( size_t i = begin; i < end; ++i ) {
+                  try {
+                     results[i].key = public_key( items[i].first, items[i].second, check_canonical );
+                  } catch( ... ) {
+                     results[i].error = std::current_exception();
+                  }
+               }
+               recovered += end - begin;
+            }
+            if( recovered && done.fetch_add( recovered, std::memory_order_acq_rel ) + recovered == count ) {
+               std::lock_guard g( mtx );
+               cv.notify_all();
+            }
+         }
+
+         void wait() {
+            std::unique_lock g( mtx );
+            cv.wait( g, [this]() { return done.load( std::memory_order_acquire ) == count; } );
+         }
+
+         const public_key::recovery_item* const items;
+         const size_t                           count;
+         const size_t                           chunk;
+         const bool                             check_canonical;
+         std::vector<recovered_key>             results;
+         std::atomic<size_t>                    next{0};
+         std::atomic<size_t>                    done{0};
+         std::mutex                             mtx;
+         std::condition_variable                cv;
+      };
+   }
+
+   std::vector<recovered_key> public_key::recover_batch( const recovery_item* items, size_t count, bool check_canonical ) {
+      static const executor_type executor = []( std::function<void()> task ) {
+         boost::asio::post( detail::worker_pool(), std::move( task ) );
+      };
+      return recover_batch( items, count, executor, detail::worker_threads(), check_canonical );
+   }
+
+   std::vector<recovered_key> public_key::recover_batch( const recovery_item* items, size_t count,
+                                                         const executor_type& executor, size_t helpers,
+                                                         bool check_canonical ) {
+      // a few chunks per thread balances recoveries of different cost, K1 being much faster than R1
+      const size_t chunk = std::clamp<size_t>( count / ( ( helpers + 1 ) * 4 ), 1, 16 );
+      helpers = std::min( helpers, ( count + chunk - 1 ) / chunk - ( count ? 1 : 0 ) );
+      auto batch = std::make_shared<recovery_batch>( items, count, chunk, check_canonical );
+      for( size_t i = 0; i < helpers; ++i ) {
+         try {
+            executor( [batch]() { batch->run(); } );
+         } catch( ... ) {
+            break; // what is left is recovered here
+         }
+      }
+      batch->run();
+      batch->wait();
+      return std::move( batch->results );
    }
 
    int public_key::which() const {
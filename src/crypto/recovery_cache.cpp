@@ -0,0 +1,147 @@
+#include <fc/crypto/recovery_cache.hpp>
+#include <fc/io/raw.hpp>
+
+#include <array>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace fc { namespace crypto {
+
+   namespace {
+      constexpr size_t shard_count = 16;
+
+      struct id_hash {
+         size_t operator()( const sha256& id ) const {
+            size_t h;
+            memcpy( &h, id.data(), sizeof(h) );
+            return h;
+         }
+      };
+
+      /// one lock and least recently used order, the most recently used entry is at the front
+      struct alignas(64) shard {
+         using entry = std::pair<sha256, public_key>;
+
+         std::optional<public_key> find( const sha256& id ) {
+            std::lock_guard g( mtx );
+            auto itr = index.find( id );
+            if( itr == index.end() ) {
+               ++misses;
+               return {};
+            }
+            ++hits;
+            entries.splice( entries.begin(), entries, itr->second );
+            return itr->second->second;
+         }
+
+         void insert( const sha256& id, const public_key& key ) {
+            std::lock_guard g( mtx );
+            if( capacity == 0 || index.count( id ) )
+               return;
+            entries.emplace_front( id, key );
+            index.emplace( id, entries.begin() );
+            trim();
+         }
+
+         void set_capacity( size_t c ) {
+            std::lock_guard g( mtx );
+            capacity = c;
+            trim();
+         }
+
+         void clear() {
+            std::lock_guard g( mtx );
+            index.clear();
+            entries.clear();
+         }
+
+         void add_to( recovery_cache::stats& s ) {
+            std::lock_guard g( mtx );
+            s.hits += hits;
+            s.misses += misses;
+            s.evictions += evictions;
+            s.size += entries.size();
+         }
+
+         // with mtx held
+         void trim() {
+            while( entries.size() > capacity ) {
+               index.erase( entries.back().first );
+               entries.pop_back();
+               ++evictions;
+            }
+         }
+
+         std::mutex                                                        mtx;
+         std::list<entry>                                                  entries;
+         std::unordered_map<sha256, std::list<entry>::iterator, id_hash>   index;
+         size_t                                                            capacity = 0;
+         uint64_t                                                          hits = 0;
+         uint64_t                                                          misses = 0;
+         uint64_t                                                          evictions = 0;
+      };
+
+      std::array<shard, shard_count>& shards() {
+         static std::array<shard, shard_count> s;
+         return s;
+      }
+
+      shard& shard_of( const sha256& id ) {
+         return shards()[uint8_t( id.data()[0] ) % shard_count];
+      }
+
+      std::mutex        capacity_mtx;
+      size_t            total_capacity = 0;
+   }
+
+   std::atomic<bool> recovery_cache::_enabled{false};
+
+   void recovery_cache::set_capacity( size_t capacity ) {
+      std::lock_guard g( capacity_mtx );
+      total_capacity = capacity;
+      if( capacity == 0 )
+         _enabled.store( false, std::memory_order_relaxed );
+      // the shards share the capacity, a shard filled by chance evicts a little early
+      for( size_t i = 0; i < shard_count; ++i )
+         shards()[i].set_capacity( capacity / shard_count + ( i < capacity % shard_count ) );
+      if( capacity != 0 )
+         _enabled.store( true, std::memory_order_relaxed );
+   }
+
+   size_t recovery_cache::capacity() {
+      std::lock_guard g( capacity_mtx );
+      return total_capacity;
+   }
+
+   void recovery_cache::clear() {
+      for( auto& s : shards() )
+         s.clear();
+   }
+
+   recovery_cache::stats recovery_cache::get_stats() {
+      stats result;
+      for( auto& s : shards() )
+         s.add_to( result );
+      result.capacity = capacity();
+      return result;
+   }
+
+   sha256 recovery_cache::id( const signature& sig, const sha256& digest, bool check_canonical ) {
+      sha256::encoder enc;
+      fc::raw::pack( enc, sig );
+      fc::raw::pack( enc, digest );
+      enc.put( check_canonical );
+      return enc.result();
+   }
+
+   std::optional<public_key> recovery_cache::find( const sha256& id ) {
+      return shard_of( id ).find( id );
+   }
+
+   void recovery_cache::insert( const sha256& id, const public_key& key ) {
+      shard_of( id ).insert( id, key );
+   }
+
+} }  // fc::crypto
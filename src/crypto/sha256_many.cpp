@@ -0,0 +1,566 @@
+#include <fc/crypto/sha256.hpp>
+
+#include <openssl/sha.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+#if defined(__x86_64__) && ( defined(__GNUC__) || defined(__clang__) )
+#define FC_SHA256_X86_KERNELS 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/**
+ *  sha256::hash_many and sha256::hash_pairs. A lane kernel runs the compression function on several
+ *  independent messages at once, one per lane; hash_messages feeds it the blocks of the messages and
+ *  starts the next message in a lane as soon as the one before it is done. The kernel is picked at run
+ *  time, the x86 ones are compiled for their instruction set by target attributes, so the rest of fc
+ *  does not need to be built for it.
+ */
+
+namespace fc {
+
+static_assert( sizeof(sha256) == 32, "hash_pairs reads two adjacent nodes as one 64 byte block" );
+
+namespace {
+
+   alignas(64) const uint32_t round_k[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+   };
+
+   const uint32_t initial_state[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+   };
+
+   inline uint32_t rotr( uint32_t x, int n ) { return ( x >> n ) | ( x << ( 32 - n ) ); }
+
+   /// K[t] + W[t] of the second block of every 64 byte message, which holds nothing but the padding and length
+   struct padding_schedule {
+      alignas(64) uint32_t kw[64];
+
+      padding_schedule() {
+         uint32_t w[64] = { 0x80000000 };
+         w[15] = 512;
+         for( int t = 16; t < 64; ++t ) {
+            const uint32_t s0 = rotr( w[t-15], 7 ) ^ rotr( w[t-15], 18 ) ^ ( w[t-15] >> 3 );
+            const uint32_t s1 = rotr( w[t-2], 17 ) ^ rotr( w[t-2], 19 ) ^ ( w[t-2] >> 10 );
+            w[t] = w[t-16] + s0 + w[t-7] + s1;
+         }
+         for( int t = 0; t < 64; ++t )
+            kw[t] = round_k[t] + w[t];
+      }
+   };
+
+   const uint32_t* padding64_kw() {
+      static const padding_schedule schedule;
+      return schedule.kw;
+   }
+
+   /// the state of a lane kernel holds word w of lane l at st[w * lanes + l]
+   void reset_lane( uint32_t* st, size_t lanes, size_t lane ) {
+      for( size_t w = 0; w < 8; ++w )
+         st[w * lanes + lane] = initial_state[w];
+   }
+
+   void store_digest( const uint32_t* st, size_t lanes, size_t lane, sha256& out ) {
+      uint8_t* d = (uint8_t*)out.data();
+      for( size_t w = 0; w < 8; ++w ) {
+         const uint32_t v = st[w * lanes + lane];
+         d[4*w]   = uint8_t( v >> 24 );
+         d[4*w+1] = uint8_t( v >> 16 );
+         d[4*w+2] = uint8_t( v >> 8 );
+         d[4*w+3] = uint8_t( v );
+      }
+   }
+
+   /// the blocks of one message: its whole blocks straight from the message, then one or two blocks of the
+   /// bytes left over, the padding and the length
+   struct lane_feed {
+      static constexpr size_t idle = size_t( -1 );
+
+      size_t         message = idle;
+      const uint8_t* next = nullptr;
+      size_t         whole = 0;
+      size_t         tail_blocks = 0;
+      size_t         tail_at = 0;
+      uint8_t        tail[128];
+
+      void start( const sha256::const_buffer& m, size_t index ) {
+         message = index;
+         next = (const uint8_t*)m.data;
+         whole = m.size / 64;
+         const size_t rest = m.size % 64;
+         tail_blocks = rest + 9 > 64 ? 2 : 1;
+         tail_at = 0;
+         memset( tail, 0, sizeof(tail) );
+         if( rest )
+            memcpy( tail, next + whole * 64, rest );
+         tail[rest] = 0x80;
+         const uint64_t bits = uint64_t( m.size ) * 8;
+         uint8_t* length = tail + tail_blocks * 64 - 8;
+         for( int i = 0; i < 8; ++i )
+            length[i] = uint8_t( bits >> ( 56 - 8 * i ) );
+      }
+
+      const uint8_t* block()const { return whole ? next : tail + 64 * tail_at; }
+
+      /// moves past the block just compressed, true when it was the last one
+      bool advance() {
+         if( whole ) {
+            next += 64;
+            --whole;
+            return false;
+         }
+         return ++tail_at == tail_blocks;
+      }
+   };
+
+   void openssl_hash_many( const sha256::const_buffer* in, size_t count, sha256* out ) {
+      SHA256_CTX ctx;
+      for( size_t i = 0; i < count; ++i ) {
+         SHA256_Init( &ctx );
+         SHA256_Update( &ctx, in[i].data, in[i].size );
+         SHA256_Final( (uint8_t*)out[i].data(), &ctx );
+      }
+   }
+
+   void openssl_hash_pairs( const sha256* nodes, size_t pairs, sha256* out ) {
+      SHA256_CTX ctx;
+      for( size_t i = 0; i < pairs; ++i ) {
+         SHA256_Init( &ctx );
+         SHA256_Update( &ctx, nodes[2 * i].data(), 64 );
+         SHA256_Final( (uint8_t*)out[i].data(), &ctx );
+      }
+   }
+
+   template<typename Kernel>
+   void hash_messages( const sha256::const_buffer* in, size_t count, sha256* out ) {
+      constexpr size_t lanes = Kernel::lanes;
+      static const uint8_t idle_block[64] = {};
+      alignas(64) uint32_t st[8 * lanes];
+      const uint8_t* blocks[lanes];
+      lane_feed feed[lanes];
+
+      size_t next = 0;
+      size_t busy = 0;
+      auto start = [&]( size_t l ) {
+         if( next == count )
+            return;
+         feed[l].start( in[next], next );
+         reset_lane( st, lanes, l );
+         ++next;
+         ++busy;
+      };
+      for( size_t l = 0; l < lanes; ++l )
+         start( l );
+
+      while( busy ) {
+         for( size_t l = 0; l < lanes; ++l )
+            blocks[l] = feed[l].message != lane_feed::idle ? feed[l].block() : idle_block;
+         Kernel::compress( st, blocks );
+         for( size_t l = 0; l < lanes; ++l ) {
+            if( feed[l].message == lane_feed::idle || !feed[l].advance() )
+               continue;
+            store_digest( st, lanes, l, out[feed[l].message] );
+            feed[l].message = lane_feed::idle;
+            --busy;
+            start( l );
+         }
+      }
+   }
+
+   template<typename Kernel>
+   void hash_node_pairs( const sha256* nodes, size_t pairs, sha256* out ) {
+      constexpr size_t lanes = Kernel::lanes;
+      const uint32_t* kw = padding64_kw();
+      alignas(64) uint32_t st[8 * lanes];
+      const uint8_t* blocks[lanes];
+
+      size_t first = 0;
+      for( ; pairs - first > lanes / 2; first += std::min( lanes, pairs - first ) ) {
+         const size_t n = std::min( lanes, pairs - first );
+         for( size_t l = 0; l < lanes; ++l ) {
+            // spare lanes hash the last pair again
+            blocks[l] = (const uint8_t*)nodes[2 * ( first + std::min( l, n - 1 ) )].data();
+            reset_lane( st, lanes, l );
+         }
+         Kernel::compress( st, blocks );
+         Kernel::compress_kw( st, kw );
+         for( size_t l = 0; l < n; ++l )
+            store_digest( st, lanes, l, out[first + l] );
+      }
+      // with most lanes spare, the last few pairs are quicker one at a time, as are the single pairs of
+      // the path from a new leaf to the root of a merkle_tree
+      openssl_hash_pairs( nodes + 2 * first, pairs - first, out + first );
+   }
+
+   bool always_supported() { return true; }
+
+#ifdef FC_SHA256_X86_KERNELS
+
+#define FC_SHA_NI __attribute__((target("sha,sse4.1")))
+#define FC_AVX2   __attribute__((target("avx2"), always_inline)) inline
+#define FC_AVX512 __attribute__((target("avx512f,avx512bw"), always_inline)) inline
+
+   /// SHA extensions, two messages interleaved to hide the latency of sha256rnds2
+   struct sha_ni_kernel {
+      static constexpr size_t lanes = 2;
+
+      static bool supported() {
+         unsigned a, b, c, d;
+         return __get_cpuid_count( 7, 0, &a, &b, &c, &d ) && ( b & ( 1u << 29 ) ) &&
+                __builtin_cpu_supports( "sse4.1" );
+      }
+
+      /// abef and cdgh are the state words in the order sha256rnds2 takes them
+      FC_SHA_NI static void load( const uint32_t* st, size_t l, __m128i& abef, __m128i& cdgh ) {
+         abef = _mm_set_epi32( st[0 * lanes + l], st[1 * lanes + l], st[4 * lanes + l], st[5 * lanes + l] );
+         cdgh = _mm_set_epi32( st[2 * lanes + l], st[3 * lanes + l], st[6 * lanes + l], st[7 * lanes + l] );
+      }
+
+      FC_SHA_NI static void store( uint32_t* st, size_t l, __m128i abef, __m128i cdgh ) {
+         st[0 * lanes + l] = _mm_extract_epi32( abef, 3 );
+         st[1 * lanes + l] = _mm_extract_epi32( abef, 2 );
+         st[4 * lanes + l] = _mm_extract_epi32( abef, 1 );
+         st[5 * lanes + l] = _mm_extract_epi32( abef, 0 );
+         st[2 * lanes + l] = _mm_extract_epi32( cdgh, 3 );
+         st[3 * lanes + l] = _mm_extract_epi32( cdgh, 2 );
+         st[6 * lanes + l] = _mm_extract_epi32( cdgh, 1 );
+         st[7 * lanes + l] = _mm_extract_epi32( cdgh, 0 );
+      }
+
+      FC_SHA_NI static void compress( uint32_t* st, const uint8_t* const* blocks ) {
+         const __m128i swap = _mm_set_epi64x( 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL );
+         __m128i abef[lanes], cdgh[lanes], abef0[lanes], cdgh0[lanes], w[lanes][4];
+         for( size_t l = 0; l < lanes; ++l ) {
+            load( st, l, abef[l], cdgh[l] );
+            abef0[l] = abef[l];
+            cdgh0[l] = cdgh[l];
+            for( int i = 0; i < 4; ++i )
+               w[l][i] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*)( blocks[l] + 16 * i ) ), swap );
+         }
+#pragma GCC unroll 16
+         for( int g = 0; g < 16; ++g ) {
+            const __m128i k = _mm_load_si128( (const __m128i*)&round_k[4 * g] );
+            for( size_t l = 0; l < lanes; ++l ) {
+               __m128i* x = w[l];
+               if( g >= 4 ) {
+                  // x[g & 3] holds W[t-16..t-13] and becomes W[t..t+3]
+                  __m128i t = _mm_sha256msg1_epu32( x[g & 3], x[( g + 1 ) & 3] );
+                  t = _mm_add_epi32( t, _mm_alignr_epi8( x[( g + 3 ) & 3], x[( g + 2 ) & 3], 4 ) );
+                  x[g & 3] = _mm_sha256msg2_epu32( t, x[( g + 3 ) & 3] );
+               }
+               const __m128i m = _mm_add_epi32( x[g & 3], k );
+               cdgh[l] = _mm_sha256rnds2_epu32( cdgh[l], abef[l], m );
+               abef[l] = _mm_sha256rnds2_epu32( abef[l], cdgh[l], _mm_shuffle_epi32( m, 0x0E ) );
+            }
+         }
+         for( size_t l = 0; l < lanes; ++l )
+            store( st, l, _mm_add_epi32( abef[l], abef0[l] ), _mm_add_epi32( cdgh[l], cdgh0[l] ) );
+      }
+
+      FC_SHA_NI static void compress_kw( uint32_t* st, const uint32_t* kw ) {
+         __m128i abef[lanes], cdgh[lanes], abef0[lanes], cdgh0[lanes];
+         for( size_t l = 0; l < lanes; ++l ) {
+            load( st, l, abef[l], cdgh[l] );
+            abef0[l] = abef[l];
+            cdgh0[l] = cdgh[l];
+         }
+#pragma GCC unroll 16
+         for( int g = 0; g < 16; ++g ) {
+            const __m128i m = _mm_load_si128( (const __m128i*)&kw[4 * g] );
+            const __m128i m_hi = _mm_shuffle_epi32( m, 0x0E );
+            for( size_t l = 0; l < lanes; ++l ) {
+               cdgh[l] = _mm_sha256rnds2_epu32( cdgh[l], abef[l], m );
+               abef[l] = _mm_sha256rnds2_epu32( abef[l], cdgh[l], m_hi );
+            }
+         }
+         for( size_t l = 0; l < lanes; ++l )
+            store( st, l, _mm_add_epi32( abef[l], abef0[l] ), _mm_add_epi32( cdgh[l], cdgh0[l] ) );
+      }
+   };
+
+   namespace avx2 {
+      template<int n>
+      FC_AVX2 __m256i ror( __m256i x ) { return _mm256_or_si256( _mm256_srli_epi32( x, n ), _mm256_slli_epi32( x, 32 - n ) ); }
+      FC_AVX2 __m256i add( __m256i a, __m256i b ) { return _mm256_add_epi32( a, b ); }
+      FC_AVX2 __m256i xor3( __m256i a, __m256i b, __m256i c ) { return _mm256_xor_si256( _mm256_xor_si256( a, b ), c ); }
+
+      FC_AVX2 void round( __m256i a, __m256i b, __m256i c, __m256i& d, __m256i e, __m256i f, __m256i g, __m256i& h,
+                          __m256i kw ) {
+         const __m256i ch  = _mm256_xor_si256( _mm256_and_si256( e, f ), _mm256_andnot_si256( e, g ) );
+         const __m256i maj = _mm256_or_si256( _mm256_and_si256( a, b ), _mm256_and_si256( c, _mm256_or_si256( a, b ) ) );
+         const __m256i t1  = add( add( h, xor3( ror<6>( e ), ror<11>( e ), ror<25>( e ) ) ), add( ch, kw ) );
+         const __m256i t2  = add( xor3( ror<2>( a ), ror<13>( a ), ror<22>( a ) ), maj );
+         d = add( d, t1 );
+         h = add( t1, t2 );
+      }
+
+      /// word t of the message schedule, w holds the 16 words before it
+      FC_AVX2 __m256i schedule( __m256i* w, int t ) {
+         const __m256i w15 = w[( t - 15 ) & 15], w2 = w[( t - 2 ) & 15];
+         const __m256i s0 = xor3( ror<7>( w15 ), ror<18>( w15 ), _mm256_srli_epi32( w15, 3 ) );
+         const __m256i s1 = xor3( ror<17>( w2 ), ror<19>( w2 ), _mm256_srli_epi32( w2, 10 ) );
+         return w[t & 15] = add( add( w[t & 15], s0 ), add( w[( t - 7 ) & 15], s1 ) );
+      }
+
+      /// 8 words of the 8 blocks at offset, transposed so that w[j] holds word j of every lane
+      FC_AVX2 void load_words( const uint8_t* const* blocks, size_t offset, __m256i* w ) {
+         const __m256i swap = _mm256_set_epi64x( 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                                 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL );
+         __m256i r[8], t[8];
+         for( int i = 0; i < 8; ++i )
+            r[i] = _mm256_loadu_si256( (const __m256i*)( blocks[i] + offset ) );
+         for( int i = 0; i < 4; ++i ) {
+            t[2*i]   = _mm256_unpacklo_epi32( r[2*i], r[2*i+1] );
+            t[2*i+1] = _mm256_unpackhi_epi32( r[2*i], r[2*i+1] );
+         }
+         for( int i = 0; i < 2; ++i ) {
+            r[4*i]   = _mm256_unpacklo_epi64( t[4*i],   t[4*i+2] );
+            r[4*i+1] = _mm256_unpackhi_epi64( t[4*i],   t[4*i+2] );
+            r[4*i+2] = _mm256_unpacklo_epi64( t[4*i+1], t[4*i+3] );
+            r[4*i+3] = _mm256_unpackhi_epi64( t[4*i+1], t[4*i+3] );
+         }
+         for( int m = 0; m < 4; ++m ) {
+            w[m]     = _mm256_shuffle_epi8( _mm256_permute2x128_si256( r[m], r[4+m], 0x20 ), swap );
+            w[4 + m] = _mm256_shuffle_epi8( _mm256_permute2x128_si256( r[m], r[4+m], 0x31 ), swap );
+         }
+      }
+   }
+
+   /// AVX2, eight messages in the 32 bit lanes of a ymm register
+   struct avx2_kernel {
+      static constexpr size_t lanes = 8;
+
+      static bool supported() { return __builtin_cpu_supports( "avx2" ); }
+
+      __attribute__((target("avx2"))) static void compress( uint32_t* st, const uint8_t* const* blocks ) {
+         using namespace avx2;
+         __m256i s[8], v[8], w[16];
+         for( int i = 0; i < 8; ++i )
+            v[i] = s[i] = _mm256_load_si256( (const __m256i*)( st + 8 * i ) );
+         load_words( blocks, 0, w );
+         load_words( blocks, 32, w + 8 );
+#pragma GCC unroll 8
+         for( int t = 0; t < 64; t += 8 ) {
+#pragma GCC unroll 8
+            for( int i = 0; i < 8; ++i ) {
+               const __m256i wt = t < 16 ? w[t + i] : schedule( w, t + i );
+               const __m256i kw = add( wt, _mm256_set1_epi32( round_k[t + i] ) );
+               round( v[( 8 - i ) & 7], v[( 9 - i ) & 7], v[( 10 - i ) & 7], v[( 11 - i ) & 7],
+                      v[( 12 - i ) & 7], v[( 13 - i ) & 7], v[( 14 - i ) & 7], v[( 15 - i ) & 7], kw );
+            }
+         }
+         for( int i = 0; i < 8; ++i )
+            _mm256_store_si256( (__m256i*)( st + 8 * i ), add( s[i], v[i] ) );
+      }
+
+      __attribute__((target("avx2"))) static void compress_kw( uint32_t* st, const uint32_t* kw ) {
+         using namespace avx2;
+         __m256i s[8], v[8];
+         for( int i = 0; i < 8; ++i )
+            v[i] = s[i] = _mm256_load_si256( (const __m256i*)( st + 8 * i ) );
+#pragma GCC unroll 8
+         for( int t = 0; t < 64; t += 8 ) {
+#pragma GCC unroll 8
+            for( int i = 0; i < 8; ++i )
+               round( v[( 8 - i ) & 7], v[( 9 - i ) & 7], v[( 10 - i ) & 7], v[( 11 - i ) & 7],
+                      v[( 12 - i ) & 7], v[( 13 - i ) & 7], v[( 14 - i ) & 7], v[( 15 - i ) & 7],
+                      _mm256_set1_epi32( kw[t + i] ) );
+         }
+         for( int i = 0; i < 8; ++i )
+            _mm256_store_si256( (__m256i*)( st + 8 * i ), add( s[i], v[i] ) );
+      }
+   };
+
+   // GCC 12 warns that the _mm512_undefined_epi32 behind the masked intrinsics is used uninitialized,
+   // a false positive of its own headers (GCC bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+   namespace avx512 {
+      FC_AVX512 __m512i add( __m512i a, __m512i b ) { return _mm512_add_epi32( a, b ); }
+      FC_AVX512 __m512i xor3( __m512i a, __m512i b, __m512i c ) { return _mm512_ternarylogic_epi32( a, b, c, 0x96 ); }
+
+      FC_AVX512 void round( __m512i a, __m512i b, __m512i c, __m512i& d, __m512i e, __m512i f, __m512i g, __m512i& h,
+                            __m512i kw ) {
+         const __m512i ch  = _mm512_ternarylogic_epi32( e, f, g, 0xCA );
+         const __m512i maj = _mm512_ternarylogic_epi32( a, b, c, 0xE8 );
+         const __m512i t1  = add( add( h, xor3( _mm512_ror_epi32( e, 6 ), _mm512_ror_epi32( e, 11 ), _mm512_ror_epi32( e, 25 ) ) ),
+                                  add( ch, kw ) );
+         const __m512i t2  = add( xor3( _mm512_ror_epi32( a, 2 ), _mm512_ror_epi32( a, 13 ), _mm512_ror_epi32( a, 22 ) ), maj );
+         d = add( d, t1 );
+         h = add( t1, t2 );
+      }
+
+      FC_AVX512 __m512i schedule( __m512i* w, int t ) {
+         const __m512i w15 = w[( t - 15 ) & 15], w2 = w[( t - 2 ) & 15];
+         const __m512i s0 = xor3( _mm512_ror_epi32( w15, 7 ), _mm512_ror_epi32( w15, 18 ), _mm512_srli_epi32( w15, 3 ) );
+         const __m512i s1 = xor3( _mm512_ror_epi32( w2, 17 ), _mm512_ror_epi32( w2, 19 ), _mm512_srli_epi32( w2, 10 ) );
+         return w[t & 15] = add( add( w[t & 15], s0 ), add( w[( t - 7 ) & 15], s1 ) );
+      }
+
+      /// the 16 blocks transposed so that w[j] holds word j of every lane
+      FC_AVX512 void load_words( const uint8_t* const* blocks, __m512i* w ) {
+         const __m512i swap = _mm512_set4_epi32( 0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203 );
+         __m512i r[16], t[16];
+         for( int i = 0; i < 16; ++i )
+            r[i] = _mm512_loadu_si512( blocks[i] );
+         for( int i = 0; i < 8; ++i ) {
+            t[2*i]   = _mm512_unpacklo_epi32( r[2*i], r[2*i+1] );
+            t[2*i+1] = _mm512_unpackhi_epi32( r[2*i], r[2*i+1] );
+         }
+         for( int i = 0; i < 4; ++i ) {
+            r[4*i]   = _mm512_unpacklo_epi64( t[4*i],   t[4*i+2] );
+            r[4*i+1] = _mm512_unpackhi_epi64( t[4*i],   t[4*i+2] );
+            r[4*i+2] = _mm512_unpacklo_epi64( t[4*i+1], t[4*i+3] );
+            r[4*i+3] = _mm512_unpackhi_epi64( t[4*i+1], t[4*i+3] );
+         }
+         // 128 bit block q of r[4i + m] holds word 4q + m of lanes 4i .. 4i + 3
+         for( int m = 0; m < 4; ++m ) {
+            const __m512i u0 = _mm512_shuffle_i32x4( r[m],     r[4 + m],  0x44 );
+            const __m512i u1 = _mm512_shuffle_i32x4( r[m],     r[4 + m],  0xEE );
+            const __m512i v0 = _mm512_shuffle_i32x4( r[8 + m], r[12 + m], 0x44 );
+            const __m512i v1 = _mm512_shuffle_i32x4( r[8 + m], r[12 + m], 0xEE );
+            w[m]      = _mm512_shuffle_epi8( _mm512_shuffle_i32x4( u0, v0, 0x88 ), swap );
+            w[4 + m]  = _mm512_shuffle_epi8( _mm512_shuffle_i32x4( u0, v0, 0xDD ), swap );
+            w[8 + m]  = _mm512_shuffle_epi8( _mm512_shuffle_i32x4( u1, v1, 0x88 ), swap );
+            w[12 + m] = _mm512_shuffle_epi8( _mm512_shuffle_i32x4( u1, v1, 0xDD ), swap );
+         }
+      }
+   }
+
+   /// AVX-512, sixteen messages in the 32 bit lanes of a zmm register
+   struct avx512_kernel {
+      static constexpr size_t lanes = 16;
+
+      static bool supported() { return __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ); }
+
+      __attribute__((target("avx512f,avx512bw"))) static void compress( uint32_t* st, const uint8_t* const* blocks ) {
+         using namespace avx512;
+         __m512i s[8], v[8], w[16];
+         for( int i = 0; i < 8; ++i )
+            v[i] = s[i] = _mm512_load_si512( st + 16 * i );
+         load_words( blocks, w );
+#pragma GCC unroll 8
+         for( int t = 0; t < 64; t += 8 ) {
+#pragma GCC unroll 8
+            for( int i = 0; i < 8; ++i ) {
+               const __m512i wt = t < 16 ? w[t + i] : schedule( w, t + i );
+               const __m512i kw = add( wt, _mm512_set1_epi32( round_k[t + i] ) );
+               round( v[( 8 - i ) & 7], v[( 9 - i ) & 7], v[( 10 - i ) & 7], v[( 11 - i ) & 7],
+                      v[( 12 - i ) & 7], v[( 13 - i ) & 7], v[( 14 - i ) & 7], v[( 15 - i ) & 7], kw );
+            }
+         }
+         for( int i = 0; i < 8; ++i )
+            _mm512_store_si512( st + 16 * i, add( s[i], v[i] ) );
+      }
+
+      __attribute__((target("avx512f,avx512bw"))) static void compress_kw( uint32_t* st, const uint32_t* kw ) {
+         using namespace avx512;
+         __m512i s[8], v[8];
+         for( int i = 0; i < 8; ++i )
+            v[i] = s[i] = _mm512_load_si512( st + 16 * i );
+#pragma GCC unroll 8
+         for( int t = 0; t < 64; t += 8 ) {
+#pragma GCC unroll 8
+            for( int i = 0; i < 8; ++i )
+               round( v[( 8 - i ) & 7], v[( 9 - i ) & 7], v[( 10 - i ) & 7], v[( 11 - i ) & 7],
+                      v[( 12 - i ) & 7], v[( 13 - i ) & 7], v[( 14 - i ) & 7], v[( 15 - i ) & 7],
+                      _mm512_set1_epi32( kw[t + i] ) );
+         }
+         for( int i = 0; i < 8; ++i )
+            _mm512_store_si512( st + 16 * i, add( s[i], v[i] ) );
+      }
+   };
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // FC_SHA256_X86_KERNELS
+
+   struct kernel_entry {
+      const char* name;
+      bool (*supported)();
+      void (*many)( const sha256::const_buffer*, size_t, sha256* );
+      void (*pairs)( const sha256*, size_t, sha256* );
+   };
+
+   template<typename Kernel>
+   constexpr kernel_entry lane_kernel( const char* name ) {
+      return { name, &Kernel::supported, &hash_messages<Kernel>, &hash_node_pairs<Kernel> };
+   }
+
+   /// in order of preference, the last one runs everywhere
+   const kernel_entry kernels[] = {
+#ifdef FC_SHA256_X86_KERNELS
+      lane_kernel<avx512_kernel>( "avx512" ),
+      lane_kernel<sha_ni_kernel>( "sha-ni" ),
+      lane_kernel<avx2_kernel>( "avx2" ),
+#endif
+      { "openssl", &always_supported, &openssl_hash_many, &openssl_hash_pairs }
+   };
+
+   std::atomic<const kernel_entry*> current_kernel{ nullptr };
+
+   const kernel_entry& selected_kernel() {
+      const kernel_entry* k = current_kernel.load( std::memory_order_acquire );
+      if( !k ) {
+         k = std::find_if( std::begin( kernels ), std::end( kernels ), []( const kernel_entry& e ) { return e.supported(); } );
+         current_kernel.store( k, std::memory_order_release );
+      }
+      return *k;
+   }
+
+} // namespace
+
+   void sha256::hash_many( const const_buffer* in, size_t count, sha256* out ) {
+      if( count )
+         selected_kernel().many( in, count, out );
+   }
+
+   void sha256::hash_many( const std::vector<const_buffer>& in, std::vector<sha256>& out ) {
+      out.resize( in.size() );
+      hash_many( in.data(), in.size(), out.data() );
+   }
+
+   void sha256::hash_pairs( const sha256* nodes, size_t pairs, sha256* out ) {
+      if( pairs )
+         selected_kernel().pairs( nodes, pairs, out );
+   }
+
+   std::vector<std::string> sha256::hash_many_kernels() {
+      std::vector<std::string> names;
+      for( const auto& k : kernels ) {
+         if( k.supported() )
+            names.push_back( k.name );
+      }
+      return names;
+   }
+
+   const char* sha256::hash_many_kernel() {
+      return selected_kernel().name;
+   }
+
+   bool sha256::use_hash_many_kernel( const std::string& name ) {
+      for( const auto& k : kernels ) {
+         if( k.name == name && k.supported() ) {
+            current_kernel.store( &k, std::memory_order_release );
+            return true;
+         }
+      }
+      return false;
+   }
+
+} // namespace fc
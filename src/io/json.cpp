@@ -1,17 +1,130 @@
 #include <fc/io/json.hpp>
+#include <fc/io/json_codec.hpp>
 //#include <fc/io/fstream.hpp>
 //#include <fc/io/sstream.hpp>
 #include <fc/log/logger.hpp>
 //#include <utfcpp/utf8.h>
 #include <fc/utf8.hpp>
+#include <charconv>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 
 #include <boost/filesystem/fstream.hpp>
 
 namespace fc
 {
+    namespace detail
+    {
+       /**
+        *  Scratch stacks shared by all objects and arrays of the document.  Members and elements are
+        *  collected here while a container is parsed, so its storage is allocated once at its final size.
+        */
+       struct json_scratch
+       {
+          std::vector<std::pair<std::string, variant>> members;
+          variants                                     elements;
+       };
+
+       /**
+        *  Lightweight istream-like cursor over a contiguous buffer.  Implements the subset of the
+        *  std::istream interface used by the parser templates (peek/get/eof) with the same EOF
+        *  semantics, so parsing from memory does not pay for the iostream machinery.
+        */
+       class json_buffer_stream : public json_scratch
+       {
+          public:
+             explicit json_buffer_stream( std::string_view s, variant_arena* arena = nullptr )
+             :_pos( s.data() ),_end( s.data() + s.size() ),_arena( arena ){}
+
+             int  peek()const { return _pos < _end ? static_cast<unsigned char>( *_pos ) : EOF; }
+             int  get()       { return _pos < _end ? static_cast<unsigned char>( *_pos++ ) : EOF; }
+             bool eof()const  { return _pos >= _end; }
+
+             /// consumes and returns the run of characters up to the next '"', '\\' or ^D
+             std::string_view get_string_run()
+             {
+                const char* start = _pos;
+                while( _pos < _end && *_pos != '"' && *_pos != '\\' && *_pos != '\x04' )
+                   ++_pos;
+                return std::string_view( start, _pos - start );
+             }
+
+             const char* pos()const { return _pos; }
+
+             /// arena for the strings, arrays and objects parsed from this stream, may be null
+             variant_arena* arena()const { return _arena; }
+
+          private:
+             const char*    _pos;
+             const char*    _end;
+             variant_arena* _arena;
+       };
+
+       /// istream-like cursor over a document pulled from a json::chunk_source, same EOF semantics as json_buffer_stream
+       class json_chunk_stream : public json_scratch
+       {
+          public:
+             explicit json_chunk_stream( const json::chunk_source& next )
+             :_next( next ){}
+
+             int  peek() { return fill() ? static_cast<unsigned char>( *_pos ) : EOF; }
+             int  get()  { return fill() ? static_cast<unsigned char>( *_pos++ ) : EOF; }
+             bool eof()  { return !fill(); }
+
+             /// same as json_buffer_stream::get_string_run() but stops at the end of the current chunk
+             std::string_view get_string_run()
+             {
+                const char* start = _pos;
+                while( _pos < _end && *_pos != '"' && *_pos != '\\' && *_pos != '\x04' )
+                   ++_pos;
+                return std::string_view( start, _pos - start );
+             }
+
+          private:
+             bool fill()
+             {
+                while( _pos == _end && !_done )
+                {
+                   const std::string_view chunk = _next();
+                   _done = chunk.empty();
+                   _pos = chunk.data();
+                   _end = chunk.data() + chunk.size();
+                }
+                return _pos != _end;
+             }
+
+             const json::chunk_source& _next;
+             const char*               _pos = nullptr;
+             const char*               _end = nullptr;
+             bool                      _done = false;
+       };
+
+       template<typename T>
+       json_scratch* scratch_of( T& in )
+       {
+          if constexpr( std::is_base_of_v<json_scratch, T> )
+             return &in;
+          else
+             return nullptr;
+       }
+
+       /// streams over memory that hand out the runs of plain characters in a string at once
+       template<typename T>
+       constexpr bool has_string_runs = std::is_same_v<T, json_buffer_stream> || std::is_same_v<T, json_chunk_stream>;
+
+       /// constructs a variant holding value in the arena of the stream, if it has one
+       template<typename T, typename V>
+       variant make_variant( T& in, V&& value )
+       {
+          if constexpr( std::is_same_v<T, json_buffer_stream> )
+          {
+             if( in.arena() )
+                return variant( std::forward<V>(value), *in.arena() );
+          }
+          return variant( std::forward<V>(value) );
+       }
+    }
+
     // forward declarations of provided functions
     template<typename T, json::parse_type parser_type> variant variant_from_stream( T& in, uint32_t max_depth );
     template<typename T> char parseEscape( T& in );
@@ -22,9 +135,11 @@ namespace fc
     template<typename T, json::parse_type parser_type> variants arrayFromStream( T& in, uint32_t max_depth );
     template<typename T, json::parse_type parser_type> variant number_from_stream( T& in );
     template<typename T> variant token_from_stream( T& in );
-    template<typename T> void to_stream( T& os, const variants& a, const json::yield_function_t& yield, json::output_formatting format );
-    template<typename T> void to_stream( T& os, const variant_object& o, const json::yield_function_t& yield, json::output_formatting format );
-    template<typename T> void to_stream( T& os, const variant& v, const json::yield_function_t& yield, json::output_formatting format );
+    template<typename T, json::parse_type parser_type> void events_from_stream( T& in, json::sax_handler& handler, uint32_t max_depth );
+    variant variant_from_buffer( detail::json_buffer_stream& in, const json::parse_type ptype, const uint32_t max_depth );
+    void to_buffer( std::string& out, const variants& a, const json::yield_function_t& yield, json::output_formatting format );
+    void to_buffer( std::string& out, const variant_object& o, const json::yield_function_t& yield, json::output_formatting format );
+    void to_buffer( std::string& out, const variant& v, const json::yield_function_t& yield, json::output_formatting format );
     std::string pretty_print( const std::string& v, uint8_t indent );
 }
 
@@ -88,7 +203,7 @@ namespace fc
    template<typename T>
    std::string stringFromStream( T& in )
    {
-      std::stringstream token;
+      std::string token;
       try
       {
          char c = in.peek();
@@ -103,28 +218,32 @@ namespace fc
             switch( c = in.peek() )
             {
                case '\\':
-                  token << parseEscape( in );
+                  token += parseEscape( in );
                   break;
                case 0x04:
                   FC_THROW_EXCEPTION( parse_error_exception, "EOF before closing '\"' in string '{token}'",
-                                                   ("token", token.str() ) );
+                                                   ("token", token ) );
                case '"':
                   in.get();
-                  return token.str();
+                  return token;
                default:
-                  token << c;
-                  in.get();
+                  if constexpr( detail::has_string_runs<T> ) {
+                     token += in.get_string_run();
+                  } else {
+                     token += c;
+                     in.get();
+                  }
             }
          }
          FC_THROW_EXCEPTION( parse_error_exception, "EOF before closing '\"' in string '{token}'",
-                                          ("token", token.str() ) );
+                                          ("token", token ) );
        } FC_RETHROW_EXCEPTIONS( warn, "while parsing token '{token}'",
-                                          ("token", token.str() ) );
+                                          ("token", token ) );
    }
    template<typename T>
    std::string stringFromToken( T& in )
    {
-      std::stringstream token;
+      std::string token;
       try
       {
          char c = in.peek();
@@ -134,49 +253,51 @@ namespace fc
             switch( c = in.peek() )
             {
                case '\\':
-                  token << parseEscape( in );
+                  token += parseEscape( in );
                   break;
                case '\t':
                case ' ':
                case '\n':
                   in.get();
-                  return token.str();
+                  return token;
                case '\0':
                   FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
                default:
                 if( isalnum( c ) || c == '_' || c == '-' || c == '.' || c == ':' || c == '/' )
                 {
-                  token << c;
+                  token += c;
                   in.get();
                 }
-                else return token.str();
+                else return token;
             }
          }
-         return token.str();
+         return token;
       }
       catch( const fc::eof_exception& eof )
       {
-         return token.str();
+         return token;
       }
       catch (const std::ios_base::failure&)
       {
-         return token.str();
+         return token;
       }
 
       FC_RETHROW_EXCEPTIONS( warn, "while parsing token '{token}'",
-                                          ("token", token.str() ) );
+                                          ("token", token ) );
    }
 
    template<typename T, json::parse_type parser_type>
    variant_object objectFromStream( T& in, uint32_t max_depth )
    {
       mutable_variant_object obj;
+      auto scratch = detail::scratch_of( in );
+      const size_t first = scratch ? scratch->members.size() : 0;
       try
       {
          char c = in.peek();
          if( c != '{' )
             FC_THROW_EXCEPTION( parse_error_exception,
-                                     "Expected '{', but read '{char}'",
+                                     "Expected '{{', but read '{char}'",
                                      ("char",string(&c, &c + 1)) );
          in.get();
          while( in.peek() != '}' )
@@ -197,12 +318,23 @@ namespace fc
             in.get();
             auto val = variant_from_stream<T, parser_type>( in, max_depth - 1 );
 
-            obj(std::move(key),std::move(val));
+            if( scratch )
+               scratch->members.emplace_back( std::move(key), std::move(val) );
+            else
+               obj(std::move(key),std::move(val));
             //skip_white_space(in);
          }
          if( in.peek() == '}' )
          {
             in.get();
+            if( scratch )
+            {
+               auto& members = scratch->members;
+               obj.reserve( members.size() - first );
+               for( auto itr = members.begin() + first; itr != members.end(); ++itr )
+                  obj(std::move(itr->first),std::move(itr->second));
+               members.erase( members.begin() + first, members.end() );
+            }
             return obj;
          }
          FC_THROW_EXCEPTION( parse_error_exception, "Expected right curly brace symbol after {variant}",
@@ -222,6 +354,8 @@ namespace fc
    variants arrayFromStream( T& in, uint32_t max_depth )
    {
       variants ar;
+      auto scratch = detail::scratch_of( in );
+      const size_t first = scratch ? scratch->elements.size() : 0;
       try
       {
         if( in.peek() != '[' )
@@ -237,7 +371,10 @@ namespace fc
               continue;
            }
            if( skip_white_space(in) ) continue;
-           ar.push_back( variant_from_stream<T, parser_type>( in, max_depth - 1) );
+           if( scratch )
+              scratch->elements.push_back( variant_from_stream<T, parser_type>( in, max_depth - 1) );
+           else
+              ar.push_back( variant_from_stream<T, parser_type>( in, max_depth - 1) );
            skip_white_space(in);
         }
         if( in.peek() != ']' )
@@ -245,6 +382,12 @@ namespace fc
                                     ("variant", fc::json::to_string(ar, fc::time_point::now() + fc::exception::format_time_limit)) );
 
         in.get();
+        if( scratch )
+        {
+           auto& elements = scratch->elements;
+           ar.assign( std::make_move_iterator( elements.begin() + first ), std::make_move_iterator( elements.end() ) );
+           elements.erase( elements.begin() + first, elements.end() );
+        }
       } FC_RETHROW_EXCEPTIONS( warn, "Attempting to parse array {array}",
                                          ("array", fc::json::to_string(ar, fc::time_point::now() + fc::exception::format_time_limit) ) );
       return ar;
@@ -253,14 +396,14 @@ namespace fc
    template<typename T, json::parse_type parser_type>
    variant number_from_stream( T& in )
    {
-      std::stringstream ss;
+      std::string str;
 
       bool  dot = false;
       bool  neg = false;
       if( in.peek() == '-')
       {
         neg = true;
-        ss.put( in.get() );
+        str += static_cast<char>( in.get() );
       }
       bool done = false;
 
@@ -285,14 +428,14 @@ namespace fc
               case '7':
               case '8':
               case '9':
-                 ss.put( in.get() );
+                 str += static_cast<char>( in.get() );
                  break;
               case '\0':
                  FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
               default:
                  if( isalnum( c ) )
                  {
-                    return ss.str() + stringFromToken( in );
+                    return str + stringFromToken( in );
                  }
                 done = true;
                 break;
@@ -305,7 +448,6 @@ namespace fc
       catch (const std::ios_base::failure&)
       {
       }
-      std::string str = ss.str();
       if (str == "-." || str == "." || str == "-") // check the obviously wrong things we could have encountered
         FC_THROW_EXCEPTION(parse_error_exception, "Can't parse token \"{token}\" as a JSON numeric constant", ("token", str));
       if( dot )
@@ -317,8 +459,7 @@ namespace fc
    template<typename T>
    variant token_from_stream( T& in )
    {
-      std::stringstream ss;
-      ss.exceptions( std::ifstream::badbit );
+      std::string str;
       bool received_eof = false;
       bool done = false;
 
@@ -338,7 +479,7 @@ namespace fc
               case 'f':
               case 'a':
               case 's':
-                 ss.put( in.get() );
+                 str += static_cast<char>( in.get() );
                  break;
               default:
                  done = true;
@@ -357,7 +498,6 @@ namespace fc
 
       // we can get here either by processing a delimiter as in "null,"
       // an EOF like "null<EOF>", or an invalid token like "nullZ"
-      std::string str = ss.str();
       if( str == "null" )
         return variant();
       if( str == "true" )
@@ -405,11 +545,11 @@ namespace fc
               in.get();
               continue;
             case '"':
-              return stringFromStream( in );
+              return detail::make_variant( in, stringFromStream( in ) );
             case '{':
-               return objectFromStream<T, parser_type>( in, max_depth - 1 );
+               return detail::make_variant( in, objectFromStream<T, parser_type>( in, max_depth - 1 ) );
             case '[':
-              return arrayFromStream<T, parser_type>( in, max_depth - 1 );
+              return detail::make_variant( in, arrayFromStream<T, parser_type>( in, max_depth - 1 ) );
             case '-':
             case '.':
             case '0':
@@ -440,39 +580,230 @@ namespace fc
 	  return variant();
    }
 
-   variant json::from_string( const std::string& utf8_str, const json::parse_type ptype, const uint32_t max_depth )
+   void scalar_event( const variant& v, json::sax_handler& handler )
+   {
+      switch( v.get_type() )
+      {
+         case variant::null_type:
+            handler.on_null();
+            return;
+         case variant::bool_type:
+            handler.on_bool( v.as_bool() );
+            return;
+         case variant::int64_type:
+            handler.on_int64( v.as_int64() );
+            return;
+         case variant::uint64_type:
+            handler.on_uint64( v.as_uint64() );
+            return;
+         case variant::double_type:
+            handler.on_double( v.as_double() );
+            return;
+         case variant::string_type:
+            handler.on_string( v.get_string() );
+            return;
+         default:
+            FC_THROW_EXCEPTION( fc::invalid_arg_exception, "Unsupported variant type: " + std::to_string( v.get_type() ) );
+      }
+   }
+
+   template<typename T, json::parse_type parser_type>
+   void object_events_from_stream( T& in, json::sax_handler& handler, uint32_t max_depth )
+   {
+      try
+      {
+         in.get();
+         handler.on_start_object();
+         while( in.peek() != '}' )
+         {
+            if( in.peek() == ',' )
+            {
+               in.get();
+               continue;
+            }
+            if( skip_white_space(in) ) continue;
+            string key = stringFromStream( in );
+            skip_white_space(in);
+            if( in.peek() != ':' )
+            {
+               FC_THROW_EXCEPTION( parse_error_exception, "Expected ':' after key \"{key}\"",
+                                        ("key", key) );
+            }
+            in.get();
+            handler.on_key( key );
+            events_from_stream<T, parser_type>( in, handler, max_depth - 1 );
+         }
+         in.get();
+         handler.on_end_object();
+      }
+      catch( const fc::eof_exception& e )
+      {
+         FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF: {e}", ("e", e.to_detail_string() ) );
+      } FC_RETHROW_EXCEPTIONS( warn, "Error parsing object" );
+   }
+
+   template<typename T, json::parse_type parser_type>
+   void array_events_from_stream( T& in, json::sax_handler& handler, uint32_t max_depth )
+   {
+      try
+      {
+        in.get();
+        handler.on_start_array();
+        skip_white_space(in);
+
+        while( in.peek() != ']' )
+        {
+           if( in.peek() == ',' )
+           {
+              in.get();
+              continue;
+           }
+           if( skip_white_space(in) ) continue;
+           events_from_stream<T, parser_type>( in, handler, max_depth - 1 );
+           skip_white_space(in);
+        }
+        in.get();
+        handler.on_end_array();
+      } FC_RETHROW_EXCEPTIONS( warn, "Attempting to parse array" );
+   }
+
+   /**
+    *  Event-producing counterpart of variant_from_stream(); accepts exactly the same input and
+    *  reports values in the order variant_from_stream() would insert them.
+    */
+   template<typename T, json::parse_type parser_type>
+   void events_from_stream( T& in, json::sax_handler& handler, uint32_t max_depth )
+   {
+      if( max_depth == 0 )
+          FC_THROW_EXCEPTION( parse_error_exception, "Too many nested items in JSON input!" );
+      skip_white_space(in);
+      while( 1 )
+      {
+         signed char c = in.peek();
+         switch( c )
+         {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+              in.get();
+              continue;
+            case '"':
+              handler.on_string( stringFromStream( in ) );
+              return;
+            case '{':
+              object_events_from_stream<T, parser_type>( in, handler, max_depth - 1 );
+              return;
+            case '[':
+              array_events_from_stream<T, parser_type>( in, handler, max_depth - 1 );
+              return;
+            case '-':
+            case '.':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+              scalar_event( number_from_stream<T, parser_type>( in ), handler );
+              return;
+            // null, true, false, or 'warning' / string
+            case 'n':
+            case 't':
+            case 'f':
+              scalar_event( token_from_stream( in ), handler );
+              return;
+            case 0x04: // ^D end of transmission
+            case EOF:
+            case '\0':
+              FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
+            default:
+              FC_THROW_EXCEPTION( parse_error_exception, "Unexpected char '{c}' in \"{s}\"",
+                                 ("c", c)("s", stringFromToken(in)) );
+         }
+      }
+   }
+
+   variant variant_from_buffer( detail::json_buffer_stream& in, const json::parse_type ptype, const uint32_t max_depth )
+   {
+      switch( ptype )
+      {
+          case json::parse_type::legacy_parser:
+             return variant_from_stream<detail::json_buffer_stream, json::parse_type::legacy_parser>( in, max_depth );
+          case json::parse_type::legacy_parser_with_string_doubles:
+              return variant_from_stream<detail::json_buffer_stream, json::parse_type::legacy_parser_with_string_doubles>( in, max_depth );
+          case json::parse_type::strict_parser:
+              return json_relaxed::variant_from_stream<detail::json_buffer_stream, true>( in, max_depth );
+          case json::parse_type::relaxed_parser:
+              return json_relaxed::variant_from_stream<detail::json_buffer_stream, false>( in, max_depth );
+          default:
+              FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", static_cast<int>(ptype)) );
+      }
+   }
+
+   variant json::from_string( std::string_view utf8_str, const json::parse_type ptype, const uint32_t max_depth )
+   { try {
+      detail::json_buffer_stream in( utf8_str );
+      return variant_from_buffer( in, ptype, max_depth );
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("str",std::string(utf8_str)) ) }
+
+   variant json::from_string( std::string_view utf8_str, variant_arena& arena, const json::parse_type ptype, const uint32_t max_depth )
    { try {
-      std::stringstream in( utf8_str );
-      //in.exceptions( std::ifstream::eofbit );
+      detail::json_buffer_stream in( utf8_str, &arena );
+      return variant_from_buffer( in, ptype, max_depth );
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("str",std::string(utf8_str)) ) }
+
+   variant json::from_chunks( const json::chunk_source& next, const json::parse_type ptype, const uint32_t max_depth )
+   {
+      detail::json_chunk_stream in( next );
       switch( ptype )
       {
-          case parse_type::legacy_parser:
-             return variant_from_stream<std::stringstream, json::parse_type::legacy_parser>( in, max_depth );
-          case parse_type::legacy_parser_with_string_doubles:
-              return variant_from_stream<std::stringstream, json::parse_type::legacy_parser_with_string_doubles>( in, max_depth );
-          case parse_type::strict_parser:
-              return json_relaxed::variant_from_stream<std::stringstream, true>( in, max_depth );
-          case parse_type::relaxed_parser:
-              return json_relaxed::variant_from_stream<std::stringstream, false>( in, max_depth );
+          case json::parse_type::legacy_parser:
+             return variant_from_stream<detail::json_chunk_stream, json::parse_type::legacy_parser>( in, max_depth );
+          case json::parse_type::legacy_parser_with_string_doubles:
+              return variant_from_stream<detail::json_chunk_stream, json::parse_type::legacy_parser_with_string_doubles>( in, max_depth );
+          case json::parse_type::strict_parser:
+              return json_relaxed::variant_from_stream<detail::json_chunk_stream, true>( in, max_depth );
+          case json::parse_type::relaxed_parser:
+              return json_relaxed::variant_from_stream<detail::json_chunk_stream, false>( in, max_depth );
           default:
               FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", static_cast<int>(ptype)) );
       }
-   } FC_RETHROW_EXCEPTIONS( warn, "", ("str",utf8_str) ) }
+   }
 
-   variants json::variants_from_string( const std::string& utf8_str, const json::parse_type ptype, const uint32_t max_depth )
+   variants json::variants_from_string( std::string_view utf8_str, const json::parse_type ptype, const uint32_t max_depth )
    { try {
       variants result;
-      std::stringstream in( utf8_str );
-      //in.exceptions( std::ifstream::eofbit );
+      detail::json_buffer_stream in( utf8_str );
       try {
          while( true )
          {
            // result.push_back( variant_from_stream( in ));
-           result.push_back(json_relaxed::variant_from_stream<std::stringstream, false>( in, max_depth ));
+           result.push_back(json_relaxed::variant_from_stream<detail::json_buffer_stream, false>( in, max_depth ));
          }
       } catch ( const fc::eof_exception& ){}
       return result;
-   } FC_RETHROW_EXCEPTIONS( warn, "", ("str",utf8_str) ) }
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("str",std::string(utf8_str)) ) }
+
+   void json::parse_events( std::string_view utf8_str, json::sax_handler& handler, const json::parse_type ptype, const uint32_t max_depth )
+   { try {
+      detail::json_buffer_stream in( utf8_str );
+      switch( ptype )
+      {
+          case parse_type::legacy_parser:
+             events_from_stream<detail::json_buffer_stream, json::parse_type::legacy_parser>( in, handler, max_depth );
+             break;
+          case parse_type::legacy_parser_with_string_doubles:
+             events_from_stream<detail::json_buffer_stream, json::parse_type::legacy_parser_with_string_doubles>( in, handler, max_depth );
+             break;
+          default:
+              FC_ASSERT( false, "JSON parser type {ptype} does not support event parsing", ("ptype", static_cast<int>(ptype)) );
+      }
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("str",std::string(utf8_str)) ) }
    /*
    void toUTF8( const char str, std::ostream& os )
    {
@@ -492,179 +823,188 @@ namespace fc
     *  Removes invalid utf8 characters
     *  Escapes Control sequence Introducer 0x9b to \u009b
     *  All other characters unmolested.
+    *
+    *  Runs of characters that need no escaping are appended in bulk, yield is still called every
+    *  escape_string_yield_check_count input characters.
     */
-   std::string escape_string( const std::string_view& str, const json::yield_function_t& yield, bool escape_control_chars )
+   void append_escaped_string( std::string& r, const std::string_view& str, const json::yield_function_t& yield, bool escape_control_chars )
    {
-      string r;
+      static constexpr char hex_digits[] = "0123456789abcdef";
       const auto init_size = str.size();
-      r.reserve( init_size + 13 ); // allow for a few escapes
-      size_t i = 0;
-      for( auto itr = str.begin(); itr != str.end(); ++i,++itr )
+      const auto start_size = r.size();
+      r.reserve( start_size + init_size + 13 ); // allow for a few escapes
+      bool has_multibyte = false;
+      const char* const begin = str.data();
+      const char* const end = begin + init_size;
+      const char* itr = begin;
+      while( itr != end )
       {
-         if( i % json::escape_string_yield_check_count == 0 ) yield( init_size + r.size() );
-         switch( *itr )
+         yield( init_size + r.size() - start_size );
+         const char* const chunk_end = static_cast<size_t>( end - itr ) > json::escape_string_yield_check_count ? itr + json::escape_string_yield_check_count : end;
+         while( itr != chunk_end )
          {
-            case '\x00': r += "\\u0000"; break;
-            case '\x01': r += "\\u0001"; break;
-            case '\x02': r += "\\u0002"; break;
-            case '\x03': r += "\\u0003"; break;
-            case '\x04': r += "\\u0004"; break;
-            case '\x05': r += "\\u0005"; break;
-            case '\x06': r += "\\u0006"; break;
-            case '\x07': r += "\\u0007"; break; // \a is not valid JSON
-            case '\x08': r += "\\u0008"; break; // \b
-         // case '\x09': r += "\\u0009"; break; // \t
-         // case '\x0a': r += "\\u000a"; break; // \n
-            case '\x0b': r += "\\u000b"; break;
-            case '\x0c': r += "\\u000c"; break; // \f
-         // case '\x0d': r += "\\u000d"; break; // \r
-            case '\x0e': r += "\\u000e"; break;
-            case '\x0f': r += "\\u000f"; break;
-            case '\x10': r += "\\u0010"; break;
-            case '\x11': r += "\\u0011"; break;
-            case '\x12': r += "\\u0012"; break;
-            case '\x13': r += "\\u0013"; break;
-            case '\x14': r += "\\u0014"; break;
-            case '\x15': r += "\\u0015"; break;
-            case '\x16': r += "\\u0016"; break;
-            case '\x17': r += "\\u0017"; break;
-            case '\x18': r += "\\u0018"; break;
-            case '\x19': r += "\\u0019"; break;
-            case '\x1a': r += "\\u001a"; break;
-            case '\x1b': r += "\\u001b"; break;
-            case '\x1c': r += "\\u001c"; break;
-            case '\x1d': r += "\\u001d"; break;
-            case '\x1e': r += "\\u001e"; break;
-            case '\x1f': r += "\\u001f"; break;
-
-            case '\x7f': r += "\\u007f"; break;
-
-            // if escape_control_chars=true these fall-through to default
-            case '\t':        // \x09
-               if( escape_control_chars ) {
-                  r += "\\t";
+            const char* run = itr;
+            while( itr != chunk_end ) {
+               const unsigned char uc = static_cast<unsigned char>( *itr );
+               if( uc < 0x20 || uc == 0x7f || uc == '\\' || uc == '"' ) break;
+               has_multibyte |= ( uc & 0x80 ) != 0;
+               ++itr;
+            }
+            r.append( run, itr - run );
+            if( itr == chunk_end ) break;
+
+            const char c = *itr++;
+            switch( c )
+            {
+               case '\t':
+                  if( escape_control_chars ) r += "\\t";
+                  else r += c;
                   break;
-               }
-            case '\n':        // \x0a
-               if( escape_control_chars ) {
-                  r += "\\n";
+               case '\n':
+                  if( escape_control_chars ) r += "\\n";
+                  else r += c;
                   break;
-               }
-            case '\r':        // \x0d
-               if( escape_control_chars ) {
-                  r += "\\r";
+               case '\r':
+                  if( escape_control_chars ) r += "\\r";
+                  else r += c;
                   break;
-               }
-            case '\\':
-               if( escape_control_chars ) {
-                  r += "\\\\";
+               case '\\':
+                  if( escape_control_chars ) r += "\\\\";
+                  else r += c;
                   break;
-               }
-            case '\"':
-               if( escape_control_chars ) {
-                  r += "\\\"";
+               case '\"':
+                  if( escape_control_chars ) r += "\\\"";
+                  else r += c;
                   break;
-               }
-            default:
-               r += *itr;
+               default: // remaining < 32 and 127, \a \b \f are not valid JSON
+                  r += "\\u00";
+                  r += hex_digits[static_cast<unsigned char>( c ) >> 4u];
+                  r += hex_digits[static_cast<unsigned char>( c ) & 15u];
+            }
          }
       }
 
-      return is_valid_utf8( r ) ? r : prune_invalid_utf8( r );
+      // escapes only produce ascii, so only the original multi-byte sequences can be invalid
+      if( has_multibyte ) {
+         const std::string_view escaped( r.data() + start_size, r.size() - start_size );
+         if( !is_valid_utf8( escaped ) ) {
+            std::string pruned = prune_invalid_utf8( escaped );
+            r.resize( start_size );
+            r += pruned;
+         }
+      }
    }
 
-   template<typename T>
-   void to_stream( T& os, const variants& a, const json::yield_function_t& yield, const json::output_formatting format )
+   std::string escape_string( const std::string_view& str, const json::yield_function_t& yield, bool escape_control_chars )
    {
-      yield(os.tellp());
-      os << '[';
+      std::string r;
+      append_escaped_string( r, str, yield, escape_control_chars );
+      return r;
+   }
+
+   namespace detail
+   {
+      template<typename Int>
+      void append_integer( std::string& out, Int i, bool quote )
+      {
+         char buf[24];
+         auto res = std::to_chars( buf, buf + sizeof(buf), i );
+         if( quote ) out += '"';
+         out.append( buf, res.ptr - buf );
+         if( quote ) out += '"';
+      }
+
+      /// matches fc::to_string(double): fixed notation with digits10 + 2 digits of precision
+      void append_double( std::string& out, double d, bool quote )
+      {
+         if( quote ) out += '"';
+         fmt::format_to( std::back_inserter( out ), "{:.{}f}", d, std::numeric_limits<double>::digits10 + 2 );
+         if( quote ) out += '"';
+      }
+   }
+
+   void to_buffer( std::string& out, const variants& a, const json::yield_function_t& yield, const json::output_formatting format )
+   {
+      yield( out.size() );
+      out += '[';
       auto itr = a.begin();
 
       while( itr != a.end() )
       {
-         to_stream( os, *itr, yield, format );
+         to_buffer( out, *itr, yield, format );
          ++itr;
          if( itr != a.end() )
-            os << ',';
+            out += ',';
       }
-      os << ']';
+      out += ']';
    }
 
-   template<typename T>
-   void to_stream( T& os, const variant_object& o, const json::yield_function_t& yield, const json::output_formatting format )
+   void to_buffer( std::string& out, const variant_object& o, const json::yield_function_t& yield, const json::output_formatting format )
    {
-       yield(os.tellp());
-       os << '{';
+       yield( out.size() );
+       out += '{';
        auto itr = o.begin();
 
        while( itr != o.end() )
        {
-          os << '"' << escape_string( itr->key(), yield ) << '"';
-          os << ':';
-          to_stream( os, itr->value(), yield, format );
+          out += '"';
+          append_escaped_string( out, itr->key(), yield );
+          out += "\":";
+          to_buffer( out, itr->value(), yield, format );
           ++itr;
           if( itr != o.end() )
-             os << ',';
+             out += ',';
        }
-       os << '}';
+       out += '}';
    }
 
-   template<typename T>
-   void to_stream( T& os, const variant& v, const json::yield_function_t& yield, const json::output_formatting format )
+   void to_buffer( std::string& out, const variant& v, const json::yield_function_t& yield, const json::output_formatting format )
    {
-      yield(os.tellp());
+      yield( out.size() );
+      const bool stringify = format == json::output_formatting::stringify_large_ints_and_doubles;
       switch( v.get_type() )
       {
          case variant::null_type:
-              os << "null";
+              out += "null";
               return;
          case variant::int64_type:
          {
               int64_t i = v.as_int64();
-              if( format == json::output_formatting::stringify_large_ints_and_doubles &&
-                  i > 0xffffffff )
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << i;
-
+              detail::append_integer( out, i, stringify && i > 0xffffffff );
               return;
          }
          case variant::uint64_type:
          {
               uint64_t i = v.as_uint64();
-              if( format == json::output_formatting::stringify_large_ints_and_doubles &&
-                  i > 0xffffffff )
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << i;
-
+              detail::append_integer( out, i, stringify && i > 0xffffffff );
               return;
          }
          case variant::double_type:
-              if (format == json::output_formatting::stringify_large_ints_and_doubles)
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << v.as_string();
+              detail::append_double( out, v.as_double(), stringify );
               return;
          case variant::bool_type:
-              os << v.as_string();
+              out += v.as_bool() ? "true" : "false";
               return;
          case variant::string_type:
-              os << '"' << escape_string( v.get_string(), yield ) << '"';
+              out += '"';
+              append_escaped_string( out, v.get_string(), yield );
+              out += '"';
               return;
          case variant::blob_type:
-              os << '"' << escape_string( v.as_string(), yield ) << '"';
+              out += '"';
+              append_escaped_string( out, v.as_string(), yield );
+              out += '"';
               return;
          case variant::array_type:
            {
               const variants&  a = v.get_array();
-              to_stream( os, a, yield, format );
+              to_buffer( out, a, yield, format );
               return;
            }
          case variant::object_type:
            {
               const variant_object& o =  v.get_object();
-              to_stream(os, o, yield, format );
+              to_buffer( out, o, yield, format );
               return;
            }
          default:
@@ -674,15 +1014,16 @@ namespace fc
 
    std::string   json::to_string( const variant& v, const json::yield_function_t& yield, const json::output_formatting format )
    {
-      std::stringstream ss;
-      fc::to_stream( ss, v, yield, format );
-      yield(ss.tellp());
-      return ss.str();
+      std::string out;
+      fc::to_buffer( out, v, yield, format );
+      yield( out.size() );
+      return out;
    }
 
    std::string json::pretty_print( const std::string& v, const uint8_t indent ) {
       int level = 0;
-      std::stringstream ss;
+      std::string out;
+      out.reserve( v.size() + v.size() / 2 );
       bool first = false;
       bool quote = false;
       bool escape = false;
@@ -693,30 +1034,30 @@ namespace fc
                 if( quote )
                   escape = true;
               } else { escape = false; }
-              ss<<v[i];
+              out += v[i];
               break;
             case ':':
               if( !quote ) {
-                ss<<": ";
+                out += ": ";
               } else {
-                ss<<':';
+                out += ':';
               }
               break;
             case '"':
               if( first ) {
-                 ss<<'\n';
-                 for( int i = 0; i < level*indent; ++i ) ss<<' ';
+                 out += '\n';
+                 for( int i = 0; i < level*indent; ++i ) out += ' ';
                  first = false;
               }
               if( !escape ) {
                 quote = !quote;
               }
               escape = false;
-              ss<<'"';
+              out += '"';
               break;
             case '{':
             case '[':
-              ss<<v[i];
+              out += v[i];
               if( !quote ) {
                 ++level;
                 first = true;
@@ -728,27 +1069,27 @@ namespace fc
             case ']':
               if( !quote ) {
                 if( v[i-1] != '[' && v[i-1] != '{' ) {
-                  ss<<'\n';
+                  out += '\n';
                 }
                 --level;
                 if( !first ) {
-                  for( int i = 0; i < level*indent; ++i ) ss<<' ';
+                  for( int i = 0; i < level*indent; ++i ) out += ' ';
                 }
                 first = false;
-                ss<<v[i];
+                out += v[i];
                 break;
               } else {
                 escape = false;
-                ss<<v[i];
+                out += v[i];
               }
               break;
             case ',':
               if( !quote ) {
-                ss<<',';
+                out += ',';
                 first = true;
               } else {
                 escape = false;
-                ss<<',';
+                out += ',';
               }
               break;
             case 'n':
@@ -763,14 +1104,14 @@ namespace fc
               //No break; fall through to default case
             default:
               if( first ) {
-                 ss<<'\n';
-                 for( int i = 0; i < level*indent; ++i ) ss<<' ';
+                 out += '\n';
+                 for( int i = 0; i < level*indent; ++i ) out += ' ';
                  first = false;
               }
-              ss << v[i];
+              out += v[i];
          }
       }
-      return ss.str();
+      return out;
     }
 
    std::string json::to_pretty_string( const variant& v, const json::yield_function_t& yield, const json::output_formatting format ) {
@@ -787,11 +1128,10 @@ namespace fc
          o.write( str.c_str(), str.size() );
          return o.good();
       } else {
+         std::string str;
+         fc::to_buffer( str, v, nullptr, format );
          std::ofstream o(fi.generic_string().c_str());
-         const auto yield = [&](size_t s) {
-            // no limitation
-         };
-         fc::to_stream( o, v, yield, format );
+         o.write( str.c_str(), str.size() );
          return o.good();
       }
    }
@@ -837,20 +1177,20 @@ namespace fc
    bool json::is_valid( const std::string& utf8_str, const json::parse_type ptype, const uint32_t max_depth )
    {
       if( utf8_str.size() == 0 ) return false;
-      std::stringstream in( utf8_str );
+      detail::json_buffer_stream in( utf8_str );
       switch( ptype )
       {
           case json::parse_type::legacy_parser:
-             variant_from_stream<std::stringstream, json::parse_type::legacy_parser>( in, max_depth );
+             variant_from_stream<detail::json_buffer_stream, json::parse_type::legacy_parser>( in, max_depth );
               break;
           case json::parse_type::legacy_parser_with_string_doubles:
-             variant_from_stream<std::stringstream, json::parse_type::legacy_parser_with_string_doubles>( in, max_depth );
+             variant_from_stream<detail::json_buffer_stream, json::parse_type::legacy_parser_with_string_doubles>( in, max_depth );
               break;
           case json::parse_type::strict_parser:
-             json_relaxed::variant_from_stream<std::stringstream, true>( in, max_depth );
+             json_relaxed::variant_from_stream<detail::json_buffer_stream, true>( in, max_depth );
               break;
           case json::parse_type::relaxed_parser:
-             json_relaxed::variant_from_stream<std::stringstream, false>( in, max_depth );
+             json_relaxed::variant_from_stream<detail::json_buffer_stream, false>( in, max_depth );
               break;
           default:
               FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", static_cast<int>(ptype)) );
@@ -859,4 +1199,140 @@ namespace fc
       return false;
    }
 
+   namespace json_codec
+   {
+      void append_int64( std::string& out, int64_t i, json::output_formatting format )
+      {
+         fc::detail::append_integer( out, i, format == json::output_formatting::stringify_large_ints_and_doubles && i > 0xffffffff );
+      }
+
+      void append_uint64( std::string& out, uint64_t u, json::output_formatting format )
+      {
+         fc::detail::append_integer( out, u, format == json::output_formatting::stringify_large_ints_and_doubles && u > 0xffffffff );
+      }
+
+      void append_double( std::string& out, double d, json::output_formatting format )
+      {
+         fc::detail::append_double( out, d, format == json::output_formatting::stringify_large_ints_and_doubles );
+      }
+
+      void append_bool( std::string& out, bool b )
+      {
+         out += b ? "true" : "false";
+      }
+
+      void append_string( std::string& out, std::string_view s )
+      {
+         out += '"';
+         append_escaped_string( out, s, json::yield_function_t() );
+         out += '"';
+      }
+
+      void append_variant( std::string& out, const variant& v, json::output_formatting format )
+      {
+         fc::to_buffer( out, v, json::yield_function_t(), format );
+      }
+
+      reader::reader( std::string_view s, uint32_t max_depth )
+      :_pos( s.data() ),_end( s.data() + s.size() ),_max_depth( max_depth ){}
+
+      int reader::peek()
+      {
+         fc::detail::json_buffer_stream in( std::string_view( _pos, _end - _pos ) );
+         skip_white_space( in );
+         _pos = in.pos();
+         return in.peek();
+      }
+
+      // the legacy parser spends two levels of max_depth on each array or object
+      uint32_t reader::remaining_depth()const
+      {
+         return _max_depth > 2 * _level ? _max_depth - 2 * _level : 0;
+      }
+
+      void reader::enter( char open )
+      {
+         if( peek() != open )
+            FC_THROW_EXCEPTION( parse_error_exception, "Expected '{c}'", ("c", string(1, open)) );
+         if( remaining_depth() == 0 )
+            FC_THROW_EXCEPTION( parse_error_exception, "Too many nested items in JSON input!" );
+         ++_pos;
+         ++_level;
+      }
+
+      void reader::begin_object()
+      {
+         enter( '{' );
+      }
+
+      bool reader::next_key( std::string& key )
+      {
+         while( true )
+         {
+            const int c = peek();
+            if( c == ',' )
+            {
+               ++_pos;
+               continue;
+            }
+            if( c == '}' )
+            {
+               ++_pos;
+               --_level;
+               return false;
+            }
+            break;
+         }
+         fc::detail::json_buffer_stream in( std::string_view( _pos, _end - _pos ) );
+         key = stringFromStream( in );
+         skip_white_space( in );
+         if( in.peek() != ':' )
+            FC_THROW_EXCEPTION( parse_error_exception, "Expected ':' after key \"{key}\"", ("key", key) );
+         in.get();
+         _pos = in.pos();
+         return true;
+      }
+
+      void reader::begin_array()
+      {
+         enter( '[' );
+      }
+
+      bool reader::next_element()
+      {
+         while( true )
+         {
+            const int c = peek();
+            if( c == ',' )
+            {
+               ++_pos;
+               continue;
+            }
+            if( c == ']' )
+            {
+               ++_pos;
+               --_level;
+               return false;
+            }
+            return true;
+         }
+      }
+
+      std::string reader::read_string()
+      {
+         fc::detail::json_buffer_stream in( std::string_view( _pos, _end - _pos ) );
+         std::string s = stringFromStream( in );
+         _pos = in.pos();
+         return s;
+      }
+
+      variant reader::read_value()
+      {
+         fc::detail::json_buffer_stream in( std::string_view( _pos, _end - _pos ) );
+         variant v = variant_from_stream<fc::detail::json_buffer_stream, json::parse_type::legacy_parser>( in, remaining_depth() );
+         _pos = in.pos();
+         return v;
+      }
+   }
+
 } // fc
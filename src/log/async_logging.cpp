@@ -0,0 +1,283 @@
+#include <fc/log/async_logging.hpp>
+#include <fc/log/log_site.hpp>
+#include <fc/log/log_metrics.hpp>
+#include <fc/log/logger_config.hpp>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fc { namespace async_logging {
+
+namespace detail {
+
+   std::atomic<bool> active{false};
+
+   /**
+    *  Ring of variable size records written by one thread and read by the background thread.
+    *  Positions only grow, a record that would straddle the end of the buffer is preceded by a
+    *  padding record so every record is contiguous.
+    */
+   class thread_ring {
+   public:
+      static constexpr uint32_t padding_flag = 0x80000000;
+
+      // zero filled so the first pass over the ring does not page fault on the logging thread
+      explicit thread_ring( size_t capacity )
+      :_capacity( capacity ), _data( new char[capacity]() ) {}
+
+      char* reserve( size_t size ) {
+         const size_t head   = _head.load( std::memory_order_relaxed );
+         const size_t offset = head & ( _capacity - 1 );
+         const size_t pad    = offset + size > _capacity ? _capacity - offset : 0;
+         if( size + pad > _capacity - ( head - _cached_tail ) ) {
+            _cached_tail = _tail.load( std::memory_order_acquire );
+            if( size + pad > _capacity - ( head - _cached_tail ) ) {
+               _dropped.fetch_add( 1, std::memory_order_relaxed );
+               return nullptr;
+            }
+         }
+         if( pad ) {
+            const uint32_t marker = pad | padding_flag;
+            memcpy( _data.get() + offset, &marker, sizeof(marker) );
+         }
+         _pending = head + pad + size;
+         return _data.get() + ( ( head + pad ) & ( _capacity - 1 ) );
+      }
+
+      void commit() { _head.store( _pending, std::memory_order_release ); }
+
+      /// calls f with each record committed so far, returns the number of records
+      template<typename F>
+      size_t consume( F&& f ) {
+         const size_t head = _head.load( std::memory_order_acquire );
+         size_t tail = _tail.load( std::memory_order_relaxed );
+         size_t n = 0;
+         while( tail != head ) {
+            const char* p = _data.get() + ( tail & ( _capacity - 1 ) );
+            uint32_t size;
+            memcpy( &size, p, sizeof(size) );
+            if( size & padding_flag ) {
+               size &= ~padding_flag;
+            } else {
+               f( p );
+               ++n;
+            }
+            tail += size;
+            _tail.store( tail, std::memory_order_release );
+         }
+         return n;
+      }
+
+      bool     empty()const   { return _tail.load( std::memory_order_acquire ) == _head.load( std::memory_order_acquire ); }
+      void     close()        { _closed.store( true, std::memory_order_release ); }
+      bool     closed()const  { return _closed.load( std::memory_order_acquire ); }
+      uint64_t dropped()const { return _dropped.load( std::memory_order_relaxed ); }
+
+   private:
+      const size_t                    _capacity;
+      std::unique_ptr<char[]>         _data;
+      std::atomic<uint64_t>           _dropped{0};
+      std::atomic<bool>               _closed{false};
+      // written by the owning thread
+      alignas(64) std::atomic<size_t> _head{0};
+      size_t                          _pending = 0;
+      size_t                          _cached_tail = 0;
+      // written by the background thread
+      alignas(64) std::atomic<size_t> _tail{0};
+   };
+
+   struct backend {
+      std::mutex                                rings_mutex;
+      std::vector<std::shared_ptr<thread_ring>> rings;
+      size_t                                    ring_size = 0;
+      uint64_t                                  closed_dropped = 0;   ///< dropped by rings already removed
+
+      std::mutex                                drain_mutex;          ///< one drain at a time, guards the members below
+      std::vector<std::shared_ptr<thread_ring>> drain_rings;
+      fmt::memory_buffer                        buf;
+
+      std::mutex                                thread_mutex;         ///< guards start and stop
+      std::thread                               thread;
+      std::mutex                                wake_mutex;
+      std::condition_variable                   wake;
+      std::atomic<bool>                         stopping{false};
+      uint64_t                                  reported_dropped = 0; ///< used by the background thread only
+   };
+
+   backend& get_backend() {
+      // leaked like log_config, so threads may log until the very end of execution
+      static backend* the = new backend;
+      return *the;
+   }
+
+   static thread_local thread_ring*     current_ring = nullptr;
+   static thread_local bool             ring_released = false;
+   static thread_local std::string_view current_record_thread_name;
+
+   struct ring_owner {
+      std::shared_ptr<thread_ring> ring;
+      ~ring_owner() {
+         if( ring )
+            ring->close();
+         current_ring  = nullptr;
+         ring_released = true;
+      }
+   };
+
+   thread_ring* this_thread_ring() {
+      if( current_ring )
+         return current_ring;
+      if( ring_released )
+         return nullptr;
+      static thread_local ring_owner owner;
+      auto& b = get_backend();
+      std::lock_guard g( b.rings_mutex );
+      owner.ring = std::make_shared<thread_ring>( b.ring_size );
+      b.rings.push_back( owner.ring );
+      current_ring = owner.ring.get();
+      return current_ring;
+   }
+
+   char* reserve( thread_ring& ring, size_t size, spdlog::logger& logger ) {
+      char* out = ring.reserve( size );
+      if( !out )
+         fc::detail::metered_logger::count_dropped( logger );
+      return out;
+   }
+
+   void  commit( thread_ring& ring )               { ring.commit(); }
+
+   std::string_view thread_name()        { return fc::get_thread_name(); }
+   std::string_view record_thread_name() { return current_record_thread_name; }
+
+   static void write_record( backend& b, const char* p ) {
+      record_header h;
+      memcpy( &h, p, sizeof(h) );
+      fc::detail::reader r{ p + sizeof(h) };
+      current_record_thread_name = r.read_string();
+      try {
+         b.buf.clear();
+         h.format( r.pos, b.buf );
+         const spdlog::string_view_t msg( b.buf.data(), b.buf.size() );
+         if( h.forced )
+            fc::detail::log_forced( *h.logger, h.time, *h.loc, h.level, msg );
+         else
+            h.logger->log( h.time, *h.loc, h.level, msg );
+      } catch( const std::exception& ex ) {
+         std::cerr << "<" << h.loc->filename << ":" << h.loc->line << "  " << ex.what() << ">" << std::endl;
+      } catch( ... ) {
+         std::cerr << "<" << h.loc->filename << ":" << h.loc->line << "  Failed to log this message>" << std::endl;
+      }
+      current_record_thread_name = {};
+   }
+
+   /// requires drain_mutex
+   static size_t drain( backend& b ) {
+      {
+         std::lock_guard g( b.rings_mutex );
+         // a closed ring gets no more records, once it is empty it can go
+         for( auto i = b.rings.begin(); i != b.rings.end(); ) {
+            if( (*i)->closed() && (*i)->empty() ) {
+               b.closed_dropped += (*i)->dropped();
+               i = b.rings.erase( i );
+            } else {
+               ++i;
+            }
+         }
+         b.drain_rings = b.rings;
+      }
+      size_t n = 0;
+      for( auto& ring : b.drain_rings )
+         n += ring->consume( [&]( const char* p ) { write_record( b, p ); } );
+      return n;
+   }
+
+   static void report_dropped( backend& b ) {
+      const uint64_t dropped = dropped_messages();
+      if( dropped == b.reported_dropped )
+         return;
+      try {
+         logger::get( DEFAULT_LOGGER ).get_agent_logger()->log( spdlog::level::warn,
+               "dropped {} log messages, async log queue full", dropped - b.reported_dropped );
+      } catch( ... ) {}
+      b.reported_dropped = dropped;
+   }
+
+   static void run( backend& b ) {
+      set_os_thread_name( "log" );
+      constexpr auto idle_wait = std::chrono::milliseconds( 1 );
+      while( !b.stopping.load( std::memory_order_acquire ) ) {
+         size_t n;
+         {
+            std::lock_guard g( b.drain_mutex );
+            n = drain( b );
+         }
+         report_dropped( b );
+         if( !n ) {
+            std::unique_lock g( b.wake_mutex );
+            b.wake.wait_for( g, idle_wait, [&]() { return b.stopping.load( std::memory_order_acquire ); } );
+         }
+      }
+      {
+         std::lock_guard g( b.drain_mutex );
+         drain( b );
+      }
+      report_dropped( b );
+   }
+
+} // namespace detail
+
+   void start( uint32_t queue_size ) {
+      auto& b = detail::get_backend();
+      std::lock_guard g( b.thread_mutex );
+      {
+         // new size applies to threads that log for the first time from now on
+         std::lock_guard rg( b.rings_mutex );
+         size_t size = 4096;
+         while( size < queue_size )
+            size <<= 1;
+         b.ring_size = size;
+      }
+      if( !b.thread.joinable() ) {
+         static const bool registered = ( std::atexit( []() { stop(); } ), true );
+         (void)registered;
+         b.stopping.store( false, std::memory_order_release );
+         b.thread = std::thread( [&b]() { detail::run( b ); } );
+      }
+      detail::active.store( true, std::memory_order_release );
+   }
+
+   void stop() {
+      auto& b = detail::get_backend();
+      std::lock_guard g( b.thread_mutex );
+      detail::active.store( false, std::memory_order_release );
+      if( b.thread.joinable() ) {
+         {
+            std::lock_guard wg( b.wake_mutex );
+            b.stopping.store( true, std::memory_order_release );
+         }
+         b.wake.notify_all();
+         b.thread.join();
+      }
+   }
+
+   void flush() {
+      auto& b = detail::get_backend();
+      std::lock_guard g( b.drain_mutex );
+      detail::drain( b );
+   }
+
+   uint64_t dropped_messages() {
+      auto& b = detail::get_backend();
+      std::lock_guard g( b.rings_mutex );
+      uint64_t dropped = b.closed_dropped;
+      for( const auto& ring : b.rings )
+         dropped += ring->dropped();
+      return dropped;
+   }
+
+} } // namespace fc::async_logging
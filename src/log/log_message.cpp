@@ -4,6 +4,8 @@
 #include <fc/time.hpp>
 #include <fc/filesystem.hpp>
 #include <fc/io/json.hpp>
+#include <iostream>
+#include <mutex>
 
 namespace fc
 {
@@ -31,8 +33,29 @@ namespace fc
             :context( std::move(ctx) ){}
             log_message_impl(){}
 
+            /// formats the packed values into msg the first time the message is read
+            const string& message() {
+               if( values.format ) {
+                  std::call_once( formatted, [this]() {
+                     try {
+                        fmt::memory_buffer buf;
+                        values.format( values.data.get(), buf );
+                        msg.assign( buf.data(), buf.size() );
+                     } catch( const std::exception& ex ) {
+                        std::cerr << "<" + context.get_file() + ":" + std::to_string( context.get_line_number() ) + "  " + ex.what() + ">" << std::endl;
+                     } catch( ... ) {
+                        std::cerr << "<" + context.get_file() + ":" + std::to_string( context.get_line_number() ) + "  " + "Failed to log this message" + ">" << std::endl;
+                     }
+                     values.data.reset();
+                  } );
+               }
+               return msg;
+            }
+
             log_context     context;
             string          msg;
+            packed_values   values;     ///< until formatted into msg
+            std::once_flag  formatted;
       };
    }
 
@@ -46,7 +69,12 @@ namespace fc
    :my( std::make_shared<detail::log_context_impl>() )
    {
       my->level       = ll;
-      my->file        = fc::path(file).filename().generic_string(); // TODO truncate filename
+      const char* name = file;
+      for( const char* p = file; *p; ++p ) {
+         if( *p == '/' || *p == '\\' )
+            name = p + 1;
+      }
+      my->file        = name;
       my->line        = line;
       my->method      = method;
       my->timestamp   = time_point::now();
@@ -202,6 +230,12 @@ namespace fc
       my->msg = std::move(msg);
    }
 
+   log_message::log_message( log_context ctx, detail::packed_values values )
+   :my( std::make_shared<detail::log_message_impl>(std::move(ctx)) )
+   {
+      my->values = std::move(values);
+   }
+
    log_message::log_message( const variant& v )
    :my( std::make_shared<detail::log_message_impl>( log_context( v.get_object()["context"] ) ) )
    {
@@ -211,21 +245,21 @@ namespace fc
    variant log_message::to_variant()const
    {
       return mutable_variant_object( "context", my->context )
-                             ("msg", my->msg);
+                             ("msg", my->message());
    }
 
    log_context log_message::get_context()const { return my->context; }
 
    string log_message::get_message()const
    {
-      return my->msg;
+      return my->message();
    }
 
    constexpr size_t minimize_max_size = 1024;
 
    string log_message::get_limited_message()const
    {
-      return my->msg.substr(0, minimize_max_size) + "...";
+      return my->message().substr(0, minimize_max_size) + "...";
    }
 
 } // fc
@@ -0,0 +1,86 @@
+#include <fc/log/log_metrics.hpp>
+#include <spdlog/pattern_formatter.h>
+#include <chrono>
+
+namespace fc { namespace detail {
+
+   void metered_logger::count_message( spdlog::logger& l ) {
+      if( auto* m = dynamic_cast<metered_logger*>( &l ) )
+         m->_messages.fetch_add( 1, std::memory_order_relaxed );
+   }
+
+   void metered_logger::count_dropped( spdlog::logger& l ) {
+      if( auto* m = dynamic_cast<metered_logger*>( &l ) )
+         m->_dropped.fetch_add( 1, std::memory_order_relaxed );
+   }
+
+   void metered_logger::sink_it_( const spdlog::details::log_msg& msg ) {
+      _messages.fetch_add( 1, std::memory_order_relaxed );
+      spdlog::logger::sink_it_( msg );
+   }
+
+   metered_sink::metered_sink( std::shared_ptr<spdlog::sinks::sink> inner, std::string type )
+   :_formatter( std::make_unique<spdlog::pattern_formatter>() )
+   ,_inner( std::move( inner ) )
+   ,_type( std::move( type ) )
+   {
+      // the line arrives formatted, with its end of line
+      _inner->set_formatter( std::make_unique<spdlog::pattern_formatter>( "%^%v%$", spdlog::pattern_time_type::local, "" ) );
+   }
+
+   void metered_sink::log( const spdlog::details::log_msg& msg ) {
+      std::lock_guard g( _mutex );
+      const auto start = std::chrono::steady_clock::now();
+      try {
+         _buf.clear();
+         _formatter->format( msg, _buf );
+         spdlog::details::log_msg line( msg );
+         line.payload = spdlog::string_view_t( _buf.data(), _buf.size() );
+         _inner->log( line );
+      } catch( ... ) {
+         _errors.fetch_add( 1, std::memory_order_relaxed );
+         throw;
+      }
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+      record( ns, _buf.size() );
+   }
+
+   void metered_sink::record( uint64_t ns, size_t bytes ) {
+      _messages.fetch_add( 1, std::memory_order_relaxed );
+      _bytes.fetch_add( bytes, std::memory_order_relaxed );
+      _write_ns.fetch_add( ns, std::memory_order_relaxed );
+      size_t bucket = 0;
+      for( uint64_t t = ns >> 8; t && bucket + 1 < _latency.size(); t >>= 1 )
+         ++bucket;
+      _latency[bucket].fetch_add( 1, std::memory_order_relaxed );
+   }
+
+   void metered_sink::flush() {
+      std::lock_guard g( _mutex );
+      _inner->flush();
+   }
+
+   void metered_sink::set_pattern( const std::string& pattern ) {
+      std::lock_guard g( _mutex );
+      _formatter = std::make_unique<spdlog::pattern_formatter>( pattern );
+   }
+
+   void metered_sink::set_formatter( std::unique_ptr<spdlog::formatter> formatter ) {
+      std::lock_guard g( _mutex );
+      _formatter = std::move( formatter );
+   }
+
+   sink_metrics metered_sink::metrics()const {
+      sink_metrics m;
+      m.type     = _type;
+      m.messages = _messages.load( std::memory_order_relaxed );
+      m.bytes    = _bytes.load( std::memory_order_relaxed );
+      m.errors   = _errors.load( std::memory_order_relaxed );
+      m.write_ns = _write_ns.load( std::memory_order_relaxed );
+      m.write_latency.reserve( _latency.size() );
+      for( const auto& b : _latency )
+         m.write_latency.push_back( b.load( std::memory_order_relaxed ) );
+      return m;
+   }
+
+} } // namespace fc::detail
@@ -0,0 +1,157 @@
+#include <fc/log/log_site.hpp>
+#include <fc/log/log_metrics.hpp>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace fc {
+
+   struct log_site_registry {
+      struct entry {
+         log_site*   site;
+         std::string logger;
+      };
+
+      struct rule {
+         std::string     file;
+         uint32_t        line;
+         log_site::mode  site_mode;
+
+         bool matches( const log_site& s )const {
+            const std::string_view f( s.loc.filename );
+            return ( line == 0 || line == uint32_t( s.loc.line ) ) &&
+                   f.size() >= file.size() && f.compare( f.size() - file.size(), file.size(), file ) == 0;
+         }
+      };
+
+      std::mutex                                   mutex;
+      std::vector<entry>                           sites;   ///< in the order they registered
+      std::unordered_map<const log_site*, size_t>  index;   ///< into sites
+      std::vector<rule>                            rules;
+      uint64_t                                     epoch = 0;   ///< bumped by invalidate_all
+
+      static log_site_registry& get() {
+         // leaked like log_config, so call sites may run until the very end of execution
+         static log_site_registry* the = new log_site_registry;
+         return *the;
+      }
+
+      static void set_state( log_site& s, uintptr_t state ) { s._state.store( state, std::memory_order_relaxed ); }
+      static void set_mode( log_site& s, log_site::mode m ) { s._mode.store( uint8_t( m ), std::memory_order_relaxed ); }
+      static log_site::mode get_mode( const log_site& s ) { return log_site::mode( s._mode.load( std::memory_order_relaxed ) ); }
+   };
+
+   bool log_site::resolve( const logger* lgr ) {
+      auto& r = log_site_registry::get();
+      uint64_t epoch;
+      {
+         std::lock_guard g( r.mutex );
+         epoch = r.epoch;
+      }
+      // looked up before taking the registry lock, log_config locks its mutex before calling invalidate_all
+      const logger& l = lgr ? *lgr : logger::default_logger();
+      const bool logger_enabled = l.is_enabled( level );
+
+      std::lock_guard g( r.mutex );
+      uintptr_t s = _state.load( std::memory_order_relaxed ) & state_mask;
+      if( s == state_unregistered ) {
+         for( auto i = r.rules.rbegin(); i != r.rules.rend(); ++i ) {
+            if( i->matches( *this ) ) {
+               r.set_mode( *this, i->site_mode );
+               break;
+            }
+         }
+         r.index.emplace( this, r.sites.size() );
+         r.sites.push_back( { this, l.name() } );
+         s = state_unresolved;
+      } else {
+         auto& e = r.sites[r.index.at( this )];
+         if( e.logger != l.name() )
+            e.logger = l.name();
+      }
+
+      bool enabled;
+      switch( r.get_mode( *this ) ) {
+         case mode::enabled:
+            enabled = true;
+            s = logger_enabled ? state_enabled : state_forced;
+            break;
+         case mode::disabled:
+            enabled = false;
+            s = state_disabled;
+            break;
+         default:
+            enabled = logger_enabled;
+            s = logger_enabled ? state_enabled : state_disabled;
+            break;
+      }
+      // a level changed while the logger was consulted, the next run asks again
+      if( epoch != r.epoch )
+         _state.store( state_unresolved, std::memory_order_relaxed );
+      else
+         _state.store( detail::logger_key( l ) | s, std::memory_order_relaxed );
+      return enabled;
+   }
+
+   std::vector<log_site::info> log_site::registered() {
+      auto& r = log_site_registry::get();
+      std::lock_guard g( r.mutex );
+      std::vector<info> result;
+      result.reserve( r.sites.size() );
+      for( const auto& e : r.sites ) {
+         const log_site& s = *e.site;
+         info i;
+         i.file      = s.loc.filename;
+         i.line      = s.loc.line;
+         i.function  = s.loc.funcname;
+         i.level     = s.level;
+         i.logger    = e.logger;
+         i.site_mode = r.get_mode( s );
+         result.push_back( std::move( i ) );
+      }
+      return result;
+   }
+
+   size_t log_site::set_mode( std::string_view file, uint32_t line, mode m ) {
+      auto& r = log_site_registry::get();
+      std::lock_guard g( r.mutex );
+      log_site_registry::rule rule{ std::string( file ), line, m };
+      r.rules.erase( std::remove_if( r.rules.begin(), r.rules.end(),
+                                     [&]( const auto& o ) { return o.file == rule.file && o.line == rule.line; } ),
+                     r.rules.end() );
+      r.rules.push_back( rule );
+
+      size_t n = 0;
+      for( auto& e : r.sites ) {
+         if( rule.matches( *e.site ) ) {
+            r.set_mode( *e.site, m );
+            r.set_state( *e.site, state_unresolved );
+            ++n;
+         }
+      }
+      return n;
+   }
+
+   void log_site::invalidate_all() {
+      auto& r = log_site_registry::get();
+      std::lock_guard g( r.mutex );
+      ++r.epoch;
+      for( auto& e : r.sites )
+         r.set_state( *e.site, state_unresolved );
+   }
+
+   namespace detail {
+      void log_forced( spdlog::logger& l, spdlog::log_clock::time_point time, const spdlog::source_loc& loc,
+                       spdlog::level::level_enum level, spdlog::string_view_t msg ) {
+         const spdlog::details::log_msg m( time, loc, l.name(), level, msg );
+         metered_logger::count_message( l );
+         for( auto& s : l.sinks() ) {
+            if( s->should_log( level ) )
+               s->log( m );
+         }
+         if( level >= l.flush_level() )
+            l.flush();
+      }
+   } // namespace detail
+
+} // namespace fc
@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <string>
 #include <fc/log/logger_config.hpp>
+#include <fc/log/log_metrics.hpp>
 #include <spdlog/pattern_formatter.h>
 
 namespace fc {
@@ -14,8 +15,11 @@ namespace fc {
       public:
          void format(const spdlog::details::log_msg &, const std::tm &, spdlog::memory_buf_t &dest) override
          {
-            std::string some_txt = fc::get_thread_name();
-            dest.append(some_txt.data(), some_txt.data() + some_txt.size());
+            // records written by the async logging thread carry the name of the thread that logged them
+            std::string_view name = async_logging::detail::record_thread_name();
+            if( name.empty() )
+               name = fc::get_thread_name();
+            dest.append(name.data(), name.data() + name.size());
          }
 
          std::unique_ptr<custom_flag_formatter> clone() const override
@@ -29,13 +33,14 @@ namespace fc {
          impl( std::unique_ptr<spdlog::logger> agent_logger = nullptr)
          :_level(log_level::warn)
          {
+            static_assert( alignof( impl ) >= 8, "log_site keeps its state in the low three bits of the address" );
             if (!agent_logger) {
                auto sink = std::make_shared<spdlog::sinks::stderr_color_sink_st>();
                sink->set_color(spdlog::level::debug, sink->green);
                sink->set_color(spdlog::level::info, sink->reset);
                sink->set_color(spdlog::level::warn, sink->yellow);
                sink->set_color(spdlog::level::err, sink->red);
-               _agent_logger = std::make_unique<spdlog::logger>( "", sink );
+               _agent_logger = std::make_unique<detail::metered_logger>( "", sink );
             }
             else {
                _agent_logger = std::move(agent_logger);
@@ -49,6 +54,9 @@ namespace fc {
             _agent_logger->set_level(spdlog::level::warn);
          }
 
+         // an impl at the address of this one must not take the answers call sites cached for this one
+         ~impl() { log_site::invalidate_all(); }
+
          fc::string       _name;
          log_level        _level;
          std::unique_ptr<spdlog::logger> _agent_logger;
@@ -76,12 +84,15 @@ namespace fc {
 
    logger::~logger(){}
 
+   // a logger variable that now refers to another logger may be the one of a log_site
    logger& logger::operator=( const logger& l ){
       my = l.my;
+      log_site::invalidate_all();
       return *this;
    }
    logger& logger::operator=( logger&& l ){
       fc_swap(my,l.my);
+      log_site::invalidate_all();
       return *this;
    }
    bool operator==( const logger& l, std::nullptr_t ) { return !l.my; }
@@ -103,6 +114,10 @@ namespace fc {
       return log_config::get_logger( s );
    }
 
+   const logger& logger::default_logger() {
+      return log_config::get_default_logger();
+   }
+
    void logger::update( const fc::string& name, logger& log ) {
       log_config::update_logger( name, log );
    }
@@ -130,17 +145,21 @@ namespace fc {
             my->_agent_logger->set_level(spdlog::level::off);
             break;
       }
+      log_site::invalidate_all();
       return *this;
    }
 
    std::unique_ptr<spdlog::logger>& logger::get_agent_logger()const { return my->_agent_logger;};
 
    void logger::update_agent_logger(std::unique_ptr<spdlog::logger>&& al) {
+      // queued async records point to the agent logger being replaced, it goes once they are written
+      std::unique_ptr<spdlog::logger> retired = std::move(my->_agent_logger);
       my->_agent_logger = std::move(al);
       auto formatter = std::make_unique<spdlog::pattern_formatter>(spdlog::pattern_time_type::utc);
       formatter->add_flag<thread_name_formatter_flag>('k').set_pattern(DEFAULT_PATTERN);
       my->_agent_logger->set_formatter(std::move(formatter));
       set_log_level(my->_level);
+      async_logging::flush();
    };
 
    void logger::add_sink(const std::shared_ptr<spdlog::sinks::sink>& s) {
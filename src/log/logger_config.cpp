@@ -1,7 +1,10 @@
 #include <fc/log/logger_config.hpp>
+#include <fc/log/log_metrics.hpp>
 #include <fc/io/json.hpp>
 #include <fc/filesystem.hpp>
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <fc/reflect/variant.hpp>
 #include <fc/exception/exception.hpp>
@@ -19,6 +22,29 @@ namespace fc {
       return log_config::get().logger_map[name];
    }
 
+   static thread_local bool default_logger_cache_destroyed = false;
+
+   const logger& log_config::get_default_logger() {
+      struct cache {
+         logger   lgr{ nullptr };
+         uint32_t generation = 0;
+         ~cache() { default_logger_cache_destroyed = true; }
+      };
+      static thread_local cache c;
+      auto& lc = log_config::get();
+      if( default_logger_cache_destroyed ) {
+         // logging from a thread_local destructor after the cache is gone
+         std::lock_guard g( lc.log_mutex );
+         return lc.logger_map[DEFAULT_LOGGER];
+      }
+      const uint32_t generation = lc.generation.load( std::memory_order_acquire );
+      if( c.generation != generation ) {
+         c.lgr = get_logger( DEFAULT_LOGGER );
+         c.generation = generation;
+      }
+      return c.lgr;
+   }
+
    void log_config::update_logger( const fc::string& name, logger& log ) {
       std::lock_guard g( log_config::get().log_mutex );
       if( log_config::get().logger_map.find( name ) != log_config::get().logger_map.end() ) {
@@ -41,7 +67,10 @@ namespace fc {
 
    bool log_config::configure_logging( const logging_config& cfg ) {
       try {
-         std::lock_guard g( log_config::get().log_mutex );
+         // queued async records point to the loggers about to be replaced
+         async_logging::flush();
+         std::unique_lock g( log_config::get().log_mutex );
+         log_config::get().retired_logger_map = std::move( log_config::get().logger_map );
          log_config::get().logger_map.clear();
          log_config::get().sink_map.clear();
 
@@ -60,17 +89,18 @@ namespace fc {
                   else
                      sink->set_color(spdlog::level::from_str(it.level), sink->reset);
                }
-               log_config::get().sink_map[cfg.sinks[i].name] = sink;
+               log_config::get().sink_map[cfg.sinks[i].name] = std::make_shared<detail::metered_sink>(sink, cfg.sinks[i].type);
             } else if (cfg.sinks[i].type == "daily_file_sink_mt") {
                auto config = cfg.sinks[i].args.as<sink::daily_file_sink_mt_config>();
-               auto sink = std::make_shared<spdlog::sinks::daily_file_sink_mt>(
+               // the metered sink serializes the writes, so the file sink itself does not lock
+               auto sink = std::make_shared<spdlog::sinks::daily_file_sink_st>(
                        config.base_filename, config.rotation_hour, config.rotation_minute, config.truncate, config.max_files);
-               log_config::get().sink_map[cfg.sinks[i].name] = sink;
+               log_config::get().sink_map[cfg.sinks[i].name] = std::make_shared<detail::metered_sink>(sink, cfg.sinks[i].type);
             } else if (cfg.sinks[i].type == "rotating_file_sink_mt") {
                auto config = cfg.sinks[i].args.as<sink::rotating_file_sink_mt_config>();
-               auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+               auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(
                        config.base_filename, config.max_size*1024*1024, config.max_files);
-               log_config::get().sink_map[cfg.sinks[i].name] = sink;
+               log_config::get().sink_map[cfg.sinks[i].name] = std::make_shared<detail::metered_sink>(sink, cfg.sinks[i].type);
             }
          }
 
@@ -86,8 +116,17 @@ namespace fc {
                }
             }
             if (cfg.loggers[i].sinks.size() > 0)
-               lgr.update_agent_logger(std::make_unique<spdlog::logger>("", lgr.get_sinks().begin(), lgr.get_sinks().end()));
+               lgr.update_agent_logger(std::make_unique<detail::metered_logger>("", lgr.get_sinks().begin(), lgr.get_sinks().end()));
          }
+         log_config::get().generation.fetch_add( 1, std::memory_order_release );
+         g.unlock();
+         // the default logger changed, and with it the answer of the call sites of dlog, ilog, ...
+         log_site::invalidate_all();
+
+         if( cfg.async )
+            async_logging::start( cfg.async_queue_size );
+         else
+            async_logging::stop();
          return true;
       } catch ( exception& e ) {
          std::cerr<<e.to_detail_string()<<"\n";
@@ -95,6 +134,35 @@ namespace fc {
       return false;
    }
 
+   logging_metrics log_config::get_metrics() {
+      logging_metrics m;
+      m.async_dropped = async_logging::dropped_messages();
+      auto& lc = log_config::get();
+      std::lock_guard g( lc.log_mutex );
+      // a logger is in the map under every name it was looked up with, see update_logger
+      std::unordered_set<const spdlog::logger*> seen;
+      for( const auto& [name, lgr] : lc.logger_map ) {
+         if( lgr == nullptr || !seen.insert( lgr.get_agent_logger().get() ).second )
+            continue;
+         logger_metrics l;
+         l.name = lgr.name().empty() ? name : lgr.name();
+         if( auto* ml = dynamic_cast<const detail::metered_logger*>( lgr.get_agent_logger().get() ) ) {
+            l.messages = ml->messages();
+            l.dropped  = ml->dropped();
+         }
+         m.loggers.push_back( std::move( l ) );
+      }
+      for( const auto& [name, s] : lc.sink_map ) {
+         if( auto* ms = dynamic_cast<const detail::metered_sink*>( s.get() ) ) {
+            m.sinks.push_back( ms->metrics() );
+            m.sinks.back().name = name;
+         }
+      }
+      std::sort( m.loggers.begin(), m.loggers.end(), []( const auto& a, const auto& b ) { return a.name < b.name; } );
+      std::sort( m.sinks.begin(), m.sinks.end(), []( const auto& a, const auto& b ) { return a.name < b.name; } );
+      return m;
+   }
+
    logging_config logging_config::default_config() {
       //slog( "default cfg" );
       logging_config cfg;
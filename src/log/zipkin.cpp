@@ -1,9 +1,10 @@
 #include <fc/log/zipkin.hpp>
+#include <fc/container/mpsc_ring_buffer.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/log/logger_config.hpp>
 #include <fc/log/custom_formatter.hpp>
 #include <fc/network/http/http_client.hpp>
-#include <fc/reflect/variant.hpp>
+#include <fc/io/json_codec.hpp>
 #include <fc/crypto/hex.hpp>
 #include <fc/crypto/sha256.hpp>
 #include <fc/variant.hpp>
@@ -67,8 +68,9 @@ zipkin_config& zipkin_config::get() {
    return the_one;
 }
 
-void zipkin_config::init( const std::string& url, const std::string& service_name, uint32_t timeout_us, uint32_t retry_interval_us, uint32_t wait_time_seconds ) {
-   get().zip = std::make_unique<zipkin>( url, service_name, timeout_us, retry_interval_us, wait_time_seconds );
+void zipkin_config::init( const std::string& url, const std::string& service_name, uint32_t timeout_us, uint32_t retry_interval_us, uint32_t wait_time_seconds,
+                          const zipkin_export_config& export_config ) {
+   get().zip = std::make_unique<zipkin>( url, service_name, timeout_us, retry_interval_us, wait_time_seconds, export_config );
 }
 
 zipkin& zipkin_config::get_zipkin() {
@@ -104,14 +106,22 @@ public:
    const std::string service_name;
    const uint32_t timeout_us;
    const uint32_t retry_interval_us;
+   const zipkin_export_config config;
    std::mutex mtx;
    uint64_t next_id = 0;
    http_client http;
    bool connected = false;
    // thread safe
-   std::atomic<bool> timer_expired = true;
+   mpsc_ring_buffer<zipkin_span::span_data> queue;
+   std::atomic<uint64_t> dropped_spans = 0;
+   std::atomic<bool> flush_posted = false;
    std::atomic<uint32_t> consecutive_errors = 0;
    std::atomic<unsigned char> stopped = 0;
+   // zipkin thread only
+   std::string batch;       // json array of the spans being exported, without the closing bracket
+   uint32_t batch_spans = 0;
+   std::optional<zipkin_span_encoder> encoder;
+   fc::time_point retry_time;
    std::optional<url> endpoint;
    std::thread thread;
    boost::asio::io_context ctx;
@@ -121,17 +131,22 @@ public:
    std::optional<boost::asio::ip::tcp::endpoint>  local_endpoint;
 
 
-   impl( std::string url, std::string service_name, uint32_t timeout_us, uint32_t retry_interval_us )
+   impl( std::string url, std::string service_name, uint32_t timeout_us, uint32_t retry_interval_us, const zipkin_export_config& config )
          : zipkin_url( std::move(url) )
          , service_name( std::move(service_name) )
          , timeout_us( timeout_us )
-         , retry_interval_us( retry_interval_us ) {
+         , retry_interval_us( retry_interval_us )
+         , config( config )
+         , queue( std::max<uint32_t>( config.queue_capacity, 1 ) ) {
    }
 
    void init(uint32_t wait_time_seconds);
    void shutdown();
 
-   void log( zipkin_span::span_data&& span );
+   void schedule_flush();
+   void flush();
+   bool fill_batch();
+   bool post_batch();
 
    ~impl();
 };
@@ -154,6 +169,15 @@ void zipkin::impl::init(uint32_t wait_time_seconds) {
       }
    }
 
+   if( local_endpoint ) {
+      const auto& address = local_endpoint->address();
+      encoder.emplace( service_name, address.to_string(), address.is_v4() );
+   } else {
+      encoder.emplace( service_name, std::string(), true );
+   }
+
+   boost::asio::post( work_strand, [this]() { schedule_flush(); } );
+
    thread = std::thread( [this]() {
       fc::set_os_thread_name( "zipkin" );
       while( true ) {
@@ -173,14 +197,20 @@ zipkin::impl::~impl() {
 
 void zipkin::impl::shutdown() {
    if( stopped.exchange(1) ) return;
-   boost::system::error_code ec;
-   timer.cancel(ec);
+   boost::asio::post( work_strand, [this]() {
+      boost::system::error_code ec;
+      timer.cancel(ec);
+      // one last attempt for whatever is queued, unless zipkin is already failing
+      if( consecutive_errors == 0 )
+         flush();
+   } );
    work_guard.reset(); // drain the queue
    thread.join();
 }
 
-zipkin::zipkin( const std::string& url, const std::string& service_name, uint32_t timeout_us, uint32_t retry_interval_us, uint32_t wait_time_seconds  ) :
-      my( new impl( url, service_name, timeout_us, retry_interval_us ) ) {
+zipkin::zipkin( const std::string& url, const std::string& service_name, uint32_t timeout_us, uint32_t retry_interval_us, uint32_t wait_time_seconds,
+                const zipkin_export_config& export_config ) :
+      my( new impl( url, service_name, timeout_us, retry_interval_us, export_config ) ) {
    my->init(wait_time_seconds);
 }
 
@@ -198,7 +228,49 @@ void zipkin::shutdown() {
    my->shutdown();
 }
 
-fc::variant create_zipkin_variant( zipkin_span::span_data&& span, const std::string& service_name, std::optional<boost::asio::ip::tcp::endpoint>& local_endpoint ) {
+uint64_t zipkin::dropped_spans() const {
+   return my->dropped_spans;
+}
+
+namespace {
+   /// two lowercase hex digits for every byte value
+   struct hex_table {
+      char digits[256][2];
+      constexpr hex_table() : digits() {
+         constexpr const char* hex = "0123456789abcdef";
+         for( int i = 0; i < 256; ++i ) {
+            digits[i][0] = hex[i >> 4];
+            digits[i][1] = hex[i & 0x0f];
+         }
+      }
+   };
+   constexpr hex_table hex_digits;
+
+   /// same as fc::to_hex of the bytes of id, which is how ids have always been sent
+   void append_hex_id( std::string& out, uint64_t id ) {
+      const auto* bytes = reinterpret_cast<const unsigned char*>( &id );
+      char buf[2 * sizeof( id )];
+      for( size_t i = 0; i < sizeof( id ); ++i ) {
+         buf[2 * i]     = hex_digits.digits[bytes[i]][0];
+         buf[2 * i + 1] = hex_digits.digits[bytes[i]][1];
+      }
+      out += '"';
+      out.append( buf, sizeof( buf ) );
+      out += '"';
+   }
+}
+
+zipkin_span_encoder::zipkin_span_encoder( const std::string& service_name, const std::string& local_address, bool is_v4 ) {
+   local_endpoint = ",\"localEndpoint\":{\"serviceName\":";
+   json_codec::append_string( local_endpoint, service_name );
+   if( !local_address.empty() ) {
+      local_endpoint += is_v4 ? ",\"ipv4\":" : ",\"ipv6\":";
+      json_codec::append_string( local_endpoint, local_address );
+   }
+   local_endpoint += '}';
+}
+
+void zipkin_span_encoder::append( std::string& out, const zipkin_span::span_data& span ) const {
    // https://zipkin.io/zipkin-api/
    //   std::string traceId;  // [a-f0-9]{16,32} unique id for trace, all children spans shared same id
    //   std::string name;     // logical operation, should have low cardinality
@@ -206,79 +278,100 @@ fc::variant create_zipkin_variant( zipkin_span::span_data&& span, const std::str
    //   std::string id        // a-f0-9]{16}
    //   int64_t     timestamp // epoch microseconds of start of span
    //   int64_t     duration  // microseconds of span
+   constexpr auto format = fc::json::output_formatting::legacy_generator;
 
-   fc::mutable_variant_object mvo;
-   mvo( "id", fc::to_hex( reinterpret_cast<const char*>(&span.id), sizeof( span.id ) ) );
-   mvo( "traceId", fc::to_hex( reinterpret_cast<const char*>(&span.trace_id), sizeof( span.trace_id ) ) );
+   out += "{\"id\":";
+   append_hex_id( out, span.id );
+   out += ",\"traceId\":";
+   append_hex_id( out, span.trace_id );
    if( span.parent_id != 0 ) {
-      mvo( "parentId", fc::to_hex( reinterpret_cast<const char*>(&span.parent_id), sizeof( span.parent_id ) ) );
+      out += ",\"parentId\":";
+      append_hex_id( out, span.parent_id );
    }
-   mvo( "name", std::move( span.name ) );
-   mvo( "timestamp", span.start.time_since_epoch().count() );
-   mvo( "duration", (span.stop - span.start).count() );
-
-   mutable_variant_object local_endpoint_mvo("serviceName", service_name);
-   if (local_endpoint) {
-      const auto &address = local_endpoint->address();
-      local_endpoint_mvo( address.is_v4() ? "ipv4": "ipv6", address.to_string());
+   out += ",\"name\":";
+   json_codec::append_string( out, span.name );
+   out += ",\"timestamp\":";
+   json_codec::append_int64( out, span.start.time_since_epoch().count(), format );
+   out += ",\"duration\":";
+   json_codec::append_int64( out, (span.stop - span.start).count(), format );
+   out += local_endpoint;
+   out += ",\"tags\":{";
+   for( size_t i = 0; i < span.tags.size(); ++i ) {
+      if( i > 0 )
+         out += ',';
+      json_codec::append_string( out, span.tags[i].first );
+      out += ':';
+      json_codec::append_string( out, span.tags[i].second );
    }
-   mvo( "localEndpoint", local_endpoint_mvo );
-
-   mvo( "tags", std::move( span.tags ) );
-   span.id = 0; // stop destructor of span from calling log again
-
-   // /api/v2/spans takes an array of spans
-   fc::variants result;
-   result.emplace_back( std::move( mvo ) );
-
-   return result;
+   out += "}}";
 }
 
 void zipkin::post_request(zipkin_span::span_data&& span) {
-   boost::asio::post(my->work_strand, [my=my.get(), span{std::move(span)}]() mutable {
-         my->log( std::move( span ) );
-   });
+   log( std::move( span ) );
+   if( !my->flush_posted.exchange( true ) ) {
+      boost::asio::post( my->work_strand, [my=my.get()]() { my->flush(); } );
+   }
 }
 
 void zipkin::log( zipkin_span::span_data&& span ) {
    if( my->stopped ) {
       return;
-   }else if( sighup_requested.load()) {
-      sighup_requested = false;
-      my->consecutive_errors = 0;
-      ilog("Retry connecting to zipkin: {u} ...", ("u", my->zipkin_url) );
-   }else if( my->consecutive_errors > my->max_consecutive_errors ) {
+   }
+   if( !my->queue.try_push( std::move( span ) ) ) {
+      ++my->dropped_spans;
       return;
    }
-
-   if( my->consecutive_errors > 0 ) {
-      if( my->timer_expired ) {
-         my->timer_expired = false;
-         my->timer.expires_from_now(boost::posix_time::microsec(my->retry_interval_us));
-         my->timer.async_wait([this](const boost::system::error_code& ec) {
-            sighup_requested = true;
-            if(!ec)
-               my->timer_expired = true;
-         });
-      }
-   }else {
-      post_request(std::move(span));
+   // wake the zipkin thread early once a full batch is waiting
+   if( my->queue.size_approx() >= my->config.max_batch_spans && !my->flush_posted.exchange( true ) ) {
+      boost::asio::post( my->work_strand, [my=my.get()]() { my->flush(); } );
    }
 }
 
-void zipkin::impl::log( zipkin_span::span_data&& span ) {
-   auto errors = consecutive_errors.load();
-   if ((errors > max_consecutive_errors) || (stopped && errors > 1)) {
-      if( errors < max_consecutive_errors + 5) { // reduce log spam
-         wlog("errors={consecutive_errors} > limit({max_consecutive_errors}) dropping: {span}",
-              ("consecutive_errors", errors)("max_consecutive_errors", max_consecutive_errors)
-              ("span",  fc::json::to_string(create_zipkin_variant(std::move(span), service_name, local_endpoint), fc::time_point::now() + fc::exception::format_time_limit)));
-      }
-      ++consecutive_errors;
+void zipkin::impl::schedule_flush() {
+   timer.expires_from_now( boost::posix_time::microsec( config.flush_interval_us ) );
+   timer.async_wait( boost::asio::bind_executor( work_strand, [this]( const boost::system::error_code& ec ) {
+      if( ec || stopped )
+         return;
+      flush();
+      schedule_flush();
+   } ) );
+}
+
+/// posts every queued span, a batch at a time, stops at the first batch that fails to post
+void zipkin::impl::flush() {
+   flush_posted = false;
+   if( sighup_requested.load() ) {
+      sighup_requested = false;
+      consecutive_errors = 0;
+      retry_time = fc::time_point();
+      ilog("Retry connecting to zipkin: {u} ...", ("u", zipkin_url) );
+   }
+   if( batch_spans > 0 && fc::time_point::now() < retry_time ) {
       return;
    }
+   while( batch_spans > 0 || fill_batch() ) {
+      if( !post_batch() )
+         return;
+   }
+}
 
-   fc::variant zip_span;
+/// moves queued spans into batch up to the configured span and byte limits
+bool zipkin::impl::fill_batch() {
+   while( batch_spans < config.max_batch_spans && batch.size() < config.max_batch_bytes ) {
+      std::optional<zipkin_span::span_data> span = queue.try_pop();
+      if( !span )
+         break;
+      // /api/v2/spans takes an array of spans
+      batch += batch_spans == 0 ? '[' : ',';
+      encoder->append( batch, *span );
+      ++batch_spans;
+   }
+   return batch_spans > 0;
+}
+
+/// @return true if batch was posted, otherwise batch is kept and retried after retry_interval_us
+bool zipkin::impl::post_batch() {
+   std::string error;
    try {
       auto deadline = fc::time_point::now() + fc::microseconds( timeout_us );
       if( !endpoint ) {
@@ -286,27 +379,32 @@ void zipkin::impl::log( zipkin_span::span_data&& span ) {
          dlog( "connecting to zipkin: {p}", ("p", string(*endpoint)) );
       }
 
-      zip_span = create_zipkin_variant(std::move(span), service_name, local_endpoint);
-      http.post_sync(*endpoint, zip_span, deadline, fc::json::output_formatting::legacy_generator);
+      http.post_sync_json( *endpoint, batch + ']', deadline );
 
+      batch.clear();
+      batch_spans = 0;
       consecutive_errors = 0;
       if (!connected){
           connected = true;
           ilog("Connected to zipkin: {u}", ("u", zipkin_url));
       }
-      return;
+      return true;
    } catch( const fc::exception& e ) {
-      wlog( "unable to connect to zipkin: {u}, error: {e}, dropping: {s}",
-            ("u", zipkin_url)("e", e.to_detail_string())("s", fc::json::to_string(zip_span, fc::time_point::now() + fc::exception::format_time_limit)) );
+      error = e.to_detail_string();
    } catch( const std::exception& e ) {
-      wlog( "unable to connect to zipkin: {u}, error: {e}, dropping: {s}",
-            ("u", zipkin_url)("e", e.what())("s", fc::json::to_string(zip_span, fc::time_point::now() + fc::exception::format_time_limit)) );
+      error = e.what();
    } catch( ... ) {
-      wlog( "unable to connect to zipkin: {u}, error: unknown, dropping: {s}",
-            ("u", zipkin_url)("s", fc::json::to_string(zip_span, fc::time_point::now() + fc::exception::format_time_limit)) );
+      error = "unknown";
+   }
+   auto errors = ++consecutive_errors;
+   if( errors <= max_consecutive_errors ) { // reduce log spam
+      wlog( "unable to connect to zipkin: {u}, error: {e}, retrying {n} spans in {r} us, queued: {q}, dropped: {d}",
+            ("u", zipkin_url)("e", error)("n", batch_spans)("r", retry_interval_us)
+            ("q", queue.size_approx())("d", dropped_spans.load()) );
    }
-   ++consecutive_errors;
    connected = false;
+   retry_time = fc::time_point::now() + fc::microseconds( retry_interval_us );
+   return false;
 }
 
 uint64_t zipkin_span::to_id( const fc::sha256& id ) {
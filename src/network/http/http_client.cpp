@@ -1,5 +1,7 @@
 #include <fc/network/http/http_client.hpp>
+#include <fc/compress/zlib.hpp>
 #include <fc/io/json.hpp>
+#include <fc/log/logger_config.hpp>
 #include <fc/scoped_exit.hpp>
 #include <fc/static_variant.hpp>
 
@@ -14,6 +16,11 @@
 #include <boost/asio/ssl/rfc2818_verification.hpp>
 #include <boost/filesystem.hpp>
 
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
 namespace http = boost::beast::http;    // from <boost/beast/http.hpp>
 namespace ssl = boost::asio::ssl;       // from <boost/asio/ssl.hpp>
@@ -31,9 +38,744 @@ static const std::map<string,uint16_t> default_proto_ports = {
    {"https", 443}
 };
 
+using http_host_key = std::tuple<std::string, std::string, uint16_t>;
+
+static http_host_key url_to_host_key( const url& dest ) {
+   FC_ASSERT(dest.host(), "Provided URL has no host");
+   uint16_t port = 80;
+   if (dest.port()) {
+      port = *dest.port();
+   }
+
+   return std::make_tuple(dest.proto(), *dest.host(), port);
+}
+
+static http::request<http::string_body> make_request( const url& dest, std::string json_body, bool accept_compressed ) {
+   FC_ASSERT(dest.host(), "No host set on URL");
+
+   string path = dest.path() ? dest.path()->generic_string() : "/";
+   if (dest.query()) {
+      path = path + "?" + *dest.query();
+   }
+
+   string host_str = *dest.host();
+   if (dest.port()) {
+      auto port = *dest.port();
+      auto proto_iter = default_proto_ports.find(dest.proto());
+      if (proto_iter != default_proto_ports.end() && proto_iter->second != port) {
+         host_str = host_str + ":" + std::to_string(port);
+      }
+   }
+
+   http::request<http::string_body> req{http::verb::post, path, 11};
+   req.set(http::field::host, host_str);
+   req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+   req.set(http::field::content_type, "application/json");
+   if (accept_compressed) {
+      req.set(http::field::accept_encoding, "gzip, deflate");
+   }
+   req.keep_alive(true);
+   req.body() = std::move(json_body);
+   req.prepare_payload();
+   return req;
+}
+
+/// the decoder for a Content-Encoding, none when the body is not encoded
+static std::optional<zlib_inflater::format> body_encoding( boost::beast::string_view encoding ) {
+   if (encoding.empty() || boost::beast::iequals(encoding, "identity")) {
+      return {};
+   } else if (boost::beast::iequals(encoding, "gzip") || boost::beast::iequals(encoding, "x-gzip")) {
+      return zlib_inflater::format::gzip;
+   } else if (boost::beast::iequals(encoding, "deflate")) {
+      return zlib_inflater::format::zlib;
+   }
+   FC_THROW("Unsupported response encoding {encoding}", ("encoding", std::string(encoding.data(), encoding.size())));
+}
+
+/// decodes the body of res in place when it is compressed
+static void decode_body( http::response<http::string_body>& res, uint64_t max_body_size ) {
+   // the parser body_limit is not applied by async_read to bodies with a Content-Length
+   FC_ASSERT(res.body().size() <= max_body_size, "Response body exceeds {max} bytes", ("max", max_body_size));
+   auto encoding = body_encoding(res[http::field::content_encoding]);
+   if (!encoding) {
+      return;
+   }
+   zlib_inflater inflater(*encoding);
+   std::string decoded;
+   const std::string_view body = res.body();
+   for (size_t pos = 0; pos < body.size(); pos += 64 * 1024) {
+      inflater.write(body.substr(pos, 64 * 1024), decoded);
+      FC_ASSERT(decoded.size() <= max_body_size, "Decoded response body exceeds {max} bytes", ("max", max_body_size));
+   }
+   FC_ASSERT(inflater.done(), "Truncated compressed response body");
+   res.body() = std::move(decoded);
+   res.erase(http::field::content_encoding);
+}
+
+/// the JSON body of res, throws for the statuses the server reports errors with
+static variant parse_response( const url& dest, http::response<http::string_body>& res, uint64_t max_body_size ) {
+   decode_body(res, max_body_size);
+
+   fc::variant result;
+   if( !res.body().empty() ) {
+      try {
+         result = json::from_string( res.body() );
+      } catch( ... ) {}
+   }
+   if (res.result() == http::status::internal_server_error) {
+      fc::exception_ptr excp;
+      try {
+         auto err_var = result.get_object()["error"].get_object();
+         excp = std::make_shared<fc::exception>(err_var["code"].as_int64(), err_var["name"].as_string(), err_var["what"].as_string());
+
+         if (err_var.contains("details")) {
+            for (const auto& dvar : err_var["details"].get_array()) {
+               excp->append_log(FC_LOG_MESSAGE(error, dvar.get_object()["message"].as_string()));
+            }
+         }
+      } catch( ... ) {
+
+      }
+
+      if (excp) {
+         throw *excp;
+      } else {
+         FC_THROW("Request failed with 500 response, but response was not parseable");
+      }
+   } else if (res.result() == http::status::not_found) {
+      FC_THROW("URL not found: {url}", ("url", (std::string)dest));
+   } else if (res.result() == http::status::bad_request) {
+      FC_THROW("Received request: {msg}", ("msg", res.body()));
+   }
+
+   return result;
+}
+
+/**
+ *  TLS sessions of the hosts connected to, so the next connection to a host resumes a session instead
+ *  of running a full handshake. OpenSSL hands the sessions over through the new session callback of
+ *  the context, which also sees the TLS 1.3 tickets a server sends after the handshake. A TLS 1.3
+ *  ticket is used once, as RFC 8446 recommends, while a TLS 1.2 session is reused until it expires.
+ *
+ *  Shared by post_sync and the pool, so it locks. It must outlive every stream of its context.
+ */
+class tls_session_cache {
+public:
+   using error_code = boost::system::error_code;
+
+   explicit tls_session_cache( ssl::context& sslc ) {
+      SSL_CTX* ctx = sslc.native_handle();
+      SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+      SSL_CTX_sess_set_new_cb(ctx, &tls_session_cache::on_new_session);
+   }
+
+   ~tls_session_cache() {
+      for (auto& [key, sessions] : _sessions) {
+         for (SSL_SESSION* s : sessions)
+            SSL_SESSION_free(s);
+      }
+   }
+
+   tls_session_cache( const tls_session_cache& ) = delete;
+   tls_session_cache& operator=( const tls_session_cache& ) = delete;
+
+   /// ties ssl to key, so its sessions are cached for key, and hands it a session of key to resume
+   void prepare( SSL* ssl, const http_host_key& key ) {
+      SSL_set_ex_data(ssl, slot_index(), new slot{ this, key });
+
+      std::lock_guard g(_mutex);
+      auto i = _sessions.find(key);
+      if (i == _sessions.end())
+         return;
+      auto& sessions = i->second;
+      const time_t now = time(nullptr);
+      while (!sessions.empty()) {
+         SSL_SESSION* s = sessions.back();
+         if (!SSL_SESSION_is_resumable(s) || SSL_SESSION_get_time(s) + SSL_SESSION_get_timeout(s) <= now) {
+            sessions.pop_back();
+            SSL_SESSION_free(s);
+            continue;
+         }
+         if (SSL_SESSION_get_protocol_version(s) == TLS1_3_VERSION) {
+            sessions.pop_back();
+         } else if (!(s = SSL_SESSION_dup(s))) {
+            break;
+         }
+         // ssl gets a session of its own, see on_new_session()
+         SSL_set_session(ssl, s);
+         SSL_SESSION_free(s);
+         break;
+      }
+   }
+
+   /// records the handshake of ssl that took elapsed, a failed one forgets the sessions of its host
+   void handshake_done( SSL* ssl, const error_code& ec, const microseconds& elapsed ) {
+      std::lock_guard g(_mutex);
+      if (ec) {
+         ++_metrics.failed_handshakes;
+         if (auto* s = static_cast<slot*>(SSL_get_ex_data(ssl, slot_index())))
+            forget(s->key);
+         return;
+      }
+      if (SSL_session_reused(ssl)) {
+         ++_metrics.resumed_handshakes;
+         _metrics.resumed_handshake_time += elapsed;
+      } else {
+         ++_metrics.full_handshakes;
+         _metrics.full_handshake_time += elapsed;
+      }
+      _metrics.max_handshake_time = std::max(_metrics.max_handshake_time, elapsed);
+   }
+
+   http_client::tls_metrics metrics() const {
+      std::lock_guard g(_mutex);
+      return _metrics;
+   }
+
+private:
+   /// sessions kept per host, a server usually sends two TLS 1.3 tickets per handshake
+   static constexpr size_t max_sessions_per_host = 8;
+
+   /// ex data of an SSL object, freed with it
+   struct slot {
+      tls_session_cache* cache;
+      http_host_key      key;
+   };
+
+   static int slot_index() {
+      static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr,
+         []( void*, void* ptr, CRYPTO_EX_DATA*, int, long, void* ) { delete static_cast<slot*>(ptr); });
+      return index;
+   }
+
+   /**
+    *  Keeps a copy of session, as OpenSSL marks the session of a connection not resumable when the
+    *  connection is freed without a TLS shutdown, which is how the connections of the client end.
+    */
+   static int on_new_session( SSL* ssl, SSL_SESSION* session ) {
+      auto* s = static_cast<slot*>(SSL_get_ex_data(ssl, slot_index()));
+      if (!s)
+         return 0;
+      session = SSL_SESSION_dup(session);
+      if (!session)
+         return 0;
+      std::lock_guard g(s->cache->_mutex);
+      auto& sessions = s->cache->_sessions[s->key];
+      if (sessions.size() == max_sessions_per_host) {
+         SSL_SESSION_free(sessions.front());
+         sessions.pop_front();
+      }
+      sessions.push_back(session);
+      return 0;
+   }
+
+   void forget( const http_host_key& key ) {
+      auto i = _sessions.find(key);
+      if (i == _sessions.end())
+         return;
+      for (SSL_SESSION* s : i->second)
+         SSL_SESSION_free(s);
+      _sessions.erase(i);
+   }
+
+   mutable std::mutex                                       _mutex;
+   std::map<http_host_key, std::deque<SSL_SESSION*>>        _sessions;   ///< oldest first
+   http_client::tls_metrics                                 _metrics;
+};
+
+/**
+ *  The connections behind http_client::post_async, driven by a thread of their own.
+ *
+ *  Every host gets a queue of requests and up to max_connections_per_host keep-alive connections. A
+ *  queued request goes to the connection with the fewest requests outstanding, a new connection is
+ *  opened while every open one is busy. Up to pipeline_depth requests are written to a connection
+ *  before their responses, which are read back in order.
+ *
+ *  When a connection fails to open, its requests fail. When a connection breaks, its requests that
+ *  were not written yet are queued again and the ones written fail, as the server may have processed
+ *  them. With pool_config::retry_stale_requests, written requests are sent once more on another
+ *  connection when a keep-alive connection that had served a response is closed by the server before
+ *  answering. A request whose deadline passes fails, and if it was already written its connection is
+ *  closed.
+ *
+ *  Everything but post() runs on the thread of the pool.
+ */
+class http_connection_pool {
+public:
+   using error_code = boost::system::error_code;
+   using handler = std::function<void( const error_code& )>;
+
+   http_connection_pool( ssl::context& sslc, tls_session_cache& tls, const http_client::pool_config& config, const http_client::response_config& response )
+   :_sslc(sslc)
+   ,_tls(tls)
+   ,_config(config)
+   ,_response(response)
+   ,_work(boost::asio::make_work_guard(_ioc))
+   {
+      FC_ASSERT(_config.max_connections_per_host > 0, "max_connections_per_host must be at least 1");
+      if (_config.pipeline_depth == 0)
+         _config.pipeline_depth = 1;
+   }
+
+   ~http_connection_pool() {
+      if (_thread.joinable()) {
+         boost::asio::post(_ioc, [this]() { shutdown(); });
+         _work.reset();
+         _thread.join();
+      }
+   }
+
+   void post( const url& dest, std::string json_body, const time_point& deadline, http_client::post_callback cb ) {
+      start();
+      auto r = std::make_shared<request>(_ioc);
+      r->cb = std::move(cb);
+      std::exception_ptr e;
+      if (_in_flight.fetch_add(1, std::memory_order_relaxed) >= _config.max_in_flight) {
+         e = std::make_exception_ptr( FC_EXCEPTION( fc::exception, "Too many requests in flight, at most {n} are allowed", ("n", _config.max_in_flight) ) );
+      } else {
+         try {
+            FC_ASSERT(dest.proto() == "http" || dest.proto() == "https"
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+                      || dest.proto() == "unix"
+#endif
+                      , "Unknown protocol {proto}", ("proto", dest.proto()));
+            r->dest = dest;
+            r->key = url_to_host_key(dest);
+            r->req = make_request(dest, std::move(json_body), _response.accept_compressed);
+            r->deadline = deadline;
+         } catch( ... ) {
+            e = std::current_exception();
+         }
+      }
+
+      boost::asio::post(_ioc, [this, r, e]() {
+         if (e)
+            return complete(*r, e, variant());
+         enqueue(r);
+      });
+   }
+
+   /// opens connections to the host of dest until it has n, cb runs once they are open
+   void warm_up( const url& dest, uint32_t n, std::function<void( std::exception_ptr )> cb ) {
+      start();
+      boost::asio::post(_ioc, [this, dest, n, cb = std::move(cb)]() {
+         auto done = [cb]( std::exception_ptr e ) {
+            try {
+               cb(e);
+            } FC_LOG_AND_DROP();
+         };
+         if (_stopped)
+            return done(std::make_exception_ptr( FC_EXCEPTION( fc::exception, "http_client destroyed" ) ));
+
+         // the first error wins, cb runs when the last connection is done
+         struct waiting {
+            size_t             left = 1;
+            std::exception_ptr e;
+         };
+         auto w = std::make_shared<waiting>();
+         auto opened = [w, done]( const error_code& ec ) {
+            if (ec && !w->e)
+               w->e = std::make_exception_ptr( FC_EXCEPTION( fc::exception, "Failed to connect: {message}", ("message", ec.message()) ) );
+            if (--w->left == 0)
+               done(w->e);
+         };
+         try {
+            FC_ASSERT(dest.proto() == "http" || dest.proto() == "https"
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+                      || dest.proto() == "unix"
+#endif
+                      , "Unknown protocol {proto}", ("proto", dest.proto()));
+            host& h = _hosts[url_to_host_key(dest)];
+            for (const auto& c : h.connections) {
+               if (!c->is_open) {
+                  ++w->left;
+                  c->waiting.push_back(opened);
+               }
+            }
+            while (h.connections.size() < std::min(n, _config.max_connections_per_host)) {
+               ++w->left;
+               open_connection(h, dest)->waiting.push_back(opened);
+            }
+         } catch( ... ) {
+            w->e = std::current_exception();
+         }
+         opened(error_code());
+      });
+   }
+
+   /// completes cb with e on the thread of the pool, for requests that failed before they were posted
+   void post_error( std::exception_ptr e, http_client::post_callback cb ) {
+      start();
+      _in_flight.fetch_add(1, std::memory_order_relaxed);
+      auto r = std::make_shared<request>(_ioc);
+      r->cb = std::move(cb);
+      boost::asio::post(_ioc, [this, r, e]() { complete(*r, e, variant()); });
+   }
+
+private:
+   struct connection;
+
+   struct request {
+      explicit request( boost::asio::io_context& ioc ) :timer(ioc) {}
+
+      url                                dest;
+      http_host_key                      key;
+      http::request<http::string_body>   req;
+      http::response<http::string_body>  res;
+      std::optional<http::response_parser<http::string_body>> parser;   ///< while the response is read
+      http_client::post_callback         cb;
+      time_point                         deadline;
+      boost::asio::deadline_timer        timer;
+      connection*                        conn = nullptr;   ///< the connection the request is assigned to
+      bool                               retried = false;
+      bool                               done = false;
+   };
+   using request_ptr = std::shared_ptr<request>;
+
+   struct host {
+      std::deque<request_ptr>                  queue;
+      std::vector<std::shared_ptr<connection>> connections;
+   };
+
+   /// state of a connection, the stream is behind the virtual functions
+   struct connection : std::enable_shared_from_this<connection> {
+      explicit connection( host& h ) :owner(h) {}
+      virtual ~connection() = default;
+
+      virtual void async_open( const url& dest, handler h ) = 0;
+      virtual void async_write( http::request<http::string_body>& req, handler h ) = 0;
+      virtual void async_read( http::response_parser<http::string_body>& parser, handler h ) = 0;
+      virtual void close() = 0;
+
+      host&                   owner;
+      std::vector<handler>    waiting;       ///< called when the connection is open or failed to open
+      std::deque<request_ptr> requests;      ///< assigned, in the order they are written
+      size_t                  written = 0;   ///< leading requests written
+      size_t                  served = 0;    ///< responses read
+      bool                    is_open = false;
+      bool                    writing = false;
+      bool                    reading = false;
+      bool                    closing = false;
+   };
+
+   template<typename Stream>
+   struct stream_connection : connection {
+      template<typename... Args>
+      stream_connection( host& h, boost::asio::io_context& ioc, Args&&... args )
+      :connection(h)
+      ,resolver(ioc)
+      ,stream(ioc, std::forward<Args>(args)...)
+      {}
+
+      void async_open( const url& dest, handler h ) override {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+         if constexpr (std::is_same_v<Stream, local::stream_protocol::socket>) {
+            stream.async_connect(local::stream_protocol::endpoint(*dest.host()), std::move(h));
+         } else
+#endif
+         {
+            constexpr bool is_ssl = std::is_same_v<Stream, ssl::stream<tcp::socket>>;
+            const std::string port = dest.port() ? std::to_string(*dest.port()) : is_ssl ? "443" : "80";
+            resolver.async_resolve(*dest.host(), port, [this, h = std::move(h)]( const error_code& ec, tcp::resolver::results_type resolved ) mutable {
+               if (ec || closing)
+                  return h(ec);
+               boost::asio::async_connect(stream.lowest_layer(), resolved, [this, h = std::move(h)]( const error_code& ec, const tcp::endpoint& ) mutable {
+                  if constexpr (is_ssl) {
+                     if (!ec && !closing) {
+                        const time_point start = time_point::now();
+                        return stream.async_handshake(ssl::stream_base::client, [this, start, h = std::move(h)]( const error_code& ec ) {
+                           tls->handshake_done(stream.native_handle(), ec, time_point::now() - start);
+                           h(ec);
+                        });
+                     }
+                  }
+                  h(ec);
+               });
+            });
+         }
+      }
+
+      void async_write( http::request<http::string_body>& req, handler h ) override {
+         http::async_write(stream, req, [h = std::move(h)]( const error_code& ec, std::size_t ) { h(ec); });
+      }
+
+      void async_read( http::response_parser<http::string_body>& parser, handler h ) override {
+         http::async_read(stream, buffer, parser, [h = std::move(h)]( const error_code& ec, std::size_t ) { h(ec); });
+      }
+
+      void close() override {
+         error_code ec;
+         resolver.cancel();
+         stream.lowest_layer().close(ec);
+      }
+
+      tcp::resolver             resolver;
+      Stream                    stream;
+      boost::beast::flat_buffer buffer;   ///< persists between the responses of the connection
+      tls_session_cache*        tls = nullptr;
+   };
+
+   void start() {
+      std::call_once(_started, [this]() {
+         _thread = std::thread([this]() {
+            fc::set_os_thread_name( "http" );
+            while( true ) {
+               try {
+                  _ioc.run();
+                  break;
+               } FC_LOG_AND_DROP();
+            }
+         });
+      });
+   }
+
+   void enqueue( const request_ptr& r ) {
+      if (_stopped)
+         return fail(*r, boost::asio::error::operation_aborted, "http_client destroyed");
+      if (r->deadline != time_point::maximum()) {
+         static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+         r->timer.expires_at(epoch + boost::posix_time::microseconds(r->deadline.time_since_epoch().count()));
+         r->timer.async_wait([this, r]( const error_code& ec ) {
+            if (!ec && !r->done)
+               expire(*r);
+         });
+      }
+      host& h = _hosts[r->key];
+      h.queue.push_back(r);
+      dispatch(h);
+   }
+
+   void dispatch( host& h ) {
+      while (!h.queue.empty()) {
+         connection* best = nullptr;
+         for (const auto& c : h.connections) {
+            if (c->requests.size() < _config.pipeline_depth && (!best || c->requests.size() < best->requests.size()))
+               best = c.get();
+         }
+         if ((!best || !best->requests.empty()) && h.connections.size() < _config.max_connections_per_host) {
+            try {
+               best = open_connection(h, h.queue.front()->dest);
+            } catch( ... ) {
+               request_ptr r = std::move(h.queue.front());
+               h.queue.pop_front();
+               complete(*r, std::current_exception(), variant());
+               continue;
+            }
+         }
+         if (!best)
+            return;   // every connection is full, the queue moves when a response arrives
+
+         request_ptr r = std::move(h.queue.front());
+         h.queue.pop_front();
+         r->conn = best;
+         best->requests.push_back(std::move(r));
+         write_next(*best);
+      }
+   }
+
+   connection* open_connection( host& h, const url& dest ) {
+      std::shared_ptr<connection> c;
+      if (dest.proto() == "https") {
+         auto s = std::make_shared<stream_connection<ssl::stream<tcp::socket>>>(h, _ioc, _sslc);
+         // Set SNI Hostname (many hosts need this to handshake successfully)
+         if(!SSL_set_tlsext_host_name(s->stream.native_handle(), dest.host()->c_str()))
+         {
+            error_code ec{static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category()};
+            FC_THROW("Unable to set SNI Host Name: {msg}", ("msg", ec.message()));
+         }
+         s->stream.set_verify_callback(boost::asio::ssl::rfc2818_verification(*dest.host()));
+         _tls.prepare(s->stream.native_handle(), url_to_host_key(dest));
+         s->tls = &_tls;
+         c = std::move(s);
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+      } else if (dest.proto() == "unix") {
+         c = std::make_shared<stream_connection<local::stream_protocol::socket>>(h, _ioc);
+#endif
+      } else {
+         c = std::make_shared<stream_connection<tcp::socket>>(h, _ioc);
+      }
+
+      h.connections.push_back(c);
+      c->async_open(dest, [this, c]( const error_code& ec ) {
+         for (auto& h : std::exchange(c->waiting, {}))
+            h(c->closing ? boost::asio::error::operation_aborted : ec);
+         if (c->closing)
+            return;
+         if (ec)
+            return drop(*c, ec, "Failed to connect");
+         c->is_open = true;
+         write_next(*c);
+      });
+      return c.get();
+   }
+
+   void write_next( connection& c ) {
+      if (!c.is_open || c.writing || c.closing || c.written == c.requests.size())
+         return;
+      c.writing = true;
+      c.async_write(c.requests[c.written]->req, [this, c = c.shared_from_this()]( const error_code& ec ) {
+         c->writing = false;
+         if (c->closing)
+            return;
+         if (ec)
+            return drop(*c, ec, "Failed to send request");
+         ++c->written;
+         read_next(*c);
+         write_next(*c);
+      });
+   }
+
+   void read_next( connection& c ) {
+      if (c.reading || c.closing || c.written == 0)
+         return;
+      c.reading = true;
+      request& r = *c.requests.front();
+      r.parser.emplace();
+      r.parser->body_limit(_response.max_body_size);
+      c.async_read(*r.parser, [this, c = c.shared_from_this()]( const error_code& ec ) {
+         c->reading = false;
+         if (c->closing)
+            return;
+         if (ec)
+            return drop(*c, ec, "Failed to read response");
+
+         request_ptr r = std::move(c->requests.front());
+         c->requests.pop_front();
+         --c->written;
+         ++c->served;
+         r->res = r->parser->release();
+         r->parser.reset();
+         const bool keep_alive = r->res.keep_alive();
+
+         variant result;
+         std::exception_ptr e;
+         try {
+            result = parse_response(r->dest, r->res, _response.max_body_size);
+         } catch( ... ) {
+            e = std::current_exception();
+         }
+         complete(*r, e, std::move(result));
+
+         if (keep_alive) {
+            read_next(*c);
+            write_next(*c);
+            dispatch(c->owner);
+         } else {
+            // the server will not answer the requests behind this one, they are sent again
+            drop(*c, error_code(), nullptr);
+         }
+      });
+   }
+
+   /**
+    *  Closes c, requeueing its requests that may be sent again and failing the rest with ec. When
+    *  c never opened, all of its requests fail, so a host that is down does not spin.
+    */
+   void drop( connection& c, const error_code& ec, const char* what ) {
+      if (c.closing)
+         return;
+      c.closing = true;
+      c.close();
+
+      host& h = c.owner;
+      auto self = c.shared_from_this();
+      h.connections.erase(std::find(h.connections.begin(), h.connections.end(), self));
+
+      // a kept-alive connection the server closed before it read anything
+      const bool stale = c.served > 0 && (ec == boost::asio::error::eof || ec == http::error::end_of_stream ||
+                                          ec == boost::asio::error::connection_reset ||
+                                          ec == boost::asio::error::broken_pipe);
+      std::vector<request_ptr> again;
+      for (size_t i = 0; i < c.requests.size(); ++i) {
+         auto& r = c.requests[i];
+         if (r->done)
+            continue;
+         r->conn = nullptr;
+         if (!ec || (c.is_open && i >= c.written)) {
+            again.push_back(std::move(r));
+         } else if (stale && _config.retry_stale_requests && !r->retried) {
+            r->retried = true;
+            again.push_back(std::move(r));
+         } else {
+            fail(*r, ec, what);
+         }
+      }
+      c.requests.clear();
+      c.written = 0;
+      h.queue.insert(h.queue.begin(), std::make_move_iterator(again.begin()), std::make_move_iterator(again.end()));
+      dispatch(h);
+   }
+
+   void expire( request& r ) {
+      const error_code ec(boost::system::errc::timed_out, boost::system::system_category());
+      if (connection* c = r.conn) {
+         auto i = std::find_if(c->requests.begin(), c->requests.end(), [&r]( const request_ptr& p ) { return p.get() == &r; });
+         if (size_t(i - c->requests.begin()) >= c->written) {
+            // not written yet, the connection stays
+            request_ptr keep = std::move(*i);
+            c->requests.erase(i);
+            fail(r, ec, "Request timed out");
+         } else {
+            fail(r, ec, "Request timed out");
+            drop(*c, boost::asio::error::operation_aborted, "Connection closed after another request timed out");
+         }
+      } else {
+         auto& q = _hosts.at(r.key).queue;
+         q.erase(std::remove_if(q.begin(), q.end(), [&r]( const request_ptr& p ) { return p.get() == &r; }), q.end());
+         fail(r, ec, "Request timed out");
+      }
+   }
+
+   void fail( request& r, const error_code& ec, const char* what ) {
+      complete(r, std::make_exception_ptr( FC_EXCEPTION( fc::exception, "{what}: {message}", ("what", what)("message", ec.message()) ) ), variant());
+   }
+
+   void complete( request& r, std::exception_ptr e, variant result ) {
+      if (r.done)
+         return;
+      r.done = true;
+      r.conn = nullptr;
+      error_code ec;
+      r.timer.cancel(ec);
+      _in_flight.fetch_sub(1, std::memory_order_relaxed);
+      try {
+         r.cb(e, std::move(result));
+      } FC_LOG_AND_DROP();
+   }
+
+   void shutdown() {
+      _stopped = true;
+      const error_code ec = boost::asio::error::operation_aborted;
+      for (auto& [key, h] : _hosts) {
+         for (auto& c : h.connections) {
+            c->closing = true;
+            c->close();
+            for (auto& r : c->requests)
+               fail(*r, ec, "http_client destroyed");
+         }
+         h.connections.clear();
+         for (auto& r : h.queue)
+            fail(*r, ec, "http_client destroyed");
+         h.queue.clear();
+      }
+   }
+
+   boost::asio::io_context                                                   _ioc;
+   ssl::context&                                                             _sslc;
+   tls_session_cache&                                                        _tls;
+   http_client::pool_config                                                  _config;
+   const http_client::response_config&                                       _response;
+   boost::asio::executor_work_guard<boost::asio::io_context::executor_type>  _work;
+   std::map<http_host_key, host>                                             _hosts;
+   std::atomic<uint32_t>                                                     _in_flight{0};
+   std::once_flag                                                            _started;
+   bool                                                                      _stopped = false;
+   std::thread                                                               _thread;
+};
+
 class http_client_impl {
 public:
-   using host_key = std::tuple<std::string, std::string, uint16_t>;
+   using host_key = http_host_key;
    using raw_socket_ptr = std::unique_ptr<tcp::socket>;
    using ssl_socket_ptr = std::unique_ptr<ssl::stream<tcp::socket>>;
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
@@ -49,9 +791,11 @@ public:
    using error_code = boost::system::error_code;
    using deadline_type = boost::posix_time::ptime;
 
-   http_client_impl()
+   explicit http_client_impl( const http_client::pool_config& config )
    :_ioc()
    ,_sslc(ssl::context::sslv23_client)
+   ,_tls(_sslc)
+   ,_pool(_sslc, _tls, config, _response_config)
    {
       set_verify_peers(true);
    }
@@ -149,23 +893,119 @@ public:
       });
    }
 
-   template<typename SyncReadStream>
-   error_code sync_read_with_timeout(SyncReadStream& s, boost::beast::flat_buffer& buffer, http::response<http::string_body>& res, const deadline_type& deadline ) {
-      return sync_do_with_deadline(s, deadline, [&s, &buffer, &res](std::optional<error_code>& final_ec){
-         http::async_read(s, buffer, res, [&final_ec]( const error_code& ec, std::size_t ) {
+   template<typename SyncReadStream, typename Parser>
+   error_code sync_read_with_timeout(SyncReadStream& s, boost::beast::flat_buffer& buffer, Parser& parser, const deadline_type& deadline ) {
+      return sync_do_with_deadline(s, deadline, [&s, &buffer, &parser](std::optional<error_code>& final_ec){
+         http::async_read(s, buffer, parser, [&final_ec]( const error_code& ec, std::size_t ) {
+            final_ec.emplace(ec);
+         });
+      });
+   }
+
+   template<typename SyncReadStream, typename Parser>
+   error_code sync_read_header_with_timeout(SyncReadStream& s, boost::beast::flat_buffer& buffer, Parser& parser, const deadline_type& deadline ) {
+      return sync_do_with_deadline(s, deadline, [&s, &buffer, &parser](std::optional<error_code>& final_ec){
+         http::async_read_header(s, buffer, parser, [&final_ec]( const error_code& ec, std::size_t ) {
+            final_ec.emplace(ec);
+         });
+      });
+   }
+
+   template<typename SyncReadStream, typename Parser>
+   error_code sync_read_some_with_timeout(SyncReadStream& s, boost::beast::flat_buffer& buffer, Parser& parser, const deadline_type& deadline ) {
+      return sync_do_with_deadline(s, deadline, [&s, &buffer, &parser](std::optional<error_code>& final_ec){
+         http::async_read_some(s, buffer, parser, [&final_ec]( const error_code& ec, std::size_t ) {
             final_ec.emplace(ec);
          });
       });
    }
 
-   host_key url_to_host_key( const url& dest ) {
-      FC_ASSERT(dest.host(), "Provided URL has no host");
-      uint16_t port = 80;
-      if (dest.port()) {
-         port = *dest.port();
+   /**
+    *  Reads a response and parses its body while it arrives, see http_client::response_config::streaming.
+    *  keep_alive is set once the connection can serve another request.
+    */
+   template<typename SyncReadStream>
+   variant read_streaming_response(SyncReadStream& s, const url& dest, const deadline_type& deadline, bool& keep_alive) {
+      boost::beast::flat_buffer buffer;
+      http::response_parser<http::buffer_body> parser;
+      parser.body_limit(_response_config.max_body_size);
+
+      error_code ec = sync_read_header_with_timeout(s, buffer, parser, deadline);
+      FC_ASSERT(!ec, "Failed to read response: {message}", ("message",ec.message()));
+
+      std::optional<zlib_inflater> inflater;
+      if (auto encoding = body_encoding(parser.get()[http::field::content_encoding])) {
+         inflater.emplace(*encoding);
       }
 
-      return std::make_tuple(dest.proto(), *dest.host(), port);
+      std::vector<char> chunk(64 * 1024);
+      std::string decoded;
+      uint64_t decoded_size = 0;
+      std::exception_ptr read_error;
+      // the next part of the decoded body, empty at its end and after an error
+      auto next = [&]() -> std::string_view {
+         if (read_error) {
+            return {};
+         }
+         try {
+            while (!parser.is_done()) {
+               parser.get().body().data = chunk.data();
+               parser.get().body().size = chunk.size();
+               error_code ec = sync_read_some_with_timeout(s, buffer, parser, deadline);
+               if (ec == http::error::need_buffer) {
+                  ec = {};
+               }
+               FC_ASSERT(!ec, "Failed to read response: {message}", ("message",ec.message()));
+
+               const std::string_view part(chunk.data(), chunk.size() - parser.get().body().size);
+               if (!inflater) {
+                  if (!part.empty()) {
+                     return part;
+                  }
+                  continue;
+               }
+               decoded.clear();
+               inflater->write(part, decoded);
+               decoded_size += decoded.size();
+               FC_ASSERT(decoded_size <= _response_config.max_body_size, "Decoded response body exceeds {max} bytes", ("max", _response_config.max_body_size));
+               if (!decoded.empty()) {
+                  return decoded;
+               }
+            }
+            FC_ASSERT(!inflater || inflater->done(), "Truncated compressed response body");
+         } catch( ... ) {
+            read_error = std::current_exception();
+         }
+         return {};
+      };
+
+      const auto status = parser.get().result();
+      if (status == http::status::internal_server_error || status == http::status::not_found || status == http::status::bad_request) {
+         // error responses are small and not always JSON, they are checked whole
+         http::response<http::string_body> res{status, parser.get().version()};
+         for (auto part = next(); !part.empty(); part = next()) {
+            res.body().append(part);
+         }
+         if (read_error) {
+            std::rethrow_exception(read_error);
+         }
+         keep_alive = parser.get().keep_alive();
+         return parse_response(dest, res, _response_config.max_body_size);
+      }
+
+      variant result;
+      try {
+         result = json::from_chunks(next);
+      } catch( ... ) {
+         // as with a buffered response, a body that is not JSON gives a null result
+      }
+      // the rest of the body is read so the connection can serve the next request
+      while (!next().empty()) {}
+      if (read_error) {
+         std::rethrow_exception(read_error);
+      }
+      keep_alive = parser.get().keep_alive();
+      return result;
    }
 
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
@@ -211,14 +1051,17 @@ public:
       }
 
       ssl_socket->set_verify_callback(boost::asio::ssl::rfc2818_verification(*dest.host()));
+      _tls.prepare(ssl_socket->native_handle(), key);
 
       error_code ec = sync_connect_with_timeout(ssl_socket->next_layer(), *dest.host(), dest.port() ? std::to_string(*dest.port()) : "443", deadline);
       if (!ec) {
+         const time_point start = time_point::now();
          ec = sync_do_with_deadline(ssl_socket->next_layer(), deadline, [&ssl_socket](std::optional<error_code>& final_ec) {
             ssl_socket->async_handshake(ssl::stream_base::client, [&final_ec](const error_code& ec) {
                final_ec.emplace(ec);
             });
          });
+         _tls.handshake_done(ssl_socket->native_handle(), ec, time_point::now() - start);
       }
       FC_ASSERT(!ec, "Failed to connect: {message}", ("message",ec.message()));
 
@@ -296,53 +1139,61 @@ public:
    };
 
    struct read_response_visitor : visitor<error_code> {
-      read_response_visitor(http_client_impl* that, boost::beast::flat_buffer& buffer, http::response<http::string_body>& res, const deadline_type& deadline)
+      read_response_visitor(http_client_impl* that, boost::beast::flat_buffer& buffer, http::response_parser<http::string_body>& parser, const deadline_type& deadline)
       :that(that)
       ,buffer(buffer)
-      ,res(res)
+      ,parser(parser)
       ,deadline(deadline)
       {}
 
       template<typename S>
       error_code operator() ( S& stream ) const {
-         return that->sync_read_with_timeout(*stream, buffer, res, deadline);
+         return that->sync_read_with_timeout(*stream, buffer, parser, deadline);
+      }
+
+      http_client_impl*                         that;
+      boost::beast::flat_buffer&                buffer;
+      http::response_parser<http::string_body>& parser;
+      const deadline_type&                      deadline;
+   };
+
+   struct read_streaming_response_visitor : visitor<variant> {
+      read_streaming_response_visitor(http_client_impl* that, const url& dest, const deadline_type& deadline, bool& keep_alive)
+      :that(that)
+      ,dest(dest)
+      ,deadline(deadline)
+      ,keep_alive(keep_alive)
+      {}
+
+      template<typename S>
+      variant operator() ( S& stream ) const {
+         return that->read_streaming_response(*stream, dest, deadline, keep_alive);
       }
 
-      http_client_impl*                  that;
-      boost::beast::flat_buffer&         buffer;
-      http::response<http::string_body>& res;
-      const deadline_type&               deadline;
+      http_client_impl*    that;
+      const url&           dest;
+      const deadline_type& deadline;
+      bool&                keep_alive;
    };
 
+   void warm_up(const url &dest, const fc::time_point &_deadline) {
+      static const deadline_type epoch(boost::gregorian::date(1970, 1, 1));
+      get_connection(dest, epoch + boost::posix_time::microseconds(_deadline.time_since_epoch().count()));
+   }
+
    variant
    post_sync(const url &dest, const variant &payload,
              const fc::time_point &_deadline,
              json::output_formatting formatting) {
+      return post_sync_json(dest, json::to_string(payload, _deadline, formatting), _deadline);
+   }
+
+   variant
+   post_sync_json(const url &dest, std::string json_body,
+                  const fc::time_point &_deadline) {
       static const deadline_type epoch(boost::gregorian::date(1970, 1, 1));
       auto deadline = epoch + boost::posix_time::microseconds(_deadline.time_since_epoch().count());
-      FC_ASSERT(dest.host(), "No host set on URL");
-
-      string path = dest.path() ? dest.path()->generic_string() : "/";
-      if (dest.query()) {
-         path = path + "?" + *dest.query();
-      }
-
-      string host_str = *dest.host();
-      if (dest.port()) {
-         auto port = *dest.port();
-         auto proto_iter = default_proto_ports.find(dest.proto());
-         if (proto_iter != default_proto_ports.end() && proto_iter->second != port) {
-            host_str = host_str + ":" + std::to_string(port);
-         }
-      }
-
-      http::request<http::string_body> req{http::verb::post, path, 11};
-      req.set(http::field::host, host_str);
-      req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
-      req.set(http::field::content_type, "application/json");
-      req.keep_alive(true);
-      req.body() = json::to_string(payload, _deadline, formatting);
-      req.prepare_payload();
+      http::request<http::string_body> req = make_request(dest, std::move(json_body), _response_config.accept_compressed);
 
       auto conn_iter = get_connection(dest, deadline);
       auto eraser = make_scoped_exit([this, &conn_iter](){
@@ -353,54 +1204,35 @@ public:
       error_code ec = std::visit(write_request_visitor(this, req, deadline), conn_iter->second);
       FC_ASSERT(!ec, "Failed to send request: {message}", ("message",ec.message()));
 
+      if (_response_config.streaming) {
+         // the connection is kept open once the response was read to its end, even if it reports an error
+         bool keep_alive = false;
+         auto keeper = make_scoped_exit([&keep_alive, &eraser](){
+            if (keep_alive) {
+               eraser.cancel();
+            }
+         });
+         return std::visit(read_streaming_response_visitor(this, dest, deadline, keep_alive), conn_iter->second);
+      }
+
       // This buffer is used for reading and must be persisted
       boost::beast::flat_buffer buffer;
 
-      // Declare a container to hold the response
-      http::response<http::string_body> res;
+      // Declare a parser to hold the response
+      http::response_parser<http::string_body> parser;
+      parser.body_limit(_response_config.max_body_size);
 
       // Receive the HTTP response
-      ec = std::visit(read_response_visitor(this, buffer, res, deadline), conn_iter->second);
+      ec = std::visit(read_response_visitor(this, buffer, parser, deadline), conn_iter->second);
       FC_ASSERT(!ec, "Failed to read response: {message}", ("message",ec.message()));
+      http::response<http::string_body> res = parser.release();
 
       // if the connection can be kept open, keep it open
       if (res.keep_alive()) {
          eraser.cancel();
       }
 
-      fc::variant result;
-      if( !res.body().empty() ) {
-         try {
-            result = json::from_string( res.body() );
-         } catch( ... ) {}
-      }
-      if (res.result() == http::status::internal_server_error) {
-         fc::exception_ptr excp;
-         try {
-            auto err_var = result.get_object()["error"].get_object();
-            excp = std::make_shared<fc::exception>(err_var["code"].as_int64(), err_var["name"].as_string(), err_var["what"].as_string());
-
-            if (err_var.contains("details")) {
-               for (const auto& dvar : err_var["details"].get_array()) {
-                  excp->append_log(FC_LOG_MESSAGE(error, dvar.get_object()["message"].as_string()));
-               }
-            }
-         } catch( ... ) {
-
-         }
-
-         if (excp) {
-            throw *excp;
-         } else {
-            FC_THROW("Request failed with 500 response, but response was not parseable");
-         }
-      } else if (res.result() == http::status::not_found) {
-         FC_THROW("URL not found: {url}", ("url", (std::string)dest));
-      } else if (res.result() == http::status::bad_request) {
-         FC_THROW("Received request: {msg}", ("msg", res.body()));
-      }
-
-      return result;
+      return parse_response(dest, res, _response_config.max_body_size);
    }
 
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
@@ -417,6 +1249,7 @@ public:
       call.
    */
    const fc::url& get_unix_url(const std::string& full_url) {
+      std::lock_guard<std::mutex> g(_unix_url_mutex);
       unix_url_split_map::const_iterator found = _unix_url_paths.find(full_url);
       if(found != _unix_url_paths.end())
          return found->second;
@@ -442,13 +1275,23 @@ public:
 
    boost::asio::io_context  _ioc;
    ssl::context             _sslc;
+   tls_session_cache        _tls;              ///< after _sslc and before the streams of its context
    connection_map           _connections;
+   http_client::response_config _response_config;
+   std::mutex               _unix_url_mutex;   ///< post_async resolves unix urls on the calling threads
    unix_url_split_map       _unix_url_paths;
+   http_connection_pool     _pool;             ///< last, so it stops before the rest is destroyed
 };
 
 
 http_client::http_client()
-:_my(new http_client_impl())
+:_my(new http_client_impl(pool_config()))
+{
+
+}
+
+http_client::http_client( const pool_config& config )
+:_my(new http_client_impl(config))
 {
 
 }
@@ -465,6 +1308,105 @@ variant http_client::post_sync(const url &dest, const variant &payload,
     return _my->post_sync(dest, payload, deadline, formatting);
 }
 
+variant http_client::post_sync_json(const url &dest, std::string json_body,
+                                    const fc::time_point &deadline) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+  if (dest.proto() == "unix")
+    return _my->post_sync_json(_my->get_unix_url(*dest.host()), std::move(json_body), deadline);
+#endif
+  return _my->post_sync_json(dest, std::move(json_body), deadline);
+}
+
+void http_client::post_async_json(const url &dest, std::string json_body,
+                                  const fc::time_point &deadline, post_callback cb) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+  if (dest.proto() == "unix") {
+    std::optional<url> unix_url;
+    try {
+      unix_url = _my->get_unix_url(*dest.host());
+    } catch( ... ) {
+      return _my->_pool.post_error(std::current_exception(), std::move(cb));
+    }
+    return _my->_pool.post(*unix_url, std::move(json_body), deadline, std::move(cb));
+  }
+#endif
+  _my->_pool.post(dest, std::move(json_body), deadline, std::move(cb));
+}
+
+static http_client::post_callback fulfill( const std::shared_ptr<std::promise<variant>>& p ) {
+  return [p](std::exception_ptr e, variant result) {
+    if (e)
+      p->set_exception(e);
+    else
+      p->set_value(std::move(result));
+  };
+}
+
+std::future<variant> http_client::post_async_json(const url &dest, std::string json_body,
+                                                  const fc::time_point &deadline) {
+  auto p = std::make_shared<std::promise<variant>>();
+  post_async_json(dest, std::move(json_body), deadline, fulfill(p));
+  return p->get_future();
+}
+
+void http_client::post_async(const url &dest, const variant &payload,
+                             const fc::time_point &deadline, post_callback cb,
+                             json::output_formatting formatting) {
+  std::string json_body;
+  try {
+    json_body = json::to_string(payload, deadline, formatting);
+  } catch( ... ) {
+    return _my->_pool.post_error(std::current_exception(), std::move(cb));
+  }
+  post_async_json(dest, std::move(json_body), deadline, std::move(cb));
+}
+
+std::future<variant> http_client::post_async(const url &dest, const variant &payload,
+                                             const fc::time_point &deadline,
+                                             json::output_formatting formatting) {
+  auto p = std::make_shared<std::promise<variant>>();
+  post_async(dest, payload, deadline, fulfill(p), formatting);
+  return p->get_future();
+}
+
+void http_client::warm_up(const url &dest, const fc::time_point &deadline) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+  if (dest.proto() == "unix")
+    return _my->warm_up(_my->get_unix_url(*dest.host()), deadline);
+#endif
+  _my->warm_up(dest, deadline);
+}
+
+void http_client::warm_up_async(const url &dest, uint32_t connections, std::function<void( std::exception_ptr )> cb) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+  if (dest.proto() == "unix") {
+    std::optional<url> unix_url;
+    try {
+      unix_url = _my->get_unix_url(*dest.host());
+    } catch( ... ) {
+      return _my->_pool.post_error(std::current_exception(), [cb = std::move(cb)](std::exception_ptr e, variant) { cb(e); });
+    }
+    return _my->_pool.warm_up(*unix_url, connections, std::move(cb));
+  }
+#endif
+  _my->_pool.warm_up(dest, connections, std::move(cb));
+}
+
+std::future<void> http_client::warm_up_async(const url &dest, uint32_t connections) {
+  auto p = std::make_shared<std::promise<void>>();
+  warm_up_async(dest, connections, [p](std::exception_ptr e) {
+    if (e)
+      p->set_exception(e);
+    else
+      p->set_value();
+  });
+  return p->get_future();
+}
+
+http_client::tls_metrics http_client::get_tls_metrics() const {
+  return _my->_tls.metrics();
+}
+
 void http_client::add_cert(const std::string& cert_pem_string) {
    _my->add_cert(cert_pem_string);
 }
@@ -473,6 +1415,10 @@ void http_client::set_verify_peers(bool enabled) {
    _my->set_verify_peers(enabled);
 }
 
+void http_client::set_response_config(const response_config& config) {
+   _my->_response_config = config;
+}
+
 http_client::~http_client() {
 
 }
@@ -9,6 +9,7 @@
 #include <fc/io/json.hpp>
 #include <fc/utf8.hpp>
 #include <algorithm>
+#include <atomic>
 
 namespace fc
 {
@@ -21,6 +22,99 @@ void set_variant_type( variant* v, variant::type_id t)
    data[ sizeof(variant) -1 ] = t;
 }
 
+namespace detail
+{
+   /**
+    *  Heap storage for string, array, object and blob variants.  Copies of a variant share
+    *  the node and only bump the reference count.  Once a mutable reference to the value has
+    *  been handed out the node is no longer shared, so writes through that reference can
+    *  never be observed through a copy.
+    */
+   template<typename T>
+   struct variant_node
+   {
+      template<typename... Args>
+      explicit variant_node( Args&&... args ) : value( std::forward<Args>(args)... ) {}
+
+      std::atomic<uint32_t> refs{1};
+      bool                  shareable = true;
+      bool                  in_arena  = false;
+      T                     value;
+   };
+}
+
+/// the node pointer is stored in the first bytes of the variant
+template<typename T>
+detail::variant_node<T>*& node_ptr( variant* v )
+{
+   return *reinterpret_cast<detail::variant_node<T>**>(v);
+}
+
+template<typename T>
+detail::variant_node<T>* node_ptr( const variant* v )
+{
+   return *reinterpret_cast<detail::variant_node<T>* const*>(v);
+}
+
+template<typename T, typename... Args>
+void init_node( variant* v, Args&&... args )
+{
+   node_ptr<T>( v ) = new detail::variant_node<T>( std::forward<Args>(args)... );
+}
+
+template<typename T, typename... Args>
+void init_node_in( variant* v, variant_arena& arena, Args&&... args )
+{
+   void* mem = arena.allocate( sizeof(detail::variant_node<T>), alignof(detail::variant_node<T>) );
+   auto n = new (mem) detail::variant_node<T>( std::forward<Args>(args)... );
+   n->in_arena = true;
+   node_ptr<T>( v ) = n;
+}
+
+template<typename T>
+const T& node_value( const variant* v )
+{
+   return node_ptr<T>( v )->value;
+}
+
+template<typename T>
+void copy_node( variant* dst, const variant* src )
+{
+   detail::variant_node<T>* n = node_ptr<T>( src );
+   if( n->shareable && !n->in_arena ) {
+      n->refs.fetch_add( 1, std::memory_order_relaxed );
+      node_ptr<T>( dst ) = n;
+   } else {
+      node_ptr<T>( dst ) = new detail::variant_node<T>( n->value );
+   }
+}
+
+template<typename T>
+void release_node( variant* v )
+{
+   detail::variant_node<T>* n = node_ptr<T>( v );
+   if( n->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+      if( n->in_arena )
+         n->~variant_node(); // the memory is released with the arena
+      else
+         delete n;
+   }
+}
+
+/// detaches v from any copies and marks its node as unshareable
+template<typename T>
+T& mutable_node_value( variant* v )
+{
+   detail::variant_node<T>*& n = node_ptr<T>( v );
+   if( n->refs.load( std::memory_order_acquire ) != 1 ) {
+      auto copy = new detail::variant_node<T>( n->value );
+      release_node<T>( v );
+      n = copy;
+   }
+   n->shareable = false;
+   return n->value;
+}
+
 variant::variant()
 {
    set_variant_type( this, null_type );
@@ -99,13 +193,13 @@ variant::variant( bool val )
 
 variant::variant( char* str )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
+   init_node<string>( this, str );
    set_variant_type( this, string_type );
 }
 
 variant::variant( const char* str )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
+   init_node<string>( this, str );
    set_variant_type( this, string_type );
 }
 
@@ -116,7 +210,7 @@ variant::variant( wchar_t* str )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
      buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
+   init_node<string>( this, buffer.get(), len );
    set_variant_type( this, string_type );
 }
 
@@ -127,59 +221,82 @@ variant::variant( const wchar_t* str )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
      buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
+   init_node<string>( this, buffer.get(), len );
    set_variant_type( this, string_type );
 }
 
 variant::variant( fc::string val )
 {
-   *reinterpret_cast<string**>(this)  = new string( fc::move(val) );
+   init_node<string>( this, fc::move(val) );
    set_variant_type( this, string_type );
 }
 variant::variant( blob val )
 {
-   *reinterpret_cast<blob**>(this)  = new blob( fc::move(val) );
+   init_node<blob>( this, fc::move(val) );
    set_variant_type( this, blob_type );
 }
 
 variant::variant( variant_object obj)
 {
-   *reinterpret_cast<variant_object**>(this)  = new variant_object(fc::move(obj));
+   init_node<variant_object>( this, fc::move(obj) );
    set_variant_type(this,  object_type );
 }
 variant::variant( mutable_variant_object obj)
 {
-   *reinterpret_cast<variant_object**>(this)  = new variant_object(fc::move(obj));
+   init_node<variant_object>( this, fc::move(obj) );
    set_variant_type(this,  object_type );
 }
 
 variant::variant( variants arr )
 {
-   *reinterpret_cast<variants**>(this)  = new variants(fc::move(arr));
+   init_node<variants>( this, fc::move(arr) );
    set_variant_type(this,  array_type );
 }
 
+variant::variant( fc::string val, variant_arena& arena )
+{
+   init_node_in<string>( this, arena, fc::move(val) );
+   set_variant_type( this, string_type );
+}
+
+variant::variant( variant_object obj, variant_arena& arena )
+{
+   init_node_in<variant_object>( this, arena, fc::move(obj) );
+   node_ptr<variant_object>( this )->value._in_arena = true;
+   set_variant_type( this, object_type );
+}
 
-typedef const variant_object* const_variant_object_ptr;
-typedef const variants* const_variants_ptr;
-typedef const blob*   const_blob_ptr;
-typedef const string* const_string_ptr;
+variant::variant( variants arr, variant_arena& arena )
+{
+   init_node_in<variants>( this, arena, fc::move(arr) );
+   set_variant_type( this, array_type );
+}
+
+variant_arena::variant_arena( size_t initial_size )
+:_resource( std::max<size_t>( initial_size, 1 ) ){}
+
+variant_arena::~variant_arena(){}
+
+void* variant_arena::allocate( size_t size, size_t alignment )
+{
+   return _resource.allocate( size, alignment );
+}
 
 void variant::clear()
 {
    switch( get_type() )
    {
      case object_type:
-        delete *reinterpret_cast<variant_object**>(this);
+        release_node<variant_object>( this );
         break;
      case array_type:
-        delete *reinterpret_cast<variants**>(this);
+        release_node<variants>( this );
         break;
      case string_type:
-        delete *reinterpret_cast<string**>(this);
+        release_node<string>( this );
         break;
      case blob_type:
-        delete *reinterpret_cast<blob**>(this);
+        release_node<blob>( this );
         break;
      default:
         break;
@@ -192,23 +309,19 @@ variant::variant( const variant& v )
    switch( v.get_type() )
    {
        case object_type:
-          *reinterpret_cast<variant_object**>(this)  =
-             new variant_object(**reinterpret_cast<const const_variant_object_ptr*>(&v));
+          copy_node<variant_object>( this, &v );
           set_variant_type( this, object_type );
           return;
        case array_type:
-          *reinterpret_cast<variants**>(this)  =
-             new variants(**reinterpret_cast<const const_variants_ptr*>(&v));
+          copy_node<variants>( this, &v );
           set_variant_type( this,  array_type );
           return;
        case string_type:
-          *reinterpret_cast<string**>(this)  =
-             new string(**reinterpret_cast<const const_string_ptr*>(&v) );
+          copy_node<string>( this, &v );
           set_variant_type( this, string_type );
           return;
        case blob_type:
-          *reinterpret_cast<blob**>(this)  =
-             new blob(**reinterpret_cast<const const_blob_ptr*>(&v) );
+          copy_node<blob>( this, &v );
           set_variant_type( this, blob_type );
           return;
        default:
@@ -216,7 +329,7 @@ variant::variant( const variant& v )
    }
 }
 
-variant::variant( variant&& v )
+variant::variant( variant&& v ) noexcept
 {
    memcpy( this, &v, sizeof(v) );
    set_variant_type( &v, null_type );
@@ -227,7 +340,7 @@ variant::~variant()
    clear();
 }
 
-variant& variant::operator=( variant&& v )
+variant& variant::operator=( variant&& v ) noexcept
 {
    if( this == &v ) return *this;
    clear();
@@ -245,18 +358,16 @@ variant& variant::operator=( const variant& v )
    switch( v.get_type() )
    {
       case object_type:
-         *reinterpret_cast<variant_object**>(this)  =
-            new variant_object((**reinterpret_cast<const const_variant_object_ptr*>(&v)));
+         copy_node<variant_object>( this, &v );
          break;
       case array_type:
-         *reinterpret_cast<variants**>(this)  =
-            new variants((**reinterpret_cast<const const_variants_ptr*>(&v)));
+         copy_node<variants>( this, &v );
          break;
       case string_type:
-         *reinterpret_cast<string**>(this)  = new string((**reinterpret_cast<const const_string_ptr*>(&v)) );
+         copy_node<string>( this, &v );
          break;
       case blob_type:
-         *reinterpret_cast<blob**>(this)  = new blob((**reinterpret_cast<const const_blob_ptr*>(&v)) );
+         copy_node<blob>( this, &v );
          break;
       default:
          memcpy( this, &v, sizeof(v) );
@@ -285,16 +396,16 @@ void  variant::visit( const visitor& v )const
          v.handle( *reinterpret_cast<const bool*>(this) );
          return;
       case string_type:
-         v.handle( **reinterpret_cast<const const_string_ptr*>(this) );
+         v.handle( node_value<string>( this ) );
          return;
       case array_type:
-         v.handle( **reinterpret_cast<const const_variants_ptr*>(this) );
+         v.handle( node_value<variants>( this ) );
          return;
       case object_type:
-         v.handle( **reinterpret_cast<const const_variant_object_ptr*>(this) );
+         v.handle( node_value<variant_object>( this ) );
          return;
       case blob_type:
-         v.handle( **reinterpret_cast<const const_blob_ptr*>(this) );
+         v.handle( node_value<blob>( this ) );
          return;
       default:
          FC_THROW_EXCEPTION( assert_exception, "Invalid Type / Corrupted Memory" );
@@ -379,7 +490,7 @@ int64_t variant::as_int64()const
    switch( get_type() )
    {
       case string_type:
-          return to_int64(**reinterpret_cast<const const_string_ptr*>(this));
+          return to_int64(node_value<string>( this ));
       case double_type:
           return int64_t(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -400,7 +511,7 @@ uint64_t variant::as_uint64()const
    switch( get_type() )
    {
       case string_type:
-          return to_uint64(**reinterpret_cast<const const_string_ptr*>(this));
+          return to_uint64(node_value<string>( this ));
       case double_type:
           return static_cast<uint64_t>(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -422,7 +533,7 @@ double  variant::as_double()const
    switch( get_type() )
    {
       case string_type:
-          return to_double(**reinterpret_cast<const const_string_ptr*>(this));
+          return to_double(node_value<string>( this ));
       case double_type:
           return *reinterpret_cast<const double*>(this);
       case int64_type:
@@ -444,7 +555,7 @@ bool  variant::as_bool()const
    {
       case string_type:
       {
-          const string& s = **reinterpret_cast<const const_string_ptr*>(this);
+          const string& s = node_value<string>( this );
           if( s == "true" )
              return true;
           if( s == "false" )
@@ -471,7 +582,7 @@ string    variant::as_string()const
    switch( get_type() )
    {
       case string_type:
-          return **reinterpret_cast<const const_string_ptr*>(this);
+          return node_value<string>( this );
       case double_type:
           return to_string(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -496,21 +607,21 @@ string    variant::as_string()const
 variants&         variant::get_array()
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<variants**>(this);
+     return mutable_node_value<variants>( this );
 
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from {type} to Array", ("type",get_type()) );
 }
 blob&         variant::get_blob()
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<blob**>(this);
+     return mutable_node_value<blob>( this );
 
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from {type} to Blob", ("type",get_type()) );
 }
 const blob&         variant::get_blob()const
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<const const_blob_ptr*>(this);
+     return node_value<blob>( this );
 
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from {type} to Blob", ("type",get_type()) );
 }
@@ -545,7 +656,7 @@ blob variant::as_blob()const
 const variants&       variant::get_array()const
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<const const_variants_ptr*>(this);
+     return node_value<variants>( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from {type} to Array", ("type",get_type()) );
 }
 
@@ -554,7 +665,7 @@ const variants&       variant::get_array()const
 variant_object&        variant::get_object()
 {
   if( get_type() == object_type )
-     return **reinterpret_cast<variant_object**>(this);
+     return mutable_node_value<variant_object>( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from {type} to Object", ("type",get_type()) );
 }
 
@@ -575,7 +686,7 @@ size_t            variant::size()const
 const string&        variant::get_string()const
 {
   if( get_type() == string_type )
-     return **reinterpret_cast<const const_string_ptr*>(this);
+     return node_value<string>( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '{type}' to string", ("type",get_type()) );
 }
 
@@ -583,7 +694,7 @@ const string&        variant::get_string()const
 const variant_object&  variant::get_object()const
 {
   if( get_type() == object_type )
-     return **reinterpret_cast<const const_variant_object_ptr*>(this);
+     return node_value<variant_object>( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '{type}' to Object", ("type",get_type()) );
 }
 
@@ -744,9 +855,8 @@ constexpr size_t minimize_max_size = 1024;
 // same behavior as std::string::substr only removes invalid utf8, and lower ascii
 void clean_append( string& app, const std::string_view& s, size_t pos = 0, size_t len = string::npos ) {
    std::string_view sub = s.substr( pos, len );
-   app.reserve( app.size() + sub.size() );
    const bool escape_control_chars = false;
-   app += escape_string( sub, nullptr, escape_control_chars );
+   append_escaped_string( app, sub, nullptr, escape_control_chars );
 }
 
 string format_string( const string& frmt, const variant_object& args, bool minimize )
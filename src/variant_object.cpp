@@ -4,12 +4,81 @@
 
 namespace fc
 {
+   namespace detail
+   {
+      /**
+       *  Open addressing hash table mapping a key to the position of its first occurrence in an
+       *  entry vector.  Slots hold position + 1 and keys are compared against the vector itself,
+       *  so the index stays valid when the vector reallocates.
+       */
+      class variant_object_index
+      {
+         public:
+            typedef std::vector<variant_object::entry> entries;
+
+            static constexpr size_t min_size = 16;
+            static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+            explicit variant_object_index( const entries& kv )
+            {
+               rehash( kv );
+            }
+
+            /// @return position of the first entry with \a key or npos
+            size_t find( const entries& kv, std::string_view key )const
+            {
+               const size_t mask = _slots.size() - 1;
+               for( size_t i = hash( key ) & mask; _slots[i] != 0; i = (i + 1) & mask )
+               {
+                  const size_t pos = _slots[i] - 1;
+                  if( kv[pos].key() == key ) return pos;
+               }
+               return npos;
+            }
+
+            /// indexes kv.back(), which must have been appended since the last update
+            void push_back( const entries& kv )
+            {
+               if( kv.size() * 2 > _slots.size() )
+                  rehash( kv );
+               else
+                  insert( kv, kv.size() - 1 );
+            }
+
+         private:
+            static size_t hash( std::string_view key ) { return std::hash<std::string_view>()( key ); }
+
+            void rehash( const entries& kv )
+            {
+               size_t capacity = min_size * 2;
+               while( capacity < kv.size() * 2 ) capacity <<= 1;
+               _slots.assign( capacity, 0 );
+               for( size_t pos = 0; pos < kv.size(); ++pos )
+                  insert( kv, pos );
+            }
+
+            void insert( const entries& kv, size_t pos )
+            {
+               const size_t mask = _slots.size() - 1;
+               const string& key = kv[pos].key();
+               size_t i = hash( key ) & mask;
+               for( ; _slots[i] != 0; i = (i + 1) & mask )
+               {
+                  if( kv[_slots[i] - 1].key() == key ) return; // find() returns the first occurrence
+               }
+               _slots[i] = static_cast<uint32_t>( pos + 1 );
+            }
+
+            std::vector<uint32_t> _slots;
+      };
+   }
+
    // ---------------------------------------------------------------
    // entry
 
    variant_object::entry::entry() {}
    variant_object::entry::entry( string k, variant v ) : _key(fc::move(k)),_value(fc::move(v)) {}
-   variant_object::entry::entry( entry&& e ) : _key(fc::move(e._key)),_value(fc::move(e._value)) {}
+   variant_object::entry::entry( entry&& e ) noexcept : _key(fc::move(e._key)),_value(fc::move(e._value)) {}
    variant_object::entry::entry( const entry& e ) : _key(e._key),_value(e._value) {}
    variant_object::entry& variant_object::entry::operator=( const variant_object::entry& e )
    {
@@ -62,19 +131,37 @@ namespace fc
 
    variant_object::iterator variant_object::find( const string& key )const
    {
-      return find( key.c_str() );
+      return find_key( key );
    }
 
    variant_object::iterator variant_object::find( const char* key )const
    {
-      for( auto itr = begin(); itr != end(); ++itr )
+      return find_key( key );
+   }
+
+   variant_object::iterator variant_object::find_key( std::string_view key )const
+   {
+      if( _key_value->size() < detail::variant_object_index::min_size )
       {
-         if( itr->key() == key )
+         for( auto itr = begin(); itr != end(); ++itr )
          {
-            return itr;
+            if( itr->key() == key )
+            {
+               return itr;
+            }
          }
+         return end();
+      }
+
+      // const lookups may race on a shared object, so publish the index atomically
+      auto index = std::atomic_load( &_index );
+      if( !index )
+      {
+         index = std::make_shared<detail::variant_object_index>( *_key_value );
+         std::atomic_store( &_index, index );
       }
-      return end();
+      const size_t pos = index->find( *_key_value, key );
+      return pos == detail::variant_object_index::npos ? end() : begin() + pos;
    }
 
    const variant& variant_object::operator[]( const string& key )const
@@ -107,13 +194,13 @@ namespace fc
    }
 
    variant_object::variant_object( const variant_object& obj )
-   :_key_value( obj._key_value )
    {
+      *this = obj;
       FC_ASSERT( _key_value != nullptr );
    }
 
    variant_object::variant_object( variant_object&& obj)
-   : _key_value( fc::move(obj._key_value) )
+   : _key_value( fc::move(obj._key_value) ),_index( fc::move(obj._index) ),_in_arena( obj._in_arena )
    {
       obj._key_value = std::make_shared<std::vector<entry>>();
       FC_ASSERT( _key_value != nullptr );
@@ -125,7 +212,7 @@ namespace fc
    }
 
    variant_object::variant_object( mutable_variant_object&& obj )
-   : _key_value(fc::move(obj._key_value))
+   : _key_value(fc::move(obj._key_value)),_index(fc::move(obj._index))
    {
       FC_ASSERT( _key_value != nullptr );
    }
@@ -135,6 +222,8 @@ namespace fc
       if (this != &obj)
       {
          fc_swap(_key_value, obj._key_value );
+         fc_swap(_index, obj._index );
+         std::swap(_in_arena, obj._in_arena );
          FC_ASSERT( _key_value != nullptr );
       }
       return *this;
@@ -144,7 +233,15 @@ namespace fc
    {
       if (this != &obj)
       {
-         _key_value = obj._key_value;
+         if( obj._in_arena ) {
+            // the values of the entries may live in the arena, copying them copies their storage to the heap
+            _key_value = std::make_shared<std::vector<entry>>( *obj._key_value );
+            _index.reset();
+         } else {
+            _key_value = obj._key_value;
+            _index = std::atomic_load( &obj._index );
+         }
+         _in_arena = false;
       }
       return *this;
    }
@@ -152,13 +249,18 @@ namespace fc
    variant_object& variant_object::operator=( mutable_variant_object&& obj )
    {
       _key_value = fc::move(obj._key_value);
+      _index = fc::move(obj._index);
+      _in_arena = false;
       obj._key_value.reset( new std::vector<entry>() );
       return *this;
    }
 
    variant_object& variant_object::operator=( const mutable_variant_object& obj )
    {
-      *_key_value = *obj._key_value;
+      // _key_value may be shared with other copies, so replace it rather than assign through it
+      _key_value = std::make_shared<std::vector<entry>>( *obj._key_value );
+      _index.reset();
+      _in_arena = false;
       return *this;
    }
 
@@ -198,36 +300,54 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::find( const string& key )const
    {
-      return find( key.c_str() );
+      return find_key( key );
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )const
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      return find_key( key );
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const string& key )
    {
-      return find( key.c_str() );
+      return find_key( key );
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )
    {
-      for( auto itr = begin(); itr != end(); ++itr )
+      return find_key( key );
+   }
+
+   mutable_variant_object::iterator mutable_variant_object::find_key( std::string_view key )const
+   {
+      if( _key_value->size() < detail::variant_object_index::min_size )
       {
-         if( itr->key() == key )
+         for( auto itr = begin(); itr != end(); ++itr )
          {
-            return itr;
+            if( itr->key() == key )
+            {
+               return itr;
+            }
          }
+         return end();
+      }
+
+      // const lookups from several threads are allowed, so publish the index atomically as variant_object does
+      auto index = std::atomic_load( &_index );
+      if( !index )
+      {
+         index = std::make_shared<detail::variant_object_index>( *_key_value );
+         std::atomic_store( &_index, index );
       }
-      return end();
+      const size_t pos = index->find( *_key_value, key );
+      return pos == detail::variant_object_index::npos ? end() : begin() + pos;
+   }
+
+   void mutable_variant_object::push_back( entry e )
+   {
+      _key_value->push_back( fc::move(e) );
+      if( _index )
+         _index->push_back( *_key_value );
    }
 
    const variant& mutable_variant_object::operator[]( const string& key )const
@@ -250,7 +370,7 @@ namespace fc
    {
       auto itr = find( key );
       if( itr != end() ) return itr->value();
-      _key_value->emplace_back(entry(key, variant()));
+      push_back( entry(key, variant()) );
       return _key_value->back().value();
    }
 
@@ -281,13 +401,14 @@ namespace fc
    }
 
    mutable_variant_object::mutable_variant_object( mutable_variant_object&& obj )
-      : _key_value(fc::move(obj._key_value))
+      : _key_value(fc::move(obj._key_value)),_index(fc::move(obj._index))
    {
    }
 
    mutable_variant_object& mutable_variant_object::operator=( const variant_object& obj )
    {
       *_key_value = *obj._key_value;
+      _index.reset();
       return *this;
    }
 
@@ -296,6 +417,7 @@ namespace fc
       if (this != &obj)
       {
          _key_value = fc::move(obj._key_value);
+         _index = fc::move(obj._index);
       }
       return *this;
    }
@@ -305,6 +427,7 @@ namespace fc
       if (this != &obj)
       {
          *_key_value = *obj._key_value;
+         _index.reset();
       }
       return *this;
    }
@@ -316,41 +439,40 @@ namespace fc
 
    void  mutable_variant_object::erase( const string& key )
    {
-      for( auto itr = begin(); itr != end(); ++itr )
+      auto itr = find_key( key );
+      if( itr != end() )
       {
-         if( itr->key() == key )
-         {
-            _key_value->erase(itr);
-            return;
-         }
+         _key_value->erase(itr);
+         // positions after itr have shifted, rebuild on next lookup
+         _index.reset();
       }
    }
 
    /** replaces the value at \a key with \a var or insert's \a key if not found */
    mutable_variant_object& mutable_variant_object::set( string key, variant var ) &
    {
-      auto itr = find( key.c_str() );
+      auto itr = find_key( key );
       if( itr != end() )
       {
          itr->set( fc::move(var) );
       }
       else
       {
-         _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+         push_back( entry( fc::move(key), fc::move(var) ) );
       }
       return *this;
    }
 
    mutable_variant_object mutable_variant_object::set( string key, variant var ) &&
    {
-      auto itr = find( key.c_str() );
+      auto itr = find_key( key );
       if( itr != end() )
       {
          itr->set( fc::move(var) );
       }
       else
       {
-         _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+         push_back( entry( fc::move(key), fc::move(var) ) );
       }
       return std::move(*this);
    }
@@ -360,13 +482,13 @@ namespace fc
     */
    mutable_variant_object& mutable_variant_object::operator()( string key, variant var ) &
    {
-      _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+      push_back( entry( fc::move(key), fc::move(var) ) );
       return *this;
    }
 
    mutable_variant_object mutable_variant_object::operator()( string key, variant var ) &&
    {
-      _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+      push_back( entry( fc::move(key), fc::move(var) ) );
       return std::move(*this);
    }
 
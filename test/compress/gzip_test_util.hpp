@@ -0,0 +1,57 @@
+#pragma once
+#include <fc/compress/zlib.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace gzip_test_util {
+
+   inline uint32_t crc32( const std::string& data ) {
+      uint32_t crc = 0xffffffff;
+      for( unsigned char c : data ) {
+         crc ^= c;
+         for( int k = 0; k < 8; ++k )
+            crc = crc & 1 ? ( crc >> 1 ) ^ 0xedb88320 : crc >> 1;
+      }
+      return ~crc;
+   }
+
+   inline void append_le32( std::string& out, uint32_t v ) {
+      for( int i = 0; i < 4; ++i )
+         out += char( v >> ( 8 * i ) );
+   }
+
+   /// data as a deflate stream without the zlib header and checksum fc::zlib_compress wraps it in
+   inline std::string raw_deflate( const std::string& data ) {
+      const std::string z = fc::zlib_compress( data );
+      return z.substr( 2, z.size() - 6 );
+   }
+
+   /// the optional fields of a gzip header
+   constexpr uint8_t fhcrc = 0x02, fextra = 0x04, fname = 0x08, fcomment = 0x10;
+
+   /// data as a gzip member, with the optional header fields of flags
+   inline std::string gzip( const std::string& data, uint8_t flags = 0 ) {
+      std::string out = { char( 0x1f ), char( 0x8b ), 8, char( flags ), 0, 0, 0, 0, 0, 3 };
+      if( flags & fextra ) {
+         const std::string extra( "AB\x04\0data", 8 );   // one subfield of 4 bytes
+         out += char( extra.size() );
+         out += char( 0 );
+         out += extra;
+      }
+      if( flags & fname )
+         out.append( "name.json", 10 );
+      if( flags & fcomment )
+         out.append( "a comment", 10 );
+      if( flags & fhcrc ) {
+         const uint32_t crc = crc32( out );
+         out += char( crc );
+         out += char( crc >> 8 );
+      }
+      out += raw_deflate( data );
+      append_le32( out, crc32( data ) );
+      append_le32( out, uint32_t( data.size() ) );
+      return out;
+   }
+
+} // namespace gzip_test_util
@@ -0,0 +1,136 @@
+#define BOOST_TEST_MODULE zlib
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
+
+#include "gzip_test_util.hpp"
+
+#include <string>
+
+using namespace fc;
+using namespace gzip_test_util;
+
+namespace {
+
+   /// a body that compresses well but still takes several output chunks
+   std::string sample( size_t size ) {
+      std::string s;
+      for( size_t i = 0; s.size() < size; ++i )
+         s += "{\"block\":" + std::to_string( i ) + ",\"producer\":\"eosio\"},";
+      s.resize( size );
+      return s;
+   }
+
+   std::string inflate( zlib_inflater::format f, const std::string& in, size_t step ) {
+      zlib_inflater inflater( f );
+      std::string out;
+      for( size_t pos = 0; pos < in.size(); pos += step )
+         inflater.write( std::string_view( in ).substr( pos, step ), out );
+      BOOST_CHECK( inflater.done() );
+      return out;
+   }
+
+   std::string error_of( zlib_inflater::format f, const std::string& in ) {
+      try {
+         zlib_inflater inflater( f );
+         std::string out;
+         inflater.write( in, out );
+      } catch( const fc::exception& e ) {
+         return e.to_detail_string();
+      }
+      return std::string();
+   }
+
+}
+
+BOOST_AUTO_TEST_SUITE(zlib_inflater_test)
+
+BOOST_AUTO_TEST_CASE(zlib_test)
+{
+   for( size_t size : { size_t( 0 ), size_t( 1 ), size_t( 100 ), size_t( 200 * 1024 ) } ) {
+      const std::string data = sample( size );
+      const std::string z = zlib_compress( data );
+      BOOST_CHECK( inflate( zlib_inflater::format::zlib, z, z.size() ) == data );
+      BOOST_CHECK( inflate( zlib_inflater::format::zlib, z, 7 ) == data );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(raw_deflate_test)
+{
+   // what some servers send as Content-Encoding: deflate
+   const std::string data = sample( 50000 );
+   const std::string raw = raw_deflate( data );
+   BOOST_CHECK( inflate( zlib_inflater::format::zlib, raw, raw.size() ) == data );
+   BOOST_CHECK( inflate( zlib_inflater::format::zlib, raw, 1 ) == data );
+}
+
+BOOST_AUTO_TEST_CASE(gzip_header_test)
+{
+   const std::string data = sample( 3000 );
+   for( uint8_t flags : std::initializer_list<uint8_t>{ 0, fextra, fname, fcomment, fhcrc, fextra | fname | fcomment | fhcrc } ) {
+      BOOST_TEST_CONTEXT( "flags " << int( flags ) ) {
+         const std::string gz = gzip( data, flags );
+         BOOST_CHECK( inflate( zlib_inflater::format::gzip, gz, gz.size() ) == data );
+         BOOST_CHECK( inflate( zlib_inflater::format::gzip, gz, 1 ) == data );
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(split_test)
+{
+   // the header, the end of the deflate stream and the trailer may each arrive in pieces
+   const std::string data = sample( 500 );
+   for( const auto& [f, encoded] : { std::pair{ zlib_inflater::format::gzip, gzip( data, fextra | fname | fhcrc ) },
+                                     std::pair{ zlib_inflater::format::zlib, zlib_compress( data ) } } ) {
+      for( size_t split = 0; split <= encoded.size(); ++split ) {
+         zlib_inflater inflater( f );
+         std::string out;
+         inflater.write( std::string_view( encoded ).substr( 0, split ), out );
+         BOOST_CHECK_EQUAL( inflater.done(), split == encoded.size() );
+         inflater.write( std::string_view( encoded ).substr( split ), out );
+         BOOST_REQUIRE( inflater.done() );
+         BOOST_REQUIRE( out == data );
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(truncated_test)
+{
+   // a stream cut short is not an error until the caller finds it is not done
+   const std::string data = sample( 2000 );
+   const std::string gz = gzip( data );
+   for( size_t cut : { size_t( 5 ), size_t( 12 ), gz.size() / 2, gz.size() - 8, gz.size() - 1 } ) {
+      zlib_inflater inflater( zlib_inflater::format::gzip );
+      std::string out;
+      inflater.write( gz.substr( 0, cut ), out );
+      BOOST_CHECK( !inflater.done() );
+      BOOST_CHECK( data.compare( 0, out.size(), out ) == 0 );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_test)
+{
+   const std::string data = sample( 2000 );
+
+   std::string bad_crc = gzip( data );
+   bad_crc[bad_crc.size() - 8] ^= 1;
+   BOOST_CHECK( error_of( zlib_inflater::format::gzip, bad_crc ).find( "checksum mismatch" ) != std::string::npos );
+
+   std::string bad_size = gzip( data );
+   bad_size[bad_size.size() - 4] ^= 1;
+   BOOST_CHECK( error_of( zlib_inflater::format::gzip, bad_size ).find( "checksum mismatch" ) != std::string::npos );
+
+   std::string bad_adler = zlib_compress( data );
+   bad_adler.back() ^= 1;
+   BOOST_CHECK( error_of( zlib_inflater::format::zlib, bad_adler ).find( "Corrupt deflate stream" ) != std::string::npos );
+
+   // a final block of the reserved type
+   BOOST_CHECK( error_of( zlib_inflater::format::zlib, std::string( "\x07\x00\x00\x00", 4 ) ).find( "Corrupt deflate stream" ) != std::string::npos );
+
+   std::string not_gzip = gzip( data );
+   not_gzip[1] = 0;
+   BOOST_CHECK( error_of( zlib_inflater::format::gzip, not_gzip ).find( "Not a gzip stream" ) != std::string::npos );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
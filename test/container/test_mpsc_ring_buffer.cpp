@@ -0,0 +1,140 @@
+#define BOOST_TEST_MODULE mpsc_ring_buffer
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/container/mpsc_ring_buffer.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fc;
+
+BOOST_AUTO_TEST_SUITE(mpsc_ring_buffer_test)
+
+BOOST_AUTO_TEST_CASE(capacity_test)
+{
+   BOOST_CHECK_EQUAL( mpsc_ring_buffer<int>( 0 ).capacity(), 2u );
+   BOOST_CHECK_EQUAL( mpsc_ring_buffer<int>( 1 ).capacity(), 2u );
+   BOOST_CHECK_EQUAL( mpsc_ring_buffer<int>( 8 ).capacity(), 8u );
+   BOOST_CHECK_EQUAL( mpsc_ring_buffer<int>( 9 ).capacity(), 16u );
+}
+
+BOOST_AUTO_TEST_CASE(full_empty_test)
+{
+   mpsc_ring_buffer<std::string> q( 4 );
+   BOOST_CHECK( !q.try_pop() );
+   BOOST_CHECK_EQUAL( q.size_approx(), 0u );
+
+   for( int i = 0; i < 4; ++i ) {
+      std::string s = "value " + std::to_string( i );
+      BOOST_CHECK( q.try_push( std::move( s ) ) );
+   }
+   BOOST_CHECK_EQUAL( q.size_approx(), 4u );
+
+   // a failed push leaves its value alone
+   std::string rejected = "rejected";
+   BOOST_CHECK( !q.try_push( std::move( rejected ) ) );
+   BOOST_CHECK_EQUAL( rejected, "rejected" );
+
+   // room for one more once one is popped
+   BOOST_CHECK_EQUAL( *q.try_pop(), "value 0" );
+   BOOST_CHECK( q.try_push( std::move( rejected ) ) );
+   BOOST_CHECK( !q.try_push( std::string( "full again" ) ) );
+
+   for( int i = 1; i < 4; ++i )
+      BOOST_CHECK_EQUAL( *q.try_pop(), "value " + std::to_string( i ) );
+   BOOST_CHECK_EQUAL( *q.try_pop(), "rejected" );
+   BOOST_CHECK( !q.try_pop() );
+   BOOST_CHECK_EQUAL( q.size_approx(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE(wrap_test)
+{
+   // the positions go around the slots many times, with the queue at every fill level
+   mpsc_ring_buffer<uint64_t> q( 8 );
+   uint64_t pushed = 0, popped = 0;
+   for( int round = 0; round < 1000; ++round ) {
+      const int n = 1 + round % 8;
+      for( int i = 0; i < n; ++i )
+         BOOST_REQUIRE( q.try_push( uint64_t( pushed++ ) ) );
+      for( int i = 0; i < n; ++i ) {
+         auto v = q.try_pop();
+         BOOST_REQUIRE( v );
+         BOOST_REQUIRE_EQUAL( *v, popped++ );
+      }
+      BOOST_REQUIRE( !q.try_pop() );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(destroy_test)
+{
+   // elements left in the queue are destroyed with it
+   auto counted = std::make_shared<int>( 0 );
+   {
+      mpsc_ring_buffer<std::shared_ptr<int>> q( 4 );
+      for( int i = 0; i < 3; ++i )
+         BOOST_CHECK( q.try_push( std::shared_ptr<int>( counted ) ) );
+      BOOST_CHECK( q.try_pop() );
+      BOOST_CHECK_EQUAL( counted.use_count(), 3 );
+   }
+   BOOST_CHECK_EQUAL( counted.use_count(), 1 );
+}
+
+BOOST_AUTO_TEST_CASE(move_only_test)
+{
+   mpsc_ring_buffer<std::unique_ptr<int>> q( 2 );
+   BOOST_CHECK( q.try_push( std::make_unique<int>( 7 ) ) );
+   auto v = q.try_pop();
+   BOOST_REQUIRE( v && *v );
+   BOOST_CHECK_EQUAL( **v, 7 );
+}
+
+BOOST_AUTO_TEST_CASE(multi_producer_test)
+{
+   constexpr uint32_t producers = 4;
+   constexpr uint32_t per_producer = 100000;
+   mpsc_ring_buffer<uint64_t> q( 256 );
+
+   std::atomic<uint32_t> done{0};
+   std::atomic<uint64_t> full{0};
+   std::vector<std::thread> threads;
+   for( uint32_t p = 0; p < producers; ++p ) {
+      threads.emplace_back( [&, p]() {
+         for( uint32_t i = 0; i < per_producer; ++i ) {
+            uint64_t v = ( uint64_t( p ) << 32 ) | i;
+            while( !q.try_push( std::move( v ) ) ) {
+               full.fetch_add( 1, std::memory_order_relaxed );
+               std::this_thread::yield();
+            }
+         }
+         done.fetch_add( 1 );
+      } );
+   }
+
+   // every element arrives once, and those of one producer in the order it pushed them
+   std::vector<uint32_t> next( producers, 0 );
+   uint64_t received = 0;
+   while( received < uint64_t( producers ) * per_producer ) {
+      auto v = q.try_pop();
+      if( !v ) {
+         std::this_thread::yield();
+         continue;
+      }
+      const uint32_t p = *v >> 32;
+      BOOST_REQUIRE_LT( p, producers );
+      BOOST_REQUIRE_EQUAL( uint32_t( *v ), next[p] );
+      ++next[p];
+      ++received;
+   }
+   for( auto& t : threads )
+      t.join();
+   BOOST_CHECK_EQUAL( done.load(), producers );
+   BOOST_CHECK( !q.try_pop() );
+   for( uint32_t p = 0; p < producers; ++p )
+      BOOST_CHECK_EQUAL( next[p], per_producer );
+   BOOST_TEST_MESSAGE( "producers found the queue full " << full.load() << " times" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
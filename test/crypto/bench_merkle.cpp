@@ -0,0 +1,90 @@
+/**
+ *  Computes the Merkle root of 1k, 100k and 10M leaves with a loop of sha256::hash( std::make_pair( a, b ) ),
+ *  the way consumers of fc did it, and with merkle_root on the calling thread only and on the pool of fc.
+ *  Then grows a merkle_tree of each size by single leaves and prints the cost of an append with its root.
+ *
+ *  bench_merkle [max leaves] [appends]
+ */
+#include <fc/crypto/merkle.hpp>
+#include <fc/io/raw.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   double seconds( const std::function<void()>& run ) {
+      const auto start = bench_clock::now();
+      run();
+      return std::chrono::duration<double>( bench_clock::now() - start ).count();
+   }
+
+   sha256 pair_loop_root( std::vector<sha256> level ) {
+      if( level.empty() )
+         return sha256();
+      while( level.size() > 1 ) {
+         if( level.size() % 2 )
+            level.push_back( level.back() );
+         for( size_t i = 0; i < level.size() / 2; ++i )
+            level[i] = sha256::hash( std::make_pair( level[2 * i], level[2 * i + 1] ) );
+         level.resize( level.size() / 2 );
+      }
+      return level.front();
+   }
+
+} // namespace
+
+int main( int argc, char** argv ) {
+   const size_t max_leaves = argc > 1 ? std::stoul( argv[1] ) : 10000000;
+   const size_t appends    = std::max<size_t>( argc > 2 ? std::stoul( argv[2] ) : 1000, 2 );
+
+   printf( "sha256 kernel %s, %u hardware threads\n", sha256::hash_many_kernel(), std::thread::hardware_concurrency() );
+   printf( "%10s %14s %14s %14s %14s %16s\n", "leaves", "pair loop ms", "1 thread ms", "pool ms", "speedup",
+           "append+root us" );
+   for( size_t n : { size_t( 1000 ), size_t( 100000 ), size_t( 10000000 ) } ) {
+      if( n > max_leaves )
+         break;
+      std::vector<sha256> leaves( n );
+      for( size_t i = 0; i < n; ++i )
+         leaves[i] = sha256::hash( uint64_t( i ) );
+
+      sha256 expected, single, pooled;
+      const double loop_s   = seconds( [&]() { expected = pair_loop_root( leaves ); } );
+      const double single_s = seconds( [&]() { single = merkle_root( leaves, {}, 0 ); } );
+      const double pool_s   = seconds( [&]() { pooled = merkle_root( leaves ); } );
+      if( single != expected || pooled != expected ) {
+         printf( "merkle_root of %zu leaves differs from the pair loop\n", n );
+         return 1;
+      }
+
+      // the first append reallocates the levels built to size by the constructor, leave it out
+      merkle_tree tree( leaves );
+      tree.append( sha256::hash( uint64_t( n ) ) );
+      sha256 root;
+      const double append_s = seconds( [&]() {
+         for( size_t i = 1; i < appends; ++i ) {
+            tree.append( sha256::hash( uint64_t( n + i ) ) );
+            root = tree.root();
+         }
+      } );
+      for( size_t i = 0; i < appends; ++i )
+         leaves.push_back( sha256::hash( uint64_t( n + i ) ) );
+      if( root != merkle_root( std::move( leaves ) ) ) {
+         printf( "merkle_tree of %zu leaves differs from merkle_root\n", n );
+         return 1;
+      }
+
+      printf( "%10zu %14.2f %14.2f %14.2f %13.2fx %16.2f\n", n, loop_s * 1e3, single_s * 1e3, pool_s * 1e3,
+              loop_s / pool_s, append_s * 1e6 / ( appends - 1 ) );
+      fflush( stdout );
+   }
+   return 0;
+}
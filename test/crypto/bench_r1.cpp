@@ -0,0 +1,142 @@
+/**
+ *  Compares the R1 (P-256) recovery, signing and verification of fc with the per call EC_KEY and
+ *  BN_CTX path they replaced, and checks that both recover the same keys.
+ *
+ *  bench_r1 [signatures]
+ */
+#include <fc/crypto/elliptic_r1.hpp>
+#include <fc/crypto/openssl.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fc;
+using namespace fc::crypto;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   template<typename F>
+   double per_call_us( size_t n, F&& f ) {
+      const auto start = bench_clock::now();
+      for( size_t i = 0; i < n; ++i )
+         f( i );
+      return std::chrono::duration<double, std::micro>( bench_clock::now() - start ).count() / n;
+   }
+
+   void print( const char* name, double openssl_us, double fc_us ) {
+      std::printf( "%-14s %10.1f us %10.1f us %7.2fx\n", name, openssl_us, fc_us, openssl_us / fc_us );
+   }
+
+   ecdsa_sig to_ecdsa( const r1::compact_signature& c ) {
+      ecdsa_sig sig = ECDSA_SIG_new();
+      BIGNUM *r = BN_new(), *s = BN_new();
+      BN_bin2bn( &c.data[1], 32, r );
+      BN_bin2bn( &c.data[33], 32, s );
+      ECDSA_SIG_set0( sig, r, s );
+      return sig;
+   }
+
+   r1::public_key_data serialize( EC_KEY* key ) {
+      r1::public_key_data dat;
+      EC_KEY_set_conv_form( key, POINT_CONVERSION_COMPRESSED );
+      char* front = &dat.data[0];
+      i2o_ECPublicKey( key, (unsigned char**)&front );
+      return dat;
+   }
+
+   /// recovery as fc did it: a new EC_KEY, group and BN_CTX per call
+   r1::public_key_data openssl_recover( const r1::compact_signature& c, const sha256& digest ) {
+      ecdsa_sig sig = to_ecdsa( c );
+      ec_key key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+      if( r1::ECDSA_SIG_recover_key_GFp( key, sig, (unsigned char*)&digest, sizeof(digest), ( c.data[0] - 27 ) & 3, 0 ) != 1 )
+         return r1::public_key_data();
+      return serialize( key );
+   }
+
+   /// signing as fc did it: each recovery id is tried until one recovers the key
+   int openssl_sign( EC_KEY* key, const r1::public_key_data& pub, const sha256& digest ) {
+      ecdsa_sig sig = ECDSA_do_sign( (unsigned char*)&digest, sizeof(digest), key );
+      for( int i = 0; i < 4; ++i ) {
+         ec_key rec = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+         if( r1::ECDSA_SIG_recover_key_GFp( rec, sig, (unsigned char*)&digest, sizeof(digest), i, 1 ) == 1 && serialize( rec ) == pub )
+            return i;
+      }
+      return -1;
+   }
+
+   bool openssl_verify( const r1::public_key_data& pub, const sha256& digest, const r1::signature& sig ) {
+      ec_key key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+      const unsigned char* front = (const unsigned char*)pub.data;
+      EC_KEY* k = key;
+      o2i_ECPublicKey( &k, &front, sizeof(pub) );
+      return 1 == ECDSA_verify( 0, (unsigned char*)&digest, sizeof(digest), (unsigned char*)&sig, 2 + (unsigned char)sig.data[1], key );
+   }
+
+} // namespace
+
+int main( int argc, char** argv ) {
+   const size_t count = argc > 1 ? std::atoi( argv[1] ) : 2000;
+
+   std::vector<r1::private_key> keys;
+   std::vector<r1::public_key_data> pubs;
+   for( int i = 0; i < 8; ++i ) {
+      keys.push_back( r1::private_key::generate() );
+      pubs.push_back( keys.back().get_public_key().serialize() );
+   }
+   std::vector<sha256> digests;
+   std::vector<r1::compact_signature> sigs;
+   std::vector<r1::signature> der;
+   for( size_t i = 0; i < count; ++i ) {
+      digests.push_back( sha256::hash( std::to_string( i ) ) );
+      sigs.push_back( keys[i % keys.size()].sign_compact( digests[i] ) );
+      der.push_back( keys[i % keys.size()].sign( digests[i] ) );
+   }
+
+   size_t mismatches = 0;
+   for( size_t i = 0; i < count; ++i ) {
+      const auto expected = pubs[i % pubs.size()];
+      mismatches += openssl_recover( sigs[i], digests[i] ) != expected;
+      mismatches += r1::recover_public_key_data( sigs[i], digests[i] ) != expected;
+      mismatches += r1::public_key( sigs[i], digests[i] ).serialize() != expected;
+   }
+
+   std::printf( "%zu signatures          openssl         fc\n", count );
+   print( "recover",
+          per_call_us( count, [&]( size_t i ) { openssl_recover( sigs[i], digests[i] ); } ),
+          per_call_us( count, [&]( size_t i ) { r1::recover_public_key_data( sigs[i], digests[i] ); } ) );
+
+   std::vector<std::unique_ptr<EC_KEY, decltype(&EC_KEY_free)>> openssl_keys;
+   for( const auto& k : keys ) {
+      EC_KEY* key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+      openssl_keys.emplace_back( key, &EC_KEY_free );
+      ssl_bignum bn;
+      const sha256 secret = k.get_secret();
+      BN_bin2bn( (const unsigned char*)&secret, sizeof(secret), bn );
+      ec_point pub( EC_POINT_new( EC_KEY_get0_group( key ) ) );
+      EC_POINT_mul( EC_KEY_get0_group( key ), pub, bn, nullptr, nullptr, nullptr );
+      EC_KEY_set_private_key( key, bn );
+      EC_KEY_set_public_key( key, pub );
+   }
+   print( "sign_compact",
+          per_call_us( count, [&]( size_t i ) {
+             mismatches += openssl_sign( openssl_keys[i % keys.size()].get(), pubs[i % keys.size()], digests[i] ) < 0;
+          } ),
+          per_call_us( count, [&]( size_t i ) { sigs[i] = keys[i % keys.size()].sign_compact( digests[i] ); } ) );
+   for( size_t i = 0; i < count; ++i )
+      mismatches += r1::recover_public_key_data( sigs[i], digests[i] ) != pubs[i % pubs.size()];
+
+   print( "verify",
+          per_call_us( count, [&]( size_t i ) { mismatches += !openssl_verify( pubs[i % pubs.size()], digests[i], der[i] ); } ),
+          per_call_us( count, [&]( size_t i ) { mismatches += !r1::public_key( pubs[i % pubs.size()] ).verify( digests[i], der[i] ); } ) );
+
+   if( mismatches ) {
+      std::printf( "\n%zu results differ from the expected keys\n", mismatches );
+      return 1;
+   }
+   return 0;
+}
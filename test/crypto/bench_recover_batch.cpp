@@ -0,0 +1,112 @@
+/**
+ *  Recovers a batch of K1 and R1 signatures, alternating, with public_key::recover_batch on 1 up to
+ *  N cores and prints the throughput next to the one of recovering them one by one.
+ *
+ *  bench_recover_batch [signatures] [max cores] [rounds]
+ *
+ *  Defaults are 10000 signatures, every core of the machine and 3 rounds, the best round is kept.
+ */
+#include <fc/crypto/private_key.hpp>
+#include <fc/crypto/public_key.hpp>
+#include <fc/crypto/signature.hpp>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace fc::crypto;
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   std::vector<public_key::recovery_item> make_items( uint32_t count, std::vector<public_key>& keys ) {
+      // a few keys of each type sign all the digests, signing is not what is measured
+      std::vector<private_key> signers;
+      for( uint32_t i = 0; i < 16; ++i )
+         signers.push_back( i % 2 ? private_key::generate<r1::private_key_shim>() : private_key::generate<ecc::private_key_shim>() );
+      std::vector<public_key::recovery_item> items;
+      items.reserve( count );
+      for( uint32_t i = 0; i < count; ++i ) {
+         const auto digest = sha256::hash( i );
+         const auto& signer = signers[i % signers.size()];
+         items.emplace_back( signer.sign( digest ), digest );
+         keys.push_back( signer.get_public_key() );
+      }
+      return items;
+   }
+
+   template<typename F>
+   double best_seconds( uint32_t rounds, F&& f ) {
+      double best = 0;
+      for( uint32_t r = 0; r < rounds; ++r ) {
+         const auto start = bench_clock::now();
+         f();
+         const double s = std::chrono::duration<double>( bench_clock::now() - start ).count();
+         best = r ? std::min( best, s ) : s;
+      }
+      return best;
+   }
+
+   bool check( const std::vector<recovered_key>& results, const std::vector<public_key>& keys ) {
+      for( size_t i = 0; i < results.size(); ++i ) {
+         if( !results[i].ok() || !( results[i].key == keys[i] ) )
+            return false;
+      }
+      return results.size() == keys.size();
+   }
+
+   void print( const char* name, uint32_t count, double seconds, double base ) {
+      std::printf( "%-22s %9.1f ms %10.0f keys/s %6.2fx\n", name, seconds * 1000, count / seconds, base / seconds );
+   }
+
+} // namespace
+
+int main( int argc, char** argv ) {
+   const uint32_t count  = argc > 1 ? std::atoi( argv[1] ) : 10000;
+   const uint32_t cores  = argc > 2 ? std::atoi( argv[2] ) : std::max( std::thread::hardware_concurrency(), 1u );
+   const uint32_t rounds = argc > 3 ? std::atoi( argv[3] ) : 3;
+
+   std::vector<public_key> keys;
+   const auto items = make_items( count, keys );
+   std::printf( "%u signatures, half K1 and half R1, best of %u rounds\n\n", count, rounds );
+
+   const double base = best_seconds( rounds, [&]() {
+      for( const auto& item : items )
+         public_key( item.first, item.second );
+   } );
+   print( "one by one", count, base, base );
+
+   bool ok = true;
+   for( uint32_t c = 1; c <= cores; ++c ) {
+      // the calling thread is one of the cores
+      boost::asio::thread_pool pool( c );
+      const public_key::executor_type executor = [&pool]( std::function<void()> task ) {
+         boost::asio::post( pool, std::move( task ) );
+      };
+      std::vector<recovered_key> results;
+      const double s = best_seconds( rounds, [&]() {
+         results = public_key::recover_batch( items.data(), items.size(), executor, c - 1 );
+      } );
+      ok = ok && check( results, keys );
+      const std::string name = "batch, " + std::to_string( c ) + ( c == 1 ? " core" : " cores" );
+      print( name.c_str(), count, s, base );
+   }
+
+   std::vector<recovered_key> results;
+   const double s = best_seconds( rounds, [&]() { results = public_key::recover_batch( items ); } );
+   ok = ok && check( results, keys );
+   print( "batch, fc pool", count, s, base );
+
+   if( !ok ) {
+      std::printf( "\nrecovered keys do not match the signing keys\n" );
+      return 1;
+   }
+   return 0;
+}
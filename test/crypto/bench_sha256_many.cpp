@@ -0,0 +1,81 @@
+/**
+ *  Hashes 64 byte inputs one at a time with sha256::hash, and with sha256::hash_many and sha256::hash_pairs
+ *  on each kernel this CPU can run, and prints the time per input.
+ *
+ *  bench_sha256_many [inputs] [rounds]
+ */
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/raw.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   /// best of rounds, in ns per input
+   double time_per_input( size_t inputs, uint32_t rounds, const std::function<void()>& run ) {
+      double best = 0;
+      for( uint32_t r = 0; r < rounds; ++r ) {
+         const auto start = bench_clock::now();
+         run();
+         const double ns = std::chrono::duration<double, std::nano>( bench_clock::now() - start ).count() / inputs;
+         best = r == 0 ? ns : std::min( best, ns );
+      }
+      return best;
+   }
+
+} // namespace
+
+int main( int argc, char** argv ) {
+   const size_t   inputs = argc > 1 ? std::stoul( argv[1] ) : 1000000;
+   const uint32_t rounds = argc > 2 ? std::stoul( argv[2] ) : 3;
+
+   // the inputs are also the node pairs of hash_pairs
+   std::vector<sha256> nodes( 2 * inputs );
+   for( size_t i = 0; i < nodes.size(); ++i )
+      nodes[i] = sha256::hash( uint64_t( i ) );
+   std::vector<sha256::const_buffer> in( inputs );
+   for( size_t i = 0; i < inputs; ++i )
+      in[i] = { nodes[2 * i].data(), 64 };
+   std::vector<sha256> out( inputs ), expected( inputs );
+
+   const double one_at_a_time = time_per_input( inputs, rounds, [&]() {
+      for( size_t i = 0; i < inputs; ++i )
+         expected[i] = sha256::hash( in[i].data, in[i].size );
+   } );
+
+   printf( "%zu inputs of 64 bytes, default kernel %s\n", inputs, sha256::hash_many_kernel() );
+   printf( "%-22s %10s %10s %8s\n", "", "ns/input", "MB/s", "speedup" );
+   auto report = [&]( const std::string& name, double ns ) {
+      printf( "%-22s %10.1f %10.1f %7.2fx\n", name.c_str(), ns, 64 * 1000.0 / ns, one_at_a_time / ns );
+   };
+   report( "sha256::hash", one_at_a_time );
+
+   const auto kernels = sha256::hash_many_kernels();
+   for( const auto& kernel : kernels ) {
+      sha256::use_hash_many_kernel( kernel );
+      report( "hash_many " + kernel, time_per_input( inputs, rounds, [&]() {
+         sha256::hash_many( in.data(), inputs, out.data() );
+      } ) );
+      if( out != expected ) {
+         printf( "hash_many %s differs from sha256::hash\n", kernel.c_str() );
+         return 1;
+      }
+      report( "hash_pairs " + kernel, time_per_input( inputs, rounds, [&]() {
+         sha256::hash_pairs( nodes.data(), inputs, out.data() );
+      } ) );
+      if( out != expected ) {
+         printf( "hash_pairs %s differs from sha256::hash\n", kernel.c_str() );
+         return 1;
+      }
+   }
+   sha256::use_hash_many_kernel( kernels.front() );
+   return 0;
+}
@@ -1,12 +1,15 @@
 #define BOOST_TEST_MODULE cypher_suites
 #include <boost/test/included/unit_test.hpp>
 
+#include <fc/crypto/merkle.hpp>
 #include <fc/crypto/public_key.hpp>
 #include <fc/crypto/private_key.hpp>
+#include <fc/crypto/recovery_cache.hpp>
 #include <fc/crypto/signature.hpp>
 #include <fc/utility.hpp>
 
 #include <fstream>
+#include <thread>
 
 using namespace fc::crypto;
 using namespace fc;
@@ -58,6 +61,23 @@ BOOST_AUTO_TEST_CASE(test_r1_recovery) try {
    BOOST_CHECK_EQUAL(recovered_pub.to_string(), pub.to_string());
 } FC_LOG_AND_RETHROW();
 
+BOOST_AUTO_TEST_CASE(test_r1_sign_verify) try {
+   auto key = r1::private_key::generate();
+   auto pub = key.get_public_key();
+   auto pub_data = pub.serialize();
+   // enough signatures for every recovery id and DER length to come up
+   for (uint32_t i = 0; i < 64; ++i) {
+      auto digest = sha256::hash(i);
+      auto compact = key.sign_compact(digest);
+      BOOST_CHECK(r1::public_key(compact, digest).serialize() == pub_data);
+      BOOST_CHECK(r1::recover_public_key_data(compact, digest) == pub_data);
+
+      auto der = key.sign(digest);
+      BOOST_CHECK(pub.verify(digest, der));
+      BOOST_CHECK(!pub.verify(sha256::hash(i + 1000), der));
+   }
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_CASE(test_k1_recyle) try {
    auto key = private_key::generate<ecc::private_key_shim>();
    auto pub = key.get_public_key();
@@ -80,6 +100,88 @@ BOOST_AUTO_TEST_CASE(test_r1_recyle) try {
    BOOST_CHECK_EQUAL(pub.to_string(), recycled_pub.to_string());
 } FC_LOG_AND_RETHROW();
 
+BOOST_AUTO_TEST_CASE(test_recover_batch) try {
+   std::vector<public_key::recovery_item> items;
+   std::vector<public_key> expected;
+   for (uint32_t i = 0; i < 100; ++i) {
+      auto digest = sha256::hash(i);
+      auto key = i % 2 ? private_key::generate<r1::private_key_shim>() : private_key::generate<ecc::private_key_shim>();
+      items.emplace_back(key.sign(digest), digest);
+      expected.push_back(key.get_public_key());
+   }
+   // a default signature cannot be recovered
+   items[37].first = signature();
+
+   auto results = public_key::recover_batch(items);
+   BOOST_REQUIRE_EQUAL(results.size(), items.size());
+   for (size_t i = 0; i < results.size(); ++i) {
+      BOOST_CHECK_EQUAL(results[i].ok(), i != 37);
+      if (results[i].ok())
+         BOOST_CHECK_EQUAL(results[i].key.to_string(), expected[i].to_string());
+   }
+   BOOST_CHECK_THROW(std::rethrow_exception(results[37].error), fc::exception);
+
+   // on the calling thread only, and on an executor running each task on its own thread
+   std::vector<std::thread> threads;
+   auto on_thread = [&threads](std::function<void()> task) { threads.emplace_back(std::move(task)); };
+   for (size_t helpers : {0, 3}) {
+      auto again = public_key::recover_batch(items.data(), items.size(), on_thread, helpers);
+      for (auto& t : threads)
+         t.join();
+      threads.clear();
+      BOOST_REQUIRE_EQUAL(again.size(), items.size());
+      for (size_t i = 0; i < again.size(); ++i)
+         BOOST_CHECK(again[i].ok() ? again[i].key == results[i].key : !results[i].ok());
+   }
+
+   BOOST_CHECK(public_key::recover_batch(items.data(), 0).empty());
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(test_recovery_cache) try {
+   std::vector<std::pair<signature, sha256>> items;
+   std::vector<public_key> expected;
+   for (uint32_t i = 0; i < 8; ++i) {
+      auto digest = sha256::hash(i);
+      auto key = i % 2 ? private_key::generate<r1::private_key_shim>() : private_key::generate<ecc::private_key_shim>();
+      items.emplace_back(key.sign(digest), digest);
+      expected.push_back(key.get_public_key());
+   }
+
+   // off by default
+   public_key(items[0].first, items[0].second);
+   BOOST_CHECK(!recovery_cache::enabled());
+   BOOST_CHECK_EQUAL(recovery_cache::get_stats().misses, 0u);
+
+   recovery_cache::set_capacity(1000);
+   for (int round = 0; round < 3; ++round) {
+      for (size_t i = 0; i < items.size(); ++i)
+         BOOST_CHECK_EQUAL(public_key(items[i].first, items[i].second).to_string(), expected[i].to_string());
+   }
+   auto stats = recovery_cache::get_stats();
+   BOOST_CHECK_EQUAL(stats.misses, items.size());
+   BOOST_CHECK_EQUAL(stats.hits, 2 * items.size());
+   BOOST_CHECK_EQUAL(stats.size, items.size());
+   BOOST_CHECK_EQUAL(stats.capacity, 1000u);
+
+   // another digest or canonical check is another entry, failures are not cached
+   public_key(items[0].first, items[0].second, false);
+   BOOST_CHECK_THROW(public_key(signature(), items[0].second), fc::exception);
+   BOOST_CHECK_THROW(public_key(signature(), items[0].second), fc::exception);
+   stats = recovery_cache::get_stats();
+   BOOST_CHECK_EQUAL(stats.misses, items.size() + 3);
+   BOOST_CHECK_EQUAL(stats.size, items.size() + 1);
+
+   // a capacity below the size evicts
+   recovery_cache::set_capacity(1);
+   BOOST_CHECK_LE(recovery_cache::get_stats().size, 1u);
+   BOOST_CHECK_GE(recovery_cache::get_stats().evictions, items.size());
+
+   recovery_cache::set_capacity(0);
+   BOOST_CHECK(!recovery_cache::enabled());
+   BOOST_CHECK_EQUAL(recovery_cache::get_stats().size, 0u);
+   BOOST_CHECK_EQUAL(public_key(items[1].first, items[1].second).to_string(), expected[1].to_string());
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_CASE(test_sha256_ifstream) try {
    std::string payload = "Test Cases";
    std::string tmpfile = "test_sha256_ifstream.tmp";
@@ -111,4 +213,103 @@ BOOST_AUTO_TEST_CASE(test_sha256_ifstream_large) try {
    BOOST_CHECK_EQUAL(digest.str(), expected);
 } FC_LOG_AND_RETHROW();
 
+BOOST_AUTO_TEST_CASE(test_sha256_hash_many) try {
+   std::string data(5000, '\0');
+   for (size_t i = 0; i < data.size(); ++i)
+      data[i] = char(i * 131 + 7);
+   // lengths around the block and padding boundaries, then enough of all sizes to refill every lane
+   std::vector<sha256::const_buffer> in;
+   for (size_t size : {0, 1, 55, 56, 57, 63, 64, 65, 119, 120, 128, 1000, 4999})
+      in.push_back({data.data(), size});
+   for (size_t i = 0; i < 200; ++i)
+      in.push_back({data.data() + i, i * 37 % 300});
+   std::vector<sha256> nodes;
+   for (uint32_t i = 0; i < 2 * 37; ++i)
+      nodes.push_back(sha256::hash(i));
+
+   const auto kernels = sha256::hash_many_kernels();
+   BOOST_REQUIRE(!kernels.empty());
+   BOOST_CHECK_EQUAL(kernels.front(), sha256::hash_many_kernel());
+   BOOST_CHECK_EQUAL(kernels.back(), "openssl");
+   BOOST_CHECK(!sha256::use_hash_many_kernel("none"));
+   for (const auto& kernel : kernels) {
+      BOOST_TEST_CONTEXT(kernel) {
+         BOOST_REQUIRE(sha256::use_hash_many_kernel(kernel));
+         std::vector<sha256> out;
+         sha256::hash_many(in, out);
+         BOOST_REQUIRE_EQUAL(out.size(), in.size());
+         for (size_t i = 0; i < in.size(); ++i)
+            BOOST_CHECK_EQUAL(out[i].str(), sha256::hash(in[i].data, in[i].size).str());
+
+         // every count of pairs up to a few full rounds of the widest kernel, and in place
+         for (size_t pairs = 0; pairs <= nodes.size() / 2; ++pairs) {
+            std::vector<sha256> parents(pairs);
+            sha256::hash_pairs(nodes.data(), pairs, parents.data());
+            for (size_t i = 0; i < pairs; ++i)
+               BOOST_CHECK(parents[i] == sha256::hash(std::make_pair(nodes[2 * i], nodes[2 * i + 1])));
+            auto level = nodes;
+            sha256::hash_pairs(level.data(), pairs, level.data());
+            BOOST_CHECK(std::equal(parents.begin(), parents.end(), level.begin()));
+         }
+      }
+   }
+   sha256::use_hash_many_kernel(kernels.front());
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(test_merkle) try {
+   // the loop each consumer used to write
+   auto reference_root = [](std::vector<sha256> level) {
+      if (level.empty())
+         return sha256();
+      while (level.size() > 1) {
+         if (level.size() % 2)
+            level.push_back(level.back());
+         std::vector<sha256> parents;
+         for (size_t i = 0; i < level.size(); i += 2)
+            parents.push_back(sha256::hash(std::make_pair(level[i], level[i + 1])));
+         level = std::move(parents);
+      }
+      return level.front();
+   };
+   std::vector<sha256> leaves;
+   for (uint32_t i = 0; i < 50000; ++i)
+      leaves.push_back(sha256::hash(i));
+
+   BOOST_CHECK(merkle_root({}) == sha256());
+   BOOST_CHECK(merkle_root({leaves[0]}) == leaves[0]);
+   for (size_t n = 2; n <= 40; ++n) {
+      const std::vector<sha256> prefix(leaves.begin(), leaves.begin() + n);
+      BOOST_CHECK(merkle_root(prefix) == reference_root(prefix));
+   }
+
+   // levels wide enough to be split between threads
+   const auto expected = reference_root(leaves);
+   BOOST_CHECK(merkle_root(leaves) == expected);
+   std::vector<std::thread> threads;
+   auto on_thread = [&threads](std::function<void()> task) { threads.emplace_back(std::move(task)); };
+   for (size_t helpers : {0, 3}) {
+      BOOST_CHECK(merkle_root(leaves, on_thread, helpers) == expected);
+      for (auto& t : threads)
+         t.join();
+      threads.clear();
+   }
+
+   // a tree grown a leaf or a batch at a time has the root of all its leaves at every step
+   merkle_tree tree;
+   BOOST_CHECK(tree.root() == sha256());
+   size_t size = 0;
+   for (size_t batch : {1, 1, 1, 2, 5, 1, 8, 100, 1, 3, 20000, 1, 29876}) {
+      if (batch == 1)
+         tree.append(leaves[size]);
+      else
+         tree.append(leaves.data() + size, batch);
+      size += batch;
+      BOOST_REQUIRE_EQUAL(tree.size(), size);
+      BOOST_CHECK(tree.root() == merkle_root(std::vector<sha256>(leaves.begin(), leaves.begin() + size)));
+   }
+   BOOST_CHECK(tree.root() == expected);
+   BOOST_CHECK(tree.leaves() == leaves);
+   BOOST_CHECK(merkle_tree(leaves).root() == expected);
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+/**
+ *  Encodes and decodes a transaction-like struct with 20 actions through fc::variant, with
+ *  json::to_string( variant(v) ) and json::from_string( s ).as<T>(), and directly with json_codec,
+ *  and prints the time per call of each.
+ *
+ *  bench_json_codec [iterations]
+ */
+#include <fc/io/json_codec.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace bench {
+   struct permission_level {
+      std::string actor;
+      std::string permission;
+   };
+
+   struct action {
+      std::string                    account;
+      std::string                    name;
+      std::vector<permission_level>  authorization;
+      std::string                    data;
+   };
+
+   struct transaction {
+      std::string               expiration;
+      uint16_t                  ref_block_num = 0;
+      uint32_t                  ref_block_prefix = 0;
+      uint32_t                  max_net_usage_words = 0;
+      uint8_t                   max_cpu_usage_ms = 0;
+      uint32_t                  delay_sec = 0;
+      std::vector<action>       actions;
+      std::vector<std::string>  signatures;
+   };
+}
+
+FC_REFLECT( bench::permission_level, (actor)(permission) )
+FC_REFLECT( bench::action, (account)(name)(authorization)(data) )
+FC_REFLECT( bench::transaction, (expiration)(ref_block_num)(ref_block_prefix)(max_net_usage_words)(max_cpu_usage_ms)(delay_sec)(actions)(signatures) )
+FC_JSON_CODEC( bench::permission_level )
+FC_JSON_CODEC( bench::action )
+FC_JSON_CODEC( bench::transaction )
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   /// keeps the results alive so the calls are not optimized away
+   volatile size_t sink_size = 0;
+
+   bench::transaction make_transaction() {
+      bench::transaction t;
+      t.expiration = "2026-10-17T10:22:14";
+      t.ref_block_num = 12345;
+      t.ref_block_prefix = 3735928559u;
+      t.max_cpu_usage_ms = 5;
+      for( int i = 0; i < 20; ++i ) {
+         bench::action a;
+         a.account = "eosio.token";
+         a.name = "transfer";
+         a.authorization = { { "alice" + std::to_string( i ), "active" } };
+         a.data = std::string( 128, "0123456789abcdef"[i % 16] );
+         t.actions.push_back( std::move( a ) );
+      }
+      t.signatures = { "SIG_K1_" + std::string( 94, 'K' ) };
+      return t;
+   }
+
+   template<typename F>
+   void measure( const char* name, size_t n, F&& f ) {
+      size_t size = 0;
+      for( size_t i = 0; i < n / 10; ++i )   // warm up
+         size += f();
+      const auto start = bench_clock::now();
+      for( size_t i = 0; i < n; ++i )
+         size += f();
+      const double us = std::chrono::duration<double, std::micro>( bench_clock::now() - start ).count() / n;
+      sink_size = sink_size + size;
+      printf( "%-28s %10.2f us\n", name, us );
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   const size_t n = argc > 1 ? std::stoul( argv[1] ) : 10000;
+   const bench::transaction t = make_transaction();
+   const std::string doc = json::to_string( variant( t ), fc::time_point::maximum() );
+   printf( "transaction of %zu bytes, %zu actions\n", doc.size(), t.actions.size() );
+
+   measure( "encode through variant", n, [&]() {
+      return json::to_string( variant( t ), fc::time_point::maximum() ).size();
+   } );
+   measure( "encode with json_codec", n, [&]() {
+      return json_codec::to_string( t ).size();
+   } );
+   std::string buffer;
+   measure( "json_codec into a buffer", n, [&]() {
+      buffer.clear();
+      json_codec::to_buffer( buffer, t );
+      return buffer.size();
+   } );
+
+   measure( "decode through variant", n, [&]() {
+      return json::from_string( doc ).as<bench::transaction>().actions.size();
+   } );
+   measure( "decode with json_codec", n, [&]() {
+      return json_codec::from_string<bench::transaction>( doc ).actions.size();
+   } );
+   return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ *  Parses a block-like JSON document of about 4MB into a variant with json::from_string, and
+ *  through json::parse_events into a handler that only counts the values, and prints the time
+ *  and throughput of each.
+ *
+ *  bench_json_parse [runs]
+ */
+#include <fc/io/json.hpp>
+#include <fc/variant.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   /// a block of transactions with actions, keys and hex data, the kind of document the parser sees
+   std::string make_document( size_t size ) {
+      std::string s = "{\"block_num\":123456789,\"producer\":\"eosio\",\"confirmed\":0,\"transactions\":[";
+      for( size_t i = 0; s.size() < size; ++i ) {
+         if( i )
+            s += ',';
+         s += "{\"id\":\"" + std::string( 64, "0123456789abcdef"[i % 16] ) + "\",\"cpu_usage_us\":" + std::to_string( i % 5000 ) +
+              ",\"net_usage_words\":" + std::to_string( i % 300 ) + ",\"expiration\":\"2026-10-17T10:22:14\"" +
+              ",\"elapsed\":" + std::to_string( i * 0.25 ) + ",\"scheduled\":" + ( i % 7 ? "false" : "true" ) +
+              ",\"actions\":[";
+         for( size_t a = 0; a < 3; ++a ) {
+            s += std::string( a ? "," : "" ) + "{\"account\":\"eosio.token\",\"name\":\"transfer\",\"authorization\":" +
+                 "[{\"actor\":\"alice\",\"permission\":\"active\"}],\"data\":\"" + std::string( 96, 'a' + a ) +
+                 "\",\"memo\":\"payment \\\"" + std::to_string( i ) + "\\\"\",\"quantity\":" + std::to_string( i * 10000 + a ) +
+                 ",\"delay\":null}";
+         }
+         s += "]}";
+      }
+      return s + "]}";
+   }
+
+   struct counting_handler : json::sax_handler {
+      size_t values = 0;
+      size_t bytes = 0;
+      void on_null() override { ++values; }
+      void on_bool( bool ) override { ++values; }
+      void on_int64( int64_t ) override { ++values; }
+      void on_uint64( uint64_t ) override { ++values; }
+      void on_double( double ) override { ++values; }
+      void on_string( std::string_view s ) override { ++values; bytes += s.size(); }
+      void on_start_object() override {}
+      void on_key( std::string_view key ) override { bytes += key.size(); }
+      void on_end_object() override { ++values; }
+      void on_start_array() override {}
+      void on_end_array() override { ++values; }
+   };
+
+   template<typename F>
+   void measure( const char* name, size_t runs, size_t size, F&& f ) {
+      f();   // warm up
+      const auto start = bench_clock::now();
+      for( size_t i = 0; i < runs; ++i )
+         f();
+      const double seconds = std::chrono::duration<double>( bench_clock::now() - start ).count() / runs;
+      printf( "%-28s %8.2f ms %8.1f MB/s\n", name, seconds * 1000, size / seconds / ( 1024 * 1024 ) );
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   const size_t runs = argc > 1 ? std::stoul( argv[1] ) : 20;
+   const std::string doc = make_document( 4 * 1024 * 1024 );
+   printf( "document of %zu bytes, %zu runs\n", doc.size(), runs );
+
+   size_t items = 0;
+   measure( "from_string", runs, doc.size(), [&]() {
+      const variant v = json::from_string( doc );
+      items = v["transactions"].size();
+   } );
+   counting_handler h;
+   measure( "parse_events", runs, doc.size(), [&]() {
+      h = counting_handler();
+      json::parse_events( doc, h );
+   } );
+   printf( "%zu transactions, %zu values, %zu string bytes\n", items, h.values, h.bytes );
+   return 0;
+}
@@ -0,0 +1,167 @@
+/**
+ *  Times fc::raw over the kinds of data it is used for, and prints the time per call of each:
+ *  - unpacking records of strings and bytes, into std::string and into std::string_view
+ *  - packing and unpacking vectors of 1M uint64_t and sha256, which are copied in bulk
+ *  - packing records one by one with raw::pack and with raw::pack_to into a reused pack_buffer
+ *
+ *  bench_raw [iterations]
+ */
+#include <fc/io/raw.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+   struct record {
+      std::string        account;
+      std::string        name;
+      std::string        memo;
+      std::vector<char>  data;
+   };
+
+   /// the same encoding as record, borrowing its strings from the buffer
+   struct record_view {
+      std::string_view   account;
+      std::string_view   name;
+      std::string_view   memo;
+      std::string_view   data;
+   };
+}
+
+FC_REFLECT( bench::record, (account)(name)(memo)(data) )
+FC_REFLECT( bench::record_view, (account)(name)(memo)(data) )
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   /// keeps the results alive so the calls are not optimized away
+   volatile size_t sink_size = 0;
+
+   template<typename F>
+   void measure( const char* name, size_t n, F&& f ) {
+      size_t size = 0;
+      for( size_t i = 0; i < n / 10; ++i )   // warm up
+         size += f();
+      const auto start = bench_clock::now();
+      for( size_t i = 0; i < n; ++i )
+         size += f();
+      const double us = std::chrono::duration<double, std::micro>( bench_clock::now() - start ).count() / n;
+      sink_size = sink_size + size;
+      printf( "%-36s %10.2f us\n", name, us );
+   }
+
+   std::vector<bench::record> make_records( size_t n ) {
+      std::vector<bench::record> records( n );
+      for( size_t i = 0; i < n; ++i ) {
+         records[i].account = "eosio.token";
+         records[i].name = "transfer";
+         records[i].memo = "payment for order " + std::to_string( i );
+         records[i].data.assign( 64, char( i ) );
+      }
+      return records;
+   }
+
+   void bench_strings( size_t n ) {
+      const auto records = make_records( 1000 );
+      const std::vector<char> packed = raw::pack( records );
+
+      measure( "unpack 1000 records, std::string", n, [&]() {
+         datastream<const char*> ds( packed.data(), packed.size() );
+         std::vector<bench::record> out;
+         raw::unpack( ds, out );
+         return out.size();
+      } );
+      measure( "unpack 1000 records, string_view", n, [&]() {
+         datastream<const char*> ds( packed.data(), packed.size() );
+         std::vector<bench::record_view> out;
+         raw::unpack( ds, out );
+         return out.size();
+      } );
+   }
+
+   template<typename T>
+   void bench_bulk( const std::string& name, const std::vector<T>& values, size_t n ) {
+      const std::vector<char> packed = raw::pack( values );
+      std::vector<char> buffer( packed.size() );
+
+      measure( ( "pack " + name ).c_str(), n, [&]() {
+         datastream<char*> ds( buffer.data(), buffer.size() );
+         raw::pack( ds, values );
+         return size_t( ds.tellp() );
+      } );
+      measure( ( "unpack " + name ).c_str(), n, [&]() {
+         datastream<const char*> ds( packed.data(), packed.size() );
+         std::vector<T> out;
+         raw::unpack( ds, out );
+         return out.size();
+      } );
+   }
+
+   void bench_pack_to( size_t n ) {
+      const auto records = make_records( 200 );
+      measure( "pack 200 records, pack", n, [&]() {
+         size_t size = 0;
+         for( const auto& r : records )
+            size += raw::pack( r ).size();
+         return size;
+      } );
+      pack_buffer buffer;
+      measure( "pack 200 records, pack_to", n, [&]() {
+         size_t size = 0;
+         for( const auto& r : records ) {
+            buffer.clear();
+            raw::pack_to( buffer, r );
+            size += buffer.size();
+         }
+         return size;
+      } );
+
+      // a bounded size, raw::pack skips the sizing pass
+      std::vector<std::pair<sha256, uint64_t>> keys( 200 );
+      for( size_t i = 0; i < keys.size(); ++i )
+         keys[i] = { sha256::hash( i ), i };
+      measure( "pack 200 (sha256, uint64_t), pack", n, [&]() {
+         size_t size = 0;
+         for( const auto& k : keys )
+            size += raw::pack( k.first ).size() + raw::pack( k.second ).size();
+         return size;
+      } );
+      measure( "pack 200 (sha256, uint64_t), pack_to", n, [&]() {
+         buffer.clear();
+         for( const auto& k : keys ) {
+            raw::pack_to( buffer, k.first );
+            raw::pack_to( buffer, k.second );
+         }
+         return buffer.size();
+      } );
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   const size_t n = argc > 1 ? std::stoul( argv[1] ) : 1000;
+   bench_strings( n );
+
+   // a hundredth of the iterations, each of these moves megabytes
+   const size_t bulk_n = std::max<size_t>( n / 100, 1 );
+   std::vector<uint64_t> numbers( 1000000 );
+   std::vector<sha256> hashes( 1000000 );
+   for( size_t i = 0; i < numbers.size(); ++i ) {
+      numbers[i] = i * 0x9e3779b97f4a7c15ull;
+      hashes[i] = sha256::hash( numbers[i] );
+   }
+   bench_bulk( "1M uint64_t", numbers, bulk_n );
+   bench_bulk( "1M sha256", hashes, bulk_n );
+
+   bench_pack_to( n );
+   return 0;
+}
@@ -200,6 +200,14 @@ BOOST_AUTO_TEST_CASE(escape_string_test)
 {
    std::string escape_out_str;
    escape_out_str = fc::escape_string(json_test_util::escape_input_str, json_test_util::yield_no_limitation);
+   {
+      const std::string in = std::string("a\"b\\c\td\x01\x7f\xc2\x9b\xff", 12);
+      BOOST_CHECK_EQUAL(fc::escape_string(in, nullptr), "a\\\"b\\\\c\\td\\u0001\\u007f\\u009b");
+      BOOST_CHECK_EQUAL(fc::escape_string(in, nullptr, false), "a\"b\\c\td\\u0001\\u007f\\u009b");
+      std::string appended = "prefix";
+      fc::append_escaped_string(appended, in, nullptr);
+      BOOST_CHECK_EQUAL(appended, "prefix" + fc::escape_string(in, nullptr));
+   }
    BOOST_CHECK_LT(json_test_util::repeat_char_num, json_test_util::escape_input_str.size());
    BOOST_CHECK_LT(json_test_util::escape_input_str.size() - json_test_util::repeat_char_num, json_test_util::exception_limit_size);  // by using size_different to calculate expected string
    {
@@ -222,4 +230,131 @@ BOOST_AUTO_TEST_CASE(escape_string_test)
    }
 }
 
+BOOST_AUTO_TEST_CASE(from_string_test)
+{
+   const std::string doc = R"({"a":1,"b":-2,"c":"str\"ing","d":[true,false,null],"e":{"f":{}},"g":18446744073709551615})";
+   for( auto ptype : { json::parse_type::legacy_parser, json::parse_type::strict_parser, json::parse_type::relaxed_parser } ) {
+      const variant v = json::from_string( doc, ptype );
+      BOOST_CHECK_EQUAL( v["a"].as_uint64(), 1u );
+      BOOST_CHECK_EQUAL( v["b"].as_int64(), -2 );
+      BOOST_CHECK_EQUAL( v["c"].as_string(), "str\"ing" );
+      BOOST_CHECK_EQUAL( v["d"].size(), 3u );
+      BOOST_CHECK( v["d"][size_t(2)].is_null() );
+      BOOST_CHECK_EQUAL( v["g"].as_uint64(), std::numeric_limits<uint64_t>::max() );
+   }
+   BOOST_CHECK_EQUAL( json::to_string( json::from_string( doc ), json_test_util::yield_no_limitation, json::output_formatting::legacy_generator ), doc );
+   BOOST_CHECK( json::from_string( "[1.5]", json::parse_type::legacy_parser )[size_t(0)].is_double() );
+   BOOST_CHECK( json::from_string( "[1.5]", json::parse_type::legacy_parser_with_string_doubles )[size_t(0)].is_string() );
+
+   BOOST_CHECK_THROW( json::from_string( "" ), fc::eof_exception );
+   BOOST_CHECK_THROW( json::from_string( R"({"a":"unterminated)" ), fc::parse_error_exception );
+   BOOST_CHECK_THROW( json::from_string( R"({"a" 1})" ), fc::parse_error_exception );
+   BOOST_CHECK_THROW( json::from_string( "[[[1]]]", json::parse_type::legacy_parser, 4 ), fc::parse_error_exception );
+
+   const variants vs = json::variants_from_string( "1 \"two\" [3]" );
+   BOOST_REQUIRE_EQUAL( vs.size(), 3u );
+   BOOST_CHECK_EQUAL( vs[1].as_string(), "two" );
+}
+
+BOOST_AUTO_TEST_CASE(from_string_arena_test)
+{
+   const std::string doc = R"({"a":1,"b":"a string too long for small string storage","c":[true,null,{"d":"e"}],"e":{}})";
+   variant copy, array_copy;
+   {
+      variant_arena arena( 64 ); // small enough to need more than one block
+      for( auto ptype : { json::parse_type::legacy_parser, json::parse_type::strict_parser, json::parse_type::relaxed_parser } ) {
+         const variant v = json::from_string( doc, arena, ptype );
+         BOOST_CHECK_EQUAL( json::to_string( v, json_test_util::yield_no_limitation, json::output_formatting::legacy_generator ), doc );
+      }
+      const variant v = json::from_string( doc, arena );
+      copy = v;
+      variant arr = json::from_string( "[1,[2]]", arena );
+      arr.get_array().push_back( variant("appended") );
+      array_copy = arr;
+   }
+   // copies do not share storage with the arena
+   BOOST_CHECK_EQUAL( copy["b"].get_string(), "a string too long for small string storage" );
+   BOOST_CHECK_EQUAL( copy["c"][size_t(2)]["d"].get_string(), "e" );
+   BOOST_CHECK_EQUAL( json::to_string( array_copy, json_test_util::yield_no_limitation ), R"([1,[2],"appended"])" );
+}
+
+BOOST_AUTO_TEST_CASE(from_string_arena_object_copy_test)
+{
+   const std::string doc = R"({"a":"a string too long for small string storage","b":{"c":["d",{"e":"f"}]},"g":[{"h":"i"}]})";
+   variant copy, assigned;
+   variant_object object_copy, as_copy;
+   {
+      variant_arena arena( 64 );
+      const variant v = json::from_string( doc, arena );
+      copy = v;
+      assigned = variant( v.get_object() );
+      object_copy = v.get_object();
+      as_copy = v.as<variant_object>();
+      // a nested object of the arena is copied the same way
+      const variant_object nested = v["b"].get_object();
+      BOOST_CHECK_EQUAL( nested["c"][size_t(1)]["e"].get_string(), "f" );
+   }
+   for( const variant& c : { copy, assigned, variant( object_copy ), variant( as_copy ) } ) {
+      BOOST_CHECK_EQUAL( c["a"].get_string(), "a string too long for small string storage" );
+      BOOST_CHECK_EQUAL( c["b"]["c"][size_t(1)]["e"].get_string(), "f" );
+      BOOST_CHECK_EQUAL( json::to_string( c, json_test_util::yield_no_limitation ), doc );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(from_chunks_test)
+{
+   const std::string doc = R"({"a":1,"b":"str\"ing","c":[true,null,150],"d":{"e":-2}})";
+   for( auto ptype : { json::parse_type::legacy_parser, json::parse_type::strict_parser, json::parse_type::relaxed_parser } ) {
+      // one byte at a time splits every token
+      for( size_t chunk_size : { size_t(1), size_t(7), doc.size() } ) {
+         size_t pos = 0;
+         const variant v = json::from_chunks( [&]() {
+            const std::string_view chunk = std::string_view( doc ).substr( pos, chunk_size );
+            pos += chunk.size();
+            return chunk;
+         }, ptype );
+         BOOST_CHECK_EQUAL( json::to_string( v, json_test_util::yield_no_limitation ), json::to_string( json::from_string( doc, ptype ), json_test_util::yield_no_limitation ) );
+      }
+   }
+
+   BOOST_CHECK_THROW( json::from_chunks( []() { return std::string_view(); } ), fc::eof_exception );
+   bool first = true;
+   BOOST_CHECK_THROW( json::from_chunks( [&]() { const bool f = first; first = false; return f ? std::string_view( R"({"a":)" ) : std::string_view(); } ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(parse_events_test)
+{
+   struct recorder : json::sax_handler {
+      std::string events;
+      void on_null() override                     { events += "n "; }
+      void on_bool( bool b ) override             { events += b ? "t " : "f "; }
+      void on_int64( int64_t i ) override         { events += "i" + std::to_string(i) + ' '; }
+      void on_uint64( uint64_t u ) override       { events += "u" + std::to_string(u) + ' '; }
+      void on_double( double d ) override         { events += "d" + std::to_string(d) + ' '; }
+      void on_string( std::string_view s ) override { events += "s" + std::string(s) + ' '; }
+      void on_start_object() override             { events += "{ "; }
+      void on_key( std::string_view k ) override  { events += "k" + std::string(k) + ' '; }
+      void on_end_object() override               { events += "} "; }
+      void on_start_array() override              { events += "[ "; }
+      void on_end_array() override                { events += "] "; }
+   };
+
+   const std::string doc = R"({"a":1,"b":-2,"c":"x","d":[true,false,null],"e":{"f":1.5}})";
+   {
+      recorder r;
+      json::parse_events( doc, r );
+      BOOST_CHECK_EQUAL( r.events, "{ ka u1 kb i-2 kc sx kd [ t f n ] ke { kf d1.500000 } } " );
+   }
+   {
+      recorder r;
+      json::parse_events( doc, r, json::parse_type::legacy_parser_with_string_doubles );
+      BOOST_CHECK_EQUAL( r.events, "{ ka u1 kb i-2 kc sx kd [ t f n ] ke { kf s1.5 } } " );
+   }
+   {
+      recorder r;
+      BOOST_CHECK_THROW( json::parse_events( doc, r, json::parse_type::strict_parser ), fc::assert_exception );
+      BOOST_CHECK_THROW( json::parse_events( R"({"a":[1,2)", r ), fc::exception );
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,142 @@
+#define BOOST_TEST_MODULE io_json_codec
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/io/json_codec.hpp>
+#include <fc/exception/exception.hpp>
+
+namespace json_codec_test {
+   enum class color { red, green, blue };
+
+   struct point {
+      int32_t x = 0;
+      int64_t y = 0;
+   };
+
+   struct shape : fc::reflect_init {
+      std::string                              name;
+      color                                    fill = color::red;
+      std::vector<point>                       points;
+      std::optional<uint64_t>                  id;
+      std::map<std::string, double>            weights;
+      std::variant<int32_t, std::string, point> tag;
+      std::pair<bool, uint32_t>                flags;
+      fc::blob                                 data;       // custom to_variant, goes through fc::variant
+      std::vector<char>                        raw;        // hex string
+      fc::variant                              extra;
+      uint32_t                                 init_count = 0;
+
+      void reflector_init() { ++init_count; }
+   };
+
+   struct labeled_shape : shape {
+      std::string label;
+   };
+
+   /// reflects a name its base reflects too
+   struct renamed_point : point {
+      std::string x;
+   };
+}
+
+FC_REFLECT_ENUM( json_codec_test::color, (red)(green)(blue) )
+FC_REFLECT( json_codec_test::point, (x)(y) )
+FC_REFLECT( json_codec_test::shape, (name)(fill)(points)(id)(weights)(tag)(flags)(data)(raw)(extra) )
+FC_REFLECT_DERIVED( json_codec_test::labeled_shape, (json_codec_test::shape), (label) )
+FC_REFLECT_DERIVED( json_codec_test::renamed_point, (json_codec_test::point), (x) )
+FC_JSON_CODEC( json_codec_test::color )
+FC_JSON_CODEC( json_codec_test::point )
+FC_JSON_CODEC( json_codec_test::shape )
+FC_JSON_CODEC( json_codec_test::labeled_shape )
+FC_JSON_CODEC( json_codec_test::renamed_point )
+
+using namespace fc;
+using namespace json_codec_test;
+
+BOOST_AUTO_TEST_SUITE(json_codec_test_suite)
+
+namespace {
+   labeled_shape make_shape() {
+      labeled_shape s;
+      s.name = "tri\"angle";
+      s.fill = color::blue;
+      s.points = { {1, -2}, {-2147483647, 0x100000000ll}, {0, -0x100000000ll} };
+      s.id = 0x1ffffffffull;
+      s.weights = { {"a", 0.5}, {"b", -1.25} };
+      s.tag = point{ 3, 4 };
+      s.flags = { true, 7 };
+      s.data.data = { 'x', 'y', 'z' };
+      s.raw = { 1, 2, 3 };
+      s.extra = mutable_variant_object( "k", "v" )( "n", variants{ 1, "two" } );
+      s.label = "label";
+      return s;
+   }
+}
+
+BOOST_AUTO_TEST_CASE(encode_matches_variant_path)
+{
+   const labeled_shape s = make_shape();
+   for( auto format : { json::output_formatting::stringify_large_ints_and_doubles, json::output_formatting::legacy_generator } ) {
+      BOOST_CHECK_EQUAL( json_codec::to_string( s, format ), json::to_string( variant( s ), fc::time_point::maximum(), format ) );
+   }
+
+   labeled_shape empty;
+   BOOST_CHECK_EQUAL( json_codec::to_string( empty ), json::to_string( variant( empty ), fc::time_point::maximum() ) );
+
+   std::optional<point> none;
+   BOOST_CHECK_EQUAL( json_codec::to_string( none ), "null" );
+}
+
+BOOST_AUTO_TEST_CASE(decode_matches_variant_path)
+{
+   const labeled_shape s = make_shape();
+   const std::string doc = json::to_string( variant( s ), fc::time_point::maximum() );
+
+   const auto direct = json_codec::from_string<labeled_shape>( doc );
+   const auto via_variant = json::from_string( doc ).as<labeled_shape>();
+   BOOST_CHECK_EQUAL( json_codec::to_string( direct ), doc );
+   BOOST_CHECK_EQUAL( json_codec::to_string( via_variant ), doc );
+   BOOST_CHECK_EQUAL( direct.init_count, 1u );
+   BOOST_CHECK_EQUAL( direct.points[size_t(2)].y, -0x100000000ll );
+   BOOST_CHECK( std::get<point>( direct.tag ).y == 4 );
+   BOOST_CHECK( direct.fill == color::blue );
+}
+
+BOOST_AUTO_TEST_CASE(decode_lenient_input)
+{
+   // unknown keys are skipped, the first of duplicate keys wins, numbers may be quoted
+   const std::string doc = R"({ "unknown":{"a":[1,2]}, "x":"5", "y":1, "x":7 ,, })";
+   const auto p = json_codec::from_string<point>( doc );
+   BOOST_CHECK_EQUAL( p.x, 5 );
+   BOOST_CHECK_EQUAL( p.y, 1 );
+
+   const auto v = json::from_string( doc ).as<point>();
+   BOOST_CHECK_EQUAL( v.x, p.x );
+
+   // values of the wrong shape fail the same way as from_variant
+   BOOST_CHECK_THROW( json_codec::from_string<point>( "[1,2]" ), fc::exception );
+   BOOST_CHECK_THROW( json_codec::from_string<point>( R"({"x" 1})" ), fc::parse_error_exception );
+   BOOST_CHECK_THROW( json_codec::from_string<std::vector<point>>( "[[[1]]]", 4 ), fc::parse_error_exception );
+
+   const auto tags = json_codec::from_string<std::vector<std::variant<int32_t, std::string, point>>>( R"([[1,"s"],[0,-3],[2,{"x":1}],[]])" );
+   BOOST_REQUIRE_EQUAL( tags.size(), 4u );
+   BOOST_CHECK_EQUAL( std::get<std::string>( tags[0] ), "s" );
+   BOOST_CHECK_EQUAL( std::get<int32_t>( tags[1] ), -3 );
+   BOOST_CHECK_EQUAL( std::get<point>( tags[2] ).x, 1 );
+   BOOST_CHECK_EQUAL( tags[3].index(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE(decode_duplicate_member_name)
+{
+   // both members reflected as "x" take the value, as from_variant assigns them
+   const std::string doc = R"({"y":2,"x":5,"x":6})";
+   const auto p = json_codec::from_string<renamed_point>( doc );
+   BOOST_CHECK_EQUAL( p.point::x, 5 );
+   BOOST_CHECK_EQUAL( p.x, "5" );
+   BOOST_CHECK_EQUAL( p.y, 2 );
+
+   const auto v = json::from_string( doc ).as<renamed_point>();
+   BOOST_CHECK_EQUAL( v.point::x, p.point::x );
+   BOOST_CHECK_EQUAL( v.x, p.x );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,279 @@
+#define BOOST_TEST_MODULE io_raw
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/io/raw_fwd.hpp>
+
+namespace raw_test {
+   /// tiles like packed_pair, but has an encoding of its own and does not opt in to bulk copies
+   struct custom_pair {
+      uint32_t a = 0;
+      uint32_t b = 0;
+   };
+}
+
+// declared ahead of fc/io/raw.hpp, as a header providing its own encoding does
+namespace fc { namespace raw {
+   // b as a varint, then a
+   template<typename Stream>
+   inline void pack( Stream& s, const raw_test::custom_pair& p ) {
+      fc::raw::pack( s, unsigned_int( p.b ) );
+      fc::raw::pack( s, p.a );
+   }
+   template<typename Stream>
+   inline void unpack( Stream& s, raw_test::custom_pair& p ) {
+      unsigned_int b;
+      fc::raw::unpack( s, b );
+      p.b = b.value;
+      fc::raw::unpack( s, p.a );
+   }
+} }
+
+#include <fc/io/raw.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <boost/container/deque.hpp>
+
+namespace raw_test {
+   struct named_blob {
+      std::string       name;
+      std::vector<char> data;
+      std::string       empty;
+   };
+
+   struct packed_pair {
+      uint32_t a = 0;
+      uint32_t b = 0;
+   };
+
+   struct packed_derived : packed_pair {
+      uint64_t c = 0;
+   };
+
+   struct padded_pair {
+      uint8_t  a = 0;
+      uint32_t b = 0;
+   };
+
+   struct swapped_pair {
+      uint32_t a = 0;
+      uint32_t b = 0;
+   };
+
+   /// tiles like packed_pair, but does not opt in to bulk copies
+   struct plain_pair {
+      uint32_t a = 0;
+      uint32_t b = 0;
+   };
+
+   // a std::list is always packed element by element, so it gives the reference encoding
+   template<typename Container>
+   void check_matches_elementwise( const Container& c ) {
+      std::list<typename Container::value_type> reference( c.begin(), c.end() );
+      const std::vector<char> packed = fc::raw::pack( c );
+      BOOST_REQUIRE( packed == fc::raw::pack( reference ) );
+
+      const auto unpacked = fc::raw::unpack<Container>( packed );
+      BOOST_REQUIRE_EQUAL( unpacked.size(), c.size() );
+      BOOST_CHECK( fc::raw::pack( unpacked ) == packed );
+   }
+}
+
+FC_REFLECT( raw_test::named_blob, (name)(data)(empty) )
+FC_REFLECT( raw_test::packed_pair, (a)(b) )
+FC_REFLECT_DERIVED( raw_test::packed_derived, (raw_test::packed_pair), (c) )
+FC_REFLECT( raw_test::padded_pair, (a)(b) )
+FC_REFLECT( raw_test::swapped_pair, (b)(a) )
+FC_REFLECT( raw_test::custom_pair, (a)(b) )
+FC_REFLECT( raw_test::plain_pair, (a)(b) )
+
+namespace fc { namespace raw {
+   template<> struct is_trivially_packable<raw_test::packed_pair> : std::true_type {};
+   template<> struct is_trivially_packable<raw_test::packed_derived> : std::true_type {};
+   // opted in, but their reflected members do not cover them in memory order
+   template<> struct is_trivially_packable<raw_test::padded_pair> : std::true_type {};
+   template<> struct is_trivially_packable<raw_test::swapped_pair> : std::true_type {};
+} }
+
+using namespace fc;
+
+BOOST_AUTO_TEST_SUITE(raw_test_suite)
+
+BOOST_AUTO_TEST_CASE(string_unpack_test)
+{
+   const raw_test::named_blob in{ std::string( 100, 'n' ), std::vector<char>( 40, 'd' ), {} };
+   const std::vector<char> packed = raw::pack( in );
+
+   // contiguous buffer
+   const auto out = raw::unpack<raw_test::named_blob>( packed );
+   BOOST_CHECK_EQUAL( out.name, in.name );
+   BOOST_CHECK( out.data == in.data );
+   BOOST_CHECK( out.empty.empty() );
+
+   // stream without direct buffer access
+   datastream<std::vector<char>> ds( packed );
+   raw_test::named_blob streamed;
+   raw::unpack( ds, streamed );
+   BOOST_CHECK_EQUAL( streamed.name, in.name );
+   BOOST_CHECK( streamed.data == in.data );
+
+   // truncated input
+   datastream<const char*> truncated( packed.data(), 50 );
+   raw_test::named_blob partial;
+   BOOST_CHECK_THROW( raw::unpack( truncated, partial ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(string_view_unpack_test)
+{
+   const std::vector<char> packed = raw::pack( std::string( "hello" ), std::string( "" ), std::string( "world" ) );
+
+   datastream<const char*> ds( packed.data(), packed.size() );
+   std::string_view a, b, c;
+   raw::unpack( ds, a );
+   raw::unpack( ds, b );
+   raw::unpack( ds, c );
+   BOOST_CHECK_EQUAL( a, "hello" );
+   BOOST_CHECK( b.empty() );
+   BOOST_CHECK_EQUAL( c, "world" );
+   // borrowed, points into the packed buffer
+   BOOST_CHECK( a.data() >= packed.data() && a.data() + a.size() <= packed.data() + packed.size() );
+   BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+
+   BOOST_CHECK( raw::pack( std::string_view( "hello" ) ) == raw::pack( std::string( "hello" ) ) );
+
+   datastream<const char*> truncated( packed.data(), 3 );
+   BOOST_CHECK_THROW( raw::unpack( truncated, a ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(packed_layout_test)
+{
+   using fc::raw::detail::has_packed_layout;
+   BOOST_CHECK( has_packed_layout<uint64_t>() );
+   BOOST_CHECK( has_packed_layout<fc::sha256>() );
+   BOOST_CHECK( (has_packed_layout<std::array<uint16_t,3>>()) );
+   BOOST_CHECK( has_packed_layout<raw_test::packed_pair>() );
+   BOOST_CHECK( has_packed_layout<raw_test::packed_derived>() );
+   BOOST_CHECK( !has_packed_layout<bool>() );
+   BOOST_CHECK( !has_packed_layout<raw_test::padded_pair>() );
+   BOOST_CHECK( !has_packed_layout<raw_test::swapped_pair>() );
+   BOOST_CHECK( !has_packed_layout<std::string>() );
+   // reflected structs that do not opt in are packed member by member
+   BOOST_CHECK( !has_packed_layout<raw_test::plain_pair>() );
+   BOOST_CHECK( !has_packed_layout<raw_test::custom_pair>() );
+}
+
+BOOST_AUTO_TEST_CASE(custom_pack_in_container_test)
+{
+   // a container of a type with its own pack and unpack uses them, as packing one alone does
+   const raw_test::custom_pair one{ 1, 2 };
+   const std::vector<char> alone = raw::pack( one );
+   BOOST_REQUIRE_EQUAL( alone.size(), 5u );
+   BOOST_CHECK_EQUAL( alone[0], 2 );
+
+   std::vector<raw_test::custom_pair> pairs;
+   for( uint32_t i = 0; i < 100; ++i )
+      pairs.push_back( raw_test::custom_pair{ i, i + 1 } );
+   const std::vector<char> packed = raw::pack( pairs );
+   std::vector<char> expected = raw::pack( unsigned_int( 100 ) );
+   for( const auto& p : pairs ) {
+      const auto e = raw::pack( p );
+      expected.insert( expected.end(), e.begin(), e.end() );
+   }
+   BOOST_CHECK( packed == expected );
+
+   const auto unpacked = raw::unpack<std::vector<raw_test::custom_pair>>( packed );
+   BOOST_REQUIRE_EQUAL( unpacked.size(), 100u );
+   BOOST_CHECK_EQUAL( unpacked[42].a, 42u );
+   BOOST_CHECK_EQUAL( unpacked[42].b, 43u );
+
+   const std::deque<raw_test::custom_pair> deque( pairs.begin(), pairs.end() );
+   BOOST_CHECK( raw::pack( deque ) == expected );
+}
+
+BOOST_AUTO_TEST_CASE(bulk_container_test)
+{
+   std::vector<uint64_t> ints;
+   std::deque<fc::sha256> hashes;
+   boost::container::deque<raw_test::packed_derived> derived;
+   std::vector<raw_test::padded_pair> padded;
+   std::vector<raw_test::swapped_pair> swapped;
+   for( uint32_t i = 0; i < 5000; ++i ) {
+      ints.push_back( uint64_t(i) * 0x0101010101ull );
+      hashes.push_back( fc::sha256::hash( std::to_string( i ) ) );
+      derived.push_back( raw_test::packed_derived{ { i, ~i }, uint64_t(i) << 33 } );
+      padded.push_back( raw_test::padded_pair{ uint8_t(i), i } );
+      swapped.push_back( raw_test::swapped_pair{ i, i + 1 } );
+   }
+
+   raw_test::check_matches_elementwise( ints );
+   raw_test::check_matches_elementwise( hashes );
+   raw_test::check_matches_elementwise( derived );
+   raw_test::check_matches_elementwise( padded );
+   raw_test::check_matches_elementwise( swapped );
+   raw_test::check_matches_elementwise( std::vector<uint64_t>{} );
+
+   const auto swapped_copy = fc::raw::unpack<std::vector<raw_test::swapped_pair>>( fc::raw::pack( swapped ) );
+   BOOST_CHECK_EQUAL( swapped_copy[7].a, 7u );
+   BOOST_CHECK_EQUAL( swapped_copy[7].b, 8u );
+
+   // truncated input
+   const std::vector<char> packed = fc::raw::pack( ints );
+   fc::datastream<const char*> truncated( packed.data(), packed.size() - 1 );
+   std::vector<uint64_t> partial;
+   BOOST_CHECK_THROW( fc::raw::unpack( truncated, partial ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(max_pack_size_test)
+{
+   static_assert( raw::max_pack_size<uint32_t> == 4 );
+   static_assert( raw::max_pack_size<bool> == 1 );
+   static_assert( raw::max_pack_size<fc::sha256> == 32 );
+   static_assert( raw::max_pack_size<std::array<unsigned_int,3>> == 15 );
+   static_assert( raw::max_pack_size<std::optional<uint64_t>> == 9 );
+   static_assert( raw::max_pack_size<std::string> == raw::unbounded_pack_size );
+   static_assert( raw::max_pack_size<raw_test::named_blob> == raw::unbounded_pack_size );
+
+   const std::array<unsigned_int,3> small_ints{ 1u, 300u, 0xffffffffu };
+   const std::vector<char> packed = raw::pack( small_ints );
+   BOOST_CHECK_EQUAL( packed.size(), raw::pack_size( small_ints ) );
+   BOOST_CHECK_EQUAL( packed.size(), 1u + 2u + 5u );
+   const auto unpacked = raw::unpack<std::array<unsigned_int,3>>( packed );
+   BOOST_CHECK( unpacked == small_ints );
+
+   BOOST_CHECK_EQUAL( raw::pack( std::optional<uint64_t>() ).size(), 1u );
+}
+
+BOOST_AUTO_TEST_CASE(pack_to_test)
+{
+   const raw_test::named_blob blob{ "name", std::vector<char>( 1000, 'x' ), "" };
+   const std::vector<uint64_t> ints( 100, 7 );
+   const fc::sha256 hash = fc::sha256::hash( std::string("abc") );
+
+   fc::pack_buffer b;
+   raw::pack_to( b, blob );
+   BOOST_CHECK( b.to_vector() == raw::pack( blob ) );
+
+   // appends after what is already in the buffer
+   raw::pack_to( b, ints );
+   raw::pack_to( b, hash );
+   std::vector<char> expected = raw::pack( blob );
+   for( const auto& part : { raw::pack( ints ), raw::pack( hash ) } )
+      expected.insert( expected.end(), part.begin(), part.end() );
+   BOOST_CHECK( b.to_vector() == expected );
+
+   // keeps its capacity when reused
+   const size_t capacity = b.capacity();
+   for( int i = 0; i < 10; ++i ) {
+      b.clear();
+      raw::pack_to( b, blob );
+      BOOST_CHECK_EQUAL( b.capacity(), capacity );
+   }
+
+   datastream<const char*> ds( b.data(), b.size() );
+   raw_test::named_blob copy;
+   raw::unpack( ds, copy );
+   BOOST_CHECK_EQUAL( copy.name, blob.name );
+   BOOST_CHECK( copy.data == blob.data );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
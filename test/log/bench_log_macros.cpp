@@ -0,0 +1,103 @@
+/**
+ *  Times the formatting, log and exception macros per call: FC_FMT, fc_ilog into a null sink,
+ *  FC_LOG_CONTEXT and FC_LOG_MESSAGE, FC_THROW_EXCEPTION and FC_ASSERT thrown and caught, and a
+ *  caught exception turned into text.
+ *
+ *  bench_log_macros [iterations]
+ */
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger_config.hpp>
+#include <spdlog/sinks/null_sink.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   /// keeps the results alive so the calls are not optimized away
+   volatile size_t sink_size = 0;
+
+   template<typename F>
+   void measure( const char* name, size_t n, F&& f ) {
+      size_t size = 0;
+      for( size_t i = 0; i < n / 10; ++i )   // warm up
+         size += f( i );
+      const auto start = bench_clock::now();
+      for( size_t i = 0; i < n; ++i )
+         size += f( i );
+      const double ns = std::chrono::duration<double, std::nano>( bench_clock::now() - start ).count() / n;
+      sink_size = sink_size + size;
+      printf( "%-28s %10.1f ns\n", name, ns );
+   }
+
+   void check_block( size_t num, const std::string& producer ) {
+      FC_ASSERT( num % 1000000 == 1, "block {num} of {producer} is not at {expected}, {count} pending",
+                 ("num", num)("producer", producer)("expected", 1)("count", num % 7) );
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   const size_t n = argc > 1 ? std::stoul( argv[1] ) : 1000000;
+   const std::string producer = "eosio";
+
+   measure( "FC_FMT, 4 values", n, [&]( size_t i ) {
+      return FC_FMT( "block {num} by {producer} at {time}, {trxs} transactions",
+                     ("num", i)("producer", producer)("time", 1234567.5)("trxs", i % 100) ).size();
+   } );
+   measure( "FC_FMT, 1 value", n, [&]( size_t i ) {
+      return FC_FMT( "block {num}", ("num", i) ).size();
+   } );
+
+   fc::logger lgr( "bench" );
+   lgr.update_agent_logger( std::make_unique<spdlog::logger>( "", std::make_shared<spdlog::sinks::null_sink_st>() ) );
+   lgr.set_log_level( log_level::info );
+   measure( "ilog to a null sink", n, [&]( size_t i ) {
+      fc_ilog( lgr, "block {num} by {producer}, {trxs} transactions", ("num", i)("producer", producer)("trxs", i % 100) );
+      return size_t( 1 );
+   } );
+   measure( "dlog below the level", n, [&]( size_t i ) {
+      fc_dlog( lgr, "block {num} by {producer}, {trxs} transactions", ("num", i)("producer", producer)("trxs", i % 100) );
+      return size_t( 1 );
+   } );
+
+   measure( "FC_LOG_CONTEXT alone", n, [&]( size_t ) {
+      return size_t( FC_LOG_CONTEXT( info ).get_line_number() );
+   } );
+   measure( "FC_LOG_MESSAGE", n, [&]( size_t i ) {
+      return FC_LOG_MESSAGE( info, "block {num} by {producer}", ("num", i)("producer", producer) ).get_context().get_line_number();
+   } );
+
+   const size_t throws = std::max<size_t>( n / 10, 1 );
+   measure( "FC_THROW_EXCEPTION + catch", throws, [&]( size_t i ) {
+      try {
+         FC_THROW_EXCEPTION( fc::invalid_arg_exception, "block {num} by {producer}", ("num", i)("producer", producer) );
+      } catch( const fc::exception& e ) {
+         return size_t( e.code() );
+      }
+      return size_t( 0 );
+   } );
+   measure( "FC_ASSERT + catch", throws, [&]( size_t i ) {
+      try {
+         check_block( i * 2, producer );
+      } catch( const fc::exception& e ) {
+         return size_t( e.code() );
+      }
+      return size_t( 0 );
+   } );
+   measure( "caught, then to_string()", throws, [&]( size_t i ) {
+      try {
+         check_block( i * 2, producer );
+      } catch( const fc::exception& e ) {
+         return e.to_string().size();
+      }
+      return size_t( 0 );
+   } );
+   return 0;
+}
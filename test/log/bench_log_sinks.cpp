@@ -0,0 +1,139 @@
+/**
+ *  Drives each sink type of log_config with concurrent producers, synchronously and through async
+ *  logging, and prints the latency of the log calls next to the metrics of the sink.
+ *
+ *  bench_log_sinks [threads] [messages per thread] [directory]
+ *
+ *  The stderr sink writes to stderr, run with 2>/dev/null to leave the terminal out of it. The file
+ *  sinks write below directory, /tmp by default.
+ */
+#include <fc/log/logger_config.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/reflect/variant.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   struct run_result {
+      double                 seconds = 0;   ///< until the last message was written
+      std::vector<uint64_t>  call_ns;       ///< latency of each log call, sorted
+   };
+
+   uint64_t percentile( const std::vector<uint64_t>& sorted, double p ) {
+      if( sorted.empty() )
+         return 0;
+      return sorted[std::min( sorted.size() - 1, size_t( p * sorted.size() ) )];
+   }
+
+   /// upper bound of the write_latency bucket that holds the given fraction of the writes
+   uint64_t histogram_percentile( const sink_metrics& m, double p ) {
+      const uint64_t rank = uint64_t( p * m.messages );
+      uint64_t seen = 0;
+      for( size_t i = 0; i < m.write_latency.size(); ++i ) {
+         seen += m.write_latency[i];
+         if( seen > rank )
+            return uint64_t( 1 ) << ( i + 8 );
+      }
+      return 0;
+   }
+
+   run_result run( uint32_t threads, uint32_t messages ) {
+      logger lgr = logger::get( "bench" );
+      std::vector<std::vector<uint64_t>> samples( threads );
+      const auto start = bench_clock::now();
+      std::vector<std::thread> producers;
+      for( uint32_t t = 0; t < threads; ++t ) {
+         producers.emplace_back( [&, t]() {
+            set_thread_name( "bench-" + std::to_string( t ) );
+            auto& s = samples[t];
+            s.reserve( messages );
+            const std::string peer = "10.0.0." + std::to_string( t );
+            for( uint32_t i = 0; i < messages; ++i ) {
+               const auto before = bench_clock::now();
+               fc_ilog( lgr, "received block {num} from {peer}, {bytes} bytes", ("num", i)("peer", peer)("bytes", i * 7 % 4096) );
+               s.push_back( std::chrono::duration_cast<std::chrono::nanoseconds>( bench_clock::now() - before ).count() );
+            }
+         } );
+      }
+      for( auto& p : producers )
+         p.join();
+      async_logging::flush();
+
+      run_result r;
+      r.seconds = std::chrono::duration<double>( bench_clock::now() - start ).count();
+      for( auto& s : samples )
+         r.call_ns.insert( r.call_ns.end(), s.begin(), s.end() );
+      std::sort( r.call_ns.begin(), r.call_ns.end() );
+      return r;
+   }
+
+   logging_config make_config( const std::string& type, const fc::path& dir, bool async ) {
+      sink_config sink( "out", type );
+      if( type == "stderr_color_sink_st" ) {
+         sink.args = variant( sink::stderr_color_sink_st_config() );
+      } else if( type == "daily_file_sink_mt" ) {
+         sink::daily_file_sink_mt_config c;
+         c.base_filename = ( dir / "bench_daily.log" ).string();
+         c.truncate = true;
+         sink.args = variant( c );
+      } else {
+         sink::rotating_file_sink_mt_config c;
+         c.base_filename = ( dir / "bench_rotating.log" ).string();
+         c.max_size = 64;   // MB
+         c.max_files = 2;
+         sink.args = variant( c );
+      }
+
+      logging_config cfg = logging_config::default_config();
+      cfg.sinks.push_back( sink );
+      logger_config lc( "bench" );
+      lc.level = log_level::info;
+      lc.sinks.push_back( "out" );
+      cfg.loggers.push_back( lc );
+      cfg.async = async;
+      cfg.async_queue_size = 4 * 1024 * 1024;
+      return cfg;
+   }
+
+} // namespace
+
+int main( int argc, char** argv ) {
+   const uint32_t threads  = argc > 1 ? std::stoul( argv[1] ) : 4;
+   const uint32_t messages = argc > 2 ? std::stoul( argv[2] ) : 200000;
+   const fc::path dir      = argc > 3 ? fc::path( argv[3] ) : fc::temp_directory_path();
+
+   printf( "%u threads x %u messages\n", threads, messages );
+   printf( "%-22s %-5s %10s %8s %8s %8s %9s %10s %9s %9s %8s\n", "sink", "mode", "msg/s", "p50 ns", "p99 ns", "p999 ns",
+           "max us", "MB", "write ns", "w p99 ns", "dropped" );
+   for( const char* type : { "stderr_color_sink_st", "daily_file_sink_mt", "rotating_file_sink_mt" } ) {
+      for( bool async : { false, true } ) {
+         if( !log_config::configure_logging( make_config( type, dir, async ) ) )
+            return 1;
+         const run_result r = run( threads, messages );
+         const logging_metrics m = log_config::get_metrics();
+
+         const auto s = std::find_if( m.sinks.begin(), m.sinks.end(), []( const auto& s ) { return s.name == "out"; } );
+         const auto l = std::find_if( m.loggers.begin(), m.loggers.end(), []( const auto& l ) { return l.name == "bench"; } );
+         if( s == m.sinks.end() || l == m.loggers.end() )
+            return 1;
+         printf( "%-22s %-5s %10.0f %8lu %8lu %8lu %9.1f %10.1f %9.0f %9lu %8lu\n", type, async ? "async" : "sync",
+                 double( s->messages ) / r.seconds,
+                 percentile( r.call_ns, 0.5 ), percentile( r.call_ns, 0.99 ), percentile( r.call_ns, 0.999 ),
+                 r.call_ns.empty() ? 0.0 : r.call_ns.back() / 1000.0,
+                 s->bytes / 1048576.0, s->messages ? double( s->write_ns ) / s->messages : 0.0,
+                 histogram_percentile( *s, 0.99 ), l->dropped );
+         fflush( stdout );
+      }
+   }
+
+   log_config::configure_logging( logging_config::default_config() );
+   return 0;
+}
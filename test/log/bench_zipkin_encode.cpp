@@ -0,0 +1,120 @@
+/**
+ *  Encodes 1M zipkin spans with a few tags, through a mutable_variant_object and json::to_string the
+ *  way they were sent before, and with zipkin_span_encoder into a reused buffer, and prints the time
+ *  and the heap allocations per span of each.
+ *
+ *  bench_zipkin_encode [spans]
+ */
+#include <fc/log/zipkin.hpp>
+#include <fc/crypto/hex.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+   std::atomic<uint64_t> allocations{0};
+}
+
+void* operator new( size_t size ) {
+   allocations.fetch_add( 1, std::memory_order_relaxed );
+   if( void* p = std::malloc( size ? size : 1 ) )
+      return p;
+   throw std::bad_alloc();
+}
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, size_t ) noexcept { std::free( p ); }
+
+namespace {
+
+   /// the span as it was sent before zipkin_span_encoder
+   fc::variant span_variant( const zipkin_span::span_data& span, const std::string& service_name, const std::string& address ) {
+      fc::mutable_variant_object mvo;
+      mvo( "id", fc::to_hex( reinterpret_cast<const char*>(&span.id), sizeof( span.id ) ) );
+      mvo( "traceId", fc::to_hex( reinterpret_cast<const char*>(&span.trace_id), sizeof( span.trace_id ) ) );
+      if( span.parent_id != 0 ) {
+         mvo( "parentId", fc::to_hex( reinterpret_cast<const char*>(&span.parent_id), sizeof( span.parent_id ) ) );
+      }
+      mvo( "name", span.name );
+      mvo( "timestamp", span.start.time_since_epoch().count() );
+      mvo( "duration", (span.stop - span.start).count() );
+      mvo( "localEndpoint", mutable_variant_object( "serviceName", service_name )( "ipv4", address ) );
+      fc::mutable_variant_object tags;
+      for( const auto& t : span.tags )
+         tags( t.first, t.second );
+      mvo( "tags", std::move( tags ) );
+      return mvo;
+   }
+
+   struct result {
+      double   seconds = 0;
+      uint64_t allocations = 0;
+      size_t   bytes = 0;
+   };
+
+   template<typename F>
+   result measure( F&& encode ) {
+      const uint64_t before = allocations.load();
+      const auto start = bench_clock::now();
+      result r;
+      r.bytes = encode();
+      r.seconds = std::chrono::duration<double>( bench_clock::now() - start ).count();
+      r.allocations = allocations.load() - before;
+      return r;
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   const size_t n = argc > 1 ? std::stoul( argv[1] ) : 1000000;
+   const std::string service = "nodeos", address = "10.0.0.1";
+
+   std::vector<zipkin_span::span_data> spans;
+   spans.reserve( n );
+   for( size_t i = 0; i < n; ++i ) {
+      spans.emplace_back( i + 1, "processed_block", i / 16 + 1, i % 16 ? i : 0 );
+      auto& s = spans.back();
+      s.stop = s.start + fc::microseconds( i % 5000 );
+      s.set_tag( "block_num", std::to_string( i ) );
+      s.set_tag( "id", "00000000a1b2c3d4e5f60718293a4b5c6d7e8f90a1b2c3d4e5f60718293a4b5c" );
+      s.set_tag( "producer", "eosio" );
+   }
+
+   const result variant_path = measure( [&]() {
+      size_t bytes = 0;
+      for( const auto& s : spans )
+         bytes += json::to_string( span_variant( s, service, address ), fc::time_point::maximum(),
+                                   json::output_formatting::legacy_generator ).size();
+      return bytes;
+   } );
+
+   // batches of 500 spans in one buffer, cleared but not released between batches, as the zipkin thread does
+   const zipkin_span_encoder encoder( service, address, true );
+   std::string batch;
+   const result encoder_path = measure( [&]() {
+      size_t bytes = 0;
+      for( size_t i = 0; i < n; ++i ) {
+         if( i % 500 == 0 ) {
+            bytes += batch.size();
+            batch.clear();
+         }
+         encoder.append( batch, spans[i] );
+      }
+      return bytes + batch.size();
+   } );
+
+   printf( "%zu spans\n", n );
+   printf( "%-20s %12s %14s %16s\n", "", "ns/span", "allocs/span", "bytes" );
+   for( const auto& [name, r] : { std::pair{ "variant + to_string", variant_path }, std::pair{ "zipkin_span_encoder", encoder_path } } )
+      printf( "%-20s %12.1f %14.2f %16zu\n", name, r.seconds * 1e9 / n, double( r.allocations ) / n, r.bytes );
+   return 0;
+}
@@ -0,0 +1,279 @@
+#define BOOST_TEST_MODULE async_logging
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/log/logger_config.hpp>
+#include <spdlog/sinks/base_sink.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fc;
+
+namespace {
+
+   /// keeps the text and the thread name of what it is given, optionally holding the writer up
+   class recording_sink : public spdlog::sinks::base_sink<std::mutex> {
+   public:
+      struct record {
+         std::string text;
+         std::string thread;
+      };
+
+      std::vector<record> records() {
+         std::lock_guard g( mutex_ );
+         return _records;
+      }
+
+      std::vector<std::string> texts() {
+         std::vector<std::string> r;
+         for( auto& e : records() )
+            r.push_back( e.text );
+         return r;
+      }
+
+      /// the next record waits in the sink until release()
+      void hold() {
+         std::lock_guard g( _gate_mutex );
+         _hold = true;
+         _held = false;
+      }
+      void wait_held() {
+         std::unique_lock g( _gate_mutex );
+         _gate.wait( g, [this]() { return _held; } );
+      }
+      void release() {
+         {
+            std::lock_guard g( _gate_mutex );
+            _hold = false;
+         }
+         _gate.notify_all();
+      }
+
+   protected:
+      void sink_it_( const spdlog::details::log_msg& msg ) override {
+         {
+            std::unique_lock g( _gate_mutex );
+            if( _hold ) {
+               _held = true;
+               _gate.notify_all();
+               _gate.wait( g, [this]() { return !_hold; } );
+            }
+         }
+         _records.push_back( { std::string( msg.payload.data(), msg.payload.size() ),
+                               std::string( async_logging::detail::record_thread_name() ) } );
+      }
+      void flush_() override {}
+
+   private:
+      std::vector<record>     _records;
+      std::mutex              _gate_mutex;
+      std::condition_variable _gate;
+      bool                    _hold = false;
+      bool                    _held = false;
+   };
+
+   struct async_fixture {
+      async_fixture() {
+         lgr.update_agent_logger( std::make_unique<spdlog::logger>( "", sink ) );
+         lgr.set_log_level( log_level::all );
+         async_logging::start( 4096 );
+      }
+      ~async_fixture() { async_logging::stop(); }
+
+      std::shared_ptr<recording_sink> sink = std::make_shared<recording_sink>();
+      fc::logger                      lgr{ "async_test" };
+   };
+
+   /// formats into more than the stack buffer a value is captured in
+   struct long_value {
+      size_t length;
+      char   fill;
+   };
+
+   struct short_value {
+      int id;
+   };
+
+}
+
+template<>
+struct fmt::formatter<long_value> : fmt::formatter<std::string_view> {
+   template<typename FormatContext>
+   auto format( const long_value& v, FormatContext& ctx ) const {
+      return fmt::formatter<std::string_view>::format( std::string( v.length, v.fill ), ctx );
+   }
+};
+
+template<>
+struct fmt::formatter<short_value> : fmt::formatter<std::string_view> {
+   template<typename FormatContext>
+   auto format( const short_value& v, FormatContext& ctx ) const {
+      return fmt::formatter<std::string_view>::format( "short#" + std::to_string( v.id ), ctx );
+   }
+};
+
+BOOST_FIXTURE_TEST_SUITE(async_logging_test, async_fixture)
+
+BOOST_AUTO_TEST_CASE(values_test)
+{
+   BOOST_REQUIRE( async_logging::is_active() );
+   const std::string str = "a string";
+   const char* cstr = "c string";
+   const char* null_cstr = nullptr;
+   fc_ilog( lgr, "{i} {d} {b} {s} {c} {n}", ("i", -7)("d", 2.5)("b", true)("s", str)("c", cstr)("n", null_cstr) );
+   fc_ilog( lgr, "{short} and {long}", ("short", short_value{ 3 })("long", long_value{ 1000, 'x' }) );
+   fc_ilog( lgr, "no values" );
+   async_logging::flush();
+
+   const auto texts = sink->texts();
+   BOOST_REQUIRE_EQUAL( texts.size(), 3u );
+   BOOST_CHECK_EQUAL( texts[0], "-7 2.5 true a string c string " );
+   BOOST_CHECK_EQUAL( texts[1], "short#3 and " + std::string( 1000, 'x' ) );
+   BOOST_CHECK_EQUAL( texts[2], "no values" );
+   BOOST_CHECK_EQUAL( sink->records()[0].thread, fc::get_thread_name() );
+}
+
+BOOST_AUTO_TEST_CASE(buffer_text_test)
+{
+   // a text without values is copied when it is logged, the buffer it is in may be reused right away
+   sink->hold();
+   fc_ilog( lgr, "first" );
+   sink->wait_held();
+   char buf[32];
+   snprintf( buf, sizeof( buf ), "hello %d", 42 );
+   fc_ilog( lgr, buf );
+   memset( buf, 'X', sizeof( buf ) - 1 );
+   std::string text = "a std::string";
+   fc_ilog( lgr, text );
+   text.assign( text.size(), 'Y' );
+   sink->release();
+   async_logging::flush();
+
+   const auto texts = sink->texts();
+   BOOST_REQUIRE_EQUAL( texts.size(), 3u );
+   BOOST_CHECK_EQUAL( texts[1], "hello 42" );
+   BOOST_CHECK_EQUAL( texts[2], "a std::string" );
+}
+
+BOOST_AUTO_TEST_CASE(wrap_test)
+{
+   // records of varying size go around the 4096 byte ring many times, straddling its end
+   std::vector<std::string> expected;
+   for( uint32_t i = 0; i < 2000; ++i ) {
+      const std::string s( i % 97, char( 'a' + i % 26 ) );
+      fc_ilog( lgr, "{i}:{s}", ("i", i)("s", s) );
+      expected.push_back( std::to_string( i ) + ":" + s );
+      if( i % 10 == 9 )
+         async_logging::flush();
+   }
+   async_logging::flush();
+   BOOST_CHECK( sink->texts() == expected );
+}
+
+BOOST_AUTO_TEST_CASE(drop_test)
+{
+   const uint64_t dropped_before = async_logging::dropped_messages();
+   sink->hold();
+   fc_ilog( lgr, "first" );
+   sink->wait_held();
+
+   // the ring fills up while the background thread waits in the sink
+   const std::string payload( 200, 'p' );
+   const uint32_t logged = 100;
+   for( uint32_t i = 0; i < logged; ++i )
+      fc_ilog( lgr, "{i} {p}", ("i", i)("p", payload) );
+   const uint64_t dropped = async_logging::dropped_messages() - dropped_before;
+   BOOST_CHECK_GT( dropped, 0u );
+   BOOST_CHECK_LT( dropped, logged );
+
+   sink->release();
+   async_logging::flush();
+   const auto texts = sink->texts();
+   BOOST_REQUIRE_EQUAL( texts.size(), 1 + logged - dropped );
+   BOOST_CHECK_EQUAL( texts[0], "first" );
+   // what made it is the first messages, in order
+   for( size_t i = 1; i < texts.size(); ++i )
+      BOOST_CHECK_EQUAL( texts[i], std::to_string( i - 1 ) + " " + payload );
+
+   // room again once the ring is drained
+   fc_ilog( lgr, "after" );
+   async_logging::flush();
+   BOOST_CHECK_EQUAL( sink->texts().back(), "after" );
+   BOOST_CHECK_EQUAL( async_logging::dropped_messages() - dropped_before, dropped );
+}
+
+BOOST_AUTO_TEST_CASE(thread_exit_test)
+{
+   constexpr uint32_t threads = 4, messages = 20;
+   for( int round = 0; round < 3; ++round ) {
+      std::vector<std::thread> producers;
+      for( uint32_t t = 0; t < threads; ++t ) {
+         producers.emplace_back( [&, t]() {
+            set_thread_name( "producer-" + std::to_string( t ) );
+            for( uint32_t i = 0; i < messages; ++i )
+               fc_ilog( lgr, "{t} {i}", ("t", t)("i", i) );
+         } );
+      }
+      // the rings of exited threads are written out before they go
+      for( auto& p : producers )
+         p.join();
+      async_logging::flush();
+   }
+
+   const auto records = sink->records();
+   BOOST_REQUIRE_EQUAL( records.size(), 3 * threads * messages );
+   std::vector<uint32_t> next( threads, 0 );
+   for( const auto& r : records ) {
+      const uint32_t t = std::stoul( r.text.substr( 0, r.text.find( ' ' ) ) );
+      BOOST_REQUIRE_LT( t, threads );
+      BOOST_CHECK_EQUAL( r.thread, "producer-" + std::to_string( t ) );
+      // in order per thread
+      BOOST_CHECK_EQUAL( r.text, std::to_string( t ) + " " + std::to_string( next[t] % messages ) );
+      ++next[t];
+   }
+}
+
+BOOST_AUTO_TEST_CASE(flush_stop_test)
+{
+   for( uint32_t i = 0; i < 10; ++i )
+      fc_ilog( lgr, "queued {i}", ("i", i) );
+   async_logging::stop();
+   BOOST_CHECK( !async_logging::is_active() );
+   BOOST_CHECK_EQUAL( sink->texts().size(), 10u );
+
+   // written right away once stopped
+   fc_ilog( lgr, "synchronous" );
+   BOOST_CHECK_EQUAL( sink->texts().back(), "synchronous" );
+
+   async_logging::start( 4096 );
+   fc_ilog( lgr, "queued again" );
+   async_logging::flush();
+   BOOST_CHECK_EQUAL( sink->texts().back(), "queued again" );
+   BOOST_CHECK_EQUAL( sink->texts().size(), 12u );
+}
+
+BOOST_AUTO_TEST_CASE(reconfigure_test)
+{
+   for( int round = 0; round < 20; ++round ) {
+      auto next_sink = std::make_shared<recording_sink>();
+      const size_t written = sink->texts().size();
+      for( uint32_t i = 0; i < 10; ++i )
+         fc_ilog( lgr, "before {i}", ("i", i) );
+      // the queued records are written through the agent logger they were logged with before it is freed
+      lgr.update_agent_logger( std::make_unique<spdlog::logger>( "", next_sink ) );
+      BOOST_CHECK_EQUAL( sink->texts().size(), written + 10 );
+      fc_ilog( lgr, "after" );
+      async_logging::flush();
+      BOOST_REQUIRE_EQUAL( next_sink->texts().size(), 1u );
+      BOOST_CHECK_EQUAL( next_sink->texts()[0], "after" );
+      sink = next_sink;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
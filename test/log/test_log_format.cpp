@@ -0,0 +1,125 @@
+#define BOOST_TEST_MODULE log_format
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/log/log_format.hpp>
+#include <fc/log/log_message.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace fc;
+using fc::detail::format_error;
+using fc::detail::to_positional;
+
+namespace {
+
+   constexpr std::array<std::string_view, 3> abc{ "a", "b", "c" };
+
+   /// the positional format of in, or the error it fails with
+   template<size_t N>
+   std::string positional( std::string_view in, const std::array<std::string_view, N>& keys ) {
+      const auto scan = to_positional( in, keys, nullptr );
+      if( scan.error != format_error::none )
+         return "error " + std::to_string( int( scan.error ) );
+      std::vector<char> out( scan.size + 1, '\0' );
+      const auto written = to_positional( in, keys, out.data() );
+      BOOST_CHECK_EQUAL( written.size, scan.size );
+      return std::string( out.data(), scan.size );
+   }
+
+   std::string error( format_error e ) {
+      return "error " + std::to_string( int( e ) );
+   }
+
+   // what log_format checks when the code is built
+   static_assert( to_positional( "{a} {c}", abc, nullptr ).error == format_error::none );
+   static_assert( to_positional( "{a} {c}", abc, nullptr ).size == 7 );
+   static_assert( to_positional( "{d}", abc, nullptr ).error == format_error::unknown_key );
+   static_assert( to_positional( "{a", abc, nullptr ).error == format_error::unmatched_open_brace );
+   static_assert( to_positional( "a}", abc, nullptr ).error == format_error::unmatched_close_brace );
+   static_assert( to_positional( "{3}", abc, nullptr ).error == format_error::index_out_of_range );
+   static_assert( detail::make_positional<10>( "{c} {b:>4}", abc )[5] == '1' );
+
+}
+
+BOOST_AUTO_TEST_SUITE(log_format_test)
+
+BOOST_AUTO_TEST_CASE(named_test)
+{
+   BOOST_CHECK_EQUAL( positional( "{a}", abc ), "{0}" );
+   BOOST_CHECK_EQUAL( positional( "{c} and {a} then {c}", abc ), "{2} and {0} then {2}" );
+   BOOST_CHECK_EQUAL( positional( "no fields", abc ), "no fields" );
+   BOOST_CHECK_EQUAL( positional( "", abc ), "" );
+   // keys are matched whole
+   BOOST_CHECK_EQUAL( positional( "{ab}", std::array<std::string_view, 2>{ "a", "ab" } ), "{1}" );
+   BOOST_CHECK_EQUAL( positional( "{a}", std::array<std::string_view, 2>{ "ab", "a" } ), "{1}" );
+   BOOST_CHECK_EQUAL( positional( "{block_num}", std::array<std::string_view, 1>{ "block_num" } ), "{0}" );
+
+   // more than ten keys take two digits
+   std::array<std::string_view, 12> many{ "k0", "k1", "k2", "k3", "k4", "k5", "k6", "k7", "k8", "k9", "k10", "k11" };
+   BOOST_CHECK_EQUAL( positional( "{k11}{k0}{k10}", many ), "{11}{0}{10}" );
+}
+
+BOOST_AUTO_TEST_CASE(automatic_and_numeric_test)
+{
+   BOOST_CHECK_EQUAL( positional( "{} {} {}", abc ), "{0} {1} {2}" );
+   BOOST_CHECK_EQUAL( positional( "{1} {0}", abc ), "{1} {0}" );
+   BOOST_CHECK_EQUAL( positional( "{} {b}", abc ), "{0} {1}" );
+   BOOST_CHECK_EQUAL( positional( "{} {} {} {}", abc ), error( format_error::index_out_of_range ) );
+   BOOST_CHECK_EQUAL( positional( "{3}", abc ), error( format_error::index_out_of_range ) );
+   BOOST_CHECK_EQUAL( positional( "{1x}", abc ), error( format_error::unknown_key ) );
+   BOOST_CHECK_EQUAL( positional( "{}", std::array<std::string_view, 0>{} ), error( format_error::index_out_of_range ) );
+}
+
+BOOST_AUTO_TEST_CASE(spec_test)
+{
+   BOOST_CHECK_EQUAL( positional( "{b:>8}", abc ), "{1:>8}" );
+   BOOST_CHECK_EQUAL( positional( "{a:.{b}f}", abc ), "{0:.{1}f}" );
+   BOOST_CHECK_EQUAL( positional( "{a:{b}.{c}}", abc ), "{0:{1}.{2}}" );
+   BOOST_CHECK_EQUAL( positional( "{a:{}}", abc ), "{0:{0}}" );
+   BOOST_CHECK_EQUAL( positional( "{c:%Y-%m-%d}", abc ), "{2:%Y-%m-%d}" );
+   // the spec itself is not checked, fmt does that
+   BOOST_CHECK_EQUAL( positional( "{a:}", abc ), "{0:}" );
+}
+
+BOOST_AUTO_TEST_CASE(escape_test)
+{
+   BOOST_CHECK_EQUAL( positional( "{{a}}", abc ), "{{a}}" );
+   BOOST_CHECK_EQUAL( positional( "{{{a}}}", abc ), "{{{0}}}" );
+   BOOST_CHECK_EQUAL( positional( "json {{\"a\":{a}}}", abc ), "json {{\"a\":{0}}}" );
+   BOOST_CHECK_EQUAL( positional( "}}", abc ), "}}" );
+}
+
+BOOST_AUTO_TEST_CASE(error_test)
+{
+   BOOST_CHECK_EQUAL( positional( "{", abc ), error( format_error::unmatched_open_brace ) );
+   BOOST_CHECK_EQUAL( positional( "{a", abc ), error( format_error::unmatched_open_brace ) );
+   BOOST_CHECK_EQUAL( positional( "{a:>8", abc ), error( format_error::unmatched_open_brace ) );
+   BOOST_CHECK_EQUAL( positional( "{a{b}}", abc ), error( format_error::unmatched_open_brace ) );
+   BOOST_CHECK_EQUAL( positional( "{a:{b:{c}}}", abc ), error( format_error::unmatched_open_brace ) );
+   BOOST_CHECK_EQUAL( positional( "}", abc ), error( format_error::unmatched_close_brace ) );
+   BOOST_CHECK_EQUAL( positional( "{a}}", abc ), error( format_error::unmatched_close_brace ) );
+   BOOST_CHECK_EQUAL( positional( "{d}", abc ), error( format_error::unknown_key ) );
+   BOOST_CHECK_EQUAL( positional( "{A}", abc ), error( format_error::unknown_key ) );
+   BOOST_CHECK_EQUAL( positional( "{ a}", abc ), error( format_error::unknown_key ) );
+}
+
+BOOST_AUTO_TEST_CASE(macro_test)
+{
+   // the values are passed in the order of their keys, whatever order the fields are in
+   BOOST_CHECK_EQUAL( FC_FMT( "{b} {a} {b}", ("a", 1)("b", "two") ), "two 1 two" );
+   BOOST_CHECK_EQUAL( FC_FMT( "{n:>5}|{x:.2f}", ("x", 3.14159)("n", 42) ), "   42|3.14" );
+   BOOST_CHECK_EQUAL( FC_FMT( "{{literal}} {v}", ("v", true) ), "{literal} true" );
+
+   const auto f = FC_LOG_FORMAT( "{b} {a}", ("a", 1)("b", 2) );
+   BOOST_CHECK_EQUAL( std::string_view( fmt::string_view( f ).data(), fmt::string_view( f ).size() ), "{1} {0}" );
+   BOOST_CHECK_EQUAL( f.source(), "{b} {a}" );
+   static_assert( is_log_format<std::decay_t<decltype( f )>>::value );
+
+   // without values the format is formatted at run time, so it need not be a literal
+   const std::string runtime = "built at run time";
+   BOOST_CHECK_EQUAL( FC_FMT( runtime ), runtime );
+   BOOST_CHECK_EQUAL( FC_FMT( "{{}}" ), "{}" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+#define BOOST_TEST_MODULE log_message
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/log_message.hpp>
+#include <fc/variant_object.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fc;
+
+namespace {
+
+   std::atomic<uint32_t> formatted{0};
+
+   /// counts the times it is turned into text
+   struct counted {
+      int value;
+   };
+
+   void check_value( int v ) {
+      FC_ASSERT( v < 10, "value {v} of {name} is over {max}", ("v", v)("name", std::string( "the request" ))("max", 10) );
+   }
+
+   fc::exception caught( int v ) {
+      try {
+         check_value( v );
+      } catch( const fc::exception& e ) {
+         return e;
+      }
+      BOOST_FAIL( "not thrown" );
+      return fc::exception();
+   }
+
+}
+
+template<>
+struct fmt::formatter<counted> : fmt::formatter<int> {
+   template<typename FormatContext>
+   auto format( const counted& c, FormatContext& ctx ) const {
+      ++formatted;
+      return fmt::formatter<int>::format( c.value, ctx );
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(log_message_test)
+
+BOOST_AUTO_TEST_CASE(message_test)
+{
+   const auto m = FC_LOG_MESSAGE( info, "{i} {d} {s} {b}", ("i", -3)("d", 0.5)("s", std::string( "text" ))("b", false) );
+   BOOST_CHECK_EQUAL( m.get_message(), "-3 0.5 text false" );
+   // read again from what the first read formatted
+   BOOST_CHECK_EQUAL( m.get_message(), "-3 0.5 text false" );
+   BOOST_CHECK_EQUAL( m.to_variant()["msg"].as_string(), "-3 0.5 text false" );
+   BOOST_CHECK_EQUAL( m.get_context().get_file(), "test_log_message.cpp" );
+   BOOST_CHECK( m.get_context().get_log_level() == log_level::info );
+
+   BOOST_CHECK_EQUAL( FC_LOG_MESSAGE( warn, "no values" ).get_message(), "no values" );
+   BOOST_CHECK_EQUAL( log_message( m.to_variant() ).get_message(), "-3 0.5 text false" );
+}
+
+BOOST_AUTO_TEST_CASE(capture_test)
+{
+   // the values are copied when the message is made, it may outlive them
+   std::string text = "before";
+   int number = 1;
+   const char* cstr = "c string";
+   auto m = FC_LOG_MESSAGE( info, "{t} {n} {c}", ("t", text)("n", number)("c", cstr) );
+   text = "after";
+   number = 2;
+   BOOST_CHECK_EQUAL( m.get_message(), "before 1 c string" );
+
+   auto temporary = FC_LOG_MESSAGE( info, "{t}", ("t", std::string( 100, 'x' )) );
+   BOOST_CHECK_EQUAL( temporary.get_message(), std::string( 100, 'x' ) );
+
+   // other values are turned into text when captured, once
+   formatted = 0;
+   counted c{ 5 };
+   auto other = FC_LOG_MESSAGE( info, "{c}", ("c", c) );
+   BOOST_CHECK_EQUAL( formatted.load(), 1u );
+   c.value = 6;
+   BOOST_CHECK_EQUAL( other.get_message(), "5" );
+   BOOST_CHECK_EQUAL( other.get_message(), "5" );
+   BOOST_CHECK_EQUAL( formatted.load(), 1u );
+}
+
+BOOST_AUTO_TEST_CASE(exception_test)
+{
+   const fc::exception e = caught( 12 );
+   BOOST_CHECK_EQUAL( e.code(), fc::assert_exception_code );
+   BOOST_CHECK( e.top_message().find( "value 12 of the request is over 10" ) != std::string::npos );
+   BOOST_CHECK( e.to_string().find( "value 12 of the request is over 10" ) != std::string::npos );
+   BOOST_CHECK( e.to_detail_string().find( "value 12 of the request is over 10" ) != std::string::npos );
+   BOOST_CHECK( e.to_detail_string().find( "v < 10" ) != std::string::npos );
+
+   // a message appended on the way up is formatted with the first
+   try {
+      try {
+         check_value( 20 );
+      } FC_RETHROW_EXCEPTIONS( warn, "checking {what}", ("what", "the block") )
+   } catch( const fc::exception& r ) {
+      const std::string detail = r.to_detail_string();
+      BOOST_CHECK( detail.find( "value 20 of the request is over 10" ) != std::string::npos );
+      BOOST_CHECK( detail.find( "checking the block" ) != std::string::npos );
+      BOOST_CHECK_EQUAL( r.get_log().size(), 2u );
+   }
+
+   BOOST_CHECK_EXCEPTION( FC_THROW_EXCEPTION( fc::invalid_arg_exception, "bad {arg}", ("arg", 7) ), fc::invalid_arg_exception,
+                          []( const fc::exception& x ) { return x.top_message().find( "bad 7" ) != std::string::npos; } );
+}
+
+BOOST_AUTO_TEST_CASE(threads_test)
+{
+   // copies of an exception share its messages, the first read on any thread formats them
+   for( int round = 0; round < 50; ++round ) {
+      const fc::exception e = caught( 100 + round );
+      const std::string expected = "value " + std::to_string( 100 + round ) + " of the request is over 10";
+      std::atomic<bool> go{ false };
+      std::atomic<uint32_t> matched{ 0 };
+      std::vector<std::thread> threads;
+      for( int t = 0; t < 4; ++t ) {
+         threads.emplace_back( [&, copy = e]() {
+            while( !go )
+               std::this_thread::yield();
+            const std::string detail = copy.to_detail_string();
+            matched += detail.find( expected ) != std::string::npos && detail == e.to_detail_string();
+         } );
+      }
+      go = true;
+      for( auto& t : threads )
+         t.join();
+      BOOST_CHECK_EQUAL( matched.load(), 4u );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+#define BOOST_TEST_MODULE log_site
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/log/log_site.hpp>
+
+#include <algorithm>
+
+using namespace fc;
+
+namespace {
+   fc::logger make_logger( const std::string& name, log_level level ) {
+      fc::logger l( name );
+      l.set_log_level( level );
+      return l;
+   }
+
+   std::optional<log_site::info> find_registered( uint32_t line ) {
+      for( auto& i : log_site::registered() ) {
+         if( i.line == line && i.file == __FILE__ )
+            return i;
+      }
+      return {};
+   }
+}
+
+#define TEST_LOG_SITE( NAME, LEVEL ) \
+   static fc::log_site NAME{ spdlog::source_loc{ __FILE__, __LINE__, SPDLOG_FUNCTION }, fc::log_level::LEVEL }
+
+BOOST_AUTO_TEST_SUITE(log_site_test)
+
+BOOST_AUTO_TEST_CASE(registered_test)
+{
+   TEST_LOG_SITE( site, info );
+   const uint32_t line = site.loc.line;
+   BOOST_CHECK( !find_registered( line ) );
+
+   const auto l = make_logger( "registered_test", log_level::info );
+   BOOST_CHECK( site.is_enabled( l ) );
+   const auto i = find_registered( line );
+   BOOST_REQUIRE( i );
+   BOOST_CHECK_EQUAL( i->function, SPDLOG_FUNCTION );
+   BOOST_CHECK( i->level == log_level::info );
+   BOOST_CHECK_EQUAL( i->logger, "registered_test" );
+   BOOST_CHECK( i->site_mode == log_site::mode::follow_logger );
+
+   // registered once
+   BOOST_CHECK( site.is_enabled( l ) );
+   const auto all = log_site::registered();
+   BOOST_CHECK_EQUAL( std::count_if( all.begin(), all.end(), [&]( const auto& r ) { return r.line == line && r.file == __FILE__; } ), 1 );
+}
+
+BOOST_AUTO_TEST_CASE(per_logger_test)
+{
+   TEST_LOG_SITE( site, debug );
+   const auto debug_logger = make_logger( "debug_logger", log_level::debug );
+   const auto error_logger = make_logger( "error_logger", log_level::error );
+
+   // the answer cached for one logger is not the one of the other
+   for( int i = 0; i < 3; ++i ) {
+      BOOST_CHECK( site.is_enabled( debug_logger ) );
+      BOOST_CHECK( site.is_enabled( debug_logger ) );
+      BOOST_CHECK( !site.is_enabled( error_logger ) );
+      BOOST_CHECK( !site.is_enabled( error_logger ) );
+   }
+   BOOST_CHECK_EQUAL( find_registered( site.loc.line )->logger, "error_logger" );
+}
+
+BOOST_AUTO_TEST_CASE(invalidate_test)
+{
+   TEST_LOG_SITE( site, info );
+   auto l = make_logger( "invalidate_test", log_level::info );
+   BOOST_CHECK( site.is_enabled( l ) );
+
+   l.set_log_level( log_level::warn );
+   BOOST_CHECK( !site.is_enabled( l ) );
+   l.set_log_level( log_level::debug );
+   BOOST_CHECK( site.is_enabled( l ) );
+
+   // assigning the variable the site logs through
+   l = make_logger( "other", log_level::error );
+   BOOST_CHECK( !site.is_enabled( l ) );
+
+   // a logger allocated where a destroyed one was does not take its answers
+   for( int i = 0; i < 8; ++i ) {
+      {
+         const auto on = make_logger( "on", log_level::all );
+         BOOST_CHECK( site.is_enabled( on ) );
+      }
+      const auto off = make_logger( "off", log_level::off );
+      BOOST_CHECK( !site.is_enabled( off ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(set_mode_test)
+{
+   TEST_LOG_SITE( site, debug );
+   TEST_LOG_SITE( neighbour, debug );
+   const auto l = make_logger( "set_mode_test", log_level::info );
+   BOOST_CHECK( !site.is_enabled( l ) );
+   BOOST_CHECK( !neighbour.is_enabled( l ) );
+
+   BOOST_CHECK_EQUAL( log_site::set_mode( "test_log_site.cpp", site.loc.line, log_site::mode::enabled ), 1u );
+   BOOST_CHECK( site.is_enabled( l ) );
+   BOOST_CHECK( site.is_forced() );
+   BOOST_CHECK( find_registered( site.loc.line )->site_mode == log_site::mode::enabled );
+   BOOST_CHECK( !neighbour.is_enabled( l ) );
+
+   // enabled above the level of the logger is not forced
+   const auto debug_logger = make_logger( "debug_logger", log_level::debug );
+   BOOST_CHECK( site.is_enabled( debug_logger ) );
+   BOOST_CHECK( !site.is_forced() );
+
+   BOOST_CHECK_EQUAL( log_site::set_mode( "test_log_site.cpp", site.loc.line, log_site::mode::disabled ), 1u );
+   BOOST_CHECK( !site.is_enabled( debug_logger ) );
+
+   BOOST_CHECK_EQUAL( log_site::set_mode( "test_log_site.cpp", site.loc.line, log_site::mode::follow_logger ), 1u );
+   BOOST_CHECK( site.is_enabled( debug_logger ) );
+   BOOST_CHECK( !site.is_enabled( l ) );
+
+   // a site that has not run yet takes the mode of the rule when it does
+   TEST_LOG_SITE( later, debug );
+   BOOST_CHECK_EQUAL( log_site::set_mode( "log/test_log_site.cpp", later.loc.line, log_site::mode::enabled ), 0u );
+   BOOST_CHECK( later.is_enabled( l ) );
+   BOOST_CHECK( later.is_forced() );
+   BOOST_CHECK( find_registered( later.loc.line )->site_mode == log_site::mode::enabled );
+
+   // a file matches by the end of its path
+   BOOST_CHECK_EQUAL( log_site::set_mode( "other_file.cpp", 0, log_site::mode::enabled ), 0u );
+   BOOST_CHECK_EQUAL( log_site::set_mode( "no_such_dir/test_log_site.cpp", 0, log_site::mode::enabled ), 0u );
+   BOOST_CHECK( !neighbour.is_enabled( l ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,308 @@
+#define BOOST_TEST_MODULE zipkin
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/log/zipkin.hpp>
+#include <fc/crypto/hex.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include "../network/http_test_server.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace fc;
+
+namespace {
+
+   /// the span as it was sent before zipkin_span_encoder, through a mutable_variant_object
+   fc::variant span_variant( const zipkin_span::span_data& span, const std::string& service_name,
+                             const std::string& local_address, bool is_v4 ) {
+      fc::mutable_variant_object mvo;
+      mvo( "id", fc::to_hex( reinterpret_cast<const char*>(&span.id), sizeof( span.id ) ) );
+      mvo( "traceId", fc::to_hex( reinterpret_cast<const char*>(&span.trace_id), sizeof( span.trace_id ) ) );
+      if( span.parent_id != 0 ) {
+         mvo( "parentId", fc::to_hex( reinterpret_cast<const char*>(&span.parent_id), sizeof( span.parent_id ) ) );
+      }
+      mvo( "name", span.name );
+      mvo( "timestamp", span.start.time_since_epoch().count() );
+      mvo( "duration", (span.stop - span.start).count() );
+
+      mutable_variant_object local_endpoint_mvo( "serviceName", service_name );
+      if( !local_address.empty() )
+         local_endpoint_mvo( is_v4 ? "ipv4" : "ipv6", local_address );
+      mvo( "localEndpoint", local_endpoint_mvo );
+
+      fc::mutable_variant_object tags;
+      for( const auto& t : span.tags )
+         tags( t.first, t.second );
+      mvo( "tags", std::move( tags ) );
+      return mvo;
+   }
+
+   std::string encode( const zipkin_span::span_data& span, const std::string& service_name,
+                       const std::string& local_address, bool is_v4 ) {
+      std::string out;
+      zipkin_span_encoder( service_name, local_address, is_v4 ).append( out, span );
+      return out;
+   }
+
+   std::string variant_json( const zipkin_span::span_data& span, const std::string& service_name,
+                             const std::string& local_address, bool is_v4 ) {
+      return json::to_string( span_variant( span, service_name, local_address, is_v4 ), fc::time_point::maximum(),
+                              json::output_formatting::legacy_generator );
+   }
+
+   zipkin_span::span_data make_span( uint64_t id, std::string name, uint64_t trace_id, uint64_t parent_id ) {
+      zipkin_span::span_data span( id, std::move( name ), trace_id, parent_id );
+      span.stop = span.start + fc::microseconds( 1234 );
+      return span;
+   }
+
+   /// names of the spans of each batch the server received
+   std::vector<std::vector<std::string>> received_batches( const http_test_util::http_test_server& server ) {
+      std::vector<std::vector<std::string>> batches;
+      for( const auto& r : server.requests() ) {
+         batches.emplace_back();
+         const variant spans = json::from_string( r.body );
+         for( const auto& span : spans.get_array() )
+            batches.back().push_back( span["name"].as_string() );
+      }
+      return batches;
+   }
+
+   std::vector<std::string> received_spans( const http_test_util::http_test_server& server ) {
+      std::vector<std::string> names;
+      for( const auto& b : received_batches( server ) )
+         names.insert( names.end(), b.begin(), b.end() );
+      return names;
+   }
+
+   template<typename Predicate>
+   bool wait_for( Predicate&& p ) {
+      for( int i = 0; i < 1000 && !p(); ++i )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+      return p();
+   }
+
+   std::vector<std::string> span_names( size_t n, size_t first = 0 ) {
+      std::vector<std::string> names;
+      for( size_t i = first; i < first + n; ++i )
+         names.push_back( "span " + std::to_string( i ) );
+      return names;
+   }
+
+   void log_spans( zipkin& z, size_t n, size_t first = 0, const std::string& tag = std::string() ) {
+      for( const auto& name : span_names( n, first ) ) {
+         auto span = make_span( zipkin_span::to_id( fc::sha256::hash( name ) ), name, 0, 0 );
+         if( !tag.empty() )
+            span.set_tag( "tag", tag );
+         z.log( std::move( span ) );
+      }
+   }
+
+   /// the zipkin of zipkin_config, replacing the one of the previous test
+   zipkin& start_zipkin( const http_test_util::http_test_server& server, const zipkin_export_config& config ) {
+      const uint32_t timeout_us = 5 * 1000 * 1000;
+      const uint32_t retry_interval_us = 20 * 1000;
+      zipkin_config::init( server.url( "/api/v2/spans" ), "test", timeout_us, retry_interval_us, 0, config );
+      return zipkin_config::get_zipkin();
+   }
+
+}
+
+BOOST_AUTO_TEST_SUITE(zipkin_test)
+
+BOOST_AUTO_TEST_CASE(encoder_matches_variant_test)
+{
+   const std::string names[] = { "", "produce_block", "quote\" backslash\\ slash/", "control\x01\x1f\n\t",
+                                 "utf8 \xc3\xa9\xe2\x82\xac", std::string( 300, 'n' ) };
+   const uint64_t ids[] = { 1, 0x0123456789abcdefull, ~0ull };
+   for( const auto& name : names ) {
+      for( uint64_t id : ids ) {
+         for( uint64_t parent : { uint64_t( 0 ), uint64_t( id ^ 0xff00ff00 ) } ) {
+            auto span = make_span( id, name, id + 7, parent );
+            span.set_tag( "block", "100" );
+            span.set_tag( name, name );
+            for( const auto& [service, address, v4] : { std::tuple{ std::string( "nodeos" ), std::string(), true },
+                                                        std::tuple{ std::string( "svc \"1\"" ), std::string( "127.0.0.1" ), true },
+                                                        std::tuple{ std::string( "nodeos" ), std::string( "::1" ), false } } ) {
+               BOOST_CHECK_EQUAL( encode( span, service, address, v4 ), variant_json( span, service, address, v4 ) );
+            }
+         }
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(tags_test)
+{
+   auto span = make_span( 5, "tags", 0, 0 );
+   BOOST_CHECK_EQUAL( span.trace_id, 5u );
+   BOOST_CHECK_EQUAL( encode( span, "s", "", true ), variant_json( span, "s", "", true ) );
+
+   // a tag set again keeps its place and takes the new value
+   span.set_tag( "k", "1" );
+   span.set_tag( "other", "" );
+   span.set_tag( "k", "2" );
+   BOOST_REQUIRE_EQUAL( span.tags.size(), 2u );
+   const std::string encoded = encode( span, "s", "", true );
+   BOOST_CHECK_EQUAL( encoded, variant_json( span, "s", "", true ) );
+   BOOST_CHECK( encoded.find( R"("tags":{"k":"2","other":""})" ) != std::string::npos );
+
+   // as the mutable_variant_object the tags were kept in did
+   mutable_variant_object tags;
+   tags( "k", std::string( "1" ) )( "other", std::string() )( "k", std::string( "2" ) );
+   BOOST_CHECK_EQUAL( json::to_string( variant( tags ), fc::time_point::maximum() ), R"({"k":"2","other":""})" );
+}
+
+BOOST_AUTO_TEST_CASE(append_test)
+{
+   // spans are appended to what the buffer already holds
+   const zipkin_span_encoder encoder( "s", "10.0.0.1", true );
+   auto a = make_span( 1, "a", 0, 0 );
+   auto b = make_span( 2, "b", 1, 1 );
+   b.set_tag( "t", "v" );
+   std::string out = "[";
+   encoder.append( out, a );
+   out += ',';
+   encoder.append( out, b );
+   out += ']';
+   BOOST_CHECK_EQUAL( out, "[" + variant_json( a, "s", "10.0.0.1", true ) + "," + variant_json( b, "s", "10.0.0.1", true ) + "]" );
+   BOOST_CHECK_EQUAL( json::to_string( json::from_string( out ), fc::time_point::maximum(), json::output_formatting::legacy_generator ), out );
+}
+
+BOOST_AUTO_TEST_CASE(batch_by_count_test)
+{
+   http_test_util::http_test_server server;
+   zipkin_export_config config;
+   config.max_batch_spans = 10;
+   config.flush_interval_us = 60 * 1000 * 1000;
+   zipkin& z = start_zipkin( server, config );
+
+   // a full batch is posted without waiting for the flush interval
+   log_spans( z, 10 );
+   BOOST_REQUIRE( wait_for( [&]() { return received_spans( server ).size() == 10; } ) );
+   log_spans( z, 25, 10 );
+   BOOST_REQUIRE( wait_for( [&]() { return received_spans( server ).size() >= 30; } ) );
+   z.shutdown();
+
+   BOOST_CHECK( received_spans( server ) == span_names( 35 ) );
+   for( const auto& b : received_batches( server ) )
+      BOOST_CHECK_LE( b.size(), 10u );
+   for( const auto& r : server.requests() )
+      BOOST_CHECK_EQUAL( r.target, "/api/v2/spans" );
+   BOOST_CHECK_EQUAL( z.dropped_spans(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE(batch_by_bytes_test)
+{
+   http_test_util::http_test_server server;
+   zipkin_export_config config;
+   config.max_batch_spans = 1000;
+   config.max_batch_bytes = 4096;
+   config.flush_interval_us = 60 * 1000 * 1000;
+   zipkin& z = start_zipkin( server, config );
+
+   const std::string tag( 1000, 't' );
+   log_spans( z, 20, 0, tag );
+   z.shutdown();
+
+   // a batch is cut by the first span that takes it to max_batch_bytes
+   BOOST_CHECK( received_spans( server ) == span_names( 20 ) );
+   const auto requests = server.requests();
+   BOOST_REQUIRE_GE( requests.size(), 2u );
+   for( size_t i = 0; i < requests.size(); ++i ) {
+      if( i + 1 < requests.size() )
+         BOOST_CHECK_GE( requests[i].body.size(), config.max_batch_bytes );
+      BOOST_CHECK_LT( requests[i].body.size(), config.max_batch_bytes + tag.size() + 500 );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(flush_interval_test)
+{
+   http_test_util::http_test_server server;
+   zipkin_export_config config;
+   config.flush_interval_us = 20 * 1000;
+   zipkin& z = start_zipkin( server, config );
+
+   // fewer spans than a batch are posted by the timer
+   log_spans( z, 3 );
+   BOOST_CHECK( wait_for( [&]() { return received_spans( server ).size() == 3; } ) );
+   log_spans( z, 2, 3 );
+   BOOST_CHECK( wait_for( [&]() { return received_spans( server ).size() == 5; } ) );
+   BOOST_CHECK( received_spans( server ) == span_names( 5 ) );
+   z.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE(post_request_test)
+{
+   http_test_util::http_test_server server;
+   zipkin_export_config config;
+   config.flush_interval_us = 60 * 1000 * 1000;
+   zipkin& z = start_zipkin( server, config );
+
+   log_spans( z, 2 );
+   auto span = make_span( 77, "span 2", 0, 0 );
+   z.post_request( std::move( span ) );
+   BOOST_CHECK( wait_for( [&]() { return received_spans( server ).size() == 3; } ) );
+   BOOST_CHECK( received_spans( server ) == span_names( 3 ) );
+   z.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE(retry_test)
+{
+   // the first posts fail, the batch is kept and posted again as it was
+   std::atomic<int> failures{ 3 };
+   http_test_util::http_test_server server( [&]( const auto& ) {
+      http_test_util::http_test_server::response res;
+      if( failures.fetch_sub( 1 ) > 0 ) {
+         res.status = http_test_util::http::status::internal_server_error;
+         res.body = "not json";
+      }
+      return res;
+   } );
+   zipkin_export_config config;
+   config.flush_interval_us = 10 * 1000;
+   zipkin& z = start_zipkin( server, config );
+
+   log_spans( z, 5 );
+   BOOST_REQUIRE( wait_for( [&]() { return server.requests().size() >= 4; } ) );
+   z.shutdown();
+
+   const auto requests = server.requests();
+   BOOST_REQUIRE_EQUAL( requests.size(), 4u );
+   for( const auto& r : requests )
+      BOOST_CHECK_EQUAL( r.body, requests.front().body );
+   BOOST_CHECK( received_batches( server ).back() == span_names( 5 ) );
+   BOOST_CHECK_EQUAL( z.dropped_spans(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE(overflow_test)
+{
+   // the zipkin thread waits in the first post while the queue fills up
+   std::atomic<bool> hold{ true };
+   http_test_util::http_test_server server( [&]( const auto& ) {
+      while( hold )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      return http_test_util::http_test_server::response();
+   } );
+   zipkin_export_config config;
+   config.queue_capacity = 8;
+   config.max_batch_spans = 1;
+   config.flush_interval_us = 60 * 1000 * 1000;
+   zipkin& z = start_zipkin( server, config );
+
+   log_spans( z, 1 );
+   BOOST_REQUIRE( wait_for( [&]() { return server.requests().size() == 1; } ) );
+   log_spans( z, 20, 1 );
+   BOOST_CHECK_EQUAL( z.dropped_spans(), 20u - 8u );
+   hold = false;
+   z.shutdown();
+
+   // the spans that fit, in order
+   BOOST_CHECK( received_spans( server ) == span_names( 9 ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
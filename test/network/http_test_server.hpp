@@ -0,0 +1,218 @@
+#pragma once
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <sys/socket.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace http_test_util {
+
+   namespace http = boost::beast::http;
+   namespace ssl = boost::asio::ssl;
+   using tcp = boost::asio::ip::tcp;
+
+   /**
+    *  HTTP/1.1 server on a port of 127.0.0.1 for the tests of the http client. Each connection is served
+    *  by a thread of its own that reads its requests one after the other, so pipelined requests wait in
+    *  its buffer, and answers each with what the handler returns for it.
+    */
+   class http_test_server {
+   public:
+      struct request {
+         std::string   target;
+         std::string   body;
+         http::fields  headers;
+         size_t        connection = 0;   ///< in the order the connections were accepted
+         size_t        buffered = 0;     ///< bytes of the requests behind it received when it was read
+      };
+
+      struct response {
+         http::status                                     status = http::status::ok;
+         std::string                                      body = "{}";
+         std::vector<std::pair<http::field, std::string>> headers;
+         std::chrono::milliseconds                        delay{ 0 };   ///< before the response is written
+         bool                                             close = false;   ///< answers with Connection: close
+         bool                                             drop = false;    ///< closes the connection without an answer
+      };
+
+      using handler = std::function<response( const request& )>;
+
+      /// serves TLS when tls is given, it must outlive the server
+      explicit http_test_server( handler h = {}, ssl::context* tls = nullptr )
+      :_handler( std::move( h ) ), _tls( tls ), _https( tls != nullptr ), _acceptor( _ioc, tcp::endpoint( boost::asio::ip::make_address( "127.0.0.1" ), 0 ) ) {
+         _accept_thread = std::thread( [this]() { accept_loop(); } );
+      }
+
+      ~http_test_server() {
+         {
+            std::lock_guard g( _mutex );
+            _stopped = true;
+         }
+         ::shutdown( _acceptor.native_handle(), SHUT_RDWR );
+         _accept_thread.join();
+         close_connections();
+         for( auto& t : _connection_threads )
+            t.join();
+      }
+
+      uint16_t port()const { return _acceptor.local_endpoint().port(); }
+
+      std::string url( const std::string& path = "/v1/test" )const {
+         return std::string( _https ? "https" : "http" ) + "://127.0.0.1:" + std::to_string( port() ) + path;
+      }
+
+      std::vector<request> requests()const {
+         std::lock_guard g( _mutex );
+         return _requests;
+      }
+
+      size_t connections()const {
+         std::lock_guard g( _mutex );
+         return _connection_threads.size();
+      }
+
+      /// connections open at the moment
+      size_t open_connections()const {
+         std::lock_guard g( _mutex );
+         size_t n = 0;
+         for( const auto& s : _sockets )
+            n += s != nullptr;
+         return n;
+      }
+
+      /// closes the open connections, as a server closing idle keep-alive connections does
+      void close_connections() {
+         std::lock_guard g( _mutex );
+         for( auto& s : _sockets ) {
+            if( s )
+               ::shutdown( s->native_handle(), SHUT_RDWR );
+         }
+      }
+
+      void set_handler( handler h ) {
+         std::lock_guard g( _mutex );
+         _handler = std::move( h );
+      }
+
+      /// the connections accepted from now on serve TLS with tls, or plain HTTP without it
+      void set_tls( ssl::context* tls ) {
+         std::lock_guard g( _mutex );
+         _tls = tls;
+      }
+
+   private:
+      void accept_loop() {
+         while( true ) {
+            auto socket = std::make_shared<tcp::socket>( _ioc );
+            boost::system::error_code ec;
+            _acceptor.accept( *socket, ec );
+            std::lock_guard g( _mutex );
+            if( _stopped || ec )
+               return;
+            const size_t index = _sockets.size();
+            _sockets.push_back( socket );
+            _connection_threads.emplace_back( [this, socket, index, tls = _tls]() {
+               if( tls ) {
+                  ssl::stream<tcp::socket&> stream( *socket, *tls );
+                  boost::system::error_code ec;
+                  stream.handshake( ssl::stream_base::server, ec );
+                  if( !ec )
+                     serve( stream, index );
+               } else {
+                  serve( *socket, index );
+               }
+               std::lock_guard g( _mutex );
+               boost::system::error_code ec;
+               socket->close( ec );
+               _sockets[index].reset();
+            } );
+         }
+      }
+
+      template<typename Stream>
+      void serve( Stream& stream, size_t index ) {
+         boost::beast::flat_buffer buffer;
+         while( true ) {
+            http::request<http::string_body> req;
+            boost::system::error_code ec;
+            http::read( stream, buffer, req, ec );
+            if( ec )
+               return;
+
+            request r{ std::string( req.target() ), req.body(), {}, index, buffer.size() };
+            for( const auto& f : req.base() )
+               r.headers.insert( f.name_string(), f.value() );
+            handler h;
+            {
+               std::lock_guard g( _mutex );
+               _requests.push_back( r );
+               h = _handler;
+            }
+            const response out = h ? h( r ) : response();
+            if( out.delay.count() )
+               std::this_thread::sleep_for( out.delay );
+            if( out.drop )
+               return;
+
+            http::response<http::string_body> res{ out.status, 11 };
+            for( const auto& [field, value] : out.headers )
+               res.set( field, value );
+            res.set( http::field::content_type, "application/json" );
+            res.keep_alive( !out.close && req.keep_alive() );
+            res.body() = out.body;
+            res.prepare_payload();
+            http::write( stream, res, ec );
+            if( ec || !res.keep_alive() )
+               return;
+         }
+      }
+
+      handler                               _handler;
+      ssl::context*                         _tls;
+      const bool                            _https;   ///< as the server was constructed
+      boost::asio::io_context               _ioc;
+      tcp::acceptor                         _acceptor;
+      mutable std::mutex                    _mutex;
+      bool                                  _stopped = false;
+      std::vector<std::shared_ptr<tcp::socket>> _sockets;   ///< by connection, reset once it is closed
+      std::vector<std::thread>              _connection_threads;
+      std::vector<request>                  _requests;
+      std::thread                           _accept_thread;
+   };
+
+   /// a TLS server context with a new self-signed certificate for localhost
+   inline std::unique_ptr<ssl::context> make_tls_context( int max_version = TLS1_3_VERSION ) {
+      auto ctx = std::make_unique<ssl::context>( ssl::context::tls_server );
+      EVP_PKEY* key = EVP_EC_gen( "P-256" );
+      X509* cert = X509_new();
+      X509_set_version( cert, 2 );
+      ASN1_INTEGER_set( X509_get_serialNumber( cert ), 1 );
+      X509_gmtime_adj( X509_getm_notBefore( cert ), -3600 );
+      X509_gmtime_adj( X509_getm_notAfter( cert ), 24 * 3600 );
+      X509_set_pubkey( cert, key );
+      X509_NAME* name = X509_get_subject_name( cert );
+      X509_NAME_add_entry_by_txt( name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>( "localhost" ), -1, -1, 0 );
+      X509_set_issuer_name( cert, name );
+      X509_sign( cert, key, EVP_sha256() );
+      SSL_CTX_use_certificate( ctx->native_handle(), cert );
+      SSL_CTX_use_PrivateKey( ctx->native_handle(), key );
+      SSL_CTX_set_max_proto_version( ctx->native_handle(), max_version );
+      X509_free( cert );
+      EVP_PKEY_free( key );
+      return ctx;
+   }
+
+} // namespace http_test_util
@@ -0,0 +1,429 @@
+#define BOOST_TEST_MODULE http_client
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/network/http/http_client.hpp>
+#include <fc/compress/zlib.hpp>
+#include <fc/network/url.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+
+#include "http_test_server.hpp"
+#include "../compress/gzip_test_util.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fc;
+using http_test_util::http_test_server;
+
+namespace {
+
+   /// answers each request with its own body
+   http_test_server::response echo( const http_test_server::request& r ) {
+      http_test_server::response res;
+      res.body = r.body;
+      return res;
+   }
+
+   std::string body( int i ) {
+      return "{\"i\":" + std::to_string( i ) + "}";
+   }
+
+   int id_of( const variant& v ) {
+      return v["i"].as_int64();
+   }
+
+   std::string error_of( std::future<variant>& f ) {
+      try {
+         f.get();
+      } catch( const fc::exception& e ) {
+         return e.to_detail_string();
+      }
+      return std::string();
+   }
+
+   template<typename Predicate>
+   bool wait_for( Predicate&& p ) {
+      for( int i = 0; i < 1000 && !p(); ++i )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+      return p();
+   }
+
+   fc::time_point in_ms( int64_t ms ) {
+      return fc::time_point::now() + fc::milliseconds( ms );
+   }
+
+   /// a JSON body long enough to be compressed in several blocks
+   std::string json_body( size_t values ) {
+      std::string s = "{\"i\":7,\"values\":[";
+      for( size_t i = 0; i < values; ++i )
+         s += ( i ? ",\"" : "\"" ) + std::to_string( i ) + "\"";
+      return s + "]}";
+   }
+
+   /// answers every request with body, sent with the given Content-Encoding
+   http_test_server::handler respond_with( std::string body, std::string encoding ) {
+      return [body = std::move( body ), encoding = std::move( encoding )]( const auto& ) {
+         http_test_server::response res;
+         res.body = body;
+         if( !encoding.empty() )
+            res.headers.emplace_back( http_test_util::http::field::content_encoding, encoding );
+         return res;
+      };
+   }
+
+   http_client::response_config response_config( bool streaming, uint64_t max_body_size = 8 * 1024 * 1024 ) {
+      http_client::response_config config;
+      config.max_body_size = max_body_size;
+      config.streaming = streaming;
+      config.accept_compressed = true;
+      return config;
+   }
+
+   std::string sync_error( http_client& client, const url& dest ) {
+      try {
+         client.post_sync_json( dest, "{}" );
+      } catch( const fc::exception& e ) {
+         return e.to_detail_string();
+      }
+      return std::string();
+   }
+
+}
+
+BOOST_AUTO_TEST_SUITE(http_client_pool_test)
+
+BOOST_AUTO_TEST_CASE(order_test)
+{
+   http_test_server server( echo );
+   http_client client;
+   const url dest( server.url() );
+
+   std::vector<std::future<variant>> results;
+   for( int i = 0; i < 50; ++i )
+      results.push_back( client.post_async_json( dest, body( i ) ) );
+   // every callback gets the response of its own request
+   for( int i = 0; i < 50; ++i )
+      BOOST_CHECK_EQUAL( id_of( results[i].get() ), i );
+   BOOST_CHECK_EQUAL( server.requests().size(), 50u );
+   BOOST_CHECK_LE( server.connections(), 4u );
+   for( const auto& r : server.requests() )
+      BOOST_CHECK_EQUAL( r.target, "/v1/test" );
+}
+
+BOOST_AUTO_TEST_CASE(pipelining_test)
+{
+   // the responses come back slowly, so the requests behind the first are written ahead of them
+   http_test_server server( []( const auto& r ) {
+      auto res = echo( r );
+      res.delay = std::chrono::milliseconds( 20 );
+      return res;
+   } );
+   http_client::pool_config config;
+   config.max_connections_per_host = 1;
+   config.pipeline_depth = 4;
+   http_client client( config );
+   const url dest( server.url() );
+
+   std::vector<std::future<variant>> results;
+   for( int i = 0; i < 12; ++i )
+      results.push_back( client.post_async_json( dest, body( i ) ) );
+   for( int i = 0; i < 12; ++i )
+      BOOST_CHECK_EQUAL( id_of( results[i].get() ), i );
+
+   BOOST_CHECK_EQUAL( server.connections(), 1u );
+   size_t pipelined = 0;
+   for( const auto& r : server.requests() )
+      pipelined += r.buffered > 0;
+   BOOST_CHECK_GT( pipelined, 0u );
+}
+
+BOOST_AUTO_TEST_CASE(no_pipelining_test)
+{
+   http_test_server server( []( const auto& r ) {
+      auto res = echo( r );
+      res.delay = std::chrono::milliseconds( 10 );
+      return res;
+   } );
+   http_client::pool_config config;
+   config.max_connections_per_host = 1;
+   http_client client( config );
+   const url dest( server.url() );
+
+   std::vector<std::future<variant>> results;
+   for( int i = 0; i < 6; ++i )
+      results.push_back( client.post_async_json( dest, body( i ) ) );
+   for( int i = 0; i < 6; ++i )
+      BOOST_CHECK_EQUAL( id_of( results[i].get() ), i );
+
+   // a request is only written once the response before it was read
+   BOOST_CHECK_EQUAL( server.connections(), 1u );
+   for( const auto& r : server.requests() )
+      BOOST_CHECK_EQUAL( r.buffered, 0u );
+}
+
+BOOST_AUTO_TEST_CASE(connections_test)
+{
+   http_test_server server( []( const auto& r ) {
+      auto res = echo( r );
+      res.delay = std::chrono::milliseconds( 100 );
+      return res;
+   } );
+   http_client::pool_config config;
+   config.max_connections_per_host = 3;
+   http_client client( config );
+   const url dest( server.url() );
+
+   std::vector<std::future<variant>> results;
+   for( int i = 0; i < 9; ++i )
+      results.push_back( client.post_async_json( dest, body( i ) ) );
+   for( int i = 0; i < 9; ++i )
+      BOOST_CHECK_EQUAL( id_of( results[i].get() ), i );
+   // a connection is opened while the open ones are busy, up to the limit
+   BOOST_CHECK_EQUAL( server.connections(), 3u );
+}
+
+BOOST_AUTO_TEST_CASE(max_in_flight_test)
+{
+   std::atomic<bool> hold{ true };
+   http_test_server server( [&]( const auto& r ) {
+      while( hold )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      return echo( r );
+   } );
+   http_client::pool_config config;
+   config.max_in_flight = 2;
+   http_client client( config );
+   const url dest( server.url() );
+
+   auto first = client.post_async_json( dest, body( 0 ) );
+   auto second = client.post_async_json( dest, body( 1 ) );
+   auto rejected = client.post_async_json( dest, body( 2 ) );
+   BOOST_CHECK( error_of( rejected ).find( "Too many requests in flight" ) != std::string::npos );
+   hold = false;
+   BOOST_CHECK_EQUAL( id_of( first.get() ), 0 );
+   BOOST_CHECK_EQUAL( id_of( second.get() ), 1 );
+
+   // completed requests make room again
+   BOOST_CHECK_EQUAL( id_of( client.post_async_json( dest, body( 3 ) ).get() ), 3 );
+   BOOST_CHECK_EQUAL( server.requests().size(), 3u );
+}
+
+BOOST_AUTO_TEST_CASE(deadline_test)
+{
+   http_test_server server( []( const auto& r ) {
+      auto res = echo( r );
+      if( id_of( json::from_string( r.body ) ) >= 100 )
+         res.delay = std::chrono::milliseconds( 300 );
+      return res;
+   } );
+   http_client::pool_config config;
+   config.max_connections_per_host = 1;
+   http_client client( config );
+   const url dest( server.url() );
+
+   // a written request that expires takes its connection with it, the queued one goes to a new connection
+   auto slow = client.post_async_json( dest, body( 100 ), in_ms( 50 ) );
+   auto queued = client.post_async_json( dest, body( 1 ) );
+   BOOST_CHECK( error_of( slow ).find( "Request timed out" ) != std::string::npos );
+   BOOST_CHECK_EQUAL( id_of( queued.get() ), 1 );
+   BOOST_CHECK_EQUAL( server.connections(), 2u );
+
+   // a request that expires before it is written leaves the connection alone
+   auto answered = client.post_async_json( dest, body( 101 ) );
+   auto expired = client.post_async_json( dest, body( 2 ), in_ms( 50 ) );
+   BOOST_CHECK( error_of( expired ).find( "Request timed out" ) != std::string::npos );
+   BOOST_CHECK_EQUAL( id_of( answered.get() ), 101 );
+   BOOST_CHECK_EQUAL( id_of( client.post_async_json( dest, body( 3 ) ).get() ), 3 );
+   BOOST_CHECK_EQUAL( server.connections(), 2u );
+   BOOST_CHECK_EQUAL( server.requests().size(), 4u );
+}
+
+BOOST_AUTO_TEST_CASE(connection_close_test)
+{
+   // the requests written behind the response that closes the connection are sent again
+   http_test_server server( []( const auto& r ) {
+      auto res = echo( r );
+      res.delay = std::chrono::milliseconds( 10 );
+      res.close = id_of( json::from_string( r.body ) ) == 1;
+      return res;
+   } );
+   http_client::pool_config config;
+   config.max_connections_per_host = 1;
+   config.pipeline_depth = 4;
+   http_client client( config );
+   const url dest( server.url() );
+
+   std::vector<std::future<variant>> results;
+   for( int i = 0; i < 6; ++i )
+      results.push_back( client.post_async_json( dest, body( i ) ) );
+   for( int i = 0; i < 6; ++i )
+      BOOST_CHECK_EQUAL( id_of( results[i].get() ), i );
+   BOOST_CHECK_EQUAL( server.connections(), 2u );
+   BOOST_CHECK_EQUAL( server.requests().size(), 6u );
+}
+
+BOOST_AUTO_TEST_CASE(stale_connection_test)
+{
+   for( bool retry : { false, true } ) {
+      BOOST_TEST_CONTEXT( "retry_stale_requests " << retry ) {
+         http_test_server server( echo );
+         http_client::pool_config config;
+         config.max_connections_per_host = 1;
+         config.retry_stale_requests = retry;
+         http_client client( config );
+         const url dest( server.url() );
+
+         BOOST_CHECK_EQUAL( id_of( client.post_async_json( dest, body( 0 ) ).get() ), 0 );
+         // the server closes the idle keep-alive connection, the client finds out once it writes to it
+         server.close_connections();
+         BOOST_REQUIRE( wait_for( [&]() { return server.open_connections() == 0; } ) );
+
+         auto again = client.post_async_json( dest, body( 1 ) );
+         if( retry ) {
+            BOOST_CHECK_EQUAL( id_of( again.get() ), 1 );
+            BOOST_CHECK_EQUAL( server.connections(), 2u );
+            BOOST_CHECK_EQUAL( server.requests().size(), 2u );
+         } else {
+            // the request was written, so it is not sent twice
+            BOOST_CHECK( error_of( again ).find( "Failed to" ) != std::string::npos );
+            BOOST_CHECK_EQUAL( server.requests().size(), 1u );
+            BOOST_CHECK_EQUAL( id_of( client.post_async_json( dest, body( 2 ) ).get() ), 2 );
+         }
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(shutdown_test)
+{
+   http_test_server server( []( const auto& r ) {
+      auto res = echo( r );
+      res.delay = std::chrono::milliseconds( 200 );
+      return res;
+   } );
+   std::atomic<uint32_t> called{ 0 }, failed{ 0 };
+   {
+      http_client client;
+      const url dest( server.url() );
+      for( int i = 0; i < 8; ++i ) {
+         client.post_async_json( dest, body( i ), fc::time_point::maximum(), [&]( std::exception_ptr e, variant ) {
+            ++called;
+            failed += e != nullptr;
+         } );
+      }
+      BOOST_REQUIRE( wait_for( [&]() { return server.requests().size() > 0; } ) );
+   }
+   // the requests written and queued fail when the client goes
+   BOOST_CHECK_EQUAL( called.load(), 8u );
+   BOOST_CHECK_EQUAL( failed.load(), 8u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(http_client_encoding_test)
+
+BOOST_AUTO_TEST_CASE(decode_test)
+{
+   const std::string body = json_body( 5000 );
+   for( const auto& [encoding, encoded] : { std::pair{ std::string( "gzip" ), gzip_test_util::gzip( body, gzip_test_util::fname ) },
+                                            std::pair{ std::string( "x-gzip" ), gzip_test_util::gzip( body ) },
+                                            std::pair{ std::string( "deflate" ), fc::zlib_compress( body ) },
+                                            std::pair{ std::string( "deflate" ), gzip_test_util::raw_deflate( body ) },
+                                            std::pair{ std::string( "identity" ), body },
+                                            std::pair{ std::string(), body } } ) {
+      for( bool streaming : { false, true } ) {
+         BOOST_TEST_CONTEXT( "encoding " << encoding << ", streaming " << streaming ) {
+            http_test_server server( respond_with( encoded, encoding ) );
+            http_client client;
+            client.set_response_config( response_config( streaming ) );
+            const url dest( server.url() );
+
+            const variant sync = client.post_sync_json( dest, "{}" );
+            BOOST_CHECK_EQUAL( sync["i"].as_int64(), 7 );
+            BOOST_CHECK_EQUAL( sync["values"].size(), 5000u );
+            BOOST_CHECK_EQUAL( json::to_string( sync, fc::time_point::maximum() ), body );
+
+            // post_async decodes the same way
+            BOOST_CHECK_EQUAL( json::to_string( client.post_async_json( dest, "{}" ).get(), fc::time_point::maximum() ), body );
+
+            for( const auto& r : server.requests() )
+               BOOST_CHECK_EQUAL( std::string( r.headers[http_test_util::http::field::accept_encoding] ), "gzip, deflate" );
+         }
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(not_accepted_test)
+{
+   http_test_server server( echo );
+   http_client client;
+   BOOST_CHECK_EQUAL( client.post_sync_json( url( server.url() ), body( 1 ) )["i"].as_int64(), 1 );
+   const auto requests = server.requests();
+   BOOST_REQUIRE_EQUAL( requests.size(), 1u );
+   BOOST_CHECK( requests[0].headers.find( http_test_util::http::field::accept_encoding ) == requests[0].headers.end() );
+}
+
+BOOST_AUTO_TEST_CASE(body_limit_test)
+{
+   const std::string body = json_body( 20000 );
+   for( bool streaming : { false, true } ) {
+      BOOST_TEST_CONTEXT( "streaming " << streaming ) {
+         // the body as it is sent
+         {
+            http_test_server server( respond_with( body, "" ) );
+            http_client client;
+            client.set_response_config( response_config( streaming, body.size() - 1 ) );
+            BOOST_CHECK( !sync_error( client, url( server.url() ) ).empty() );
+            BOOST_CHECK_THROW( client.post_async_json( url( server.url() ), "{}" ).get(), fc::exception );
+         }
+         // a small compressed body that decodes into more than the limit
+         {
+            const std::string gz = gzip_test_util::gzip( body );
+            BOOST_REQUIRE_LT( gz.size(), body.size() / 2 );
+            http_test_server server( respond_with( gz, "gzip" ) );
+            http_client client;
+            client.set_response_config( response_config( streaming, body.size() / 2 ) );
+            BOOST_CHECK( sync_error( client, url( server.url() ) ).find( "Decoded response body exceeds" ) != std::string::npos );
+            BOOST_CHECK_THROW( client.post_async_json( url( server.url() ), "{}" ).get(), fc::exception );
+         }
+         // exactly at the limit
+         {
+            http_test_server server( respond_with( fc::zlib_compress( body ), "deflate" ) );
+            http_client client;
+            client.set_response_config( response_config( streaming, body.size() ) );
+            BOOST_CHECK_EQUAL( client.post_sync_json( url( server.url() ), "{}" )["i"].as_int64(), 7 );
+         }
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(bad_encoding_test)
+{
+   const std::string body = json_body( 1000 );
+   std::string truncated = gzip_test_util::gzip( body );
+   truncated.resize( truncated.size() - 5 );
+   std::string bad_crc = gzip_test_util::gzip( body );
+   bad_crc[bad_crc.size() - 8] ^= 1;
+
+   for( const auto& [encoding, encoded, error] : { std::tuple{ "gzip", truncated, "Truncated compressed response body" },
+                                                   std::tuple{ "gzip", bad_crc, "checksum mismatch" },
+                                                   std::tuple{ "br", body, "Unsupported response encoding" } } ) {
+      for( bool streaming : { false, true } ) {
+         BOOST_TEST_CONTEXT( error << ", streaming " << streaming ) {
+            http_test_server server( respond_with( encoded, encoding ) );
+            http_client client;
+            client.set_response_config( response_config( streaming ) );
+            BOOST_CHECK( sync_error( client, url( server.url() ) ).find( error ) != std::string::npos );
+            auto async = client.post_async_json( url( server.url() ), "{}" );
+            BOOST_CHECK( error_of( async ).find( error ) != std::string::npos );
+         }
+      }
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
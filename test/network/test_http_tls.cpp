@@ -0,0 +1,186 @@
+#define BOOST_TEST_MODULE http_tls
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/network/http/http_client.hpp>
+#include <fc/network/url.hpp>
+#include <fc/exception/exception.hpp>
+
+#include "http_test_server.hpp"
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fc;
+using http_test_util::http_test_server;
+
+namespace {
+
+   /// a client that trusts the self-signed certificates of the test servers
+   struct tls_client {
+      tls_client() { client.set_verify_peers( false ); }
+      http_client client;
+   };
+
+   void check_times( const http_client::tls_metrics& m ) {
+      BOOST_CHECK( m.full_handshakes == 0 || m.full_handshake_time.count() > 0 );
+      BOOST_CHECK( m.resumed_handshakes == 0 || m.resumed_handshake_time.count() > 0 );
+      BOOST_CHECK( m.full_handshake_time + m.resumed_handshake_time >= m.max_handshake_time );
+      BOOST_CHECK( m.full_handshakes + m.resumed_handshakes == 0 || m.max_handshake_time.count() > 0 );
+   }
+
+   /// the server accepts a connection a little after the client sees it open
+   template<typename Predicate>
+   bool wait_for( Predicate&& p ) {
+      for( int i = 0; i < 1000 && !p(); ++i )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+      return p();
+   }
+
+}
+
+BOOST_AUTO_TEST_SUITE(http_client_tls_test)
+
+BOOST_AUTO_TEST_CASE(tls13_resume_test)
+{
+   auto tls = http_test_util::make_tls_context( TLS1_3_VERSION );
+   http_test_server server( {}, tls.get() );
+   tls_client c;
+   const url dest( server.url() );
+
+   // the tickets of a TLS 1.3 server arrive after the handshake, with the first response
+   c.client.post_async_json( dest, "{}" ).get();
+   auto m = c.client.get_tls_metrics();
+   BOOST_CHECK_EQUAL( m.full_handshakes, 1u );
+   BOOST_CHECK_EQUAL( m.resumed_handshakes, 0u );
+
+   // the server sent two, each resumes one connection
+   c.client.warm_up_async( dest, 3 ).get();
+   m = c.client.get_tls_metrics();
+   BOOST_CHECK_EQUAL( m.full_handshakes, 1u );
+   BOOST_CHECK_EQUAL( m.resumed_handshakes, 2u );
+
+   // and is not used again, the connections that resumed read no tickets of their own yet
+   c.client.warm_up_async( dest, 4 ).get();
+   m = c.client.get_tls_metrics();
+   BOOST_CHECK_EQUAL( m.full_handshakes, 2u );
+   BOOST_CHECK_EQUAL( m.resumed_handshakes, 2u );
+   BOOST_CHECK_EQUAL( m.failed_handshakes, 0u );
+   BOOST_CHECK_EQUAL( server.connections(), 4u );
+   check_times( m );
+}
+
+BOOST_AUTO_TEST_CASE(tls12_resume_test)
+{
+   auto tls = http_test_util::make_tls_context( TLS1_2_VERSION );
+   http_test_server server( {}, tls.get() );
+   tls_client c;
+   const url dest( server.url() );
+
+   c.client.warm_up_async( dest, 1 ).get();
+   // a TLS 1.2 session is reused by every connection, the pool's and post_sync's
+   c.client.warm_up_async( dest, 4 ).get();
+   c.client.warm_up( dest );
+   const auto m = c.client.get_tls_metrics();
+   BOOST_CHECK_EQUAL( m.full_handshakes, 1u );
+   BOOST_CHECK_EQUAL( m.resumed_handshakes, 4u );
+   BOOST_CHECK_EQUAL( server.connections(), 5u );
+   check_times( m );
+
+   // the sessions of a host are not offered to another
+   http_test_server other( {}, tls.get() );
+   c.client.warm_up_async( url( other.url() ), 1 ).get();
+   BOOST_CHECK_EQUAL( c.client.get_tls_metrics().full_handshakes, 2u );
+}
+
+BOOST_AUTO_TEST_CASE(forget_test)
+{
+   auto tls = http_test_util::make_tls_context( TLS1_2_VERSION );
+   http_test_server server( {}, tls.get() );
+   tls_client c;
+   const url dest( server.url() );
+
+   c.client.post_async_json( dest, "{}" ).get();
+   BOOST_CHECK_EQUAL( c.client.get_tls_metrics().full_handshakes, 1u );
+
+   // a failed handshake drops the sessions of its host, which may no longer be valid
+   server.set_tls( nullptr );
+   BOOST_CHECK_THROW( c.client.warm_up_async( dest, 2 ).get(), fc::exception );
+   BOOST_CHECK_EQUAL( c.client.get_tls_metrics().failed_handshakes, 1u );
+
+   server.set_tls( tls.get() );
+   c.client.warm_up_async( dest, 2 ).get();
+   const auto m = c.client.get_tls_metrics();
+   BOOST_CHECK_EQUAL( m.full_handshakes, 2u );
+   BOOST_CHECK_EQUAL( m.resumed_handshakes, 0u );
+   BOOST_CHECK_EQUAL( m.failed_handshakes, 1u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(http_client_warm_up_test)
+
+BOOST_AUTO_TEST_CASE(warm_up_sync_test)
+{
+   auto tls = http_test_util::make_tls_context();
+   for( bool https : { false, true } ) {
+      BOOST_TEST_CONTEXT( "https " << https ) {
+         http_test_server server( {}, https ? tls.get() : nullptr );
+         tls_client c;
+         const url dest( server.url() );
+
+         // the connection post_sync uses is opened once, ahead of the first post
+         c.client.warm_up( dest );
+         c.client.warm_up( dest );
+         BOOST_CHECK( wait_for( [&]() { return server.connections() == 1; } ) );
+         BOOST_CHECK( server.requests().empty() );
+         c.client.post_sync_json( dest, "{}" );
+         BOOST_CHECK_EQUAL( server.connections(), 1u );
+         BOOST_CHECK_EQUAL( server.requests().size(), 1u );
+         BOOST_CHECK_EQUAL( c.client.get_tls_metrics().full_handshakes, https ? 1u : 0u );
+      }
+   }
+}
+
+BOOST_AUTO_TEST_CASE(warm_up_async_test)
+{
+   http_test_server server( []( const auto& ) {
+      http_test_server::response res;
+      res.delay = std::chrono::milliseconds( 50 );
+      return res;
+   } );
+   http_client::pool_config config;
+   config.max_connections_per_host = 3;
+   http_client client( config );
+   const url dest( server.url() );
+
+   // at most max_connections_per_host
+   client.warm_up_async( dest, 5 ).get();
+   BOOST_CHECK( wait_for( [&]() { return server.connections() == 3; } ) );
+
+   // the posts go to the connections already open
+   std::vector<std::future<variant>> results;
+   for( int i = 0; i < 6; ++i )
+      results.push_back( client.post_async_json( dest, "{}" ) );
+   for( auto& r : results )
+      r.get();
+   BOOST_CHECK_EQUAL( server.connections(), 3u );
+   BOOST_CHECK_EQUAL( server.requests().size(), 6u );
+}
+
+BOOST_AUTO_TEST_CASE(warm_up_failure_test)
+{
+   // a port nothing listens on, once the server is gone
+   std::string dead;
+   {
+      http_test_server server;
+      dead = server.url();
+   }
+   http_client client;
+   BOOST_CHECK_THROW( client.warm_up( url( dead ) ), fc::exception );
+   BOOST_CHECK_THROW( client.warm_up_async( url( dead ), 2 ).get(), fc::exception );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,74 @@
+/**
+ *  Builds objects of 8, 64, 1k and 100k keys with mutable_variant_object::set, then looks every key
+ *  up with find, in the mutable object and in the variant_object made from it, and prints the time
+ *  per call of each. Small objects are scanned, larger ones build the hash index on first lookup.
+ *
+ *  bench_variant_object [lookups per size]
+ */
+#include <fc/variant_object.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+
+   /// keeps the results alive so the calls are not optimized away
+   volatile size_t sink_found = 0;
+
+   double ns_since( bench_clock::time_point start, size_t calls ) {
+      return std::chrono::duration<double, std::nano>( bench_clock::now() - start ).count() / calls;
+   }
+
+   std::vector<std::string> make_keys( size_t n ) {
+      std::vector<std::string> keys;
+      keys.reserve( n );
+      for( size_t i = 0; i < n; ++i )
+         keys.push_back( "key_" + std::to_string( i * 7919 ) );
+      return keys;
+   }
+
+   template<typename Object>
+   double find_all( const Object& obj, const std::vector<std::string>& keys, size_t lookups ) {
+      size_t found = 0;
+      const auto start = bench_clock::now();
+      for( size_t i = 0; i < lookups; ++i )
+         found += obj.find( keys[( i * 31 ) % keys.size()] ) != obj.end();
+      const double ns = ns_since( start, lookups );
+      sink_found = sink_found + found;
+      return ns;
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   const size_t lookups = argc > 1 ? std::stoul( argv[1] ) : 1000000;
+
+   printf( "%8s %12s %14s %14s\n", "keys", "set ns", "mutable find", "object find" );
+   for( size_t n : { size_t( 8 ), size_t( 64 ), size_t( 1024 ), size_t( 100 * 1024 ) } ) {
+      const auto keys = make_keys( n );
+
+      // enough objects that the small sizes are not timed on a single pass
+      const size_t rounds = std::max<size_t>( 1, 100000 / n );
+      mutable_variant_object mvo;
+      const auto start = bench_clock::now();
+      for( size_t r = 0; r < rounds; ++r ) {
+         mvo = mutable_variant_object();
+         for( size_t i = 0; i < n; ++i )
+            mvo.set( keys[i], variant( uint64_t( i ) ) );
+      }
+      const double set_ns = ns_since( start, rounds * n );
+
+      const double mutable_ns = find_all( mvo, keys, lookups );
+      const variant_object obj( mvo );
+      const double object_ns = find_all( obj, keys, lookups );
+      printf( "%8zu %12.1f %14.1f %14.1f\n", n, set_ns, mutable_ns, object_ns );
+   }
+   return 0;
+}
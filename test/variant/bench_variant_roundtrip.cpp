@@ -0,0 +1,94 @@
+/**
+ *  Copies a variant holding an array of 500 strings and 500 objects 1000 times, and prints the time
+ *  and the heap allocations per copy of each way: a plain copy, which shares the array, a copy of an
+ *  array whose objects were reached through get_array() and get_object(), which copies the array and
+ *  the objects, and a conversion to std::vector<variant> and back.
+ *
+ *  bench_variant_roundtrip [copies]
+ */
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace fc;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+   std::atomic<uint64_t> allocations{0};
+}
+
+void* operator new( size_t size ) {
+   allocations.fetch_add( 1, std::memory_order_relaxed );
+   if( void* p = std::malloc( size ? size : 1 ) )
+      return p;
+   throw std::bad_alloc();
+}
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, size_t ) noexcept { std::free( p ); }
+
+namespace {
+
+   /// keeps the copies alive so they are not optimized away
+   volatile size_t sink_size = 0;
+
+   variant make_array( size_t n ) {
+      variants values;
+      values.reserve( n );
+      for( size_t i = 0; i < n; ++i ) {
+         if( i % 2 )
+            values.emplace_back( mutable_variant_object( "account", "eosio.token" )( "amount", i )( "memo", "transfer " + std::to_string( i ) ) );
+         else
+            values.emplace_back( "a string long enough to be stored on the heap " + std::to_string( i ) );
+      }
+      return variant( std::move( values ) );
+   }
+
+   template<typename F>
+   void measure( const char* name, size_t copies, F&& copy ) {
+      const uint64_t before = allocations.load();
+      const auto start = bench_clock::now();
+      size_t size = 0;
+      for( size_t i = 0; i < copies; ++i )
+         size += copy();
+      const double ns = std::chrono::duration<double, std::nano>( bench_clock::now() - start ).count() / copies;
+      const double allocs = double( allocations.load() - before ) / copies;
+      sink_size = sink_size + size;
+      printf( "%-28s %12.1f %14.1f\n", name, ns, allocs );
+   }
+
+}
+
+int main( int argc, char** argv ) {
+   const size_t copies = argc > 1 ? std::stoul( argv[1] ) : 1000;
+   const variant shared = make_array( 1000 );
+
+   // a value reached through a non-const accessor is no longer shared, its copies allocate their own
+   variant unshared = make_array( 1000 );
+   for( auto& v : unshared.get_array() ) {
+      if( v.is_object() )
+         v.get_object();
+   }
+
+   printf( "%-28s %12s %14s\n", "", "ns/copy", "allocs/copy" );
+   measure( "shared copy", copies, [&]() {
+      const variant copy = shared;
+      return copy.size();
+   } );
+   measure( "copy after get_array()", copies, [&]() {
+      const variant copy = unshared;
+      return copy.size();
+   } );
+   measure( "to vector and back", copies, [&]() {
+      const auto values = shared.as<std::vector<variant>>();
+      const variant back( values );
+      return back.size();
+   } );
+   return 0;
+}
@@ -2,9 +2,40 @@
 #include <boost/test/included/unit_test.hpp>
 
 #include <fc/variant_object.hpp>
+#include <fc/reflect/variant.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/crypto/base64.hpp>
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
+
+namespace variant_test {
+   struct base_fields {
+      uint32_t a = 0;
+      std::string b;
+   };
+
+   struct wide_fields : base_fields {
+      uint32_t f00 = 0, f01 = 0, f02 = 0, f03 = 0, f04 = 0, f05 = 0, f06 = 0, f07 = 0, f08 = 0, f09 = 0;
+      uint32_t f10 = 0, f11 = 0, f12 = 0, f13 = 0, f14 = 0, f15 = 0, f16 = 0, f17 = 0, f18 = 0, f19 = 0;
+      uint32_t f20 = 0, f21 = 0, f22 = 0, f23 = 0, f24 = 0, f25 = 0, f26 = 0, f27 = 0, f28 = 0, f29 = 0;
+      std::optional<std::string> opt;
+   };
+
+   /// reflects a name its base reflects too
+   struct shadowing_fields : base_fields {
+      std::string a;
+      uint32_t    c = 0;
+   };
+}
+
+FC_REFLECT( variant_test::base_fields, (a)(b) )
+FC_REFLECT_DERIVED( variant_test::wide_fields, (variant_test::base_fields),
+                    (f00)(f01)(f02)(f03)(f04)(f05)(f06)(f07)(f08)(f09)
+                    (f10)(f11)(f12)(f13)(f14)(f15)(f16)(f17)(f18)(f19)
+                    (f20)(f21)(f22)(f23)(f24)(f25)(f26)(f27)(f28)(f29)(opt) )
+FC_REFLECT_DERIVED( variant_test::shadowing_fields, (variant_test::base_fields), (a)(c) )
 
 using namespace fc;
 
@@ -95,4 +126,146 @@ BOOST_AUTO_TEST_CASE(variant_format_string_limited)
       BOOST_CHECK_LT(result.size(), 1024 + 3 * mu.size());
    }
 }
+BOOST_AUTO_TEST_CASE(variant_object_large_find_test)
+{
+   constexpr size_t num_keys = 1000;
+   mutable_variant_object mvo;
+   for( size_t i = 0; i < num_keys; ++i ) {
+      mvo.set( "key" + std::to_string(i), i );
+   }
+   mvo.set( "key10", "replaced" );
+   mvo( "key20", variant( "duplicate" ) ); // appended without checking, find still returns the first one
+   BOOST_REQUIRE_EQUAL( mvo.size(), num_keys + 1 );
+   BOOST_CHECK_EQUAL( mvo["key10"].as_string(), "replaced" );
+   BOOST_CHECK_EQUAL( mvo["key20"].as_uint64(), 20u );
+   BOOST_CHECK( mvo.find( "missing" ) == mvo.end() );
+
+   mvo.erase( "key0" );
+   BOOST_CHECK( mvo.find( "key0" ) == mvo.end() );
+   BOOST_CHECK_EQUAL( mvo["key999"].as_uint64(), 999u );
+   mvo["key0"] = 0;
+   BOOST_CHECK_EQUAL( (mvo.end() - 1)->key(), "key0" );
+
+   const variant_object vo( mvo );
+   for( auto itr = vo.begin(); itr != vo.end(); ++itr ) {
+      if( itr->value().is_string() && itr->value().as_string() == "duplicate" )
+         BOOST_CHECK( vo.find( itr->key() ) < itr );
+      else
+         BOOST_CHECK( vo.find( itr->key() ) == itr );
+   }
+   BOOST_CHECK( !vo.contains( "missing" ) );
+
+   variant_object copy = vo;
+   copy = mutable_variant_object( "key1", 1 );
+   BOOST_CHECK_EQUAL( copy.size(), 1u );
+   BOOST_CHECK_EQUAL( vo.size(), num_keys + 1 );
+   BOOST_CHECK_EQUAL( vo["key999"].as_uint64(), 999u );
+}
+
+BOOST_AUTO_TEST_CASE(mutable_variant_object_concurrent_find_test)
+{
+   // a copy starts without an index, the first const lookups of several threads build it together
+   mutable_variant_object original;
+   for( size_t i = 0; i < 20; ++i ) {
+      original.set( "key" + std::to_string(i), i );
+   }
+   for( int round = 0; round < 100; ++round ) {
+      const mutable_variant_object copy( original );
+      std::atomic<bool> go{ false };
+      std::atomic<uint32_t> found{ 0 };
+      std::vector<std::thread> threads;
+      for( int t = 0; t < 4; ++t ) {
+         threads.emplace_back( [&, t]() {
+            while( !go )
+               std::this_thread::yield();
+            for( size_t i = 0; i < 20; ++i ) {
+               const size_t k = ( i + t * 5 ) % 20;
+               found += copy.find( "key" + std::to_string(k) ) != copy.end() && copy["key" + std::to_string(k)].as_uint64() == k;
+            }
+         } );
+      }
+      go = true;
+      for( auto& t : threads )
+         t.join();
+      BOOST_CHECK_EQUAL( found.load(), 80u );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(variant_copy_independence_test)
+{
+   fc::variants arr{ fc::variant("a"), fc::variant(1) };
+   fc::variant v1( arr );
+   fc::variant v2 = v1;
+
+   v2.get_array().push_back( fc::variant("b") );
+   BOOST_CHECK_EQUAL( v1.size(), 2u );
+   BOOST_CHECK_EQUAL( v2.size(), 3u );
+
+   // a copy taken while a mutable reference is outstanding must not see later writes
+   auto& a1 = v1.get_array();
+   fc::variant v3 = v1;
+   a1[size_t(0)] = fc::variant("changed");
+   BOOST_CHECK_EQUAL( v3[size_t(0)].get_string(), "a" );
+   BOOST_CHECK_EQUAL( v1[size_t(0)].get_string(), "changed" );
+
+   fc::variant s1( std::string("some string") );
+   fc::variant s2 = s1;
+   s1 = fc::variant("other");
+   BOOST_CHECK_EQUAL( s2.get_string(), "some string" );
+
+   fc::variant o1( fc::mutable_variant_object("k", 1) );
+   fc::variant o2 = o1;
+   o2.get_object() = fc::mutable_variant_object("k", 2);
+   BOOST_CHECK_EQUAL( o1["k"].as_uint64(), 1u );
+   BOOST_CHECK_EQUAL( o2["k"].as_uint64(), 2u );
+}
+
+BOOST_AUTO_TEST_CASE(from_variant_reflected_test)
+{
+   mutable_variant_object mvo;
+   for( uint32_t i = 29; i < 30; --i ) // reverse of the reflected order
+      mvo( (i < 10 ? "f0" : "f") + std::to_string(i), variant(i + 100) );
+   mvo( "unknown", variant("ignored") );
+   mvo( "a", variant(7) );
+   mvo( "a", variant(8) ); // the first of duplicate keys wins, as with variant_object::find
+   mvo( "b", variant("bee") );
+
+   variant_test::wide_fields w;
+   w.opt = "preset";
+   from_variant( variant(mvo), w );
+   BOOST_CHECK_EQUAL( w.a, 7u );
+   BOOST_CHECK_EQUAL( w.b, "bee" );
+   BOOST_CHECK_EQUAL( w.f00, 100u );
+   BOOST_CHECK_EQUAL( w.f17, 117u );
+   BOOST_CHECK_EQUAL( w.f29, 129u );
+   BOOST_REQUIRE( w.opt.has_value() ); // members without an entry are left untouched
+   BOOST_CHECK_EQUAL( *w.opt, "preset" );
+
+   const variant round_trip( w );
+   BOOST_CHECK( round_trip.as<variant_test::wide_fields>().f23 == 123u );
+   BOOST_CHECK( reflector_member_index<variant_test::wide_fields>::find( "a" ) == 0u );
+   BOOST_CHECK( reflector_member_index<variant_test::wide_fields>::find( "f00" ) == 2u );
+   BOOST_CHECK( reflector_member_index<variant_test::wide_fields>::find( "nope" ) == reflector_member_index<variant_test::wide_fields>::npos );
+}
+
+BOOST_AUTO_TEST_CASE(from_variant_duplicate_member_name_test)
+{
+   // every member reflected as "a", in the base and in the derived class, is assigned the first entry
+   variant_test::shadowing_fields s;
+   from_variant( variant( mutable_variant_object( "c", variant(3) )( "a", variant(7) )( "b", variant("bee") )( "a", variant(8) ) ), s );
+   BOOST_CHECK_EQUAL( s.base_fields::a, 7u );
+   BOOST_CHECK_EQUAL( s.a, "7" );
+   BOOST_CHECK_EQUAL( s.b, "bee" );
+   BOOST_CHECK_EQUAL( s.c, 3u );
+
+   typedef reflector_member_index<variant_test::shadowing_fields> index;
+   BOOST_CHECK( index::has_duplicate_names() );
+   BOOST_CHECK( !reflector_member_index<variant_test::wide_fields>::has_duplicate_names() );
+   const auto range = index::equal_range( "a" );
+   BOOST_REQUIRE_EQUAL( std::distance( range.first, range.second ), 2 );
+   BOOST_CHECK_EQUAL( range.first->second, 0u );
+   BOOST_CHECK_EQUAL( std::next( range.first )->second, 2u );
+   BOOST_CHECK_EQUAL( index::find( "a" ), 0u );
+}
+
 BOOST_AUTO_TEST_SUITE_END()